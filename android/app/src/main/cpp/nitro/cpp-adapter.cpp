@@ -1,6 +1,13 @@
 #include <jni.h>
 #include "morseNitroOnLoad.hpp"
+#include "ActuatorThread.hpp"
+#include "NativeOutputsBridge.hpp"
 
 JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM* vm, void*) {
-  return margelo::nitro::morse::initialize(vm);
+  const jint version = margelo::nitro::morse::initialize(vm);
+  // Resolve dispatcher method IDs and attach the actuator thread up front so
+  // the first replay never pays for class lookups or JVM attachment.
+  margelo::nitro::morse::resolveNativeOutputsBridge();
+  margelo::nitro::morse::ActuatorThread::shared().start();
+  return version;
 }
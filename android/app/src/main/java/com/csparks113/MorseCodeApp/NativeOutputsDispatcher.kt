@@ -8,6 +8,8 @@ import android.graphics.drawable.ColorDrawable
 import android.hardware.camera2.CameraAccessException
 import android.hardware.camera2.CameraCharacteristics
 import android.hardware.camera2.CameraManager
+import android.media.AudioDeviceInfo
+import android.media.AudioManager
 import android.os.Build
 import android.os.Bundle
 import android.os.Handler
@@ -45,6 +47,23 @@ object NativeOutputsDispatcher {
   private const val BRIGHTNESS_SCALAR_MAX = 1.0f
   private const val DEFAULT_TINT_COLOR = 0xFFFFFFFF.toInt()
   private const val APPEARANCE_EVENT = "flashAppearanceApplied"
+  // Ids shared with NativeHapticEffect in NativeOutputsBridge.hpp.
+  private const val HAPTIC_TICK = 0
+  private const val HAPTIC_CLICK = 1
+  private const val HAPTIC_HEAVY_CLICK = 2
+  private const val HAPTIC_DOUBLE_CLICK = 3
+  private const val HAPTIC_SUCCESS = 4
+  private const val HAPTIC_WARNING = 5
+  private const val HAPTIC_ERROR = 6
+  // Ids shared with AudioRoute in AudioRoute.hpp.
+  private const val AUDIO_ROUTE_SPEAKER = 0
+  private const val AUDIO_ROUTE_WIRED = 1
+  private const val AUDIO_ROUTE_BLUETOOTH = 2
+  private const val AUDIO_ROUTE_USB = 3
+  private const val AUDIO_ROUTE_OTHER = 4
+  // AudioDeviceInfo.TYPE_BLE_HEADSET / TYPE_BLE_SPEAKER (API 31).
+  private const val BLE_HEADSET_TYPE = 26
+  private const val BLE_SPEAKER_TYPE = 27
 
   private enum class OverlayAvailabilityState {
     UNKNOWN,
@@ -223,6 +242,182 @@ object NativeOutputsDispatcher {
     }
   }
 
+  /**
+   * Plays a whole replay pattern as one waveform. [timings] alternates off/on
+   * durations in milliseconds starting with the initial off delay, matching
+   * [VibrationEffect.createWaveform]. Returns false when no vibrator is present.
+   */
+  @JvmStatic
+  fun vibrateWaveform(timings: LongArray): Boolean {
+    if (timings.size < 2 || timings.none { it > 0 }) {
+      return false
+    }
+    val localVibrator = vibrator ?: resolveVibrator(applicationContext).also { vibrator = it }
+    if (localVibrator == null) {
+      if (vibrateUnavailableLogged.compareAndSet(false, true)) {
+        Log.w(TAG, "Vibrator unavailable; ignoring vibrateWaveform(${timings.size})")
+      }
+      return false
+    }
+    return try {
+      if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.O) {
+        localVibrator.vibrate(VibrationEffect.createWaveform(timings, -1))
+      } else {
+        @Suppress("DEPRECATION")
+        localVibrator.vibrate(timings, -1)
+      }
+      true
+    } catch (error: SecurityException) {
+      Log.w(TAG, "Missing permission while triggering vibration waveform", error)
+      false
+    } catch (error: RuntimeException) {
+      Log.w(TAG, "Unexpected error while triggering vibration waveform", error)
+      false
+    }
+  }
+
+  /**
+   * Builds the [VibrationEffect] for a native haptic effect id. The C++ side
+   * calls this once per id and keeps the result as a global ref, so a tap only
+   * pays for [playHapticEffect]. Returns null below API 26 or for unknown ids.
+   */
+  @JvmStatic
+  fun createHapticEffect(effectId: Int): Any? {
+    if (Build.VERSION.SDK_INT < Build.VERSION_CODES.O) {
+      return null
+    }
+    if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.Q) {
+      val predefined = when (effectId) {
+        HAPTIC_TICK -> VibrationEffect.EFFECT_TICK
+        HAPTIC_CLICK -> VibrationEffect.EFFECT_CLICK
+        HAPTIC_HEAVY_CLICK -> VibrationEffect.EFFECT_HEAVY_CLICK
+        HAPTIC_DOUBLE_CLICK, HAPTIC_SUCCESS -> VibrationEffect.EFFECT_DOUBLE_CLICK
+        else -> null
+      }
+      if (predefined != null) {
+        return VibrationEffect.createPredefined(predefined)
+      }
+    }
+    return when (effectId) {
+      HAPTIC_TICK -> VibrationEffect.createOneShot(10, 80)
+      HAPTIC_CLICK -> VibrationEffect.createOneShot(20, 160)
+      HAPTIC_HEAVY_CLICK -> VibrationEffect.createOneShot(30, 255)
+      HAPTIC_DOUBLE_CLICK, HAPTIC_SUCCESS ->
+        VibrationEffect.createWaveform(longArrayOf(0, 20, 60, 20), intArrayOf(0, 160, 0, 160), -1)
+      HAPTIC_WARNING ->
+        VibrationEffect.createWaveform(longArrayOf(0, 40, 80, 40), intArrayOf(0, 200, 0, 200), -1)
+      HAPTIC_ERROR ->
+        VibrationEffect.createWaveform(
+          longArrayOf(0, 40, 60, 40, 60, 40),
+          intArrayOf(0, 255, 0, 255, 0, 255),
+          -1,
+        )
+      else -> null
+    }
+  }
+
+  /** Plays an effect built by [createHapticEffect]. */
+  @JvmStatic
+  fun playHapticEffect(effect: Any): Boolean {
+    if (Build.VERSION.SDK_INT < Build.VERSION_CODES.O || effect !is VibrationEffect) {
+      return false
+    }
+    val localVibrator = vibrator ?: resolveVibrator(applicationContext).also { vibrator = it }
+    if (localVibrator == null) {
+      if (vibrateUnavailableLogged.compareAndSet(false, true)) {
+        Log.w(TAG, "Vibrator unavailable; ignoring playHapticEffect")
+      }
+      return false
+    }
+    return try {
+      localVibrator.vibrate(effect)
+      true
+    } catch (error: SecurityException) {
+      Log.w(TAG, "Missing permission while playing haptic effect", error)
+      false
+    } catch (error: RuntimeException) {
+      Log.w(TAG, "Unexpected error while playing haptic effect", error)
+      false
+    }
+  }
+
+  @JvmStatic
+  fun cancelVibration() {
+    val localVibrator = vibrator ?: return
+    try {
+      localVibrator.cancel()
+    } catch (error: RuntimeException) {
+      Log.w(TAG, "Unexpected error while cancelling vibration", error)
+    }
+  }
+
+  /**
+   * Describes the output device an audio stream opened on as
+   * "<route id>|<product name>". [deviceId] is the stream's device id; when
+   * it is unknown (0, or an OpenSL ES stream) the device the platform routes
+   * media to is guessed from what is connected. Empty below API 23.
+   */
+  @JvmStatic
+  fun getActiveAudioRoute(deviceId: Int): String {
+    if (Build.VERSION.SDK_INT < Build.VERSION_CODES.M) {
+      return ""
+    }
+    val audioManager =
+      applicationContext?.getSystemService(Context.AUDIO_SERVICE) as? AudioManager ?: return ""
+    return try {
+      val devices = audioManager.getDevices(AudioManager.GET_DEVICES_OUTPUTS)
+      val device =
+        devices.firstOrNull { deviceId != 0 && it.id == deviceId }
+          ?: devices.maxByOrNull { audioRoutePriority(audioRouteId(it.type)) }
+          ?: return ""
+      "${audioRouteId(device.type)}|${device.productName}"
+    } catch (error: RuntimeException) {
+      Log.w(TAG, "Unexpected error while resolving audio route", error)
+      ""
+    }
+  }
+
+  /**
+   * Directory native code keeps its per-device caches in (the audio
+   * capability probe). Not backed up, so a restore onto another phone starts
+   * clean. Empty before [initialize].
+   */
+  @JvmStatic
+  fun getCacheDirectory(): String {
+    return applicationContext?.noBackupFilesDir?.absolutePath ?: ""
+  }
+
+  private fun audioRouteId(type: Int): Int {
+    return when (type) {
+      AudioDeviceInfo.TYPE_BUILTIN_SPEAKER,
+      AudioDeviceInfo.TYPE_BUILTIN_EARPIECE -> AUDIO_ROUTE_SPEAKER
+      AudioDeviceInfo.TYPE_WIRED_HEADSET,
+      AudioDeviceInfo.TYPE_WIRED_HEADPHONES,
+      AudioDeviceInfo.TYPE_LINE_ANALOG -> AUDIO_ROUTE_WIRED
+      AudioDeviceInfo.TYPE_BLUETOOTH_A2DP,
+      AudioDeviceInfo.TYPE_BLUETOOTH_SCO,
+      AudioDeviceInfo.TYPE_HEARING_AID,
+      BLE_HEADSET_TYPE,
+      BLE_SPEAKER_TYPE -> AUDIO_ROUTE_BLUETOOTH
+      AudioDeviceInfo.TYPE_USB_DEVICE,
+      AudioDeviceInfo.TYPE_USB_HEADSET,
+      AudioDeviceInfo.TYPE_USB_ACCESSORY -> AUDIO_ROUTE_USB
+      else -> AUDIO_ROUTE_OTHER
+    }
+  }
+
+  // Without a device id, media is assumed to go to the most personal output
+  // connected: Bluetooth, then wired, then USB, then the speaker.
+  private fun audioRoutePriority(routeId: Int): Int {
+    return when (routeId) {
+      AUDIO_ROUTE_BLUETOOTH -> 4
+      AUDIO_ROUTE_WIRED -> 3
+      AUDIO_ROUTE_USB -> 2
+      AUDIO_ROUTE_SPEAKER -> 1
+      else -> 0
+    }
+  }
+
   private fun setTorchEnabledInternal(enabled: Boolean, waitForResult: Boolean): Boolean {
     val manager = cameraManager
     val cameraId = torchCameraId
@@ -56,6 +56,7 @@ export default ({ config }: ConfigContext): ExpoConfig => {
       backgroundColor: '#000000',
     },
     edgeToEdgeEnabled: true,
+    permissions: ['android.permission.RECORD_AUDIO'],
     package: 'com.csparks113.MorseCodeApp',
     ...config.android,
   };
@@ -6,7 +6,7 @@ import type { PromptActionLabels, PromptActionConfig, SessionActionIconName } fr
 import { useSessionFlow } from '@/hooks/useSessionFlow';
 import { useKeyerOutputs } from '@/hooks/useKeyerOutputs';
 import { useOutputsService, type PlaybackSymbolContext, resolvePlaybackRequestedAt, resolvePlaybackTimelineOffset, buildPlaybackMetadata } from '@/services/outputs/OutputsService';
-import { createPressTracker } from '@/services/latency/pressTracker';
+import { createPressTracker, normalizePressTimestamp } from '@/services/latency/pressTracker';
 import { traceOutputs } from '@/services/outputs/trace';
 import { useProgressStore } from '@/store/useProgressStore';
 import { TOTAL_SEND_QUESTIONS, DEFAULT_VERDICT_BUFFER_MS } from '@/constants/appConfig';
@@ -19,7 +19,7 @@ import {
   getMorseUnitMs,
   MORSE_UNITS,
 } from '@/utils/morseTiming';
-import { nowMs, toMonotonicTime } from '@/utils/time';
+import { nowMs } from '@/utils/time';
 
 type FeedbackState = 'idle' | 'correct' | 'wrong';
 type PressWindow = { startMs: number; endMs: number };
@@ -559,7 +559,7 @@ export function useSendSession({
   );
 
   const onPressOut = React.useCallback((rawTimestamp?: number) => {
-    const releaseAt = toMonotonicTime(rawTimestamp);
+    const releaseAt = normalizePressTimestamp(rawTimestamp);
     onUp(releaseAt);
 
     if (!canInteractBase || isReplaying) {
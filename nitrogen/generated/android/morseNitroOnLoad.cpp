@@ -17,6 +17,7 @@
 
 #include "JHybridHapticsSpec.hpp"
 #include "OutputsAudio.hpp"
+#include "Haptics.hpp"
 
 namespace margelo::nitro::morse {
 
@@ -39,6 +40,15 @@ int initialize(JavaVM* vm) {
         return std::make_shared<OutputsAudio>();
       }
     );
+    HybridObjectRegistry::registerHybridObjectConstructor(
+      "Haptics",
+      []() -> std::shared_ptr<HybridObject> {
+        static_assert(std::is_default_constructible_v<Haptics>,
+                      "The HybridObject \"Haptics\" is not default-constructible! "
+                      "Create a public constructor that takes zero arguments to be able to autolink this HybridObject.");
+        return std::make_shared<Haptics>();
+      }
+    );
   });
 }
 
@@ -26,6 +26,7 @@ namespace margelo::nitro::morse { enum class PlaybackSymbol; }
 #include "PlaybackDispatchPhase.hpp"
 #include "PlaybackSymbol.hpp"
 #include <optional>
+#include <string>
 
 namespace margelo::nitro::morse {
 
@@ -53,10 +54,11 @@ namespace margelo::nitro::morse {
     std::optional<double> sincePriorMs     SWIFT_PRIVATE;
     std::optional<bool> flashHandledNatively     SWIFT_PRIVATE;
     std::optional<bool> nativeFlashAvailable     SWIFT_PRIVATE;
+    std::optional<std::string> correlationId     SWIFT_PRIVATE;
 
   public:
     PlaybackDispatchEvent() = default;
-    explicit PlaybackDispatchEvent(PlaybackDispatchPhase phase, PlaybackSymbol symbol, double sequence, double patternStartMs, double expectedTimestampMs, double offsetMs, double durationMs, double unitMs, double toneHz, std::optional<double> scheduledTimestampMs, std::optional<double> leadMs, std::optional<double> actualTimestampMs, std::optional<double> monotonicTimestampMs, std::optional<double> startSkewMs, std::optional<double> batchElapsedMs, std::optional<double> expectedSincePriorMs, std::optional<double> sincePriorMs, std::optional<bool> flashHandledNatively, std::optional<bool> nativeFlashAvailable): phase(phase), symbol(symbol), sequence(sequence), patternStartMs(patternStartMs), expectedTimestampMs(expectedTimestampMs), offsetMs(offsetMs), durationMs(durationMs), unitMs(unitMs), toneHz(toneHz), scheduledTimestampMs(scheduledTimestampMs), leadMs(leadMs), actualTimestampMs(actualTimestampMs), monotonicTimestampMs(monotonicTimestampMs), startSkewMs(startSkewMs), batchElapsedMs(batchElapsedMs), expectedSincePriorMs(expectedSincePriorMs), sincePriorMs(sincePriorMs), flashHandledNatively(flashHandledNatively), nativeFlashAvailable(nativeFlashAvailable) {}
+    explicit PlaybackDispatchEvent(PlaybackDispatchPhase phase, PlaybackSymbol symbol, double sequence, double patternStartMs, double expectedTimestampMs, double offsetMs, double durationMs, double unitMs, double toneHz, std::optional<double> scheduledTimestampMs, std::optional<double> leadMs, std::optional<double> actualTimestampMs, std::optional<double> monotonicTimestampMs, std::optional<double> startSkewMs, std::optional<double> batchElapsedMs, std::optional<double> expectedSincePriorMs, std::optional<double> sincePriorMs, std::optional<bool> flashHandledNatively, std::optional<bool> nativeFlashAvailable, std::optional<std::string> correlationId): phase(phase), symbol(symbol), sequence(sequence), patternStartMs(patternStartMs), expectedTimestampMs(expectedTimestampMs), offsetMs(offsetMs), durationMs(durationMs), unitMs(unitMs), toneHz(toneHz), scheduledTimestampMs(scheduledTimestampMs), leadMs(leadMs), actualTimestampMs(actualTimestampMs), monotonicTimestampMs(monotonicTimestampMs), startSkewMs(startSkewMs), batchElapsedMs(batchElapsedMs), expectedSincePriorMs(expectedSincePriorMs), sincePriorMs(sincePriorMs), flashHandledNatively(flashHandledNatively), nativeFlashAvailable(nativeFlashAvailable), correlationId(correlationId) {}
   };
 
 } // namespace margelo::nitro::morse
@@ -87,7 +89,8 @@ namespace margelo::nitro {
         JSIConverter<std::optional<double>>::fromJSI(runtime, obj.getProperty(runtime, "expectedSincePriorMs")),
         JSIConverter<std::optional<double>>::fromJSI(runtime, obj.getProperty(runtime, "sincePriorMs")),
         JSIConverter<std::optional<bool>>::fromJSI(runtime, obj.getProperty(runtime, "flashHandledNatively")),
-        JSIConverter<std::optional<bool>>::fromJSI(runtime, obj.getProperty(runtime, "nativeFlashAvailable"))
+        JSIConverter<std::optional<bool>>::fromJSI(runtime, obj.getProperty(runtime, "nativeFlashAvailable")),
+        JSIConverter<std::optional<std::string>>::fromJSI(runtime, obj.getProperty(runtime, "correlationId"))
       );
     }
     static inline jsi::Value toJSI(jsi::Runtime& runtime, const margelo::nitro::morse::PlaybackDispatchEvent& arg) {
@@ -111,6 +114,7 @@ namespace margelo::nitro {
       obj.setProperty(runtime, "sincePriorMs", JSIConverter<std::optional<double>>::toJSI(runtime, arg.sincePriorMs));
       obj.setProperty(runtime, "flashHandledNatively", JSIConverter<std::optional<bool>>::toJSI(runtime, arg.flashHandledNatively));
       obj.setProperty(runtime, "nativeFlashAvailable", JSIConverter<std::optional<bool>>::toJSI(runtime, arg.nativeFlashAvailable));
+      obj.setProperty(runtime, "correlationId", JSIConverter<std::optional<std::string>>::toJSI(runtime, arg.correlationId));
       return obj;
     }
     static inline bool canConvert(jsi::Runtime& runtime, const jsi::Value& value) {
@@ -137,6 +141,7 @@ namespace margelo::nitro {
       if (!JSIConverter<std::optional<double>>::canConvert(runtime, obj.getProperty(runtime, "sincePriorMs"))) return false;
       if (!JSIConverter<std::optional<bool>>::canConvert(runtime, obj.getProperty(runtime, "flashHandledNatively"))) return false;
       if (!JSIConverter<std::optional<bool>>::canConvert(runtime, obj.getProperty(runtime, "nativeFlashAvailable"))) return false;
+      if (!JSIConverter<std::optional<std::string>>::canConvert(runtime, obj.getProperty(runtime, "correlationId"))) return false;
       return true;
     }
   };
@@ -0,0 +1,94 @@
+///
+/// PlaybackProgressEvent.hpp
+/// This file was generated by nitrogen. DO NOT MODIFY THIS FILE.
+/// https://github.com/mrousavy/nitro
+/// Copyright © 2025 Marc Rousavy @ Margelo
+///
+
+#pragma once
+
+#if __has_include(<NitroModules/JSIConverter.hpp>)
+#include <NitroModules/JSIConverter.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/NitroDefines.hpp>)
+#include <NitroModules/NitroDefines.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+
+// Forward declaration of `PlaybackProgressPhase` to properly resolve imports.
+namespace margelo::nitro::morse { enum class PlaybackProgressPhase; }
+
+#include "PlaybackProgressPhase.hpp"
+#include <optional>
+#include <string>
+
+namespace margelo::nitro::morse {
+
+  /**
+   * A struct which can be represented as a JavaScript object (PlaybackProgressEvent).
+   */
+  struct PlaybackProgressEvent {
+  public:
+    PlaybackProgressPhase phase     SWIFT_PRIVATE;
+    double character     SWIFT_PRIVATE;
+    double word     SWIFT_PRIVATE;
+    double sequence     SWIFT_PRIVATE;
+    bool wordFinished     SWIFT_PRIVATE;
+    double timestampMs     SWIFT_PRIVATE;
+    std::optional<std::string> correlationId     SWIFT_PRIVATE;
+
+  public:
+    PlaybackProgressEvent() = default;
+    explicit PlaybackProgressEvent(PlaybackProgressPhase phase, double character, double word, double sequence, bool wordFinished, double timestampMs, std::optional<std::string> correlationId): phase(phase), character(character), word(word), sequence(sequence), wordFinished(wordFinished), timestampMs(timestampMs), correlationId(correlationId) {}
+  };
+
+} // namespace margelo::nitro::morse
+
+namespace margelo::nitro {
+
+  // C++ PlaybackProgressEvent <> JS PlaybackProgressEvent (object)
+  template <>
+  struct JSIConverter<margelo::nitro::morse::PlaybackProgressEvent> final {
+    static inline margelo::nitro::morse::PlaybackProgressEvent fromJSI(jsi::Runtime& runtime, const jsi::Value& arg) {
+      jsi::Object obj = arg.asObject(runtime);
+      return margelo::nitro::morse::PlaybackProgressEvent(
+        JSIConverter<margelo::nitro::morse::PlaybackProgressPhase>::fromJSI(runtime, obj.getProperty(runtime, "phase")),
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, "character")),
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, "word")),
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, "sequence")),
+        JSIConverter<bool>::fromJSI(runtime, obj.getProperty(runtime, "wordFinished")),
+        JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, "timestampMs")),
+        JSIConverter<std::optional<std::string>>::fromJSI(runtime, obj.getProperty(runtime, "correlationId"))
+      );
+    }
+    static inline jsi::Value toJSI(jsi::Runtime& runtime, const margelo::nitro::morse::PlaybackProgressEvent& arg) {
+      jsi::Object obj(runtime);
+      obj.setProperty(runtime, "phase", JSIConverter<margelo::nitro::morse::PlaybackProgressPhase>::toJSI(runtime, arg.phase));
+      obj.setProperty(runtime, "character", JSIConverter<double>::toJSI(runtime, arg.character));
+      obj.setProperty(runtime, "word", JSIConverter<double>::toJSI(runtime, arg.word));
+      obj.setProperty(runtime, "sequence", JSIConverter<double>::toJSI(runtime, arg.sequence));
+      obj.setProperty(runtime, "wordFinished", JSIConverter<bool>::toJSI(runtime, arg.wordFinished));
+      obj.setProperty(runtime, "timestampMs", JSIConverter<double>::toJSI(runtime, arg.timestampMs));
+      obj.setProperty(runtime, "correlationId", JSIConverter<std::optional<std::string>>::toJSI(runtime, arg.correlationId));
+      return obj;
+    }
+    static inline bool canConvert(jsi::Runtime& runtime, const jsi::Value& value) {
+      if (!value.isObject()) {
+        return false;
+      }
+      jsi::Object obj = value.getObject(runtime);
+      if (!JSIConverter<margelo::nitro::morse::PlaybackProgressPhase>::canConvert(runtime, obj.getProperty(runtime, "phase"))) return false;
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, "character"))) return false;
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, "word"))) return false;
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, "sequence"))) return false;
+      if (!JSIConverter<bool>::canConvert(runtime, obj.getProperty(runtime, "wordFinished"))) return false;
+      if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, "timestampMs"))) return false;
+      if (!JSIConverter<std::optional<std::string>>::canConvert(runtime, obj.getProperty(runtime, "correlationId"))) return false;
+      return true;
+    }
+  };
+
+} // namespace margelo::nitro
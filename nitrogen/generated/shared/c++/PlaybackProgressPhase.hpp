@@ -0,0 +1,76 @@
+///
+/// PlaybackProgressPhase.hpp
+/// This file was generated by nitrogen. DO NOT MODIFY THIS FILE.
+/// https://github.com/mrousavy/nitro
+/// Copyright © 2025 Marc Rousavy @ Margelo
+///
+
+#pragma once
+
+#if __has_include(<NitroModules/NitroHash.hpp>)
+#include <NitroModules/NitroHash.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/JSIConverter.hpp>)
+#include <NitroModules/JSIConverter.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+#if __has_include(<NitroModules/NitroDefines.hpp>)
+#include <NitroModules/NitroDefines.hpp>
+#else
+#error NitroModules cannot be found! Are you sure you installed NitroModules properly?
+#endif
+
+namespace margelo::nitro::morse {
+
+  /**
+   * An enum which can be represented as a JavaScript union (PlaybackProgressPhase).
+   */
+  enum class PlaybackProgressPhase {
+    STARTED      SWIFT_NAME(started) = 0,
+    FINISHED      SWIFT_NAME(finished) = 1,
+  } CLOSED_ENUM;
+
+} // namespace margelo::nitro::morse
+
+namespace margelo::nitro {
+
+  // C++ PlaybackProgressPhase <> JS PlaybackProgressPhase (union)
+  template <>
+  struct JSIConverter<margelo::nitro::morse::PlaybackProgressPhase> final {
+    static inline margelo::nitro::morse::PlaybackProgressPhase fromJSI(jsi::Runtime& runtime, const jsi::Value& arg) {
+      std::string unionValue = JSIConverter<std::string>::fromJSI(runtime, arg);
+      switch (hashString(unionValue.c_str(), unionValue.size())) {
+        case hashString("started"): return margelo::nitro::morse::PlaybackProgressPhase::STARTED;
+        case hashString("finished"): return margelo::nitro::morse::PlaybackProgressPhase::FINISHED;
+        default: [[unlikely]]
+          throw std::invalid_argument("Cannot convert \"" + unionValue + "\" to enum PlaybackProgressPhase - invalid value!");
+      }
+    }
+    static inline jsi::Value toJSI(jsi::Runtime& runtime, margelo::nitro::morse::PlaybackProgressPhase arg) {
+      switch (arg) {
+        case margelo::nitro::morse::PlaybackProgressPhase::STARTED: return JSIConverter<std::string>::toJSI(runtime, "started");
+        case margelo::nitro::morse::PlaybackProgressPhase::FINISHED: return JSIConverter<std::string>::toJSI(runtime, "finished");
+        default: [[unlikely]]
+          throw std::invalid_argument("Cannot convert PlaybackProgressPhase to JS - invalid value: "
+                                    + std::to_string(static_cast<int>(arg)) + "!");
+      }
+    }
+    static inline bool canConvert(jsi::Runtime& runtime, const jsi::Value& value) {
+      if (!value.isString()) {
+        return false;
+      }
+      std::string unionValue = JSIConverter<std::string>::fromJSI(runtime, value);
+      switch (hashString(unionValue.c_str(), unionValue.size())) {
+        case hashString("started"):
+        case hashString("finished"):
+          return true;
+        default:
+          return false;
+      }
+    }
+  };
+
+} // namespace margelo::nitro
@@ -24,6 +24,7 @@ namespace margelo::nitro::morse { enum class PlaybackSymbol; }
 #include "PlaybackSymbol.hpp"
 #include <vector>
 #include <optional>
+#include <string>
 
 namespace margelo::nitro::morse {
 
@@ -41,10 +42,11 @@ namespace margelo::nitro::morse {
     std::optional<bool> torchEnabled     SWIFT_PRIVATE;
     std::optional<double> flashBrightnessPercent     SWIFT_PRIVATE;
     std::optional<bool> screenBrightnessBoost     SWIFT_PRIVATE;
+    std::optional<std::vector<std::string>> correlationIds     SWIFT_PRIVATE;
 
   public:
     PlaybackRequest() = default;
-    explicit PlaybackRequest(double toneHz, double unitMs, std::vector<PlaybackSymbol> pattern, std::optional<double> gain, std::optional<bool> flashEnabled, std::optional<bool> hapticsEnabled, std::optional<bool> torchEnabled, std::optional<double> flashBrightnessPercent, std::optional<bool> screenBrightnessBoost): toneHz(toneHz), unitMs(unitMs), pattern(pattern), gain(gain), flashEnabled(flashEnabled), hapticsEnabled(hapticsEnabled), torchEnabled(torchEnabled), flashBrightnessPercent(flashBrightnessPercent), screenBrightnessBoost(screenBrightnessBoost) {}
+    explicit PlaybackRequest(double toneHz, double unitMs, std::vector<PlaybackSymbol> pattern, std::optional<double> gain, std::optional<bool> flashEnabled, std::optional<bool> hapticsEnabled, std::optional<bool> torchEnabled, std::optional<double> flashBrightnessPercent, std::optional<bool> screenBrightnessBoost, std::optional<std::vector<std::string>> correlationIds): toneHz(toneHz), unitMs(unitMs), pattern(pattern), gain(gain), flashEnabled(flashEnabled), hapticsEnabled(hapticsEnabled), torchEnabled(torchEnabled), flashBrightnessPercent(flashBrightnessPercent), screenBrightnessBoost(screenBrightnessBoost), correlationIds(correlationIds) {}
   };
 
 } // namespace margelo::nitro::morse
@@ -65,7 +67,8 @@ namespace margelo::nitro {
         JSIConverter<std::optional<bool>>::fromJSI(runtime, obj.getProperty(runtime, "hapticsEnabled")),
         JSIConverter<std::optional<bool>>::fromJSI(runtime, obj.getProperty(runtime, "torchEnabled")),
         JSIConverter<std::optional<double>>::fromJSI(runtime, obj.getProperty(runtime, "flashBrightnessPercent")),
-        JSIConverter<std::optional<bool>>::fromJSI(runtime, obj.getProperty(runtime, "screenBrightnessBoost"))
+        JSIConverter<std::optional<bool>>::fromJSI(runtime, obj.getProperty(runtime, "screenBrightnessBoost")),
+        JSIConverter<std::optional<std::vector<std::string>>>::fromJSI(runtime, obj.getProperty(runtime, "correlationIds"))
       );
     }
     static inline jsi::Value toJSI(jsi::Runtime& runtime, const margelo::nitro::morse::PlaybackRequest& arg) {
@@ -79,6 +82,7 @@ namespace margelo::nitro {
       obj.setProperty(runtime, "torchEnabled", JSIConverter<std::optional<bool>>::toJSI(runtime, arg.torchEnabled));
       obj.setProperty(runtime, "flashBrightnessPercent", JSIConverter<std::optional<double>>::toJSI(runtime, arg.flashBrightnessPercent));
       obj.setProperty(runtime, "screenBrightnessBoost", JSIConverter<std::optional<bool>>::toJSI(runtime, arg.screenBrightnessBoost));
+      obj.setProperty(runtime, "correlationIds", JSIConverter<std::optional<std::vector<std::string>>>::toJSI(runtime, arg.correlationIds));
       return obj;
     }
     static inline bool canConvert(jsi::Runtime& runtime, const jsi::Value& value) {
@@ -95,6 +99,7 @@ namespace margelo::nitro {
       if (!JSIConverter<std::optional<bool>>::canConvert(runtime, obj.getProperty(runtime, "torchEnabled"))) return false;
       if (!JSIConverter<std::optional<double>>::canConvert(runtime, obj.getProperty(runtime, "flashBrightnessPercent"))) return false;
       if (!JSIConverter<std::optional<bool>>::canConvert(runtime, obj.getProperty(runtime, "screenBrightnessBoost"))) return false;
+      if (!JSIConverter<std::optional<std::vector<std::string>>>::canConvert(runtime, obj.getProperty(runtime, "correlationIds"))) return false;
       return true;
     }
   };
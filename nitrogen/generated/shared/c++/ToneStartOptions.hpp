@@ -22,6 +22,7 @@
 namespace margelo::nitro::morse { struct ToneEnvelopeOptions; }
 
 #include <optional>
+#include <string>
 #include "ToneEnvelopeOptions.hpp"
 
 namespace margelo::nitro::morse {
@@ -34,10 +35,11 @@ namespace margelo::nitro::morse {
     double toneHz     SWIFT_PRIVATE;
     std::optional<double> gain     SWIFT_PRIVATE;
     std::optional<ToneEnvelopeOptions> envelope     SWIFT_PRIVATE;
+    std::optional<std::string> correlationId     SWIFT_PRIVATE;
 
   public:
     ToneStartOptions() = default;
-    explicit ToneStartOptions(double toneHz, std::optional<double> gain, std::optional<ToneEnvelopeOptions> envelope): toneHz(toneHz), gain(gain), envelope(envelope) {}
+    explicit ToneStartOptions(double toneHz, std::optional<double> gain, std::optional<ToneEnvelopeOptions> envelope, std::optional<std::string> correlationId): toneHz(toneHz), gain(gain), envelope(envelope), correlationId(correlationId) {}
   };
 
 } // namespace margelo::nitro::morse
@@ -52,7 +54,8 @@ namespace margelo::nitro {
       return margelo::nitro::morse::ToneStartOptions(
         JSIConverter<double>::fromJSI(runtime, obj.getProperty(runtime, "toneHz")),
         JSIConverter<std::optional<double>>::fromJSI(runtime, obj.getProperty(runtime, "gain")),
-        JSIConverter<std::optional<margelo::nitro::morse::ToneEnvelopeOptions>>::fromJSI(runtime, obj.getProperty(runtime, "envelope"))
+        JSIConverter<std::optional<margelo::nitro::morse::ToneEnvelopeOptions>>::fromJSI(runtime, obj.getProperty(runtime, "envelope")),
+        JSIConverter<std::optional<std::string>>::fromJSI(runtime, obj.getProperty(runtime, "correlationId"))
       );
     }
     static inline jsi::Value toJSI(jsi::Runtime& runtime, const margelo::nitro::morse::ToneStartOptions& arg) {
@@ -60,6 +63,7 @@ namespace margelo::nitro {
       obj.setProperty(runtime, "toneHz", JSIConverter<double>::toJSI(runtime, arg.toneHz));
       obj.setProperty(runtime, "gain", JSIConverter<std::optional<double>>::toJSI(runtime, arg.gain));
       obj.setProperty(runtime, "envelope", JSIConverter<std::optional<margelo::nitro::morse::ToneEnvelopeOptions>>::toJSI(runtime, arg.envelope));
+      obj.setProperty(runtime, "correlationId", JSIConverter<std::optional<std::string>>::toJSI(runtime, arg.correlationId));
       return obj;
     }
     static inline bool canConvert(jsi::Runtime& runtime, const jsi::Value& value) {
@@ -70,6 +74,7 @@ namespace margelo::nitro {
       if (!JSIConverter<double>::canConvert(runtime, obj.getProperty(runtime, "toneHz"))) return false;
       if (!JSIConverter<std::optional<double>>::canConvert(runtime, obj.getProperty(runtime, "gain"))) return false;
       if (!JSIConverter<std::optional<margelo::nitro::morse::ToneEnvelopeOptions>>::canConvert(runtime, obj.getProperty(runtime, "envelope"))) return false;
+      if (!JSIConverter<std::optional<std::string>>::canConvert(runtime, obj.getProperty(runtime, "correlationId"))) return false;
       return true;
     }
   };
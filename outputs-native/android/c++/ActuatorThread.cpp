@@ -0,0 +1,392 @@
+#include "ActuatorThread.hpp"
+
+#include "AllocationAudit.hpp"
+#include "NativeOutputsBridge.hpp"
+#include "TraceRecorder.hpp"
+
+#include <android/log.h>
+#include <fbjni/fbjni.h>
+#include <pthread.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace margelo::nitro::morse {
+
+namespace {
+constexpr const char* kLogPrefix = "[outputs-audio]";
+constexpr const char* kTag = "OutputsAudio";
+constexpr double kIdleWaitMs = 50.0;
+constexpr double kLateCommandThresholdMs = 4.0;
+// Frame marks are not signalled (the audio thread must not take the wake
+// mutex), so the worker polls at this interval while timed work is pending.
+constexpr double kFrameMarkPollMs = 2.0;
+// Larger corrections come from a bad stream timestamp, not from drift.
+constexpr double kMaxFrameClockOffsetMs = 100.0;
+
+inline double nowMs() {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+inline const char* commandName(ActuatorCommandType type) {
+  switch (type) {
+    case ActuatorCommandType::Torch:
+      return "torch";
+    case ActuatorCommandType::OverlayState:
+      return "overlay";
+    case ActuatorCommandType::Vibrate:
+      return "vibrate";
+    case ActuatorCommandType::BrightnessBoost:
+      return "brightness";
+    case ActuatorCommandType::VibrateWaveform:
+      return "waveform";
+    case ActuatorCommandType::CancelVibration:
+      return "vibrate.cancel";
+    case ActuatorCommandType::HapticEffect:
+      return "haptic";
+  }
+  return "unknown";
+}
+} // namespace
+
+ActuatorThread& ActuatorThread::shared() {
+  // Intentionally leaked: the worker stays attached to the JVM for the life of
+  // the process and must not be joined from static destructors.
+  static ActuatorThread* instance = new ActuatorThread();
+  return *instance;
+}
+
+ActuatorThread::ActuatorThread()
+    : mDroppedFrameMarks(0),
+      mFrameClockListener(nullptr),
+      mFrameClockGeneration(0),
+      mFrameClockOffsetMs(0.0),
+      mStarted(false),
+      mDroppedCommands(0),
+      mPinnedListener(nullptr) {
+  mPending.reserve(kQueueCapacity);
+  for (WaveformSlot& slot : mWaveforms) {
+    slot.timings.reserve(kMaxWaveformTimings);
+    slot.generation = 0;
+    slot.sequence = 0;
+    slot.pending = false;
+  }
+  mExecuteWaveform.reserve(kMaxWaveformTimings);
+  mListeners.reserve(4);
+}
+
+void ActuatorThread::start() {
+  bool expected = false;
+  if (!mStarted.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+    return;
+  }
+  mThread = std::thread([this]() { run(); });
+  mThread.detach();
+}
+
+bool ActuatorThread::submit(const ActuatorCommand& command) {
+  start();
+  if (!mQueue.tryPush(command)) {
+    const uint64_t dropped = mDroppedCommands.fetch_add(1, std::memory_order_relaxed) + 1;
+    __android_log_print(ANDROID_LOG_WARN,
+                        kTag,
+                        "%s actuator.queue.full type=%s dropped=%llu",
+                        kLogPrefix,
+                        commandName(command.type),
+                        static_cast<unsigned long long>(dropped));
+    return false;
+  }
+  // The empty critical section orders this push against the worker's
+  // "queue empty -> wait" check so a wakeup can never be lost.
+  { std::lock_guard<std::mutex> lock(mWakeMutex); }
+  mWakeCondition.notify_one();
+  return true;
+}
+
+bool ActuatorThread::submitWaveform(const ActuatorCommand& command, const std::vector<int64_t>& timings) {
+  WaveformSlot* target = nullptr;
+  {
+    // Keep whole on/off pairs when truncating.
+    const std::size_t count = std::min(timings.size(), kMaxWaveformTimings) & ~std::size_t{ 1 };
+    std::lock_guard<std::mutex> lock(mWaveformMutex);
+    // A slot is free once its chunk ran, or once a newer generation made the
+    // command that would consume it stale; the same chunk queued again
+    // replaces its own slot.
+    for (WaveformSlot& slot : mWaveforms) {
+      if (!slot.pending || slot.generation < command.generation ||
+          (slot.generation == command.generation && slot.sequence == command.sequence)) {
+        target = &slot;
+        break;
+      }
+    }
+    if (target != nullptr) {
+      target->timings.assign(timings.begin(), timings.begin() + static_cast<std::ptrdiff_t>(count));
+      target->generation = command.generation;
+      target->sequence = command.sequence;
+      target->pending = true;
+    }
+  }
+  if (target == nullptr) {
+    __android_log_print(ANDROID_LOG_WARN,
+                        kTag,
+                        "%s actuator.waveform.full sequence=%llu pending=%zu",
+                        kLogPrefix,
+                        static_cast<unsigned long long>(command.sequence),
+                        kWaveformSlots);
+    return false;
+  }
+  if (!submit(command)) {
+    std::lock_guard<std::mutex> lock(mWaveformMutex);
+    if (target->generation == command.generation && target->sequence == command.sequence) {
+      target->pending = false;
+    }
+    return false;
+  }
+  return true;
+}
+
+bool ActuatorThread::publishFrameMark(const AudioFrameMark& mark) {
+  if (!mFrameMarks.tryPush(mark)) {
+    mDroppedFrameMarks.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  return true;
+}
+
+void ActuatorThread::attachListener(ActuatorListener* listener) {
+  if (listener == nullptr) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mListenerMutex);
+  if (std::find(mListeners.begin(), mListeners.end(), listener) == mListeners.end()) {
+    mListeners.push_back(listener);
+  }
+}
+
+void ActuatorThread::detachListener(ActuatorListener* listener) {
+  std::unique_lock<std::mutex> lock(mListenerMutex);
+  mListeners.erase(std::remove(mListeners.begin(), mListeners.end(), listener), mListeners.end());
+  // Only a callback already under way can still reach the listener; it is
+  // short unless the JNI call it makes is, and other listeners are not held
+  // up by it.
+  mListenerIdle.wait(lock, [this, listener]() { return mPinnedListener != listener; });
+}
+
+bool ActuatorThread::pinListener(ActuatorListener* listener) {
+  std::lock_guard<std::mutex> lock(mListenerMutex);
+  if (std::find(mListeners.begin(), mListeners.end(), listener) == mListeners.end()) {
+    return false;
+  }
+  mPinnedListener = listener;
+  return true;
+}
+
+void ActuatorThread::unpinListener() {
+  {
+    std::lock_guard<std::mutex> lock(mListenerMutex);
+    mPinnedListener = nullptr;
+  }
+  mListenerIdle.notify_all();
+}
+
+void ActuatorThread::releaseWaveform(const ActuatorCommand& command) {
+  if (command.type != ActuatorCommandType::VibrateWaveform) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mWaveformMutex);
+  for (WaveformSlot& slot : mWaveforms) {
+    if (slot.pending && slot.generation == command.generation && slot.sequence == command.sequence) {
+      slot.pending = false;
+      return;
+    }
+  }
+}
+
+void ActuatorThread::run() {
+  pthread_setname_np(pthread_self(), "outputs-actuator");
+  facebook::jni::Environment::ensureCurrentThreadIsAttached();
+  __android_log_print(ANDROID_LOG_DEBUG, kTag, "%s actuator.thread.start", kLogPrefix);
+
+  for (;;) {
+    drainQueue();
+    applyFrameMarks();
+
+    const double now = nowMs();
+    while (!mPending.empty() && mPending.front().dueTimeMs <= now) {
+      const ActuatorCommand command = mPending.front();
+      mPending.erase(mPending.begin());
+      execute(command);
+    }
+
+    double waitMs = kIdleWaitMs;
+    if (!mPending.empty()) {
+      waitMs = std::clamp(mPending.front().dueTimeMs - nowMs(), 0.0, kFrameMarkPollMs);
+    }
+    std::unique_lock<std::mutex> lock(mWakeMutex);
+    if (!mQueue.empty() || waitMs <= 0.0) {
+      continue;
+    }
+    mWakeCondition.wait_for(lock, std::chrono::duration<double, std::milli>(waitMs));
+  }
+}
+
+void ActuatorThread::drainQueue() {
+  ActuatorCommand command{};
+  while (mQueue.tryPop(command)) {
+    if (command.targetTimeMs > 0.0 && command.listener == mFrameClockListener &&
+        command.generation == mFrameClockGeneration) {
+      command.dueTimeMs += mFrameClockOffsetMs;
+      command.targetTimeMs += mFrameClockOffsetMs;
+      command.frameClockOffsetMs = mFrameClockOffsetMs;
+    }
+    if (mPending.size() >= kQueueCapacity) {
+      // Never grow past the reserved capacity; flush the earliest command early.
+      const ActuatorCommand earliest = mPending.front();
+      mPending.erase(mPending.begin());
+      execute(earliest);
+    }
+    // Stable insert keeps FIFO order between commands that share a due time.
+    const auto position =
+        std::upper_bound(mPending.begin(),
+                         mPending.end(),
+                         command.dueTimeMs,
+                         [](double due, const ActuatorCommand& entry) { return due < entry.dueTimeMs; });
+    mPending.insert(position, command);
+  }
+}
+
+void ActuatorThread::applyFrameMarks() {
+  AudioFrameMark mark{};
+  bool moved = false;
+  while (mFrameMarks.tryPop(mark)) {
+    const double offsetMs = std::clamp(mark.presentationMs - mark.expectedTimestampMs,
+                                       -kMaxFrameClockOffsetMs,
+                                       kMaxFrameClockOffsetMs);
+    mFrameClockListener = mark.listener;
+    mFrameClockGeneration = mark.generation;
+    mFrameClockOffsetMs = offsetMs;
+    TraceRecorder::shared().record(TraceEventType::FrameMark, static_cast<int64_t>(mark.sequence), offsetMs);
+    for (ActuatorCommand& command : mPending) {
+      // Earlier symbols already followed their own mark.
+      if (command.targetTimeMs <= 0.0 || command.listener != mark.listener ||
+          command.generation != mark.generation || command.sequence < mark.sequence) {
+        continue;
+      }
+      const double deltaMs = offsetMs - command.frameClockOffsetMs;
+      command.dueTimeMs += deltaMs;
+      command.targetTimeMs += deltaMs;
+      command.frameClockOffsetMs = offsetMs;
+      moved = true;
+    }
+  }
+  if (!moved) {
+    return;
+  }
+  // Only one listener's commands moved, all by similar amounts, so the list
+  // is nearly sorted; an in-place stable insertion sort restores it without
+  // allocating.
+  for (std::size_t i = 1; i < mPending.size(); ++i) {
+    const ActuatorCommand command = mPending[i];
+    std::size_t j = i;
+    while (j > 0 && mPending[j - 1].dueTimeMs > command.dueTimeMs) {
+      mPending[j] = mPending[j - 1];
+      --j;
+    }
+    mPending[j] = command;
+  }
+}
+
+void ActuatorThread::execute(const ActuatorCommand& command) {
+  AllocationAuditScope auditScope;
+  // The listener is pinned rather than called under mListenerMutex: its
+  // callbacks make JNI calls of their own, and a destructor detaching
+  // another listener must not queue up behind them.
+  const bool hasListener = command.listener != nullptr;
+  if (hasListener) {
+    // A detached listener's owner is gone or going; what it queued is stale.
+    if (!pinListener(command.listener)) {
+      releaseWaveform(command);
+      return;
+    }
+    if (!command.listener->isActuatorCommandCurrent(command)) {
+      unpinListener();
+      return;
+    }
+  }
+
+  const double startedAtMs = nowMs();
+  TraceRecorder::shared().record(TraceEventType::ActuatorBegin,
+                                 static_cast<int64_t>(command.sequence),
+                                 0.0,
+                                 static_cast<uint16_t>(command.type));
+  bool success = true;
+  {
+    // The JNI bridge and the Java side own their allocations.
+    AllocationAuditExemption bridgeExemption;
+    switch (command.type) {
+      case ActuatorCommandType::Torch:
+        // The synchronous variant returns once the camera service applied the
+        // mode, which is what the per-channel latency estimate needs to observe.
+        success = setNativeTorchEnabledSync(command.enabled);
+        break;
+      case ActuatorCommandType::OverlayState:
+        success = setNativeFlashOverlayState(command.enabled, command.value);
+        break;
+      case ActuatorCommandType::Vibrate:
+        triggerNativeVibration(static_cast<long>(std::llround(command.value)));
+        break;
+      case ActuatorCommandType::BrightnessBoost:
+        setNativeScreenBrightnessBoost(command.enabled);
+        break;
+      case ActuatorCommandType::VibrateWaveform: {
+        mExecuteWaveform.clear();
+        {
+          std::lock_guard<std::mutex> lock(mWaveformMutex);
+          for (WaveformSlot& slot : mWaveforms) {
+            if (slot.pending && slot.generation == command.generation && slot.sequence == command.sequence) {
+              mExecuteWaveform.swap(slot.timings);
+              slot.pending = false;
+              break;
+            }
+          }
+        }
+        success = !mExecuteWaveform.empty() && triggerNativeVibrationWaveform(mExecuteWaveform);
+        break;
+      }
+      case ActuatorCommandType::CancelVibration:
+        cancelNativeVibration();
+        break;
+      case ActuatorCommandType::HapticEffect:
+        success = playNativeHapticEffect(static_cast<NativeHapticEffect>(std::lround(command.value)));
+        break;
+    }
+  }
+  const double committedAtMs = nowMs();
+  TraceRecorder::shared().record(TraceEventType::ActuatorEnd,
+                                 static_cast<int64_t>(command.sequence),
+                                 success ? 1.0 : 0.0,
+                                 static_cast<uint16_t>(command.type));
+
+  const double lateMs = startedAtMs - std::max(command.dueTimeMs, command.enqueuedAtMs);
+  if (lateMs > kLateCommandThresholdMs) {
+    __android_log_print(ANDROID_LOG_DEBUG,
+                        kTag,
+                        "%s actuator.late type=%s sequence=%llu late=%.3f call=%.3f",
+                        kLogPrefix,
+                        commandName(command.type),
+                        static_cast<unsigned long long>(command.sequence),
+                        lateMs,
+                        committedAtMs - startedAtMs);
+  }
+
+  if (!hasListener) {
+    return;
+  }
+  command.listener->onActuatorCommandCompleted(command, success, startedAtMs, committedAtMs);
+  unpinListener();
+}
+
+} // namespace margelo::nitro::morse
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "LockFreeQueue.hpp"
+
+namespace margelo::nitro::morse {
+
+class ActuatorListener;
+
+enum class ActuatorCommandType : uint8_t {
+  Torch,
+  OverlayState,
+  Vibrate,
+  BrightnessBoost,
+  VibrateWaveform,
+  CancelVibration,
+  HapticEffect,
+};
+
+struct ActuatorCommand {
+  ActuatorCommandType type;
+  bool enabled;
+  // Brightness percent for overlay commands, duration (ms) for vibration,
+  // total pattern length (ms) for waveforms, NativeHapticEffect for effects.
+  double value;
+  // steady_clock milliseconds; commands due in the past run immediately.
+  double dueTimeMs;
+  // When the output is meant to become visible on the timeline (dueTimeMs plus
+  // the channel lead); 0 for untimed commands such as cancellation.
+  double targetTimeMs;
+  double enqueuedAtMs;
+  uint64_t sequence;
+  // Playback generation that produced the command; stale generations are
+  // dropped before they reach Java (see ActuatorListener::isActuatorCommandCurrent).
+  uint64_t generation;
+  // Commands of a listener that has since been detached are dropped. Null for
+  // cleanup (outputs off) that must run even after its submitter is gone.
+  ActuatorListener* listener;
+  // Correction already applied to dueTimeMs/targetTimeMs from audio frame
+  // marks (see AudioFrameMark); 0 when queued.
+  double frameClockOffsetMs;
+  // CorrelationLog tag the commit is logged under; 0 when untagged.
+  uint32_t correlationTag;
+};
+
+// Published by the audio callback on the frame a pattern tone starts: symbol
+// `sequence` of `generation` reaches the DAC at presentationMs, where the
+// timeline expected it at expectedTimestampMs.
+struct AudioFrameMark {
+  ActuatorListener* listener;
+  uint64_t generation;
+  uint64_t sequence;
+  int64_t frame;
+  double presentationMs;
+  double expectedTimestampMs;
+};
+
+class ActuatorListener {
+ public:
+  virtual ~ActuatorListener() = default;
+  // Checked on the actuator thread right before the command is dispatched.
+  virtual bool isActuatorCommandCurrent(const ActuatorCommand& /* command */) const { return true; }
+  // Invoked on the actuator thread once the JNI call returned.
+  virtual void onActuatorCommandCompleted(const ActuatorCommand& command,
+                                          bool success,
+                                          double dispatchedAtMs,
+                                          double committedAtMs) = 0;
+};
+
+// Process-wide worker that owns every torch/overlay/vibration JNI call made on
+// behalf of playback. The thread is attached to the JVM once, producers hand it
+// timestamped commands through a lock-free queue, and nothing on the audio
+// timeline ever waits for Java to return.
+class ActuatorThread {
+ public:
+  static ActuatorThread& shared();
+
+  void start();
+  bool submit(const ActuatorCommand& command);
+  // A waveform chunk does not fit in a queue slot, so its timings are copied
+  // into one of kWaveformSlots preallocated buffers and picked up when the
+  // VibrateWaveform command with the same generation and sequence runs. A
+  // chunk queued while the earlier ones are still waiting gets its own slot;
+  // when every slot holds an unconsumed chunk of the current generation the
+  // new one is refused. Longer chunks are truncated to kMaxWaveformTimings.
+  static constexpr std::size_t kMaxWaveformTimings = 1024;
+  static constexpr std::size_t kWaveformSlots = 4;
+  bool submitWaveform(const ActuatorCommand& command, const std::vector<int64_t>& timings);
+  // Audio-thread safe (no lock, no wake-up): the worker picks marks up on its
+  // next pass and moves the listener's pending timed commands for that symbol
+  // and later ones by (presentation - expected), so torch, overlay and
+  // vibration follow the sound actually produced rather than the playback
+  // thread's clock. Commands whose lead exceeds the output latency have
+  // already run for the marked symbol; they follow from the next one.
+  bool publishFrameMark(const AudioFrameMark& mark);
+  void attachListener(ActuatorListener* listener);
+  // Returns once no callback into `listener` is running, so the listener can
+  // be destroyed right after. Must not be called from a listener callback.
+  void detachListener(ActuatorListener* listener);
+
+ private:
+  ActuatorThread();
+
+  void run();
+  void drainQueue();
+  void applyFrameMarks();
+  void execute(const ActuatorCommand& command);
+  // Pins an attached listener while execute() calls into it without holding
+  // mListenerMutex; false when it has been detached.
+  bool pinListener(ActuatorListener* listener);
+  void unpinListener();
+  // Frees the slot of a waveform command that is dropped instead of run.
+  void releaseWaveform(const ActuatorCommand& command);
+
+  static constexpr std::size_t kQueueCapacity = 256;
+  static constexpr std::size_t kFrameMarkCapacity = 64;
+
+  LockFreeQueue<ActuatorCommand, kQueueCapacity> mQueue;
+  LockFreeQueue<AudioFrameMark, kFrameMarkCapacity> mFrameMarks;
+  std::atomic<uint64_t> mDroppedFrameMarks;
+  // Worker-only: latest frame-clock correction, applied to matching commands
+  // as they are drained so later symbols start out corrected.
+  ActuatorListener* mFrameClockListener;
+  uint64_t mFrameClockGeneration;
+  double mFrameClockOffsetMs;
+  std::vector<ActuatorCommand> mPending;
+  std::mutex mWakeMutex;
+  std::condition_variable mWakeCondition;
+  std::atomic<bool> mStarted;
+  std::atomic<uint64_t> mDroppedCommands;
+  std::thread mThread;
+  std::mutex mListenerMutex;
+  std::vector<ActuatorListener*> mListeners;
+  // The listener execute() is calling into (only the worker calls listeners,
+  // so there is at most one); detachListener waits on mListenerIdle until it
+  // is no longer this one.
+  ActuatorListener* mPinnedListener;
+  std::condition_variable mListenerIdle;
+  struct WaveformSlot {
+    std::vector<int64_t> timings;
+    uint64_t generation;
+    uint64_t sequence;
+    bool pending;
+  };
+  std::mutex mWaveformMutex;
+  std::array<WaveformSlot, kWaveformSlots> mWaveforms;
+  // Worker-only; swapped with a slot's timings so no buffer is ever
+  // reallocated.
+  std::vector<int64_t> mExecuteWaveform;
+};
+
+} // namespace margelo::nitro::morse
@@ -0,0 +1,145 @@
+#include "AllocationAudit.hpp"
+
+#if defined(MORSE_ALLOCATION_AUDIT)
+
+#include <android/log.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+namespace margelo::nitro::morse {
+
+namespace {
+constexpr const char* kTag = "OutputsAudio";
+// Scopes opened by the RAII guards on this thread; 0 outside them and while
+// an exemption is active.
+thread_local uint32_t tAuditDepth = 0;
+// Outermost scopes currently open, independent of exemptions.
+thread_local uint32_t tScopeDepth = 0;
+thread_local AllocationAuditReport tReport{};
+
+void noteAllocation(std::size_t size) {
+  if (tAuditDepth == 0) {
+    return;
+  }
+  tReport.allocations += 1;
+  tReport.bytes += size;
+  tReport.largestBytes = std::max(tReport.largestBytes, size);
+}
+
+void* allocate(std::size_t size, std::size_t alignment) {
+  noteAllocation(size);
+  const std::size_t requested = size == 0 ? 1 : size;
+  if (alignment <= alignof(std::max_align_t)) {
+    return std::malloc(requested);
+  }
+  void* pointer = nullptr;
+  return ::posix_memalign(&pointer, alignment, requested) == 0 ? pointer : nullptr;
+}
+
+void* allocateOrThrow(std::size_t size, std::size_t alignment) {
+  void* pointer = allocate(size, alignment);
+  if (pointer == nullptr) {
+    throw std::bad_alloc();
+  }
+  return pointer;
+}
+} // namespace
+
+AllocationAuditReport AllocationAudit::report() {
+  return tReport;
+}
+
+void AllocationAudit::reset() {
+  tReport = {};
+}
+
+AllocationAuditScope::AllocationAuditScope() {
+  if (tScopeDepth++ == 0) {
+    AllocationAudit::reset();
+  }
+  ++tAuditDepth;
+}
+
+AllocationAuditScope::~AllocationAuditScope() {
+  --tAuditDepth;
+  if (--tScopeDepth == 0 && tReport.allocations > 0) {
+    __android_log_assert(nullptr,
+                         kTag,
+                         "[outputs-audio] alloc.audit.failed allocations=%llu bytes=%llu largest=%zu",
+                         static_cast<unsigned long long>(tReport.allocations),
+                         static_cast<unsigned long long>(tReport.bytes),
+                         tReport.largestBytes);
+  }
+}
+
+AllocationAuditExemption::AllocationAuditExemption() : mSavedDepth(tAuditDepth) {
+  tAuditDepth = 0;
+}
+
+AllocationAuditExemption::~AllocationAuditExemption() {
+  tAuditDepth = mSavedDepth;
+}
+
+} // namespace margelo::nitro::morse
+
+using margelo::nitro::morse::allocateOrThrow;
+
+void* operator new(std::size_t size) {
+  return allocateOrThrow(size, alignof(std::max_align_t));
+}
+
+void* operator new[](std::size_t size) {
+  return allocateOrThrow(size, alignof(std::max_align_t));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+  return allocateOrThrow(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+  return allocateOrThrow(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  return margelo::nitro::morse::allocate(size, alignof(std::max_align_t));
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  return margelo::nitro::morse::allocate(size, alignof(std::max_align_t));
+}
+
+void operator delete(void* pointer) noexcept {
+  std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+  std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+  std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+  std::free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept {
+  std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept {
+  std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept {
+  std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept {
+  std::free(pointer);
+}
+
+#endif
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace margelo::nitro::morse {
+
+// Heap-allocation audit for the real-time paths (pattern playback thread,
+// audio callback, actuator worker). Builds configured with
+// -DMORSE_ALLOCATION_AUDIT=ON replace the global operator new and count every
+// allocation made while the calling thread is inside an AllocationAuditScope.
+// Counts are per thread and start from zero when a thread opens its outermost
+// scope, so a playback run, a callback or an actuator command only ever sees
+// its own allocations; closing that scope with a non-zero count aborts, so the
+// tombstone points at the offending thread. In normal builds the scopes
+// compile to nothing. On the host, outputs-native/tools/tests/
+// allocation-audit-test.cpp covers PatternTimeline, FixedRing, ActuatorThread
+// and DriftCorrector under the audit (ctest); OutputsAudio itself needs the
+// device build.
+struct AllocationAuditReport {
+  uint64_t allocations;
+  uint64_t bytes;
+  std::size_t largestBytes;
+};
+
+#if defined(MORSE_ALLOCATION_AUDIT)
+
+class AllocationAudit {
+ public:
+  // The calling thread's counts since its outermost scope opened.
+  static AllocationAuditReport report();
+  static void reset();
+};
+
+class AllocationAuditScope {
+ public:
+  AllocationAuditScope();
+  ~AllocationAuditScope();
+  AllocationAuditScope(const AllocationAuditScope&) = delete;
+  AllocationAuditScope& operator=(const AllocationAuditScope&) = delete;
+};
+
+// Suspends the audit across a boundary we do not own (the Nitro JS callback
+// dispatcher, the JNI bridge, a stream reopen after a device change).
+class AllocationAuditExemption {
+ public:
+  AllocationAuditExemption();
+  ~AllocationAuditExemption();
+  AllocationAuditExemption(const AllocationAuditExemption&) = delete;
+  AllocationAuditExemption& operator=(const AllocationAuditExemption&) = delete;
+
+ private:
+  uint32_t mSavedDepth;
+};
+
+#else
+
+class AllocationAudit {
+ public:
+  static AllocationAuditReport report() { return {}; }
+  static void reset() {}
+};
+
+class AllocationAuditScope {
+ public:
+  // User-provided so the RAII locals do not trip -Wunused-variable.
+  AllocationAuditScope() {}
+  ~AllocationAuditScope() {}
+  AllocationAuditScope(const AllocationAuditScope&) = delete;
+  AllocationAuditScope& operator=(const AllocationAuditScope&) = delete;
+};
+
+class AllocationAuditExemption {
+ public:
+  AllocationAuditExemption() {}
+  ~AllocationAuditExemption() {}
+  AllocationAuditExemption(const AllocationAuditExemption&) = delete;
+  AllocationAuditExemption& operator=(const AllocationAuditExemption&) = delete;
+};
+
+#endif
+
+} // namespace margelo::nitro::morse
@@ -0,0 +1,195 @@
+#include "AudioCapabilityCache.hpp"
+
+#include "NativeOutputsBridge.hpp"
+
+#include <android/log.h>
+#include <sys/system_properties.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace margelo::nitro::morse {
+
+namespace {
+constexpr const char* kLogPrefix = "[outputs-audio]";
+constexpr const char* kTag = "OutputsAudio";
+// Bump when the file layout changes; older files are then ignored.
+constexpr const char* kCacheFileName = "outputs-audio-capabilities.v1";
+
+std::string readBuildFingerprint() {
+  char value[PROP_VALUE_MAX] = {};
+  const int length = __system_property_get("ro.build.fingerprint", value);
+  return length > 0 ? std::string(value, static_cast<std::size_t>(length)) : std::string();
+}
+
+void appendJsonString(std::ostringstream& stream, const std::string& value) {
+  stream << "\"";
+  for (const char c : value) {
+    switch (c) {
+      case '"':
+        stream << "\\\"";
+        break;
+      case '\\':
+        stream << "\\\\";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char escaped[8];
+          std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+          stream << escaped;
+        } else {
+          stream << c;
+        }
+    }
+  }
+  stream << "\"";
+}
+} // namespace
+
+AudioCapabilityCache& AudioCapabilityCache::shared() {
+  static AudioCapabilityCache* instance = new AudioCapabilityCache();
+  return *instance;
+}
+
+AudioCapabilityCache::AudioCapabilityCache() : mLoaded(false), mFromDisk(false) {}
+
+void AudioCapabilityCache::loadLocked() {
+  if (mLoaded) {
+    return;
+  }
+  mFingerprint = readBuildFingerprint();
+  const std::string directory = getNativeCacheDirectory();
+  if (mFingerprint.empty() || directory.empty()) {
+    // Retried on the next call: the dispatcher may not be initialised yet.
+    return;
+  }
+  mLoaded = true;
+  mPath = directory + "/" + kCacheFileName;
+
+  std::ifstream file(mPath);
+  if (!file) {
+    return;
+  }
+  Capabilities capabilities{};
+  bool fingerprintMatches = false;
+  std::string line;
+  while (std::getline(file, line)) {
+    const std::size_t separator = line.find('=');
+    if (separator == std::string::npos) {
+      continue;
+    }
+    const std::string key = line.substr(0, separator);
+    const std::string value = line.substr(separator + 1);
+    if (key == "fingerprint") {
+      fingerprintMatches = value == mFingerprint;
+    } else if (key == "supported") {
+      capabilities.supported = value == "1";
+    } else if (key == "sampleRate") {
+      capabilities.sampleRate = std::atoi(value.c_str());
+    } else if (key == "framesPerBurst") {
+      capabilities.framesPerBurst = std::atoi(value.c_str());
+    } else if (key == "exclusive") {
+      capabilities.exclusive = value == "1";
+    } else if (key == "audioApi") {
+      capabilities.audioApi = std::atoi(value.c_str());
+    }
+  }
+  if (!fingerprintMatches || !capabilities.supported) {
+    __android_log_print(ANDROID_LOG_DEBUG, kTag, "%s capabilities.cache.stale", kLogPrefix);
+    return;
+  }
+  mCapabilities = capabilities;
+  mFromDisk = true;
+  __android_log_print(ANDROID_LOG_DEBUG,
+                      kTag,
+                      "%s capabilities.cache.hit sampleRate=%d burst=%d exclusive=%d api=%d",
+                      kLogPrefix,
+                      capabilities.sampleRate,
+                      capabilities.framesPerBurst,
+                      capabilities.exclusive ? 1 : 0,
+                      capabilities.audioApi);
+}
+
+void AudioCapabilityCache::writeLocked() {
+  if (mPath.empty() || !mCapabilities.has_value()) {
+    return;
+  }
+  // Written aside and renamed so a crash mid-write never leaves a torn file.
+  const std::string temporaryPath = mPath + ".tmp";
+  {
+    std::ofstream file(temporaryPath, std::ios::trunc);
+    if (!file) {
+      return;
+    }
+    const Capabilities& capabilities = mCapabilities.value();
+    file << "fingerprint=" << mFingerprint << "\n"
+         << "supported=" << (capabilities.supported ? 1 : 0) << "\n"
+         << "sampleRate=" << capabilities.sampleRate << "\n"
+         << "framesPerBurst=" << capabilities.framesPerBurst << "\n"
+         << "exclusive=" << (capabilities.exclusive ? 1 : 0) << "\n"
+         << "audioApi=" << capabilities.audioApi << "\n";
+    if (!file) {
+      return;
+    }
+  }
+  if (std::rename(temporaryPath.c_str(), mPath.c_str()) != 0) {
+    std::remove(temporaryPath.c_str());
+    __android_log_print(ANDROID_LOG_WARN, kTag, "%s capabilities.cache.writeFailed", kLogPrefix);
+  }
+}
+
+std::optional<AudioCapabilityCache::Capabilities> AudioCapabilityCache::load() {
+  std::lock_guard<std::mutex> lock(mMutex);
+  loadLocked();
+  return mCapabilities;
+}
+
+void AudioCapabilityCache::store(const Capabilities& capabilities) {
+  if (!capabilities.supported) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mMutex);
+  loadLocked();
+  if (mCapabilities.has_value()) {
+    const Capabilities& current = mCapabilities.value();
+    if (current.sampleRate == capabilities.sampleRate && current.framesPerBurst == capabilities.framesPerBurst &&
+        current.exclusive == capabilities.exclusive && current.audioApi == capabilities.audioApi) {
+      return;
+    }
+  }
+  mCapabilities = capabilities;
+  mFromDisk = false;
+  writeLocked();
+}
+
+void AudioCapabilityCache::forgetStreamConfig() {
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (!mCapabilities.has_value() || mCapabilities->sampleRate == 0) {
+    return;
+  }
+  mCapabilities = Capabilities{ true, 0, 0, true, 0 };
+  writeLocked();
+}
+
+std::string AudioCapabilityCache::toJson() {
+  std::lock_guard<std::mutex> lock(mMutex);
+  loadLocked();
+  std::ostringstream stream;
+  stream << "{\"fingerprint\":";
+  appendJsonString(stream, mFingerprint);
+  stream << ",\"fromDisk\":" << (mFromDisk ? "true" : "false");
+  if (mCapabilities.has_value()) {
+    const Capabilities& capabilities = mCapabilities.value();
+    stream << ",\"supported\":" << (capabilities.supported ? "true" : "false")
+           << ",\"sampleRate\":" << capabilities.sampleRate
+           << ",\"framesPerBurst\":" << capabilities.framesPerBurst
+           << ",\"sharingMode\":\"" << (capabilities.exclusive ? "exclusive" : "shared") << "\""
+           << ",\"audioApi\":" << capabilities.audioApi;
+  }
+  stream << "}";
+  return stream.str();
+}
+
+} // namespace margelo::nitro::morse
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace margelo::nitro::morse {
+
+// Outcome of the Oboe support probe and the configuration the last stream
+// actually opened with, kept in a small file under the app's no-backup
+// directory. The file is keyed on the build fingerprint, so an OS update or
+// a restore onto another phone probes again; otherwise a cold start trusts it
+// and skips the probe stream, and the real stream asks for the granted
+// sample rate and sharing mode up front instead of negotiating them again.
+//
+// Only a supported result is cached: a probe that failed because another app
+// held the device must not disable native audio for the rest of the build.
+class AudioCapabilityCache {
+ public:
+  struct Capabilities {
+    bool supported;
+    // 0 until a stream has opened on this build.
+    int32_t sampleRate;
+    int32_t framesPerBurst;
+    bool exclusive;
+    int32_t audioApi;
+  };
+
+  static AudioCapabilityCache& shared();
+
+  // What the file held for this build (read on the first call), updated by
+  // store(). nullopt when nothing is cached or the build is unknown.
+  std::optional<Capabilities> load();
+  // Writes through when the value changed.
+  void store(const Capabilities& capabilities);
+  // Drops the stream configuration (kept: supported) after it failed to open.
+  void forgetStreamConfig();
+
+  std::string toJson();
+
+ private:
+  AudioCapabilityCache();
+
+  // Caller holds mMutex.
+  void loadLocked();
+  void writeLocked();
+
+  std::mutex mMutex;
+  bool mLoaded;
+  // Whether mCapabilities came from the file rather than this process.
+  bool mFromDisk;
+  std::string mFingerprint;
+  std::string mPath;
+  std::optional<Capabilities> mCapabilities;
+};
+
+} // namespace margelo::nitro::morse
@@ -0,0 +1,415 @@
+#include "AudioEngine.hpp"
+
+#include "AllocationAudit.hpp"
+#include "AudioCapabilityCache.hpp"
+#include "AudioFrameClock.hpp"
+#include "AudioRoute.hpp"
+#include "ChannelLatencyTracker.hpp"
+#include "LatencyHistogram.hpp"
+#include "NativeOutputsBridge.hpp"
+#include "TraceRecorder.hpp"
+
+#include <android/log.h>
+#include <time.h>
+
+#include <algorithm>
+#include <thread>
+
+namespace margelo::nitro::morse {
+
+namespace {
+constexpr const char* kLogPrefix = "[outputs-audio]";
+constexpr const char* kTag = "OutputsAudio";
+// Stream timestamps are sampled every this many callbacks (~20 per second at
+// 48 kHz/192-frame bursts); the latency moves slowly and getTimestamp is not
+// free on every backend.
+constexpr uint32_t kPresentationSampleInterval = 12;
+
+inline double toMillis(const std::chrono::steady_clock::time_point& timePoint) {
+  return std::chrono::duration<double, std::milli>(timePoint.time_since_epoch()).count();
+}
+} // namespace
+
+void AudioEngine::StreamDeleter::operator()(oboe::AudioStream* stream) const {
+  if (stream != nullptr) {
+    stream->close();
+    delete stream;
+  }
+}
+
+AudioEngine& AudioEngine::shared() {
+  // Intentionally leaked, like ActuatorThread: the idle reaper is detached and
+  // the stream must not be torn down from static destructors.
+  static AudioEngine* instance = new AudioEngine();
+  return *instance;
+}
+
+AudioEngine::AudioEngine()
+    : mCallbackEpoch(0),
+      mStream(nullptr),
+      mReady(false),
+      mSampleRate(48000.0),
+      mSupportKnown(false),
+      mSupported(false),
+      mClients(0),
+      mReaperStarted(false),
+      mLastXRunCount(0),
+      mPresentationSampleCountdown(0),
+      mPresentationKnown(false),
+      mPresentedFrame(0),
+      mPresentedMs(0.0) {
+  for (auto& voice : mVoices) {
+    voice.store(nullptr, std::memory_order_relaxed);
+  }
+  mMix.resize(kMixFrames);
+}
+
+bool AudioEngine::isSupported() {
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (mSupportKnown) {
+    return mSupported;
+  }
+  if (mStream) {
+    // Already holding the device; a second exclusive probe would only fail.
+    mSupported = true;
+    mSupportKnown = true;
+    return true;
+  }
+  const auto cached = AudioCapabilityCache::shared().load();
+  if (cached.has_value() && cached->supported) {
+    // Probed on an earlier launch of this build: skip the test stream.
+    mSupported = true;
+    mSupportKnown = true;
+    __android_log_print(ANDROID_LOG_DEBUG, kTag, "%s isSupported.cached", kLogPrefix);
+    return true;
+  }
+  oboe::AudioStreamBuilder builder;
+  builder.setDirection(oboe::Direction::Output);
+  builder.setPerformanceMode(oboe::PerformanceMode::LowLatency);
+  builder.setSharingMode(oboe::SharingMode::Exclusive);
+  builder.setChannelCount(1);
+  builder.setFormat(oboe::AudioFormat::Float);
+
+  oboe::AudioStream* testStream = nullptr;
+  const oboe::Result result = builder.openStream(&testStream);
+  if (result == oboe::Result::OK && testStream != nullptr) {
+    mSupported = true;
+    testStream->close();
+    delete testStream;
+    AudioCapabilityCache::shared().store(AudioCapabilityCache::Capabilities{ true, 0, 0, true, 0 });
+  } else {
+    mSupported = false;
+    __android_log_print(ANDROID_LOG_DEBUG,
+                        kTag,
+                        "%s isSupported.failed error=%s",
+                        kLogPrefix,
+                        oboe::convertToText(result));
+  }
+  mSupportKnown = true;
+  return mSupported;
+}
+
+bool AudioEngine::acquire(AudioVoice* voice) {
+  for (auto& slot : mVoices) {
+    AudioVoice* expected = nullptr;
+    if (slot.compare_exchange_strong(expected, voice, std::memory_order_acq_rel)) {
+      std::lock_guard<std::mutex> lock(mMutex);
+      ++mClients;
+      __android_log_print(ANDROID_LOG_DEBUG, kTag, "%s engine.acquire clients=%zu", kLogPrefix, mClients);
+      return true;
+    }
+  }
+  __android_log_print(ANDROID_LOG_WARN, kTag, "%s engine.acquire.full voices=%zu", kLogPrefix, kMaxVoices);
+  return false;
+}
+
+void AudioEngine::release(AudioVoice* voice) {
+  bool found = false;
+  for (auto& slot : mVoices) {
+    AudioVoice* expected = voice;
+    if (slot.compare_exchange_strong(expected, nullptr, std::memory_order_seq_cst)) {
+      found = true;
+      break;
+    }
+  }
+  if (!found) {
+    return;
+  }
+  // A callback that loaded the slot before it was cleared may still be inside
+  // renderVoice; wait for it to finish that pass. Both sides store then load,
+  // so the slot and epoch accesses need a single total order (seq_cst).
+  const uint32_t epoch = mCallbackEpoch.load(std::memory_order_seq_cst);
+  if ((epoch & 1u) != 0u) {
+    while (mCallbackEpoch.load(std::memory_order_acquire) == epoch) {
+      std::this_thread::yield();
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (mClients > 0 && --mClients == 0) {
+    mIdleSince = std::chrono::steady_clock::now();
+    if (!mReaperStarted) {
+      mReaperStarted = true;
+      std::thread([this]() { runIdleReaper(); }).detach();
+    }
+    mReaperCondition.notify_all();
+  }
+  __android_log_print(ANDROID_LOG_DEBUG, kTag, "%s engine.release clients=%zu", kLogPrefix, mClients);
+}
+
+bool AudioEngine::start() {
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (mReady.load(std::memory_order_acquire) && mStream) {
+    return true;
+  }
+
+  // Opening (or reopening after a device change) is a recovery path, not
+  // steady state.
+  AllocationAuditExemption exemption;
+  mStream.reset();
+  // Frame counters restart with the new stream; no callback is running here.
+  mPresentationKnown = false;
+
+  // The configuration this build's device granted last time is requested
+  // directly, so the open does not negotiate it again. If that fails (the
+  // device changed under the same build), the plain request is retried.
+  auto& capabilityCache = AudioCapabilityCache::shared();
+  const auto cached = capabilityCache.load();
+  const bool useCachedConfig = cached.has_value() && cached->sampleRate > 0;
+  oboe::AudioStream* rawStream = nullptr;
+  oboe::Result result = oboe::Result::OK;
+  for (int attempt = useCachedConfig ? 0 : 1; attempt < 2; ++attempt) {
+    oboe::AudioStreamBuilder builder;
+    builder.setDirection(oboe::Direction::Output);
+    builder.setPerformanceMode(oboe::PerformanceMode::LowLatency);
+    builder.setSharingMode(attempt == 0 && !cached->exclusive ? oboe::SharingMode::Shared
+                                                              : oboe::SharingMode::Exclusive);
+    builder.setUsage(oboe::Usage::Game);
+    builder.setContentType(oboe::ContentType::Sonification);
+    builder.setChannelCount(1);
+    builder.setFormat(oboe::AudioFormat::Float);
+    if (attempt == 0) {
+      builder.setSampleRate(cached->sampleRate);
+    }
+    builder.setCallback(this);
+    builder.setErrorCallback(this);
+
+    rawStream = nullptr;
+    result = builder.openStream(&rawStream);
+    if (result == oboe::Result::OK && rawStream != nullptr) {
+      break;
+    }
+    __android_log_print(ANDROID_LOG_DEBUG,
+                        kTag,
+                        "%s stream.open.failed error=%s cachedConfig=%d",
+                        kLogPrefix,
+                        oboe::convertToText(result),
+                        attempt == 0 ? 1 : 0);
+    if (rawStream != nullptr) {
+      rawStream->close();
+      delete rawStream;
+      rawStream = nullptr;
+    }
+    if (attempt == 0) {
+      capabilityCache.forgetStreamConfig();
+    }
+  }
+  if (rawStream == nullptr) {
+    mReady.store(false, std::memory_order_release);
+    return false;
+  }
+
+  mStream = StreamPtr(rawStream);
+  auto* stream = mStream.get();
+  mSampleRate.store(static_cast<double>(stream->getSampleRate()), std::memory_order_relaxed);
+  const int32_t burst = stream->getFramesPerBurst();
+  if (burst > 0) {
+    stream->setBufferSizeInFrames(burst);
+  }
+  capabilityCache.store(AudioCapabilityCache::Capabilities{ true,
+                                                            stream->getSampleRate(),
+                                                            burst,
+                                                            stream->getSharingMode() == oboe::SharingMode::Exclusive,
+                                                            static_cast<int32_t>(stream->getAudioApi()) });
+  activateRouteLocked(stream);
+  AudioFrameClock::shared().reset(sampleRate());
+  __android_log_print(ANDROID_LOG_DEBUG,
+                      kTag,
+                      "%s stream.open sampleRate=%.1f burst=%d api=%d device=%d route=%s",
+                      kLogPrefix,
+                      sampleRate(),
+                      burst,
+                      static_cast<int>(stream->getAudioApi()),
+                      stream->getDeviceId(),
+                      audioRouteName(AudioRouteProfiles::shared().activeRoute()));
+
+  const oboe::Result startResult = stream->requestStart();
+  if (startResult != oboe::Result::OK) {
+    __android_log_print(ANDROID_LOG_DEBUG,
+                        kTag,
+                        "%s stream.start.failed error=%s",
+                        kLogPrefix,
+                        oboe::convertToText(startResult));
+    mReady.store(false, std::memory_order_release);
+    return false;
+  }
+  mReady.store(true, std::memory_order_release);
+  return true;
+}
+
+void AudioEngine::activateRouteLocked(oboe::AudioStream* stream) {
+  // Before requestStart, so the first callback already applies the route's
+  // offset.
+  const auto route = getNativeActiveAudioRoute(stream->getDeviceId());
+  if (route) {
+    AudioRouteProfiles::shared().activate(route->route, route->deviceName);
+  } else {
+    // Most likely the speaker, but not worth a device-specific profile.
+    AudioRouteProfiles::shared().activate(AudioRoute::Other, std::string());
+  }
+}
+
+void AudioEngine::closeLocked() {
+  auto* stream = mStream.get();
+  if (stream == nullptr) {
+    return;
+  }
+  if (mReady.load(std::memory_order_acquire)) {
+    const oboe::Result stopResult = stream->requestStop();
+    if (stopResult != oboe::Result::OK) {
+      __android_log_print(ANDROID_LOG_DEBUG,
+                          kTag,
+                          "%s stream.stop.failed error=%s",
+                          kLogPrefix,
+                          oboe::convertToText(stopResult));
+    }
+  }
+  mStream.reset();
+  mReady.store(false, std::memory_order_release);
+}
+
+void AudioEngine::runIdleReaper() {
+  std::unique_lock<std::mutex> lock(mMutex);
+  for (;;) {
+    if (mClients == 0 && mStream) {
+      const auto deadline = mIdleSince + kIdleCloseMs;
+      if (std::chrono::steady_clock::now() >= deadline) {
+        closeLocked();
+        __android_log_print(ANDROID_LOG_DEBUG, kTag, "%s engine.idle.close", kLogPrefix);
+        continue;
+      }
+      mReaperCondition.wait_until(lock, deadline);
+    } else {
+      mReaperCondition.wait(lock);
+    }
+  }
+}
+
+oboe::DataCallbackResult AudioEngine::onAudioReady(oboe::AudioStream* stream,
+                                                  void* audioData,
+                                                  int32_t numFrames) {
+  if (stream == nullptr || audioData == nullptr || numFrames <= 0) {
+    return oboe::DataCallbackResult::Continue;
+  }
+  AllocationAuditScope auditScope;
+  mCallbackEpoch.fetch_add(1, std::memory_order_seq_cst);
+  TraceRecorder& trace = TraceRecorder::shared();
+  const bool tracing = trace.isActive();
+  AudioRenderInfo info{};
+  info.tracing = tracing;
+  info.firstFrame = stream->getFramesWritten();
+  if (tracing) {
+    trace.record(TraceEventType::CallbackBegin, numFrames);
+    const auto xruns = stream->getXRunCount();
+    if (xruns && xruns.value() != mLastXRunCount) {
+      mLastXRunCount = xruns.value();
+      trace.record(TraceEventType::Xrun, mLastXRunCount);
+    }
+  }
+
+  auto* floatData = static_cast<float*>(audioData);
+  const int32_t channelCount = std::max(1, stream->getChannelCount());
+  const double sampleRate = stream->getSampleRate() > 0 ? stream->getSampleRate() : this->sampleRate();
+  info.sampleRate = sampleRate;
+  info.presentationOffsetMs = AudioRouteProfiles::shared().presentationOffsetMs();
+  info.presentationMs = estimatePresentationMs(stream, info.firstFrame, sampleRate) + info.presentationOffsetMs;
+
+  for (int32_t offset = 0; offset < numFrames; offset += kMixFrames) {
+    const int32_t frames = std::min(kMixFrames, numFrames - offset);
+    float* mix = mMix.data();
+    std::fill(mix, mix + frames, 0.0f);
+    for (auto& slot : mVoices) {
+      AudioVoice* voice = slot.load(std::memory_order_seq_cst);
+      if (voice != nullptr) {
+        voice->renderVoice(mix, frames, info);
+      }
+    }
+    for (int32_t frame = 0; frame < frames; ++frame) {
+      // Voices are individually bounded; only overlapping tones can clip.
+      const float sample = std::clamp(mix[frame], -1.0f, 1.0f);
+      for (int32_t channel = 0; channel < channelCount; ++channel) {
+        floatData[(offset + frame) * channelCount + channel] = sample;
+      }
+    }
+    info.firstFrame += frames;
+    info.presentationMs += static_cast<double>(frames) * 1000.0 / sampleRate;
+  }
+  mCallbackEpoch.fetch_add(1, std::memory_order_acq_rel);
+
+  samplePresentation(stream, sampleRate);
+  if (tracing) {
+    trace.record(TraceEventType::CallbackEnd, numFrames);
+  }
+  return oboe::DataCallbackResult::Continue;
+}
+
+void AudioEngine::samplePresentation(oboe::AudioStream* stream, double sampleRate) {
+  if (mPresentationSampleCountdown > 0) {
+    --mPresentationSampleCountdown;
+    return;
+  }
+  mPresentationSampleCountdown = kPresentationSampleInterval;
+  int64_t framePosition = 0;
+  int64_t framePresentedNs = 0;
+  if (stream->getTimestamp(CLOCK_MONOTONIC, &framePosition, &framePresentedNs) == oboe::Result::OK) {
+    mPresentationKnown = true;
+    mPresentedFrame = framePosition;
+    mPresentedMs = static_cast<double>(framePresentedNs) / 1.0e6;
+    AudioFrameClock::shared().record(framePosition, mPresentedMs);
+    // The first frame of this buffer is framesWritten; extrapolate from the
+    // last presented frame to when it will reach the DAC.
+    const int64_t framesAhead = stream->getFramesWritten() - framePosition;
+    const double presentationMs =
+        static_cast<double>(framePresentedNs) / 1.0e6 + static_cast<double>(framesAhead) * 1000.0 / sampleRate;
+    const double outputLatencyMs = presentationMs - toMillis(std::chrono::steady_clock::now());
+    auto& profiles = AudioRouteProfiles::shared();
+    profiles.recordOutputLatency(outputLatencyMs);
+    // Callback to audible, so the histogram matches what the route needs.
+    LatencyHistograms::shared().record(OutputChannel::Tone,
+                                       LatencyMetric::CallbackToPresentation,
+                                       outputLatencyMs + profiles.presentationOffsetMs());
+  }
+}
+
+double AudioEngine::estimatePresentationMs(oboe::AudioStream* stream, int64_t frame, double sampleRate) const {
+  if (mPresentationKnown) {
+    return mPresentedMs + static_cast<double>(frame - mPresentedFrame) * 1000.0 / sampleRate;
+  }
+  // No timestamp yet (first callbacks after open): everything already queued
+  // for the device plays before this frame.
+  const int64_t queuedFrames = std::max<int64_t>(0, frame - stream->getFramesRead());
+  return toMillis(std::chrono::steady_clock::now()) + static_cast<double>(queuedFrames) * 1000.0 / sampleRate;
+}
+
+void AudioEngine::onErrorAfterClose(oboe::AudioStream*, oboe::Result error) {
+  __android_log_print(ANDROID_LOG_DEBUG,
+                      kTag,
+                      "%s stream.error error=%s",
+                      kLogPrefix,
+                      oboe::convertToText(error));
+  std::lock_guard<std::mutex> lock(mMutex);
+  mStream.reset();
+  mReady.store(false, std::memory_order_release);
+}
+
+} // namespace margelo::nitro::morse
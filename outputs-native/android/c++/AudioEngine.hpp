@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <oboe/Oboe.h>
+
+namespace margelo::nitro::morse {
+
+struct AudioRenderInfo {
+  double sampleRate;
+  // Absolute output frame of mix[0].
+  int64_t firstFrame;
+  // steady_clock ms at which mix[0] is expected to be heard; frame f of the
+  // slice follows 1000 / sampleRate ms later per frame. Includes the active
+  // route's calibrated offset (see AudioRouteProfiles).
+  double presentationMs;
+  // That offset, so a voice can recover the stream's own estimate.
+  double presentationOffsetMs;
+  bool tracing;
+};
+
+// One sound source mixed by the engine. renderVoice runs on the audio thread
+// and must add (not write) its samples into the mono mix buffer.
+class AudioVoice {
+ public:
+  virtual ~AudioVoice() = default;
+  virtual void renderVoice(float* mix, int32_t numFrames, const AudioRenderInfo& info) = 0;
+};
+
+// Process-wide output engine: one exclusive low-latency Oboe stream and a
+// mixer over the registered voices. Each OutputsAudio HybridObject is a client
+// with its own voice, so a second instance (dev console, preview screen) no
+// longer fights the first for the device. The stream outlives its clients by
+// kIdleCloseMs so it stays warm across screen changes. Every (re)open looks up
+// the output route, so a headset plugged in mid-session (which disconnects the
+// stream) switches the latency profile with it.
+class AudioEngine final : public oboe::AudioStreamCallback {
+ public:
+  static AudioEngine& shared();
+
+  bool isSupported();
+
+  // Registers a client voice; the stream is opened by start().
+  bool acquire(AudioVoice* voice);
+  // Unregisters the voice and waits out a callback that may still be using it,
+  // so the caller can destroy it afterwards.
+  void release(AudioVoice* voice);
+
+  // Opens and starts the stream if needed (first use, after a disconnect or
+  // after the idle close). Returns whether the stream is running.
+  bool start();
+  bool isReady() const { return mReady.load(std::memory_order_acquire); }
+  double sampleRate() const { return mSampleRate.load(std::memory_order_relaxed); }
+
+  oboe::DataCallbackResult onAudioReady(oboe::AudioStream* stream,
+                                        void* audioData,
+                                        int32_t numFrames) override;
+  void onErrorAfterClose(oboe::AudioStream* stream, oboe::Result error) override;
+
+ private:
+  struct StreamDeleter {
+    void operator()(oboe::AudioStream* stream) const;
+  };
+  using StreamPtr = std::unique_ptr<oboe::AudioStream, StreamDeleter>;
+
+  static constexpr std::size_t kMaxVoices = 8;
+  // Larger callbacks are rendered in slices of this size.
+  static constexpr int32_t kMixFrames = 1024;
+  static constexpr std::chrono::milliseconds kIdleCloseMs{ 10000 };
+
+  AudioEngine();
+  void closeLocked();
+  void activateRouteLocked(oboe::AudioStream* stream);
+  void runIdleReaper();
+  void samplePresentation(oboe::AudioStream* stream, double sampleRate);
+  double estimatePresentationMs(oboe::AudioStream* stream, int64_t frame, double sampleRate) const;
+
+  std::array<std::atomic<AudioVoice*>, kMaxVoices> mVoices;
+  // Odd while a callback is mixing; release() waits for it to move on.
+  std::atomic<uint32_t> mCallbackEpoch;
+
+  std::mutex mMutex;
+  StreamPtr mStream;
+  std::atomic<bool> mReady;
+  std::atomic<double> mSampleRate;
+  bool mSupportKnown;
+  bool mSupported;
+  std::size_t mClients;
+  std::chrono::steady_clock::time_point mIdleSince;
+  bool mReaperStarted;
+  std::condition_variable mReaperCondition;
+
+  // Audio-thread state.
+  std::vector<float> mMix;
+  int32_t mLastXRunCount;
+  uint32_t mPresentationSampleCountdown;
+  // Last stream timestamp (frame, steady_clock ms); frames are mapped to
+  // presentation times from it until the next sample.
+  bool mPresentationKnown;
+  int64_t mPresentedFrame;
+  double mPresentedMs;
+};
+
+} // namespace margelo::nitro::morse
@@ -0,0 +1,178 @@
+#include "AudioFrameClock.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+namespace margelo::nitro::morse {
+
+namespace {
+// Timestamps arrive every few dozen ms; keeping one per interval stretches
+// the ring over ~16 s, long enough to resolve tens of ppm.
+constexpr double kSampleSpacingMs = 250.0;
+// Below this span the slope is mostly timestamp jitter; use the nominal rate.
+constexpr double kMinFitSpanMs = 2000.0;
+// A timestamp further than this (plus 1000 ppm of the gap) from the nominal
+// extrapolation means the device clock jumped (xrun, route glitch).
+constexpr double kDiscontinuityMs = 2.0;
+constexpr double kDiscontinuityPpm = 1000.0;
+// Slope uncertainty applied to extrapolation: crystals are within ~100 ppm of
+// nominal; a fitted slope is good to a few.
+constexpr double kNominalRatePpm = 100.0;
+constexpr double kFittedRatePpm = 5.0;
+} // namespace
+
+AudioFrameClock& AudioFrameClock::shared() {
+  static AudioFrameClock* instance = new AudioFrameClock();
+  return *instance;
+}
+
+AudioFrameClock::AudioFrameClock() : mGeneration(0), mNominalSampleRate(0.0), mDiscontinuities(0) {}
+
+void AudioFrameClock::reset(double sampleRate) {
+  std::lock_guard<std::mutex> lock(mMutex);
+  mSamples.clear();
+  mNominalSampleRate = sampleRate;
+  mDiscontinuities = 0;
+  ++mGeneration;
+}
+
+void AudioFrameClock::record(int64_t frame, double presentedMs) {
+  std::unique_lock<std::mutex> lock(mMutex, std::try_to_lock);
+  if (!lock.owns_lock() || mNominalSampleRate <= 0.0) {
+    return;
+  }
+  if (!mSamples.empty()) {
+    const Sample& last = mSamples[mSamples.size() - 1];
+    if (frame == last.frame) {
+      // The stream has not presented anything new since the last query.
+      return;
+    }
+    const double nominalMs = static_cast<double>(frame - last.frame) * 1000.0 / mNominalSampleRate;
+    const double tolerance = kDiscontinuityMs + std::abs(nominalMs) * kDiscontinuityPpm * 1.0e-6;
+    if (frame < last.frame || std::abs(presentedMs - last.ms - nominalMs) > tolerance) {
+      mSamples.clear();
+      ++mDiscontinuities;
+    } else if (mSamples.size() >= 2 && last.ms - mSamples[mSamples.size() - 2].ms < kSampleSpacingMs) {
+      // Keep the newest timestamp as the anchor without crowding the ring.
+      mSamples[mSamples.size() - 1] = Sample{ frame, presentedMs };
+      return;
+    }
+  }
+  mSamples.push(Sample{ frame, presentedMs });
+}
+
+AudioFrameClock::Estimate AudioFrameClock::estimateLocked() const {
+  Estimate estimate{};
+  estimate.generation = mGeneration;
+  estimate.nominalSampleRate = mNominalSampleRate;
+  estimate.samples = static_cast<uint32_t>(mSamples.size());
+  if (mSamples.empty() || mNominalSampleRate <= 0.0) {
+    estimate.msPerFrame = mNominalSampleRate > 0.0 ? 1000.0 / mNominalSampleRate : 0.0;
+    return estimate;
+  }
+
+  // Everything relative to the newest sample keeps the sums well conditioned
+  // with frame counters in the millions.
+  const Sample& anchor = mSamples[mSamples.size() - 1];
+  const std::size_t count = mSamples.size();
+  estimate.spanMs = anchor.ms - mSamples[0].ms;
+  double slope = 1000.0 / mNominalSampleRate;
+  if (count >= 4 && estimate.spanMs >= kMinFitSpanMs) {
+    double meanX = 0.0;
+    double meanY = 0.0;
+    for (std::size_t i = 0; i < count; ++i) {
+      meanX += static_cast<double>(mSamples[i].frame - anchor.frame);
+      meanY += mSamples[i].ms - anchor.ms;
+    }
+    meanX /= static_cast<double>(count);
+    meanY /= static_cast<double>(count);
+    double sxx = 0.0;
+    double sxy = 0.0;
+    for (std::size_t i = 0; i < count; ++i) {
+      const double dx = static_cast<double>(mSamples[i].frame - anchor.frame) - meanX;
+      sxy += dx * (mSamples[i].ms - anchor.ms - meanY);
+      sxx += dx * dx;
+    }
+    if (sxx > 0.0) {
+      slope = sxy / sxx;
+      estimate.driftPpm = (slope * mNominalSampleRate / 1000.0 - 1.0) * 1.0e6;
+    }
+  }
+
+  // Intercept at the anchor frame, then the worst residual around the line.
+  double intercept = 0.0;
+  for (std::size_t i = 0; i < count; ++i) {
+    intercept += mSamples[i].ms - anchor.ms - slope * static_cast<double>(mSamples[i].frame - anchor.frame);
+  }
+  intercept /= static_cast<double>(count);
+  double worst = 0.0;
+  for (std::size_t i = 0; i < count; ++i) {
+    const double fitted = intercept + slope * static_cast<double>(mSamples[i].frame - anchor.frame);
+    worst = std::max(worst, std::abs(mSamples[i].ms - anchor.ms - fitted));
+  }
+
+  estimate.valid = true;
+  estimate.anchorFrame = anchor.frame;
+  estimate.anchorMs = anchor.ms + intercept;
+  estimate.msPerFrame = slope;
+  estimate.errorMs = worst;
+  return estimate;
+}
+
+AudioFrameClock::Estimate AudioFrameClock::estimate() const {
+  std::lock_guard<std::mutex> lock(mMutex);
+  return estimateLocked();
+}
+
+bool AudioFrameClock::frameToSteadyMs(int64_t frame, double* steadyMs, double* errorMs) const {
+  std::lock_guard<std::mutex> lock(mMutex);
+  const Estimate estimate = estimateLocked();
+  if (!estimate.valid) {
+    return false;
+  }
+  const int64_t firstFrame = mSamples[0].frame;
+  int64_t outside = 0;
+  if (frame > estimate.anchorFrame) {
+    outside = frame - estimate.anchorFrame;
+  } else if (frame < firstFrame) {
+    outside = firstFrame - frame;
+  }
+  const bool fitted = estimate.spanMs >= kMinFitSpanMs && estimate.samples >= 4;
+  const double ratePpm = fitted ? kFittedRatePpm : kNominalRatePpm;
+  if (steadyMs != nullptr) {
+    *steadyMs = estimate.anchorMs + static_cast<double>(frame - estimate.anchorFrame) * estimate.msPerFrame;
+  }
+  if (errorMs != nullptr) {
+    *errorMs = estimate.errorMs + static_cast<double>(outside) * estimate.msPerFrame * ratePpm * 1.0e-6;
+  }
+  return true;
+}
+
+std::string AudioFrameClock::toJson() const {
+  Estimate estimate;
+  uint32_t discontinuities = 0;
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    estimate = estimateLocked();
+    discontinuities = mDiscontinuities;
+  }
+  std::ostringstream stream;
+  stream.setf(std::ios::fixed, std::ios::floatfield);
+  stream << "{\"valid\":" << (estimate.valid ? "true" : "false")
+         << ",\"generation\":" << estimate.generation
+         << ",\"sampleRate\":" << std::setprecision(1) << estimate.nominalSampleRate
+         << ",\"anchorFrame\":" << estimate.anchorFrame
+         << ",\"anchorMs\":" << std::setprecision(4) << estimate.anchorMs
+         << ",\"msPerFrame\":" << std::setprecision(9) << estimate.msPerFrame
+         << ",\"driftPpm\":" << std::setprecision(2) << estimate.driftPpm
+         << ",\"errorMs\":" << std::setprecision(4) << estimate.errorMs
+         << ",\"samples\":" << estimate.samples
+         << ",\"spanMs\":" << std::setprecision(1) << estimate.spanMs
+         << ",\"discontinuities\":" << discontinuities
+         << "}";
+  return stream.str();
+}
+
+} // namespace margelo::nitro::morse
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include "FixedRing.hpp"
+
+namespace margelo::nitro::morse {
+
+// Maps output frame positions of the engine's stream to steady_clock ms. The
+// stream's timestamps pair a frame with the time it reached the DAC; a least
+// squares line through the recent ones gives the rate the device clock really
+// runs at against steady_clock (its drift from the nominal sample rate) and
+// the scatter of the timestamps around it, which bounds the error of every
+// conversion. Each stream (re)open starts a new generation, since frame
+// counters restart with it.
+//
+// record() runs on the audio thread and skips the sample rather than wait
+// when a reader holds the lock.
+class AudioFrameClock {
+ public:
+  struct Estimate {
+    bool valid;
+    uint32_t generation;
+    double nominalSampleRate;
+    // Frame and steady_clock ms of the newest timestamp; conversions
+    // extrapolate from it along msPerFrame.
+    int64_t anchorFrame;
+    double anchorMs;
+    double msPerFrame;
+    // Measured rate against nominal, in parts per million; 0 until the
+    // timestamps span kMinFitSpanMs.
+    double driftPpm;
+    // Largest residual of the fitted timestamps.
+    double errorMs;
+    uint32_t samples;
+    double spanMs;
+  };
+
+  static AudioFrameClock& shared();
+
+  // The stream opened (or reopened) at this rate; drops the old samples.
+  void reset(double sampleRate);
+  // Audio thread: one stream timestamp.
+  void record(int64_t frame, double presentedMs);
+
+  Estimate estimate() const;
+  // Returns false until the stream has produced a timestamp. errorMs grows
+  // with the distance from the fitted span at the drift's uncertainty.
+  bool frameToSteadyMs(int64_t frame, double* steadyMs, double* errorMs) const;
+  std::string toJson() const;
+
+ private:
+  AudioFrameClock();
+
+  struct Sample {
+    int64_t frame;
+    double ms;
+  };
+
+  static constexpr std::size_t kMaxSamples = 64;
+
+  // Caller holds mMutex.
+  Estimate estimateLocked() const;
+
+  mutable std::mutex mMutex;
+  FixedRing<Sample, kMaxSamples> mSamples;
+  uint32_t mGeneration;
+  double mNominalSampleRate;
+  uint32_t mDiscontinuities;
+};
+
+} // namespace margelo::nitro::morse
@@ -0,0 +1,228 @@
+#include "AudioRoute.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+
+namespace margelo::nitro::morse {
+
+namespace {
+constexpr double kOutputLatencyWeight = 0.1;
+constexpr double kMaxOutputLatencyMs = 500.0;
+// A route can play slightly ahead of its timestamps (a DAC that reports the
+// end of its FIFO), but never by much.
+constexpr double kMinPresentationOffsetMs = -50.0;
+constexpr double kMaxPresentationOffsetMs = 500.0;
+
+void appendJsonString(std::ostringstream& stream, const std::string& value) {
+  stream << "\"";
+  for (const char c : value) {
+    switch (c) {
+      case '"':
+        stream << "\\\"";
+        break;
+      case '\\':
+        stream << "\\\\";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char escaped[8];
+          std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+          stream << escaped;
+        } else {
+          stream << c;
+        }
+    }
+  }
+  stream << "\"";
+}
+} // namespace
+
+const char* audioRouteName(AudioRoute route) {
+  switch (route) {
+    case AudioRoute::Speaker:
+      return "speaker";
+    case AudioRoute::Wired:
+      return "wired";
+    case AudioRoute::Bluetooth:
+      return "bluetooth";
+    case AudioRoute::Usb:
+      return "usb";
+    case AudioRoute::Other:
+      return "other";
+  }
+  return "unknown";
+}
+
+std::optional<AudioRoute> parseAudioRoute(const std::string& name) {
+  for (std::size_t i = 0; i < kAudioRouteCount; ++i) {
+    const auto route = static_cast<AudioRoute>(i);
+    if (name == audioRouteName(route)) {
+      return route;
+    }
+  }
+  return std::nullopt;
+}
+
+AudioRouteProfiles& AudioRouteProfiles::shared() {
+  static AudioRouteProfiles* instance = new AudioRouteProfiles();
+  return *instance;
+}
+
+AudioRouteProfiles::AudioRouteProfiles() : mUsed(kAudioRouteCount), mActive(0) {
+  for (std::size_t i = 0; i < kMaxProfiles; ++i) {
+    Entry& entry = mEntries[i];
+    entry.route.store(static_cast<uint8_t>(i < kAudioRouteCount ? i : 0), std::memory_order_relaxed);
+    entry.outputLatencyMs.store(0.0, std::memory_order_relaxed);
+    entry.presentationOffsetMs.store(0.0, std::memory_order_relaxed);
+    entry.latencySamples.store(0, std::memory_order_relaxed);
+    entry.calibrations.store(0, std::memory_order_relaxed);
+  }
+}
+
+std::optional<std::size_t> AudioRouteProfiles::findLocked(AudioRoute route, const std::string& deviceName) const {
+  if (deviceName.empty()) {
+    return static_cast<std::size_t>(route);
+  }
+  for (std::size_t i = kAudioRouteCount; i < mUsed; ++i) {
+    if (mEntries[i].route.load(std::memory_order_relaxed) == static_cast<uint8_t>(route) &&
+        mNames[i] == deviceName) {
+      return i;
+    }
+  }
+  return std::nullopt;
+}
+
+std::size_t AudioRouteProfiles::findOrCreateLocked(AudioRoute route, const std::string& deviceName) {
+  if (const auto index = findLocked(route, deviceName)) {
+    return *index;
+  }
+  if (mUsed == kMaxProfiles) {
+    return static_cast<std::size_t>(route);
+  }
+  const std::size_t index = mUsed++;
+  mNames[index] = deviceName;
+  mEntries[index].route.store(static_cast<uint8_t>(route), std::memory_order_relaxed);
+  // A new device starts from what its route is known to need.
+  const Entry& generic = mEntries[static_cast<std::size_t>(route)];
+  mEntries[index].presentationOffsetMs.store(generic.presentationOffsetMs.load(std::memory_order_relaxed),
+                                             std::memory_order_relaxed);
+  return index;
+}
+
+void AudioRouteProfiles::activate(AudioRoute route, const std::string& deviceName) {
+  std::lock_guard<std::mutex> lock(mMutex);
+  mActive.store(findOrCreateLocked(route, deviceName), std::memory_order_release);
+}
+
+AudioRoute AudioRouteProfiles::activeRoute() const {
+  const Entry& entry = mEntries[mActive.load(std::memory_order_acquire)];
+  return static_cast<AudioRoute>(entry.route.load(std::memory_order_relaxed));
+}
+
+std::string AudioRouteProfiles::activeDeviceName() const {
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mNames[mActive.load(std::memory_order_acquire)];
+}
+
+void AudioRouteProfiles::recordOutputLatency(double latencyMs) {
+  if (!std::isfinite(latencyMs) || latencyMs < 0.0 || latencyMs > kMaxOutputLatencyMs) {
+    return;
+  }
+  Entry& entry = mEntries[mActive.load(std::memory_order_acquire)];
+  // Single writer (the audio callback), so load-modify-store is enough.
+  const uint32_t samples = entry.latencySamples.load(std::memory_order_relaxed);
+  const double previous = entry.outputLatencyMs.load(std::memory_order_relaxed);
+  const double next = samples == 0 ? latencyMs : previous + kOutputLatencyWeight * (latencyMs - previous);
+  entry.outputLatencyMs.store(next, std::memory_order_relaxed);
+  entry.latencySamples.store(samples + 1, std::memory_order_release);
+}
+
+double AudioRouteProfiles::presentationOffsetMs() const {
+  return mEntries[mActive.load(std::memory_order_acquire)].presentationOffsetMs.load(std::memory_order_relaxed);
+}
+
+double AudioRouteProfiles::audibleLatencyMs() const {
+  const Entry& entry = mEntries[mActive.load(std::memory_order_acquire)];
+  const double outputMs = entry.latencySamples.load(std::memory_order_acquire) > 0
+                              ? entry.outputLatencyMs.load(std::memory_order_relaxed)
+                              : 0.0;
+  return std::max(0.0, outputMs + entry.presentationOffsetMs.load(std::memory_order_relaxed));
+}
+
+bool AudioRouteProfiles::setPresentationOffset(AudioRoute route,
+                                               const std::string& deviceName,
+                                               double offsetMs,
+                                               bool calibrated) {
+  if (!std::isfinite(offsetMs) || offsetMs < kMinPresentationOffsetMs || offsetMs > kMaxPresentationOffsetMs) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mMutex);
+  Entry& entry = mEntries[findOrCreateLocked(route, deviceName)];
+  entry.presentationOffsetMs.store(offsetMs, std::memory_order_relaxed);
+  if (calibrated) {
+    entry.calibrations.fetch_add(1, std::memory_order_relaxed);
+  }
+  return true;
+}
+
+std::optional<AudioRouteProfiles::Profile> AudioRouteProfiles::profile(AudioRoute route,
+                                                                      const std::string& deviceName) const {
+  std::lock_guard<std::mutex> lock(mMutex);
+  const auto index = findLocked(route, deviceName);
+  if (!index) {
+    return std::nullopt;
+  }
+  const Entry& entry = mEntries[*index];
+  Profile result{};
+  result.route = route;
+  result.deviceName = mNames[*index];
+  result.outputLatencyMs = entry.outputLatencyMs.load(std::memory_order_relaxed);
+  result.presentationOffsetMs = entry.presentationOffsetMs.load(std::memory_order_relaxed);
+  result.calibrations = entry.calibrations.load(std::memory_order_relaxed);
+  result.active = *index == mActive.load(std::memory_order_acquire);
+  return result;
+}
+
+std::string AudioRouteProfiles::toJson() const {
+  std::lock_guard<std::mutex> lock(mMutex);
+  const std::size_t active = mActive.load(std::memory_order_acquire);
+  std::ostringstream stream;
+  stream.setf(std::ios::fixed, std::ios::floatfield);
+  stream << "{\"active\":{\"route\":\""
+         << audioRouteName(static_cast<AudioRoute>(mEntries[active].route.load(std::memory_order_relaxed)))
+         << "\",\"device\":";
+  appendJsonString(stream, mNames[active]);
+  stream << "},\"profiles\":[";
+  bool first = true;
+  for (std::size_t i = 0; i < mUsed; ++i) {
+    const Entry& entry = mEntries[i];
+    const uint32_t samples = entry.latencySamples.load(std::memory_order_acquire);
+    const uint32_t calibrations = entry.calibrations.load(std::memory_order_relaxed);
+    const double offsetMs = entry.presentationOffsetMs.load(std::memory_order_relaxed);
+    // Generic profiles nobody has used yet carry no information.
+    if (i != active && samples == 0 && calibrations == 0 && offsetMs == 0.0) {
+      continue;
+    }
+    if (!first) {
+      stream << ",";
+    }
+    first = false;
+    stream << "{\"route\":\""
+           << audioRouteName(static_cast<AudioRoute>(entry.route.load(std::memory_order_relaxed)))
+           << "\",\"device\":";
+    appendJsonString(stream, mNames[i]);
+    stream << ",\"outputLatencyMs\":" << std::setprecision(3) << entry.outputLatencyMs.load(std::memory_order_relaxed)
+           << ",\"presentationOffsetMs\":" << std::setprecision(3) << offsetMs
+           << ",\"latencySamples\":" << samples
+           << ",\"calibrations\":" << calibrations
+           << ",\"active\":" << (i == active ? "true" : "false")
+           << "}";
+  }
+  stream << "]}";
+  return stream.str();
+}
+
+} // namespace margelo::nitro::morse
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace margelo::nitro::morse {
+
+// Kind of output device the engine's stream is playing on. The values are the
+// ids NativeOutputsDispatcher.getActiveAudioRoute reports.
+enum class AudioRoute : uint8_t {
+  Speaker = 0,
+  Wired,
+  Bluetooth,
+  Usb,
+  Other,
+};
+
+constexpr std::size_t kAudioRouteCount = 5;
+
+const char* audioRouteName(AudioRoute route);
+std::optional<AudioRoute> parseAudioRoute(const std::string& name);
+
+// Process-wide latency profiles, one per output route and device (a given
+// Bluetooth headset, a given USB DAC). AudioEngine activates the profile of
+// the device its stream opened on; the audio callback then keeps its observed
+// output latency up to date and adds its presentation offset to every
+// presentation time. The offset is the part of the latency the stream
+// timestamps do not report (Bluetooth codec and link buffering, some USB
+// DACs), so it only comes from loopback calibration or a persisted profile.
+// Profiles are never removed; the audio thread only touches atomics.
+class AudioRouteProfiles {
+ public:
+  struct Profile {
+    AudioRoute route;
+    std::string deviceName;
+    // Smoothed callback-to-presentation lag while the profile was active.
+    double outputLatencyMs;
+    double presentationOffsetMs;
+    uint32_t calibrations;
+    bool active;
+  };
+
+  static AudioRouteProfiles& shared();
+
+  // Selects the profile for the device the stream opened on, creating it if
+  // needed. An empty name selects the route's generic profile.
+  void activate(AudioRoute route, const std::string& deviceName);
+  AudioRoute activeRoute() const;
+  std::string activeDeviceName() const;
+
+  // Audio thread.
+  void recordOutputLatency(double latencyMs);
+  double presentationOffsetMs() const;
+
+  // Callback-to-audible latency of the active route: what visual channels
+  // have to wait for the tone to be heard.
+  double audibleLatencyMs() const;
+
+  // Calibrated offsets count towards `calibrations`; restored ones do not.
+  // Returns false for an implausible offset.
+  bool setPresentationOffset(AudioRoute route, const std::string& deviceName, double offsetMs, bool calibrated);
+  std::optional<Profile> profile(AudioRoute route, const std::string& deviceName) const;
+  std::string toJson() const;
+
+ private:
+  AudioRouteProfiles();
+
+  // The first kAudioRouteCount entries are the generic per-route profiles;
+  // devices past the table size share them.
+  static constexpr std::size_t kMaxProfiles = 16;
+
+  struct Entry {
+    std::atomic<uint8_t> route;
+    std::atomic<double> outputLatencyMs;
+    std::atomic<double> presentationOffsetMs;
+    std::atomic<uint32_t> latencySamples;
+    std::atomic<uint32_t> calibrations;
+  };
+
+  // Caller holds mMutex.
+  std::optional<std::size_t> findLocked(AudioRoute route, const std::string& deviceName) const;
+  // Caller holds mMutex. Falls back to the generic profile when full.
+  std::size_t findOrCreateLocked(AudioRoute route, const std::string& deviceName);
+
+  std::array<Entry, kMaxProfiles> mEntries;
+  // Guards the names and the allocation count; values are atomics.
+  mutable std::mutex mMutex;
+  std::array<std::string, kMaxProfiles> mNames;
+  std::size_t mUsed;
+  std::atomic<std::size_t> mActive;
+};
+
+} // namespace margelo::nitro::morse
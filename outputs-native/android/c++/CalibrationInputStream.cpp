@@ -0,0 +1,153 @@
+#include "CalibrationInputStream.hpp"
+
+#include <android/log.h>
+#include <time.h>
+
+#include <chrono>
+#include <cmath>
+
+namespace margelo::nitro::morse {
+
+namespace {
+constexpr const char* kLogPrefix = "[outputs-audio]";
+constexpr const char* kTag = "OutputsAudio";
+
+inline double nowMs() {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+} // namespace
+
+void CalibrationInputStream::StreamDeleter::operator()(oboe::AudioStream* stream) const {
+  if (stream != nullptr) {
+    stream->close();
+    delete stream;
+  }
+}
+
+CalibrationInputStream::CalibrationInputStream(LoopbackCalibrator& calibrator)
+    : mCalibrator(calibrator), mStream(nullptr), mRunning(false), mAnchored(false), mAnchorFrame(0), mAnchorMs(0.0) {}
+
+CalibrationInputStream::~CalibrationInputStream() {
+  stop();
+}
+
+bool CalibrationInputStream::start(double sampleRate) {
+  std::lock_guard<std::mutex> lock(mStreamMutex);
+  if (mStream) {
+    mRunning.store(false, std::memory_order_release);
+    mStream->requestStop();
+    mStream.reset();
+  }
+
+  oboe::AudioStreamBuilder builder;
+  builder.setDirection(oboe::Direction::Input);
+  builder.setPerformanceMode(oboe::PerformanceMode::LowLatency);
+  builder.setSharingMode(oboe::SharingMode::Shared);
+  // Echo cancellation would remove exactly the signal being measured.
+  builder.setInputPreset(oboe::InputPreset::Unprocessed);
+  builder.setChannelCount(1);
+  builder.setFormat(oboe::AudioFormat::Float);
+  builder.setSampleRate(static_cast<int32_t>(std::lround(sampleRate)));
+  builder.setSampleRateConversionQuality(oboe::SampleRateConversionQuality::Medium);
+  builder.setCallback(this);
+  builder.setErrorCallback(this);
+
+  oboe::AudioStream* rawStream = nullptr;
+  const oboe::Result result = builder.openStream(&rawStream);
+  if (result != oboe::Result::OK || rawStream == nullptr) {
+    __android_log_print(ANDROID_LOG_WARN,
+                        kTag,
+                        "%s calibration.input.open.failed error=%s",
+                        kLogPrefix,
+                        oboe::convertToText(result));
+    if (rawStream != nullptr) {
+      rawStream->close();
+      delete rawStream;
+    }
+    return false;
+  }
+  mStream = StreamPtr(rawStream);
+  if (mStream->getSampleRate() != static_cast<int32_t>(std::lround(sampleRate))) {
+    __android_log_print(ANDROID_LOG_WARN,
+                        kTag,
+                        "%s calibration.input.rate.mismatch requested=%.0f actual=%d",
+                        kLogPrefix,
+                        sampleRate,
+                        mStream->getSampleRate());
+    mStream.reset();
+    return false;
+  }
+
+  // No callback runs before requestStart.
+  mAnchored = false;
+  mRunning.store(true, std::memory_order_release);
+  const oboe::Result startResult = mStream->requestStart();
+  if (startResult != oboe::Result::OK) {
+    __android_log_print(ANDROID_LOG_WARN,
+                        kTag,
+                        "%s calibration.input.start.failed error=%s",
+                        kLogPrefix,
+                        oboe::convertToText(startResult));
+    mRunning.store(false, std::memory_order_release);
+    mStream.reset();
+    return false;
+  }
+  __android_log_print(ANDROID_LOG_DEBUG, kTag, "%s calibration.input.start sampleRate=%.1f", kLogPrefix, sampleRate);
+  return true;
+}
+
+void CalibrationInputStream::stop() {
+  std::lock_guard<std::mutex> lock(mStreamMutex);
+  mRunning.store(false, std::memory_order_release);
+  if (!mStream) {
+    return;
+  }
+  mStream->requestStop();
+  mStream.reset();
+  __android_log_print(ANDROID_LOG_DEBUG, kTag, "%s calibration.input.stop", kLogPrefix);
+}
+
+oboe::DataCallbackResult CalibrationInputStream::onAudioReady(oboe::AudioStream* stream,
+                                                              void* audioData,
+                                                              int32_t numFrames) {
+  if (!mRunning.load(std::memory_order_acquire)) {
+    return oboe::DataCallbackResult::Stop;
+  }
+  if (stream == nullptr || audioData == nullptr || numFrames <= 0) {
+    return oboe::DataCallbackResult::Continue;
+  }
+  const double deliveredMs = nowMs();
+  const double frameMs = 1000.0 / static_cast<double>(stream->getSampleRate());
+  // frames read so far is the position of this buffer's first frame.
+  const int64_t firstFrame = stream->getFramesRead();
+  if (!mAnchored) {
+    int64_t framePosition = 0;
+    int64_t frameCapturedNs = 0;
+    if (stream->getTimestamp(CLOCK_MONOTONIC, &framePosition, &frameCapturedNs) == oboe::Result::OK) {
+      mAnchored = true;
+      mAnchorFrame = framePosition;
+      mAnchorMs = static_cast<double>(frameCapturedNs) / 1.0e6;
+    }
+  }
+  const double captureMs = mAnchored
+                               ? mAnchorMs + static_cast<double>(firstFrame - mAnchorFrame) * frameMs
+                               : deliveredMs - static_cast<double>(numFrames) * frameMs;
+  mCalibrator.captureInput(static_cast<const float*>(audioData),
+                           numFrames,
+                           stream->getChannelCount(),
+                           captureMs,
+                           deliveredMs,
+                           mAnchored);
+  return oboe::DataCallbackResult::Continue;
+}
+
+void CalibrationInputStream::onErrorAfterClose(oboe::AudioStream*, oboe::Result error) {
+  __android_log_print(ANDROID_LOG_WARN,
+                      kTag,
+                      "%s calibration.input.error error=%s",
+                      kLogPrefix,
+                      oboe::convertToText(error));
+  mRunning.store(false, std::memory_order_release);
+}
+
+} // namespace margelo::nitro::morse
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include <oboe/Oboe.h>
+
+#include "LoopbackCalibrator.hpp"
+
+namespace margelo::nitro::morse {
+
+// Oboe input stream that records the loopback side of a latency calibration.
+// Capture times come from the stream's timestamps once it has one, so the
+// input buffering does not end up in the measured output latency.
+class CalibrationInputStream final : public oboe::AudioStreamCallback {
+ public:
+  explicit CalibrationInputStream(LoopbackCalibrator& calibrator);
+  ~CalibrationInputStream() override;
+
+  // Opens the input at the output stream's rate (resampled if the device
+  // runs at another) so both sides share one sample clock.
+  bool start(double sampleRate);
+  void stop();
+  bool isRunning() const { return mRunning.load(std::memory_order_acquire); }
+
+  oboe::DataCallbackResult onAudioReady(oboe::AudioStream* stream,
+                                        void* audioData,
+                                        int32_t numFrames) override;
+  void onErrorAfterClose(oboe::AudioStream* stream, oboe::Result error) override;
+
+ private:
+  struct StreamDeleter {
+    void operator()(oboe::AudioStream* stream) const;
+  };
+  using StreamPtr = std::unique_ptr<oboe::AudioStream, StreamDeleter>;
+
+  LoopbackCalibrator& mCalibrator;
+  std::mutex mStreamMutex;
+  StreamPtr mStream;
+  std::atomic<bool> mRunning;
+
+  // Audio-thread state: first stream timestamp (frame, steady_clock ms).
+  bool mAnchored;
+  int64_t mAnchorFrame;
+  double mAnchorMs;
+};
+
+} // namespace margelo::nitro::morse
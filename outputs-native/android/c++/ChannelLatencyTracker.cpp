@@ -0,0 +1,129 @@
+#include "ChannelLatencyTracker.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+namespace margelo::nitro::morse {
+
+namespace {
+// Anything slower than this is a stalled main thread or a dropped callback,
+// not an actuation latency worth scheduling around.
+constexpr double kMaxPlausibleLatencyMs = 500.0;
+} // namespace
+
+const char* outputChannelName(OutputChannel channel) {
+  switch (channel) {
+    case OutputChannel::Tone:
+      return "tone";
+    case OutputChannel::Torch:
+      return "torch";
+    case OutputChannel::Overlay:
+      return "overlay";
+    case OutputChannel::Haptics:
+      return "haptics";
+  }
+  return "unknown";
+}
+
+std::optional<OutputChannel> parseOutputChannel(const std::string& name) {
+  for (std::size_t i = 0; i < kOutputChannelCount; ++i) {
+    const auto channel = static_cast<OutputChannel>(i);
+    if (name == outputChannelName(channel)) {
+      return channel;
+    }
+  }
+  return std::nullopt;
+}
+
+ChannelLatencyTracker& ChannelLatencyTracker::shared() {
+  static ChannelLatencyTracker* instance = new ChannelLatencyTracker();
+  return *instance;
+}
+
+ChannelLatencyTracker::ChannelLatencyTracker() {
+  reset();
+}
+
+void ChannelLatencyTracker::record(OutputChannel channel, double latencyMs) {
+  if (!std::isfinite(latencyMs) || latencyMs < 0.0 || latencyMs > kMaxPlausibleLatencyMs) {
+    return;
+  }
+  auto& window = mWindows[static_cast<std::size_t>(channel)];
+  const uint32_t index = window.total.fetch_add(1, std::memory_order_acq_rel);
+  window.samples[index % kWindow].store(static_cast<float>(latencyMs), std::memory_order_release);
+}
+
+void ChannelLatencyTracker::seed(OutputChannel channel, double latencyMs) {
+  for (uint32_t i = 0; i < kMinSamples; ++i) {
+    record(channel, latencyMs);
+  }
+}
+
+void ChannelLatencyTracker::reset() {
+  for (auto& window : mWindows) {
+    for (auto& sample : window.samples) {
+      sample.store(0.0f, std::memory_order_relaxed);
+    }
+    window.total.store(0, std::memory_order_release);
+  }
+}
+
+ChannelLatencyTracker::Summary ChannelLatencyTracker::summarize(OutputChannel channel) const {
+  const auto& window = mWindows[static_cast<std::size_t>(channel)];
+  const uint32_t total = window.total.load(std::memory_order_acquire);
+  const std::size_t count = std::min<std::size_t>(total, kWindow);
+  Summary summary{ 0.0, 0.0, 0.0, static_cast<uint32_t>(count) };
+  if (count == 0) {
+    return summary;
+  }
+
+  std::array<float, kWindow> values{};
+  for (std::size_t i = 0; i < count; ++i) {
+    values[i] = window.samples[i].load(std::memory_order_acquire);
+  }
+  summary.lastMs = window.samples[(total - 1) % kWindow].load(std::memory_order_acquire);
+
+  const auto mid = values.begin() + static_cast<std::ptrdiff_t>(count / 2);
+  std::nth_element(values.begin(), mid, values.begin() + static_cast<std::ptrdiff_t>(count));
+  summary.medianMs = *mid;
+
+  for (std::size_t i = 0; i < count; ++i) {
+    values[i] = std::fabs(values[i] - static_cast<float>(summary.medianMs));
+  }
+  std::nth_element(values.begin(), mid, values.begin() + static_cast<std::ptrdiff_t>(count));
+  summary.madMs = *mid;
+  return summary;
+}
+
+double ChannelLatencyTracker::estimateMs(OutputChannel channel, double fallbackMs) const {
+  const Summary summary = summarize(channel);
+  if (summary.samples < kMinSamples) {
+    return fallbackMs;
+  }
+  return summary.medianMs;
+}
+
+std::string ChannelLatencyTracker::toJson() const {
+  std::ostringstream stream;
+  stream.setf(std::ios::fixed, std::ios::floatfield);
+  stream << "{";
+  for (std::size_t i = 0; i < kOutputChannelCount; ++i) {
+    const auto channel = static_cast<OutputChannel>(i);
+    const Summary summary = summarize(channel);
+    stream << "\"" << outputChannelName(channel) << "\":{"
+           << "\"samples\":" << summary.samples
+           << ",\"medianMs\":" << std::setprecision(3) << summary.medianMs
+           << ",\"madMs\":" << std::setprecision(3) << summary.madMs
+           << ",\"lastMs\":" << std::setprecision(3) << summary.lastMs
+           << "}";
+    if (i + 1 < kOutputChannelCount) {
+      stream << ",";
+    }
+  }
+  stream << "}";
+  return stream.str();
+}
+
+} // namespace margelo::nitro::morse
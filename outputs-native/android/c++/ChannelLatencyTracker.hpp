@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace margelo::nitro::morse {
+
+enum class OutputChannel : uint8_t {
+  Tone = 0,
+  Torch,
+  Overlay,
+  Haptics,
+};
+
+constexpr std::size_t kOutputChannelCount = 4;
+
+const char* outputChannelName(OutputChannel channel);
+std::optional<OutputChannel> parseOutputChannel(const std::string& name);
+
+// Process-wide dispatch-to-commit latency estimates, one window per output
+// channel. Samples are written from the audio callback and the actuator thread
+// without locks; readers take the median of the window so a handful of slow
+// main-thread hops do not drag the scheduling lead around.
+class ChannelLatencyTracker {
+ public:
+  struct Summary {
+    double medianMs;
+    double madMs;
+    double lastMs;
+    uint32_t samples;
+  };
+
+  static ChannelLatencyTracker& shared();
+
+  void record(OutputChannel channel, double latencyMs);
+  // Pre-fills a channel (e.g. from a persisted per-device profile) so the first
+  // pattern after launch is already scheduled with a realistic lead.
+  void seed(OutputChannel channel, double latencyMs);
+  void reset();
+  double estimateMs(OutputChannel channel, double fallbackMs) const;
+  Summary summarize(OutputChannel channel) const;
+  std::string toJson() const;
+
+ private:
+  ChannelLatencyTracker();
+
+  static constexpr std::size_t kWindow = 64;
+  static constexpr uint32_t kMinSamples = 5;
+
+  struct ChannelWindow {
+    std::array<std::atomic<float>, kWindow> samples;
+    std::atomic<uint32_t> total;
+  };
+
+  std::array<ChannelWindow, kOutputChannelCount> mWindows;
+};
+
+} // namespace margelo::nitro::morse
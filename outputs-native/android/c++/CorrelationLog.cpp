@@ -0,0 +1,153 @@
+#include "CorrelationLog.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+
+namespace margelo::nitro::morse {
+
+namespace {
+void appendJsonString(std::ostringstream& stream, const std::string& value) {
+  stream << "\"";
+  for (const char c : value) {
+    switch (c) {
+      case '"':
+        stream << "\\\"";
+        break;
+      case '\\':
+        stream << "\\\\";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char escaped[8];
+          std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+          stream << escaped;
+        } else {
+          stream << c;
+        }
+    }
+  }
+  stream << "\"";
+}
+} // namespace
+
+CorrelationLog& CorrelationLog::shared() {
+  static CorrelationLog* instance = new CorrelationLog();
+  return *instance;
+}
+
+CorrelationLog::CorrelationLog() : mNextTag(1), mNextRecord(0) {
+  mNameTags.fill(0);
+  mTagsByName.reserve(kNameSlots);
+  for (auto& slot : mSlots) {
+    slot.version.store(0, std::memory_order_relaxed);
+  }
+}
+
+uint32_t CorrelationLog::intern(const std::string& id) {
+  if (id.empty()) {
+    return 0;
+  }
+  std::lock_guard<std::mutex> lock(mNameMutex);
+  const auto existing = mTagsByName.find(id);
+  if (existing != mTagsByName.end()) {
+    return existing->second;
+  }
+  const uint32_t tag = mNextTag;
+  // 0 stays reserved for "untagged" when the counter wraps.
+  mNextTag = mNextTag == UINT32_MAX ? 1 : mNextTag + 1;
+  const std::size_t slot = tag % kNameSlots;
+  if (mNameTags[slot] != 0) {
+    mTagsByName.erase(mNames[slot]);
+  }
+  mNames[slot] = id;
+  mNameTags[slot] = tag;
+  mTagsByName.emplace(id, tag);
+  return tag;
+}
+
+std::string CorrelationLog::name(uint32_t tag) const {
+  if (tag == 0) {
+    return {};
+  }
+  std::lock_guard<std::mutex> lock(mNameMutex);
+  const std::size_t slot = tag % kNameSlots;
+  return mNameTags[slot] == tag ? mNames[slot] : std::string();
+}
+
+void CorrelationLog::record(const Record& record) {
+  if (record.tag == 0) {
+    return;
+  }
+  const uint64_t index = mNextRecord.fetch_add(1, std::memory_order_acq_rel);
+  Slot& slot = mSlots[index % kRecordSlots];
+  slot.version.store(2 * index + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.tag.store(record.tag, std::memory_order_relaxed);
+  slot.channel.store(static_cast<uint8_t>(record.channel), std::memory_order_relaxed);
+  slot.sequence.store(record.sequence, std::memory_order_relaxed);
+  slot.dispatchedMs.store(record.dispatchedMs, std::memory_order_relaxed);
+  slot.committedMs.store(record.committedMs, std::memory_order_relaxed);
+  slot.targetMs.store(record.targetMs, std::memory_order_relaxed);
+  slot.version.store(2 * index + 2, std::memory_order_release);
+}
+
+std::string CorrelationLog::toJson(uint64_t cursor) const {
+  const uint64_t end = mNextRecord.load(std::memory_order_acquire);
+  uint64_t index = cursor > end ? end : cursor;
+  const uint64_t dropped = end - index > kRecordSlots ? end - index - kRecordSlots : 0;
+  index += dropped;
+
+  std::ostringstream stream;
+  stream.setf(std::ios::fixed, std::ios::floatfield);
+  stream << std::setprecision(3) << "{\"records\":[";
+  bool first = true;
+  for (; index < end; ++index) {
+    const Slot& slot = mSlots[index % kRecordSlots];
+    const uint64_t version = slot.version.load(std::memory_order_acquire);
+    if (version > 2 * index + 2) {
+      // Lapped by a writer since `end` was read.
+      continue;
+    }
+    if (version != 2 * index + 2) {
+      // Still being written: resume here next time.
+      break;
+    }
+    Record record{};
+    record.tag = slot.tag.load(std::memory_order_relaxed);
+    record.channel = static_cast<OutputChannel>(slot.channel.load(std::memory_order_relaxed));
+    record.sequence = slot.sequence.load(std::memory_order_relaxed);
+    record.dispatchedMs = slot.dispatchedMs.load(std::memory_order_relaxed);
+    record.committedMs = slot.committedMs.load(std::memory_order_relaxed);
+    record.targetMs = slot.targetMs.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.version.load(std::memory_order_relaxed) != version) {
+      continue;
+    }
+    const std::string id = name(record.tag);
+    if (id.empty()) {
+      continue;
+    }
+    if (!first) {
+      stream << ",";
+    }
+    first = false;
+    stream << "{\"correlationId\":";
+    appendJsonString(stream, id);
+    stream << ",\"channel\":\"" << outputChannelName(record.channel) << "\""
+           << ",\"sequence\":" << record.sequence
+           << ",\"dispatchedMs\":" << record.dispatchedMs
+           << ",\"committedMs\":" << record.committedMs
+           << ",\"latencyMs\":" << record.committedMs - record.dispatchedMs;
+    if (record.targetMs > 0.0) {
+      stream << ",\"targetMs\":" << record.targetMs
+             << ",\"skewMs\":" << record.committedMs - record.targetMs;
+    }
+    stream << "}";
+  }
+  stream << "],\"cursor\":" << index << ",\"dropped\":" << dropped << "}";
+  return stream.str();
+}
+
+} // namespace margelo::nitro::morse
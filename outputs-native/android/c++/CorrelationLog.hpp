@@ -0,0 +1,81 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "ChannelLatencyTracker.hpp"
+
+namespace margelo::nitro::morse {
+
+// Press correlation ids carried through the native output path. JS tags a
+// tone or a pattern symbol with the id its press tracker generated; the id is
+// interned here on the calling thread and only the 32-bit tag travels on,
+// through the playback thread, the audio callback's first-sample detection and
+// the actuator commits. Each tagged commit is logged with its dispatch and
+// commit times, so JS can attribute the latency to the press exactly instead
+// of matching commit times back to presses.
+//
+// record() is lock-free and allocation-free (audio and actuator threads); the
+// log is a ring that JS drains with a cursor.
+class CorrelationLog {
+ public:
+  struct Record {
+    uint32_t tag;
+    OutputChannel channel;
+    // Pattern symbol the commit belongs to; 0 for a manual tone.
+    uint64_t sequence;
+    double dispatchedMs;
+    double committedMs;
+    // Timeline target, 0 when the output was untimed.
+    double targetMs;
+  };
+
+  static CorrelationLog& shared();
+
+  // Returns 0 (untagged) for an empty id. Ids are recycled after
+  // kNameSlots newer ones, which is far longer than a commit takes.
+  uint32_t intern(const std::string& id);
+  // Empty once the tag has been recycled.
+  std::string name(uint32_t tag) const;
+
+  // Untagged commits are not logged.
+  void record(const Record& record);
+
+  // Records after `cursor` (the cursor a previous call returned), oldest
+  // first, with the ids resolved.
+  std::string toJson(uint64_t cursor) const;
+
+ private:
+  CorrelationLog();
+
+  static constexpr std::size_t kNameSlots = 512;
+  static constexpr std::size_t kRecordSlots = 1024;
+
+  // Per-slot seqlock: odd while a writer fills it, 2 * index + 2 once record
+  // `index` is complete.
+  struct Slot {
+    std::atomic<uint64_t> version;
+    std::atomic<uint32_t> tag;
+    std::atomic<uint8_t> channel;
+    std::atomic<uint64_t> sequence;
+    std::atomic<double> dispatchedMs;
+    std::atomic<double> committedMs;
+    std::atomic<double> targetMs;
+  };
+
+  mutable std::mutex mNameMutex;
+  std::array<std::string, kNameSlots> mNames;
+  std::array<uint32_t, kNameSlots> mNameTags;
+  std::unordered_map<std::string, uint32_t> mTagsByName;
+  uint32_t mNextTag;
+
+  std::array<Slot, kRecordSlots> mSlots;
+  std::atomic<uint64_t> mNextRecord;
+};
+
+} // namespace margelo::nitro::morse
@@ -0,0 +1,390 @@
+#include "CwChannelizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <iomanip>
+#include <sstream>
+
+namespace margelo::nitro::morse {
+
+namespace {
+constexpr double kTwoPi = 6.283185307179586476925286766559;
+constexpr double kMinLevel = 1e-7;
+// Hop matches CwReceiver's block length; the analysis window is longer so
+// bins are narrow enough (~30-60 Hz) to separate stations in a pileup.
+constexpr double kHopsPerUnit = 5.0;
+constexpr double kMinHopMs = 2.0;
+constexpr double kMaxHopMs = 10.0;
+constexpr double kWindowUnits = 0.5;
+constexpr double kMinWindowMs = 12.0;
+constexpr double kMaxWindowMs = 32.0;
+// Hops buffered before a batch runs; large enough to amortise the fork/join.
+constexpr int64_t kBatchHops = 64;
+constexpr std::size_t kSpectraGrain = 8;
+// Per-bin floor is a running 30th-percentile estimate of the log magnitude. A
+// keyed carrier is on well under 70% of the time, so the estimate stays on the
+// noise even in an occupied bin, and unlike a minimum tracker it does not sink
+// into the low tail of the noise where ordinary noise peaks look like carriers.
+constexpr int64_t kWarmupHops = 8;
+constexpr double kFloorQuantile = 0.3;
+constexpr double kFloorStep = 0.1;
+// A bin becomes a carrier when it is a local spectral peak this far above its
+// floor for several consecutive hops. Hops overlap, so fewer than three lets
+// single noise spikes through at a rate of a few per minute.
+constexpr double kCarrierThresholdDb = 15.0;
+constexpr uint32_t kCarrierConfirmHops = 3;
+// Hann main lobe spans +/-2 bins; keep new carriers clear of existing ones.
+constexpr uint32_t kGuardBins = 3;
+// Channels whose carrier has been absent this long (in units of the seed
+// speed, several word gaps) are closed and freed, before the keying tracker's
+// signal estimate can decay into the noise and start keying on it.
+constexpr double kRetireUnits = 40.0;
+constexpr double kFlushHorizonMs = 60000.0;
+
+double dbToLog(double db) {
+  return db / 20.0 * std::log(10.0);
+}
+} // namespace
+
+CwChannelizer::CwChannelizer()
+    : mConfig{ 48000.0, 60.0, 300.0, 2000.0, 16, 0 },
+      mMagnitudeScale(1.0f),
+      mWindowSize(0),
+      mHopSize(0),
+      mMinBin(0),
+      mBinCount(0),
+      mBatchStartHop(0),
+      mTrackedHops(0),
+      mNextChannelId(1) {}
+
+CwChannelizer::~CwChannelizer() = default;
+
+void CwChannelizer::configure(const Config& config) {
+  mConfig = config;
+  mConfig.sampleRate = config.sampleRate > 0.0 ? config.sampleRate : 48000.0;
+  mConfig.unitMs = config.unitMs > 0.0 ? config.unitMs : 60.0;
+  mConfig.maxChannels = std::max<uint32_t>(1, config.maxChannels);
+  const double sampleRate = mConfig.sampleRate;
+
+  const double hopMs = std::clamp(mConfig.unitMs / kHopsPerUnit, kMinHopMs, kMaxHopMs);
+  const double windowMs = std::clamp(mConfig.unitMs * kWindowUnits, kMinWindowMs, kMaxWindowMs);
+  mHopSize = std::max<std::size_t>(8, static_cast<std::size_t>(std::lround(sampleRate * hopMs / 1000.0)));
+  mWindowSize = std::max(mHopSize, static_cast<std::size_t>(std::lround(sampleRate * windowMs / 1000.0)));
+  mFft = std::make_unique<Fft>(mWindowSize);
+
+  mWindow.assign(mWindowSize, 0.0f);
+  double windowSum = 0.0;
+  for (std::size_t i = 0; i < mWindowSize; ++i) {
+    const double w = 0.5 - 0.5 * std::cos(kTwoPi * static_cast<double>(i) / static_cast<double>(mWindowSize - 1));
+    mWindow[i] = static_cast<float>(w);
+    windowSum += w;
+  }
+  // A full-scale sine on a bin centre reads as amplitude 1.0.
+  mMagnitudeScale = static_cast<float>(windowSum > 0.0 ? 2.0 / windowSum : 1.0);
+
+  const double binHz = sampleRate / static_cast<double>(mFft->size());
+  const auto nyquistBin = static_cast<uint32_t>(mFft->size() / 2 - 1);
+  const double minHz = std::max(mConfig.minHz, binHz);
+  const double maxHz = std::max(minHz, mConfig.maxHz);
+  mMinBin = std::min(nyquistBin, static_cast<uint32_t>(std::ceil(minHz / binHz)));
+  const uint32_t maxBin = std::min(nyquistBin, static_cast<uint32_t>(std::floor(maxHz / binHz)));
+  mBinCount = maxBin >= mMinBin ? maxBin - mMinBin + 1 : 0;
+
+  if (!mPool || (mConfig.threads != 0 && mPool->concurrency() != mConfig.threads)) {
+    mPool = std::make_unique<WorkStealingPool>(mConfig.threads);
+  }
+
+  mInput.clear();
+  mSpectra.clear();
+  mBatchStartHop = 0;
+  mBinFloor.assign(mBinCount, 0.0);
+  mBinHits.assign(mBinCount, 0);
+  mTrackedHops = 0;
+  mChannels.clear();
+  mNextChannelId = 1;
+}
+
+double CwChannelizer::hopTimeMs(int64_t hop) const {
+  // Magnitudes describe the centre of the analysis window.
+  const double centreFrame =
+      static_cast<double>(hop) * static_cast<double>(mHopSize) + static_cast<double>(mWindowSize) * 0.5;
+  return centreFrame * 1000.0 / mConfig.sampleRate;
+}
+
+double CwChannelizer::elapsedMs() const {
+  return static_cast<double>(mBatchStartHop) * static_cast<double>(mHopSize) * 1000.0 / mConfig.sampleRate;
+}
+
+void CwChannelizer::process(const float* samples,
+                            int32_t frames,
+                            int32_t channels,
+                            std::vector<ChannelEvent>& events) {
+  if (samples == nullptr || frames <= 0 || !mFft) {
+    return;
+  }
+  const int32_t stride = channels > 0 ? channels : 1;
+  const float channelScale = 1.0f / static_cast<float>(stride);
+  mInput.reserve(mInput.size() + static_cast<std::size_t>(frames));
+  for (int32_t frame = 0; frame < frames; ++frame) {
+    float sample = 0.0f;
+    for (int32_t channel = 0; channel < stride; ++channel) {
+      sample += samples[frame * stride + channel];
+    }
+    mInput.push_back(sample * channelScale);
+  }
+  if (mInput.size() < mWindowSize) {
+    return;
+  }
+  const auto available = static_cast<int64_t>((mInput.size() - mWindowSize) / mHopSize + 1);
+  if (available >= kBatchHops) {
+    runBatch(available, events);
+  }
+}
+
+void CwChannelizer::finish(std::vector<ChannelEvent>& events) {
+  if (mFft && mInput.size() >= mWindowSize) {
+    runBatch(static_cast<int64_t>((mInput.size() - mWindowSize) / mHopSize + 1), events);
+  }
+  for (auto& channel : mChannels) {
+    closeChannel(*channel);
+  }
+  collect(events);
+}
+
+void CwChannelizer::runBatch(int64_t hops, std::vector<ChannelEvent>& events) {
+  retireIdleChannels(events);
+  computeSpectra(hops);
+  trackCarriers(hops);
+  mPool->parallelFor(mChannels.size(), [&](std::size_t index) { decodeChannel(*mChannels[index], hops); });
+  collect(events);
+  mBatchStartHop += hops;
+  mInput.erase(mInput.begin(), mInput.begin() + static_cast<std::ptrdiff_t>(hops * static_cast<int64_t>(mHopSize)));
+}
+
+void CwChannelizer::computeSpectra(int64_t hops) {
+  mSpectra.resize(static_cast<std::size_t>(hops) * mBinCount);
+  const std::size_t fftSize = mFft->size();
+  const std::size_t chunks = (static_cast<std::size_t>(hops) + kSpectraGrain - 1) / kSpectraGrain;
+  mPool->parallelFor(chunks, [&](std::size_t chunk) {
+    std::vector<std::complex<float>> buffer(fftSize);
+    const std::size_t firstHop = chunk * kSpectraGrain;
+    const std::size_t lastHop = std::min(firstHop + kSpectraGrain, static_cast<std::size_t>(hops));
+    for (std::size_t hop = firstHop; hop < lastHop; ++hop) {
+      const float* input = mInput.data() + hop * mHopSize;
+      for (std::size_t i = 0; i < mWindowSize; ++i) {
+        buffer[i] = std::complex<float>(input[i] * mWindow[i], 0.0f);
+      }
+      std::fill(buffer.begin() + static_cast<std::ptrdiff_t>(mWindowSize), buffer.end(), std::complex<float>());
+      mFft->forward(buffer.data());
+      float* row = mSpectra.data() + hop * mBinCount;
+      for (uint32_t bin = 0; bin < mBinCount; ++bin) {
+        row[bin] = std::abs(buffer[mMinBin + bin]) * mMagnitudeScale;
+      }
+    }
+  });
+}
+
+void CwChannelizer::trackCarriers(int64_t hops) {
+  const double threshold = dbToLog(kCarrierThresholdDb);
+  const double binHz = mConfig.sampleRate / static_cast<double>(mFft->size());
+  std::vector<double> logs(mBinCount);
+
+  for (int64_t hop = 0; hop < hops; ++hop) {
+    const float* row = mSpectra.data() + static_cast<std::size_t>(hop) * mBinCount;
+    for (uint32_t bin = 0; bin < mBinCount; ++bin) {
+      logs[bin] = std::log(std::max(static_cast<double>(row[bin]), kMinLevel));
+    }
+    const bool warming = mTrackedHops < kWarmupHops;
+    for (uint32_t bin = 0; bin < mBinCount; ++bin) {
+      const double level = logs[bin];
+      double& floor = mBinFloor[bin];
+      if (warming) {
+        // Plain mean of the first hops gets the quantile tracker close.
+        floor += (level - floor) / static_cast<double>(mTrackedHops + 1);
+      } else if (level < floor) {
+        floor -= kFloorStep * (1.0 - kFloorQuantile);
+      } else {
+        floor += kFloorStep * kFloorQuantile;
+      }
+    }
+    ++mTrackedHops;
+    if (warming) {
+      continue;
+    }
+
+    const int64_t globalHop = mBatchStartHop + hop;
+    for (uint32_t bin = 0; bin < mBinCount; ++bin) {
+      const double level = logs[bin];
+      bool peak = level - mBinFloor[bin] >= threshold;
+      for (uint32_t offset = 1; peak && offset <= 2; ++offset) {
+        if ((bin >= offset && logs[bin - offset] > level) ||
+            (bin + offset < mBinCount && logs[bin + offset] > level)) {
+          peak = false;
+        }
+      }
+      mBinHits[bin] = peak ? mBinHits[bin] + 1 : 0;
+      if (mBinHits[bin] < kCarrierConfirmHops || mChannels.size() >= mConfig.maxChannels) {
+        continue;
+      }
+      const bool owned = std::any_of(mChannels.begin(), mChannels.end(), [&](const auto& channel) {
+        return (channel->bin > bin ? channel->bin - bin : bin - channel->bin) <= kGuardBins;
+      });
+      if (owned) {
+        continue;
+      }
+
+      // Parabolic interpolation across the neighbouring bins for the pitch.
+      double offset = 0.0;
+      if (bin > 0 && bin + 1 < mBinCount) {
+        const double denominator = logs[bin - 1] - 2.0 * level + logs[bin + 1];
+        if (denominator < 0.0) {
+          offset = std::clamp(0.5 * (logs[bin - 1] - logs[bin + 1]) / denominator, -0.5, 0.5);
+        }
+      }
+      auto channel = std::make_unique<Channel>();
+      channel->id = mNextChannelId++;
+      channel->bin = bin;
+      channel->toneHz = (static_cast<double>(mMinBin + bin) + offset) * binHz;
+      // Rewind to the hop before the carrier first crossed the threshold so
+      // the opening mark is decoded too.
+      channel->startHop = std::max(mBatchStartHop, globalHop - static_cast<int64_t>(kCarrierConfirmHops));
+      channel->lastKeyedHop = globalHop;
+      channel->lastCarrierHop = globalHop;
+      channel->tracker.seed(std::exp(mBinFloor[bin]), std::exp(level));
+      channel->classifier.reset(mConfig.unitMs);
+      mChannels.push_back(std::move(channel));
+    }
+  }
+}
+
+void CwChannelizer::decodeChannel(Channel& channel, int64_t hops) {
+  const double carrierRatio = std::exp(dbToLog(kCarrierThresholdDb));
+  const int64_t firstHop = std::max<int64_t>(0, channel.startHop - mBatchStartHop);
+  for (int64_t hop = firstHop; hop < hops; ++hop) {
+    const float level = mSpectra[static_cast<std::size_t>(hop) * mBinCount + channel.bin];
+    const int64_t globalHop = mBatchStartHop + hop;
+    if (channel.tracker.update(level)) {
+      const double edgeMs = hopTimeMs(globalHop - static_cast<int64_t>(KeyingTracker::kDebounceBlocks) + 1);
+      if (channel.tracker.keyed()) {
+        channel.classifier.keyDown(edgeMs, channel.pending);
+      } else {
+        channel.classifier.keyUp(edgeMs);
+      }
+    }
+    if (channel.tracker.keyed()) {
+      channel.lastKeyedHop = globalHop;
+    }
+    if (level >= channel.tracker.noiseLevel() * carrierRatio) {
+      channel.lastCarrierHop = globalHop;
+    }
+  }
+  channel.classifier.flush(hopTimeMs(mBatchStartHop + hops - 1), channel.pending);
+}
+
+void CwChannelizer::closeChannel(Channel& channel) {
+  const double endMs = elapsedMs();
+  if (channel.tracker.keyed()) {
+    channel.classifier.keyUp(endMs);
+  }
+  // Far enough past the last edge to close both the letter and the word.
+  channel.classifier.flush(endMs + kFlushHorizonMs, channel.pending);
+}
+
+void CwChannelizer::retireIdleChannels(std::vector<ChannelEvent>& events) {
+  const double hopMs = static_cast<double>(mHopSize) * 1000.0 / mConfig.sampleRate;
+  const auto retireHops = static_cast<int64_t>(kRetireUnits * mConfig.unitMs / hopMs);
+  const auto idle = [&](const std::unique_ptr<Channel>& channel) {
+    return !channel->tracker.keyed() && mBatchStartHop - channel->lastCarrierHop > retireHops;
+  };
+  bool retired = false;
+  for (auto& channel : mChannels) {
+    if (idle(channel)) {
+      closeChannel(*channel);
+      retired = true;
+    }
+  }
+  if (!retired) {
+    return;
+  }
+  collect(events);
+  mChannels.erase(std::remove_if(mChannels.begin(), mChannels.end(), idle), mChannels.end());
+}
+
+void CwChannelizer::collect(std::vector<ChannelEvent>& events) {
+  const std::size_t first = events.size();
+  for (auto& channel : mChannels) {
+    for (auto& event : channel->pending) {
+      events.push_back(ChannelEvent{ channel->id, channel->toneHz, std::move(event) });
+    }
+    channel->pending.clear();
+  }
+  std::stable_sort(events.begin() + static_cast<std::ptrdiff_t>(first),
+                   events.end(),
+                   [](const ChannelEvent& a, const ChannelEvent& b) { return a.event.endMs < b.event.endMs; });
+}
+
+std::vector<CwChannelizer::ChannelSummary> CwChannelizer::summarize() const {
+  std::vector<ChannelSummary> summaries;
+  summaries.reserve(mChannels.size());
+  for (const auto& channel : mChannels) {
+    summaries.push_back(ChannelSummary{ channel->id,
+                                        channel->toneHz,
+                                        hopTimeMs(channel->startHop),
+                                        hopTimeMs(channel->lastKeyedHop),
+                                        channel->tracker.summarize(),
+                                        channel->classifier.summarize() });
+  }
+  return summaries;
+}
+
+std::string CwChannelizer::toJson(const std::vector<ChannelEvent>& events) {
+  std::ostringstream stream;
+  stream.setf(std::ios::fixed, std::ios::floatfield);
+  stream << "[";
+  for (std::size_t i = 0; i < events.size(); ++i) {
+    const auto& entry = events[i];
+    const auto& event = entry.event;
+    const bool isLetter = event.kind == DecodedMorseEvent::Kind::Letter;
+    stream << "{\"channel\":" << entry.channel
+           << ",\"toneHz\":" << std::setprecision(1) << entry.toneHz
+           << ",\"type\":\"" << (isLetter ? "letter" : "word") << "\""
+           << ",\"text\":\"" << event.text << "\"";
+    if (isLetter) {
+      stream << ",\"pattern\":\"" << event.pattern << "\"";
+    }
+    stream << ",\"confidence\":" << std::setprecision(3) << event.confidence
+           << ",\"startMs\":" << std::setprecision(3) << event.startMs
+           << ",\"endMs\":" << std::setprecision(3) << event.endMs
+           << "}";
+    if (i + 1 < events.size()) {
+      stream << ",";
+    }
+  }
+  stream << "]";
+  return stream.str();
+}
+
+std::string CwChannelizer::toJson(const std::vector<ChannelSummary>& channels) {
+  std::ostringstream stream;
+  stream.setf(std::ios::fixed, std::ios::floatfield);
+  stream << "[";
+  for (std::size_t i = 0; i < channels.size(); ++i) {
+    const auto& channel = channels[i];
+    stream << "{\"channel\":" << channel.channel
+           << ",\"toneHz\":" << std::setprecision(1) << channel.toneHz
+           << ",\"firstSeenMs\":" << std::setprecision(3) << channel.firstSeenMs
+           << ",\"lastKeyedMs\":" << std::setprecision(3) << channel.lastKeyedMs
+           << ",\"snrDb\":" << std::setprecision(2) << channel.keying.snrDb
+           << ",\"keyed\":" << (channel.keying.keyed ? "true" : "false")
+           << ",\"classifier\":" << PressClassifier::toJson(channel.classifier)
+           << "}";
+    if (i + 1 < channels.size()) {
+      stream << ",";
+    }
+  }
+  stream << "]";
+  return stream.str();
+}
+
+} // namespace margelo::nitro::morse
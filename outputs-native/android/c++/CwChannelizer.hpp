@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Fft.hpp"
+#include "KeyingTracker.hpp"
+#include "PressClassifier.hpp"
+#include "WorkStealingPool.hpp"
+
+namespace margelo::nitro::morse {
+
+// Multi-signal CW decoder. A short-time FFT splits the band into bins, a
+// per-bin floor/peak tracker spots new carriers, and every carrier gets its own
+// KeyingTracker + PressClassifier fed from that bin's magnitude.
+//
+// Input is processed in batches of hops. Each batch runs in three phases:
+// spectra (parallel over hops), carrier tracking (serial, cheap), and decoding
+// (parallel over channels). Phases are deterministic, so output does not
+// depend on the thread count.
+class CwChannelizer {
+ public:
+  struct Config {
+    double sampleRate;
+    // Seed speed for new channels; each classifier adapts on its own.
+    double unitMs;
+    double minHz;
+    double maxHz;
+    uint32_t maxChannels;
+    // 0 = one per hardware thread.
+    std::size_t threads;
+  };
+
+  struct ChannelEvent {
+    uint32_t channel;
+    double toneHz;
+    DecodedMorseEvent event;
+  };
+
+  struct ChannelSummary {
+    uint32_t channel;
+    double toneHz;
+    double firstSeenMs;
+    double lastKeyedMs;
+    KeyingTracker::Summary keying;
+    PressClassifier::Summary classifier;
+  };
+
+  CwChannelizer();
+  ~CwChannelizer();
+
+  void configure(const Config& config);
+  void process(const float* samples, int32_t frames, int32_t channels, std::vector<ChannelEvent>& events);
+  void finish(std::vector<ChannelEvent>& events);
+
+  std::vector<ChannelSummary> summarize() const;
+  double elapsedMs() const;
+  std::size_t concurrency() const { return mPool ? mPool->concurrency() : 1; }
+
+  static std::string toJson(const std::vector<ChannelEvent>& events);
+  static std::string toJson(const std::vector<ChannelSummary>& channels);
+
+ private:
+  struct Channel {
+    uint32_t id;
+    uint32_t bin;
+    double toneHz;
+    int64_t startHop;
+    int64_t lastKeyedHop;
+    int64_t lastCarrierHop;
+    KeyingTracker tracker;
+    PressClassifier classifier;
+    std::vector<DecodedMorseEvent> pending;
+  };
+
+  void runBatch(int64_t hops, std::vector<ChannelEvent>& events);
+  void computeSpectra(int64_t hops);
+  void trackCarriers(int64_t hops);
+  void decodeChannel(Channel& channel, int64_t hops);
+  void retireIdleChannels(std::vector<ChannelEvent>& events);
+  void closeChannel(Channel& channel);
+  void collect(std::vector<ChannelEvent>& events);
+  double hopTimeMs(int64_t hop) const;
+
+  Config mConfig;
+  std::unique_ptr<Fft> mFft;
+  std::unique_ptr<WorkStealingPool> mPool;
+  std::vector<float> mWindow;
+  float mMagnitudeScale;
+  std::size_t mWindowSize;
+  std::size_t mHopSize;
+  uint32_t mMinBin;
+  uint32_t mBinCount;
+
+  // Mono input not yet consumed; always starts at the next window.
+  std::vector<float> mInput;
+  // Magnitudes for the current batch, hop-major.
+  std::vector<float> mSpectra;
+  int64_t mBatchStartHop;
+
+  // Per-bin log-domain noise floor.
+  std::vector<double> mBinFloor;
+  std::vector<uint32_t> mBinHits;
+  int64_t mTrackedHops;
+
+  std::vector<std::unique_ptr<Channel>> mChannels;
+  uint32_t mNextChannelId;
+};
+
+} // namespace margelo::nitro::morse
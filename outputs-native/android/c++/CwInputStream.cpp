@@ -0,0 +1,114 @@
+#include "CwInputStream.hpp"
+
+#include <android/log.h>
+
+namespace margelo::nitro::morse {
+
+namespace {
+constexpr const char* kLogPrefix = "[outputs-audio]";
+constexpr const char* kTag = "OutputsAudio";
+} // namespace
+
+void CwInputStream::StreamDeleter::operator()(oboe::AudioStream* stream) const {
+  if (stream != nullptr) {
+    stream->close();
+    delete stream;
+  }
+}
+
+CwInputStream::CwInputStream(CwReceiver& receiver) : mReceiver(receiver), mStream(nullptr), mRunning(false) {}
+
+CwInputStream::~CwInputStream() {
+  stop();
+}
+
+bool CwInputStream::start(double toneHz, double unitMs) {
+  std::lock_guard<std::mutex> lock(mStreamMutex);
+  if (mStream) {
+    mRunning.store(false, std::memory_order_release);
+    mStream->requestStop();
+    mStream.reset();
+  }
+
+  oboe::AudioStreamBuilder builder;
+  builder.setDirection(oboe::Direction::Input);
+  builder.setPerformanceMode(oboe::PerformanceMode::LowLatency);
+  builder.setSharingMode(oboe::SharingMode::Shared);
+  // Unprocessed skips AGC/noise suppression, which would otherwise pump the
+  // level between marks and smear the keying envelope.
+  builder.setInputPreset(oboe::InputPreset::Unprocessed);
+  builder.setChannelCount(1);
+  builder.setFormat(oboe::AudioFormat::Float);
+  builder.setCallback(this);
+  builder.setErrorCallback(this);
+
+  oboe::AudioStream* rawStream = nullptr;
+  const oboe::Result result = builder.openStream(&rawStream);
+  if (result != oboe::Result::OK || rawStream == nullptr) {
+    __android_log_print(ANDROID_LOG_WARN,
+                        kTag,
+                        "%s receiver.open.failed error=%s",
+                        kLogPrefix,
+                        oboe::convertToText(result));
+    if (rawStream != nullptr) {
+      rawStream->close();
+      delete rawStream;
+    }
+    return false;
+  }
+  mStream = StreamPtr(rawStream);
+
+  const double sampleRate = static_cast<double>(mStream->getSampleRate());
+  mReceiver.configure(CwReceiver::Config{ sampleRate, toneHz, unitMs });
+  mRunning.store(true, std::memory_order_release);
+  const oboe::Result startResult = mStream->requestStart();
+  if (startResult != oboe::Result::OK) {
+    __android_log_print(ANDROID_LOG_WARN,
+                        kTag,
+                        "%s receiver.start.failed error=%s",
+                        kLogPrefix,
+                        oboe::convertToText(startResult));
+    mRunning.store(false, std::memory_order_release);
+    mStream.reset();
+    return false;
+  }
+  __android_log_print(ANDROID_LOG_DEBUG,
+                      kTag,
+                      "%s receiver.start sampleRate=%.1f hz=%.1f unit=%.1f",
+                      kLogPrefix,
+                      sampleRate,
+                      toneHz,
+                      unitMs);
+  return true;
+}
+
+void CwInputStream::stop() {
+  std::lock_guard<std::mutex> lock(mStreamMutex);
+  mRunning.store(false, std::memory_order_release);
+  if (!mStream) {
+    return;
+  }
+  mStream->requestStop();
+  mStream.reset();
+  __android_log_print(ANDROID_LOG_DEBUG, kTag, "%s receiver.stop", kLogPrefix);
+}
+
+oboe::DataCallbackResult CwInputStream::onAudioReady(oboe::AudioStream* stream,
+                                                     void* audioData,
+                                                     int32_t numFrames) {
+  if (!mRunning.load(std::memory_order_acquire)) {
+    return oboe::DataCallbackResult::Stop;
+  }
+  if (stream == nullptr || audioData == nullptr || numFrames <= 0) {
+    return oboe::DataCallbackResult::Continue;
+  }
+  mReceiver.processRealtime(static_cast<const float*>(audioData), numFrames, stream->getChannelCount());
+  return oboe::DataCallbackResult::Continue;
+}
+
+void CwInputStream::onErrorAfterClose(oboe::AudioStream*, oboe::Result error) {
+  __android_log_print(ANDROID_LOG_WARN, kTag, "%s receiver.error error=%s", kLogPrefix, oboe::convertToText(error));
+  mRunning.store(false, std::memory_order_release);
+}
+
+} // namespace margelo::nitro::morse
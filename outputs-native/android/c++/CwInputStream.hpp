@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#include <oboe/Oboe.h>
+
+#include "CwReceiver.hpp"
+
+namespace margelo::nitro::morse {
+
+// Oboe input stream that feeds microphone PCM into a CwReceiver. The callback
+// only runs the tone detector; decoding happens on whichever thread polls the
+// receiver.
+class CwInputStream final : public oboe::AudioStreamCallback {
+ public:
+  explicit CwInputStream(CwReceiver& receiver);
+  ~CwInputStream() override;
+
+  bool start(double toneHz, double unitMs);
+  void stop();
+  bool isRunning() const { return mRunning.load(std::memory_order_acquire); }
+
+  oboe::DataCallbackResult onAudioReady(oboe::AudioStream* stream,
+                                        void* audioData,
+                                        int32_t numFrames) override;
+  void onErrorAfterClose(oboe::AudioStream* stream, oboe::Result error) override;
+
+ private:
+  struct StreamDeleter {
+    void operator()(oboe::AudioStream* stream) const;
+  };
+  using StreamPtr = std::unique_ptr<oboe::AudioStream, StreamDeleter>;
+
+  CwReceiver& mReceiver;
+  std::mutex mStreamMutex;
+  StreamPtr mStream;
+  std::atomic<bool> mRunning;
+};
+
+} // namespace margelo::nitro::morse
@@ -0,0 +1,114 @@
+#include "CwReceiver.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace margelo::nitro::morse {
+
+namespace {
+// Several blocks per dot keep edge quantisation well under the classifier's
+// tolerance while the Goertzel bandwidth stays narrow enough to reject QRM.
+constexpr double kBlocksPerUnit = 5.0;
+constexpr double kMinBlockMs = 2.0;
+constexpr double kMaxBlockMs = 10.0;
+} // namespace
+
+CwReceiver::CwReceiver()
+    : mRealtimeElapsedMs(0.0),
+      mNoiseLevel(0.0),
+      mSignalLevel(0.0),
+      mSnrDb(0.0),
+      mKeyed(false),
+      mDroppedEdges(0) {}
+
+void CwReceiver::configure(const Config& config) {
+  const double blockMs = std::clamp(config.unitMs / kBlocksPerUnit, kMinBlockMs, kMaxBlockMs);
+  mDetector.configure(ToneDetector::Config{ config.sampleRate, config.toneHz, blockMs });
+  mClassifier.reset(config.unitMs);
+  ToneDetector::Edge discarded{};
+  while (mEdges.tryPop(discarded)) {
+  }
+  mDroppedEdges.store(0, std::memory_order_relaxed);
+  publishLevels();
+}
+
+void CwReceiver::publishLevels() {
+  const ToneDetector::Summary detector = mDetector.summarize();
+  mNoiseLevel.store(detector.noiseLevel, std::memory_order_relaxed);
+  mSignalLevel.store(detector.signalLevel, std::memory_order_relaxed);
+  mSnrDb.store(detector.snrDb, std::memory_order_relaxed);
+  mKeyed.store(detector.keyed, std::memory_order_relaxed);
+  mRealtimeElapsedMs.store(mDetector.elapsedMs(), std::memory_order_release);
+}
+
+void CwReceiver::applyEdge(const ToneDetector::Edge& edge, std::vector<DecodedMorseEvent>& events) {
+  if (edge.keyDown) {
+    mClassifier.keyDown(edge.timestampMs, events);
+  } else {
+    mClassifier.keyUp(edge.timestampMs);
+  }
+}
+
+void CwReceiver::process(const float* samples,
+                         int32_t frames,
+                         int32_t channels,
+                         std::vector<DecodedMorseEvent>& events) {
+  mDetector.process(samples, frames, channels, [&](const ToneDetector::Edge& edge) { applyEdge(edge, events); });
+  mClassifier.flush(mDetector.elapsedMs(), events);
+  publishLevels();
+}
+
+void CwReceiver::finish(std::vector<DecodedMorseEvent>& events) {
+  if (mDetector.summarize().keyed) {
+    mClassifier.keyUp(mDetector.elapsedMs());
+  }
+  // Far enough past the last edge to close both the letter and the word.
+  mClassifier.flush(mDetector.elapsedMs() + 60000.0, events);
+}
+
+void CwReceiver::processRealtime(const float* samples, int32_t frames, int32_t channels) {
+  mDetector.process(samples, frames, channels, [this](const ToneDetector::Edge& edge) {
+    if (!mEdges.tryPush(edge)) {
+      mDroppedEdges.fetch_add(1, std::memory_order_relaxed);
+    }
+  });
+  publishLevels();
+}
+
+void CwReceiver::poll(std::vector<DecodedMorseEvent>& events) {
+  // Read the clock before draining so no edge can be newer than the flush time.
+  const double elapsedMs = mRealtimeElapsedMs.load(std::memory_order_acquire);
+  ToneDetector::Edge edge{};
+  while (mEdges.tryPop(edge)) {
+    applyEdge(edge, events);
+  }
+  mClassifier.flush(elapsedMs, events);
+}
+
+CwReceiver::Summary CwReceiver::summarize() const {
+  const ToneDetector::Summary detector{ mNoiseLevel.load(std::memory_order_relaxed),
+                                        mSignalLevel.load(std::memory_order_relaxed),
+                                        mSnrDb.load(std::memory_order_relaxed),
+                                        mKeyed.load(std::memory_order_relaxed) };
+  return Summary{ detector,
+                  mClassifier.summarize(),
+                  mRealtimeElapsedMs.load(std::memory_order_acquire),
+                  mDroppedEdges.load(std::memory_order_relaxed) };
+}
+
+std::string CwReceiver::toJson(const Summary& summary) {
+  std::ostringstream stream;
+  stream.setf(std::ios::fixed, std::ios::floatfield);
+  stream << "{\"keyed\":" << (summary.detector.keyed ? "true" : "false")
+         << ",\"snrDb\":" << std::setprecision(2) << summary.detector.snrDb
+         << ",\"noiseLevel\":" << std::setprecision(6) << summary.detector.noiseLevel
+         << ",\"signalLevel\":" << std::setprecision(6) << summary.detector.signalLevel
+         << ",\"elapsedMs\":" << std::setprecision(3) << summary.elapsedMs
+         << ",\"droppedEdges\":" << summary.droppedEdges
+         << ",\"classifier\":" << PressClassifier::toJson(summary.classifier)
+         << "}";
+  return stream.str();
+}
+
+} // namespace margelo::nitro::morse
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "LockFreeQueue.hpp"
+#include "PressClassifier.hpp"
+#include "ToneDetector.hpp"
+
+namespace margelo::nitro::morse {
+
+// Receive pipeline: PCM -> ToneDetector keying edges -> PressClassifier text.
+//
+// Offline callers (WAV replay, tools) use process()/finish() on one thread.
+// Live capture splits the work: the input callback only runs the detector and
+// pushes edges through a lock-free queue (processRealtime), and a consumer
+// thread turns them into letters with poll().
+class CwReceiver {
+ public:
+  struct Config {
+    double sampleRate;
+    double toneHz;
+    double unitMs;
+  };
+
+  struct Summary {
+    ToneDetector::Summary detector;
+    PressClassifier::Summary classifier;
+    double elapsedMs;
+    uint64_t droppedEdges;
+  };
+
+  CwReceiver();
+
+  void configure(const Config& config);
+
+  void process(const float* samples, int32_t frames, int32_t channels, std::vector<DecodedMorseEvent>& events);
+  void finish(std::vector<DecodedMorseEvent>& events);
+
+  void processRealtime(const float* samples, int32_t frames, int32_t channels);
+  void poll(std::vector<DecodedMorseEvent>& events);
+
+  Summary summarize() const;
+  static std::string toJson(const Summary& summary);
+
+ private:
+  void applyEdge(const ToneDetector::Edge& edge, std::vector<DecodedMorseEvent>& events);
+  void publishLevels();
+
+  static constexpr std::size_t kEdgeCapacity = 256;
+
+  ToneDetector mDetector;
+  PressClassifier mClassifier;
+  LockFreeQueue<ToneDetector::Edge, kEdgeCapacity> mEdges;
+  // Detector levels republished after every block of input so status reads
+  // from other threads never touch the detector's working state.
+  std::atomic<double> mRealtimeElapsedMs;
+  std::atomic<double> mNoiseLevel;
+  std::atomic<double> mSignalLevel;
+  std::atomic<double> mSnrDb;
+  std::atomic<bool> mKeyed;
+  std::atomic<uint64_t> mDroppedEdges;
+};
+
+} // namespace margelo::nitro::morse
@@ -0,0 +1,42 @@
+#include "DriftCorrector.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace margelo::nitro::morse {
+
+DriftCorrector::Config DriftCorrector::defaultConfig() {
+  Config config{};
+  config.proportionalGain = 0.15;
+  config.integralGain = 0.1;
+  config.maxCorrectionMs = 20.0;
+  config.outlierMs = 40.0;
+  config.residualWeight = 0.1;
+  return config;
+}
+
+DriftCorrector::DriftCorrector(const Config& config) : mConfig(config) {
+  reset();
+}
+
+void DriftCorrector::reset() {
+  mIntegralMs = 0.0;
+  mCorrectionMs = 0.0;
+  mResidualMs = 0.0;
+  mSamples = 0;
+}
+
+bool DriftCorrector::update(double skewMs) {
+  if (!std::isfinite(skewMs) || std::abs(skewMs) > mConfig.outlierMs) {
+    return false;
+  }
+  const double limit = mConfig.maxCorrectionMs;
+  // Clamping the integral itself keeps a stuck device from winding it up.
+  mIntegralMs = std::clamp(mIntegralMs + mConfig.integralGain * skewMs, -limit, limit);
+  mCorrectionMs = std::clamp(mIntegralMs + mConfig.proportionalGain * skewMs, -limit, limit);
+  mResidualMs = mSamples == 0 ? skewMs : mResidualMs + mConfig.residualWeight * (skewMs - mResidualMs);
+  ++mSamples;
+  return true;
+}
+
+} // namespace margelo::nitro::morse
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+
+namespace margelo::nitro::morse {
+
+// Closed-loop correction for pattern dispatch. Each played symbol feeds the
+// start skew it was measured with (actual tone start minus timeline start,
+// correction already applied); a PI controller turns that into extra tone
+// lead, so a device that is consistently late by a few milliseconds, or one
+// whose lateness creeps up over a long pattern, is pulled back onto the
+// timeline instead of staying off it. The static part of the lead still comes
+// from ChannelLatencyTracker at pattern start; this only trims what is left.
+class DriftCorrector {
+ public:
+  struct Config {
+    double proportionalGain;
+    double integralGain;
+    double maxCorrectionMs;
+    // Samples further off than this are a stall, xrun or resume, not drift.
+    double outlierMs;
+    // EWMA weight of the residual estimate.
+    double residualWeight;
+  };
+
+  static Config defaultConfig();
+
+  explicit DriftCorrector(const Config& config = defaultConfig());
+
+  void reset();
+  // Returns false when the sample was rejected as an outlier.
+  bool update(double skewMs);
+  // Added to the tone lead: positive dispatches earlier.
+  double correctionMs() const { return mCorrectionMs; }
+  // Smoothed skew still left after correction; tends to 0 once converged.
+  double residualMs() const { return mResidualMs; }
+  uint32_t samples() const { return mSamples; }
+
+ private:
+  Config mConfig;
+  double mIntegralMs;
+  double mCorrectionMs;
+  double mResidualMs;
+  uint32_t mSamples;
+};
+
+} // namespace margelo::nitro::morse
@@ -0,0 +1,57 @@
+#include "Fft.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <utility>
+
+namespace margelo::nitro::morse {
+
+namespace {
+constexpr double kTwoPi = 6.283185307179586476925286766559;
+} // namespace
+
+Fft::Fft(std::size_t size) : mSize(1) {
+  while (mSize < size) {
+    mSize <<= 1;
+  }
+  mTwiddles.resize(mSize / 2);
+  for (std::size_t i = 0; i < mSize / 2; ++i) {
+    const double angle = -kTwoPi * static_cast<double>(i) / static_cast<double>(mSize);
+    mTwiddles[i] = std::complex<float>(static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle)));
+  }
+  uint32_t bits = 0;
+  while ((std::size_t{ 1 } << bits) < mSize) {
+    ++bits;
+  }
+  mBitReverse.resize(mSize);
+  for (std::size_t i = 0; i < mSize; ++i) {
+    uint32_t reversed = 0;
+    for (uint32_t bit = 0; bit < bits; ++bit) {
+      reversed |= ((static_cast<uint32_t>(i) >> bit) & 1u) << (bits - 1 - bit);
+    }
+    mBitReverse[i] = reversed;
+  }
+}
+
+void Fft::forward(std::complex<float>* data) const {
+  for (std::size_t i = 0; i < mSize; ++i) {
+    const std::size_t j = mBitReverse[i];
+    if (j > i) {
+      std::swap(data[i], data[j]);
+    }
+  }
+  for (std::size_t length = 2; length <= mSize; length <<= 1) {
+    const std::size_t half = length / 2;
+    const std::size_t stride = mSize / length;
+    for (std::size_t start = 0; start < mSize; start += length) {
+      for (std::size_t k = 0; k < half; ++k) {
+        const std::complex<float> odd = data[start + k + half] * mTwiddles[k * stride];
+        const std::complex<float> even = data[start + k];
+        data[start + k] = even + odd;
+        data[start + k + half] = even - odd;
+      }
+    }
+  }
+}
+
+} // namespace margelo::nitro::morse
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace margelo::nitro::morse {
+
+// In-place iterative radix-2 FFT with precomputed twiddles and bit-reversal
+// table. Immutable after construction, so one instance can be shared by any
+// number of threads as long as each brings its own buffer.
+class Fft {
+ public:
+  explicit Fft(std::size_t size);
+
+  std::size_t size() const { return mSize; }
+  // `data` must hold size() values.
+  void forward(std::complex<float>* data) const;
+
+ private:
+  std::size_t mSize;
+  std::vector<std::complex<float>> mTwiddles;
+  std::vector<uint32_t> mBitReverse;
+};
+
+} // namespace margelo::nitro::morse
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+namespace margelo::nitro::morse {
+
+// Fixed-capacity FIFO over inline storage. Pushing into a full ring drops the
+// oldest entry, so the steady-state playback path never touches the heap.
+// Not thread-safe; callers guard it with their own mutex.
+template <typename T, std::size_t Capacity>
+class FixedRing {
+  static_assert(Capacity > 0, "FixedRing needs at least one slot");
+
+ public:
+  bool empty() const { return mSize == 0; }
+  std::size_t size() const { return mSize; }
+
+  void push(const T& value) {
+    mSlots[(mHead + mSize) % Capacity] = value;
+    if (mSize < Capacity) {
+      ++mSize;
+    } else {
+      mHead = (mHead + 1) % Capacity;
+    }
+  }
+
+  // Index 0 is the oldest entry.
+  T& operator[](std::size_t index) { return mSlots[(mHead + index) % Capacity]; }
+  const T& operator[](std::size_t index) const { return mSlots[(mHead + index) % Capacity]; }
+
+  T popFront() {
+    const T value = mSlots[mHead];
+    mHead = (mHead + 1) % Capacity;
+    --mSize;
+    return value;
+  }
+
+  void clear() {
+    mHead = 0;
+    mSize = 0;
+  }
+
+ private:
+  std::array<T, Capacity> mSlots{};
+  std::size_t mHead = 0;
+  std::size_t mSize = 0;
+};
+
+} // namespace margelo::nitro::morse
@@ -0,0 +1,150 @@
+#include "Haptics.hpp"
+#include "LatencyHistogram.hpp"
+
+#include <android/log.h>
+
+#include <chrono>
+
+namespace margelo::nitro::morse {
+
+namespace {
+constexpr const char* kLogPrefix = "[outputs-haptics]";
+constexpr const char* kTag = "Haptics";
+
+inline double nowMs() {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+NativeHapticEffect effectForImpact(ImpactFeedbackStyle style) {
+  switch (style) {
+    case ImpactFeedbackStyle::LIGHT:
+    case ImpactFeedbackStyle::SOFT:
+      return NativeHapticEffect::Tick;
+    case ImpactFeedbackStyle::MEDIUM:
+    case ImpactFeedbackStyle::RIGID:
+      return NativeHapticEffect::Click;
+    case ImpactFeedbackStyle::HEAVY:
+      return NativeHapticEffect::HeavyClick;
+  }
+  return NativeHapticEffect::Click;
+}
+
+NativeHapticEffect effectForNotification(NotificationFeedbackType type) {
+  switch (type) {
+    case NotificationFeedbackType::SUCCESS:
+      return NativeHapticEffect::Success;
+    case NotificationFeedbackType::WARNING:
+      return NativeHapticEffect::Warning;
+    case NotificationFeedbackType::ERROR:
+      return NativeHapticEffect::Error;
+  }
+  return NativeHapticEffect::Success;
+}
+
+// HapticFeedbackConstants need a View; these are the closest vibrator effects.
+std::optional<NativeHapticEffect> effectForAndroidHaptics(AndroidHaptics type) {
+  switch (type) {
+    case AndroidHaptics::CONFIRM:
+      return NativeHapticEffect::DoubleClick;
+    case AndroidHaptics::REJECT:
+      return NativeHapticEffect::Error;
+    case AndroidHaptics::LONG_PRESS:
+    case AndroidHaptics::DRAG_START:
+      return NativeHapticEffect::HeavyClick;
+    case AndroidHaptics::TOGGLE_ON:
+    case AndroidHaptics::CONTEXT_CLICK:
+    case AndroidHaptics::KEYBOARD_TAP:
+    case AndroidHaptics::KEYBOARD_PRESS:
+    case AndroidHaptics::VIRTUAL_KEY:
+      return NativeHapticEffect::Click;
+    case AndroidHaptics::GESTURE_START:
+    case AndroidHaptics::GESTURE_END:
+    case AndroidHaptics::TOGGLE_OFF:
+    case AndroidHaptics::CLOCK_TICK:
+    case AndroidHaptics::KEYBOARD_RELEASE:
+    case AndroidHaptics::VIRTUAL_KEY_RELEASE:
+    case AndroidHaptics::SEGMENT_TICK:
+    case AndroidHaptics::SEGMENT_FREQUENT_TICK:
+    case AndroidHaptics::TEXT_HANDLE_MOVE:
+      return NativeHapticEffect::Tick;
+    case AndroidHaptics::NO_HAPTICS:
+      return std::nullopt;
+  }
+  return std::nullopt;
+}
+} // namespace
+
+Haptics::Haptics() : margelo::nitro::HybridObject(HybridHapticsSpec::TAG), HybridHapticsSpec(), mSequence(0) {
+  // Runs on the JS thread, which is attached to the JVM; the handful of
+  // createHapticEffect calls are paid here rather than on the first tap.
+  const std::size_t resolved = prepareNativeHapticEffects();
+  mEffectsAvailable = resolved > 0;
+  ActuatorThread::shared().attachListener(this);
+  __android_log_print(ANDROID_LOG_DEBUG, kTag, "%s constructor effects=%zu", kLogPrefix, resolved);
+}
+
+Haptics::~Haptics() {
+  ActuatorThread::shared().detachListener(this);
+}
+
+void Haptics::impact(ImpactFeedbackStyle style) {
+  play(effectForImpact(style));
+}
+
+void Haptics::notification(NotificationFeedbackType type) {
+  play(effectForNotification(type));
+}
+
+void Haptics::selection() {
+  play(NativeHapticEffect::Tick);
+}
+
+void Haptics::performAndroidHaptics(AndroidHaptics type) {
+  play(effectForAndroidHaptics(type));
+}
+
+void Haptics::play(std::optional<NativeHapticEffect> effect) {
+  if (!effect.has_value()) {
+    return;
+  }
+  const double requestedAtMs = nowMs();
+  ActuatorCommand command{};
+  // Devices without VibrationEffect (API < 26) get a plain one-shot instead.
+  if (mEffectsAvailable) {
+    command.type = ActuatorCommandType::HapticEffect;
+    command.value = static_cast<double>(*effect);
+  } else {
+    command.type = ActuatorCommandType::Vibrate;
+    command.value = kFallbackVibrateMs;
+  }
+  command.enabled = true;
+  command.enqueuedAtMs = requestedAtMs;
+  command.dueTimeMs = 0.0;
+  command.targetTimeMs = 0.0;
+  command.sequence = mSequence.fetch_add(1, std::memory_order_relaxed) + 1;
+  command.generation = 0;
+  command.listener = this;
+  ActuatorThread::shared().submit(command);
+}
+
+void Haptics::onActuatorCommandCompleted(const ActuatorCommand& command,
+                                         bool success,
+                                         double /* dispatchedAtMs */,
+                                         double committedAtMs) {
+  if (!success) {
+    __android_log_print(ANDROID_LOG_DEBUG,
+                        kTag,
+                        "%s play.failed sequence=%llu effect=%.0f",
+                        kLogPrefix,
+                        static_cast<unsigned long long>(command.sequence),
+                        command.value);
+    return;
+  }
+  // Measured from the request like the tone's DispatchToCommit, so the queue
+  // hop to the actuator thread is included and the two are comparable.
+  LatencyHistograms::shared().record(OutputChannel::Haptics,
+                                     LatencyMetric::DispatchToCommit,
+                                     committedAtMs - command.enqueuedAtMs);
+}
+
+} // namespace margelo::nitro::morse
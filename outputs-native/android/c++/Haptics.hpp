@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+
+#include "HybridHapticsSpec.hpp"
+#include "ActuatorThread.hpp"
+#include "NativeOutputsBridge.hpp"
+
+namespace margelo::nitro::morse {
+
+// Native implementation of the Haptics HybridObject. Effects are built once
+// (prepareNativeHapticEffects) and played from the actuator thread, so a keyer
+// tap costs the JS thread one lock-free queue push instead of a JNI round trip
+// and a VibrationEffect allocation. Each tap is timed like a tone start:
+// request to vibrate() returning lands in the Haptics DispatchToCommit
+// histogram next to the Tone one.
+class Haptics final : public HybridHapticsSpec, public ActuatorListener {
+ public:
+  Haptics();
+  ~Haptics() override;
+
+  void impact(ImpactFeedbackStyle style) override;
+  void notification(NotificationFeedbackType type) override;
+  void selection() override;
+  void performAndroidHaptics(AndroidHaptics type) override;
+
+  void onActuatorCommandCompleted(const ActuatorCommand& command,
+                                  bool success,
+                                  double dispatchedAtMs,
+                                  double committedAtMs) override;
+
+ private:
+  // Duration of the one-shot used when the effect is missing on this device.
+  static constexpr double kFallbackVibrateMs = 20.0;
+
+  void play(std::optional<NativeHapticEffect> effect);
+
+  bool mEffectsAvailable;
+  std::atomic<uint64_t> mSequence;
+};
+
+} // namespace margelo::nitro::morse
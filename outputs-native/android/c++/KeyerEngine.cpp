@@ -0,0 +1,227 @@
+#include "KeyerEngine.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace margelo::nitro::morse {
+
+namespace {
+constexpr double kDefaultUnitMs = 60.0;
+constexpr double kDefaultWeighting = 0.5;
+constexpr double kDefaultDahRatio = 3.0;
+constexpr double kMinUnitMs = 10.0;
+constexpr double kMaxUnitMs = 1200.0;
+constexpr double kMinWeighting = 0.25;
+constexpr double kMaxWeighting = 0.75;
+constexpr double kMinDahRatio = 2.0;
+constexpr double kMaxDahRatio = 4.5;
+
+inline KeyerPaddle opposite(KeyerPaddle paddle) {
+  return paddle == KeyerPaddle::Dit ? KeyerPaddle::Dah : KeyerPaddle::Dit;
+}
+} // namespace
+
+std::optional<KeyerPaddle> parseKeyerPaddle(const std::string& name) {
+  if (name == "dit" || name == "dot") {
+    return KeyerPaddle::Dit;
+  }
+  if (name == "dah" || name == "dash") {
+    return KeyerPaddle::Dah;
+  }
+  return std::nullopt;
+}
+
+std::optional<KeyerMode> parseKeyerMode(const std::string& name) {
+  if (name == "iambicA" || name == "A") {
+    return KeyerMode::IambicA;
+  }
+  if (name == "iambicB" || name == "B") {
+    return KeyerMode::IambicB;
+  }
+  return std::nullopt;
+}
+
+KeyerEngine::KeyerEngine()
+    : mEnabled(false),
+      mResetRequested(false),
+      mUnitMs(kDefaultUnitMs),
+      mWeighting(kDefaultWeighting),
+      mDahRatio(kDefaultDahRatio),
+      mMode(KeyerMode::IambicB),
+      mConfigVersion(1),
+      mSampleRate(48000.0),
+      mAppliedConfigVersion(0),
+      mDitMarkFrames(0),
+      mDahMarkFrames(0),
+      mSpaceFrames(0),
+      mState(State::Idle),
+      mElement(KeyerPaddle::Dit),
+      mFramesRemaining(0),
+      mDitDown(false),
+      mDahDown(false),
+      mDitMemory(false),
+      mDahMemory(false),
+      mSqueezed(false) {}
+
+void KeyerEngine::configure(const Config& config) {
+  mUnitMs.store(std::clamp(config.unitMs, kMinUnitMs, kMaxUnitMs), std::memory_order_relaxed);
+  mWeighting.store(std::clamp(config.weighting, kMinWeighting, kMaxWeighting), std::memory_order_relaxed);
+  mDahRatio.store(std::clamp(config.dahRatio, kMinDahRatio, kMaxDahRatio), std::memory_order_relaxed);
+  mMode.store(config.mode, std::memory_order_relaxed);
+  mConfigVersion.fetch_add(1, std::memory_order_release);
+}
+
+void KeyerEngine::setEnabled(bool enabled) {
+  if (!enabled) {
+    mResetRequested.store(true, std::memory_order_release);
+  }
+  mEnabled.store(enabled, std::memory_order_release);
+}
+
+bool KeyerEngine::postPaddle(KeyerPaddle paddle, bool down) {
+  return mEvents.tryPush(PaddleEvent{ paddle, down });
+}
+
+void KeyerEngine::setSampleRate(double sampleRate) {
+  if (sampleRate > 0.0 && sampleRate != mSampleRate) {
+    mSampleRate = sampleRate;
+    mAppliedConfigVersion = 0;
+  }
+}
+
+void KeyerEngine::recomputeFrames() {
+  const double unitFrames = mUnitMs.load(std::memory_order_relaxed) * mSampleRate / 1000.0;
+  // Weighting moves time from the space into the mark (or back) so the overall
+  // element rhythm, and therefore the WPM, stays unchanged.
+  const double weightUnits = 2.0 * mWeighting.load(std::memory_order_relaxed) - 1.0;
+  const double dahRatio = mDahRatio.load(std::memory_order_relaxed);
+  mDitMarkFrames = std::max<int64_t>(1, std::llround(unitFrames * (1.0 + weightUnits)));
+  mDahMarkFrames = std::max<int64_t>(1, std::llround(unitFrames * (dahRatio + weightUnits)));
+  mSpaceFrames = std::max<int64_t>(1, std::llround(unitFrames * (1.0 - weightUnits)));
+}
+
+void KeyerEngine::resetState() {
+  PaddleEvent discarded{};
+  while (mEvents.tryPop(discarded)) {
+  }
+  mState = State::Idle;
+  mLastElement.reset();
+  mFramesRemaining = 0;
+  mDitDown = false;
+  mDahDown = false;
+  mDitMemory = false;
+  mDahMemory = false;
+  mSqueezed = false;
+}
+
+void KeyerEngine::beginBlock() {
+  if (mResetRequested.exchange(false, std::memory_order_acq_rel)) {
+    resetState();
+  }
+  const uint32_t version = mConfigVersion.load(std::memory_order_acquire);
+  if (version != mAppliedConfigVersion) {
+    mAppliedConfigVersion = version;
+    recomputeFrames();
+  }
+  PaddleEvent event{};
+  while (mEvents.tryPop(event)) {
+    applyEvent(event);
+  }
+}
+
+void KeyerEngine::applyEvent(const PaddleEvent& event) {
+  if (event.paddle == KeyerPaddle::Dit) {
+    mDitDown = event.down;
+  } else {
+    mDahDown = event.down;
+  }
+  if (!event.down || mState == State::Idle) {
+    return;
+  }
+  // Element memory: a press of the opposite paddle during an element, or of
+  // either paddle during the inter-element space, is remembered even if the
+  // paddle is released again before the current element finishes.
+  if (event.paddle != mElement || mState == State::Space) {
+    if (event.paddle == KeyerPaddle::Dit) {
+      mDitMemory = true;
+    } else {
+      mDahMemory = true;
+    }
+  }
+  if (mDitDown && mDahDown) {
+    mSqueezed = true;
+  }
+}
+
+void KeyerEngine::startElement(KeyerPaddle element) {
+  mElement = element;
+  mLastElement = element;
+  mState = State::Mark;
+  mFramesRemaining = element == KeyerPaddle::Dit ? mDitMarkFrames : mDahMarkFrames;
+  if (element == KeyerPaddle::Dit) {
+    mDitMemory = false;
+  } else {
+    mDahMemory = false;
+  }
+  mSqueezed = mDitDown && mDahDown;
+}
+
+bool KeyerEngine::startNextElement() {
+  const KeyerPaddle alternate = mLastElement.has_value() ? opposite(*mLastElement) : KeyerPaddle::Dit;
+  const bool alternateMemory = alternate == KeyerPaddle::Dit ? mDitMemory : mDahMemory;
+  const bool repeatMemory = alternate == KeyerPaddle::Dit ? mDahMemory : mDitMemory;
+
+  if (mDitDown && mDahDown) {
+    startElement(alternate);
+  } else if (alternateMemory) {
+    startElement(alternate);
+  } else if (repeatMemory) {
+    startElement(opposite(alternate));
+  } else if (mDitDown) {
+    startElement(KeyerPaddle::Dit);
+  } else if (mDahDown) {
+    startElement(KeyerPaddle::Dah);
+  } else if (mSqueezed && mMode.load(std::memory_order_relaxed) == KeyerMode::IambicB) {
+    // Mode B: releasing a squeeze still completes one more alternating element.
+    startElement(alternate);
+    mSqueezed = false;
+  } else {
+    mState = State::Idle;
+    mLastElement.reset();
+    mSqueezed = false;
+    return false;
+  }
+  return true;
+}
+
+bool KeyerEngine::nextFrame() {
+  switch (mState) {
+    case State::Idle:
+      if (!mDitDown && !mDahDown) {
+        return false;
+      }
+      startNextElement();
+      break;
+    case State::Mark:
+      if (mDitDown && mDahDown) {
+        mSqueezed = true;
+      }
+      if (mFramesRemaining <= 0) {
+        mState = State::Space;
+        mFramesRemaining = mSpaceFrames;
+      }
+      break;
+    case State::Space:
+      if (mFramesRemaining <= 0 && !startNextElement()) {
+        return false;
+      }
+      break;
+  }
+  if (mState == State::Idle) {
+    return false;
+  }
+  --mFramesRemaining;
+  return mState == State::Mark;
+}
+
+} // namespace margelo::nitro::morse
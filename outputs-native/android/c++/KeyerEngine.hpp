@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "LockFreeQueue.hpp"
+
+namespace margelo::nitro::morse {
+
+enum class KeyerPaddle : uint8_t {
+  Dit,
+  Dah,
+};
+
+enum class KeyerMode : uint8_t {
+  IambicA,
+  IambicB,
+};
+
+std::optional<KeyerPaddle> parseKeyerPaddle(const std::string& name);
+std::optional<KeyerMode> parseKeyerMode(const std::string& name);
+
+// Iambic keyer state machine clocked by the audio callback. Paddle edges are
+// posted from any thread through a lock-free queue; every element length is
+// counted in output frames, so the sidetone is element-perfect regardless of
+// how late the JS thread delivered the edge that started it.
+class KeyerEngine {
+ public:
+  struct Config {
+    double unitMs;
+    KeyerMode mode;
+    // Fraction of a dit+space occupied by the mark; 0.5 is standard.
+    double weighting;
+    // Dah length in units (3.0 is standard).
+    double dahRatio;
+  };
+
+  KeyerEngine();
+
+  // Producer side (JS thread).
+  void configure(const Config& config);
+  void setEnabled(bool enabled);
+  bool postPaddle(KeyerPaddle paddle, bool down);
+  bool isEnabled() const { return mEnabled.load(std::memory_order_acquire); }
+
+  // Audio thread only.
+  void setSampleRate(double sampleRate);
+  void beginBlock();
+  bool nextFrame();
+
+ private:
+  enum class State : uint8_t {
+    Idle,
+    Mark,
+    Space,
+  };
+
+  struct PaddleEvent {
+    KeyerPaddle paddle;
+    bool down;
+  };
+
+  void applyEvent(const PaddleEvent& event);
+  bool startNextElement();
+  void startElement(KeyerPaddle element);
+  void resetState();
+  void recomputeFrames();
+
+  static constexpr std::size_t kEventCapacity = 64;
+
+  LockFreeQueue<PaddleEvent, kEventCapacity> mEvents;
+  std::atomic<bool> mEnabled;
+  std::atomic<bool> mResetRequested;
+  std::atomic<double> mUnitMs;
+  std::atomic<double> mWeighting;
+  std::atomic<double> mDahRatio;
+  std::atomic<KeyerMode> mMode;
+  std::atomic<uint32_t> mConfigVersion;
+
+  // Audio-thread state.
+  double mSampleRate;
+  uint32_t mAppliedConfigVersion;
+  int64_t mDitMarkFrames;
+  int64_t mDahMarkFrames;
+  int64_t mSpaceFrames;
+  State mState;
+  KeyerPaddle mElement;
+  std::optional<KeyerPaddle> mLastElement;
+  int64_t mFramesRemaining;
+  bool mDitDown;
+  bool mDahDown;
+  bool mDitMemory;
+  bool mDahMemory;
+  bool mSqueezed;
+};
+
+} // namespace margelo::nitro::morse
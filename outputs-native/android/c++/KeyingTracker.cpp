@@ -0,0 +1,103 @@
+#include "KeyingTracker.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace margelo::nitro::morse {
+
+namespace {
+constexpr double kMinLevel = 1e-7;
+// Noise floor is an asymmetric average of unkeyed blocks: it settles near the
+// middle of the noise distribution rather than on its minima, and is frozen
+// while keyed so a long mark cannot drag it up to the tone level.
+constexpr double kNoiseFallRate = 0.1;
+constexpr double kNoiseRiseRate = 0.03;
+// Signal peak follows marks quickly and decays towards the floor between them.
+constexpr double kSignalAttackRate = 0.5;
+constexpr double kSignalDecayRate = 0.002;
+// Below this peak/noise ratio (~10 dB) there is nothing worth keying on.
+constexpr double kMinKeyingSnr = 3.2;
+// Threshold sits at this fraction of the log distance from noise to peak.
+constexpr double kKeyDownFraction = 0.5;
+constexpr double kKeyUpFraction = 0.35;
+constexpr uint32_t kWarmupBlocks = 8;
+} // namespace
+
+KeyingTracker::KeyingTracker()
+    : mNoiseLevel(kMinLevel),
+      mSignalLevel(kMinLevel),
+      mKeyed(false),
+      mPendingBlocks(0),
+      mWarmupBlocks(kWarmupBlocks) {}
+
+void KeyingTracker::reset() {
+  mNoiseLevel = kMinLevel;
+  mSignalLevel = kMinLevel;
+  mKeyed = false;
+  mPendingBlocks = 0;
+  mWarmupBlocks = kWarmupBlocks;
+}
+
+void KeyingTracker::seed(double noiseLevel, double signalLevel) {
+  mNoiseLevel = std::max(noiseLevel, kMinLevel);
+  mSignalLevel = std::max(signalLevel, mNoiseLevel);
+  mKeyed = false;
+  mPendingBlocks = 0;
+  mWarmupBlocks = 0;
+}
+
+bool KeyingTracker::update(double level) {
+  level = std::max(level, kMinLevel);
+  if (mWarmupBlocks > 0) {
+    // Seed both trackers from the first blocks instead of from silence.
+    --mWarmupBlocks;
+    mNoiseLevel = mWarmupBlocks + 1 == kWarmupBlocks ? level : std::min(mNoiseLevel, level);
+    mSignalLevel = std::max(mSignalLevel, level);
+    return false;
+  }
+
+  if (level < mNoiseLevel) {
+    mNoiseLevel += (level - mNoiseLevel) * kNoiseFallRate;
+  } else if (!mKeyed && mPendingBlocks == 0) {
+    mNoiseLevel += (level - mNoiseLevel) * kNoiseRiseRate;
+  }
+  if (level > mSignalLevel) {
+    mSignalLevel += (level - mSignalLevel) * kSignalAttackRate;
+  } else {
+    mSignalLevel += (level - mSignalLevel) * kSignalDecayRate;
+  }
+  mSignalLevel = std::max(mSignalLevel, mNoiseLevel);
+
+  const double ratio = mSignalLevel / mNoiseLevel;
+  bool wantKeyed = mKeyed;
+  if (ratio < kMinKeyingSnr) {
+    wantKeyed = false;
+  } else {
+    const double logNoise = std::log(mNoiseLevel);
+    const double logSpan = std::log(ratio);
+    const double logLevel = std::log(level);
+    if (!mKeyed) {
+      wantKeyed = logLevel >= logNoise + logSpan * kKeyDownFraction;
+    } else {
+      wantKeyed = logLevel >= logNoise + logSpan * kKeyUpFraction;
+    }
+  }
+
+  if (wantKeyed == mKeyed) {
+    mPendingBlocks = 0;
+    return false;
+  }
+  if (++mPendingBlocks < kDebounceBlocks) {
+    return false;
+  }
+  mPendingBlocks = 0;
+  mKeyed = wantKeyed;
+  return true;
+}
+
+KeyingTracker::Summary KeyingTracker::summarize() const {
+  const double snr = mSignalLevel / std::max(mNoiseLevel, kMinLevel);
+  return Summary{ mNoiseLevel, mSignalLevel, 20.0 * std::log10(std::max(snr, 1.0)), mKeyed };
+}
+
+} // namespace margelo::nitro::morse
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+
+namespace margelo::nitro::morse {
+
+// Turns a stream of per-block tone magnitudes into keyed/unkeyed state. A
+// fast-falling noise floor and a fast-attack/slow-decay signal peak set a
+// log-domain threshold with hysteresis, so keying is recovered without a fixed
+// input gain. Shared by the single-tone ToneDetector and the per-channel
+// decoders of CwChannelizer.
+class KeyingTracker {
+ public:
+  struct Summary {
+    double noiseLevel;
+    double signalLevel;
+    double snrDb;
+    bool keyed;
+  };
+
+  // A state change must hold for this many consecutive blocks; callers
+  // back-date the reported edge to the first of them.
+  static constexpr uint32_t kDebounceBlocks = 2;
+
+  KeyingTracker();
+
+  void reset();
+  // Skips warm-up by starting from levels measured elsewhere (e.g. the
+  // channelizer's per-bin floor when a new carrier appears).
+  void seed(double noiseLevel, double signalLevel);
+  // Returns true when the keyed state flipped on this block.
+  bool update(double level);
+  bool keyed() const { return mKeyed; }
+  double noiseLevel() const { return mNoiseLevel; }
+  Summary summarize() const;
+
+ private:
+  double mNoiseLevel;
+  double mSignalLevel;
+  bool mKeyed;
+  uint32_t mPendingBlocks;
+  uint32_t mWarmupBlocks;
+};
+
+} // namespace margelo::nitro::morse
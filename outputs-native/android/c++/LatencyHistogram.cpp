@@ -0,0 +1,212 @@
+#include "LatencyHistogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+namespace margelo::nitro::morse {
+
+namespace {
+// Outside this range the sample is a stalled thread or a clock glitch.
+constexpr double kMaxMagnitudeMs = 600000.0;
+
+int floorLog2(uint64_t value) {
+  int exponent = 0;
+  while (value >>= 1) {
+    ++exponent;
+  }
+  return exponent;
+}
+} // namespace
+
+const char* latencyMetricName(LatencyMetric metric) {
+  switch (metric) {
+    case LatencyMetric::StartSkew:
+      return "startSkew";
+    case LatencyMetric::DispatchToCommit:
+      return "dispatchToCommit";
+    case LatencyMetric::CallbackToPresentation:
+      return "callbackToPresentation";
+    case LatencyMetric::DriftResidual:
+      return "driftResidual";
+  }
+  return "unknown";
+}
+
+LatencyHistogram::LatencyHistogram() {
+  reset();
+}
+
+std::size_t LatencyHistogram::bucketIndex(uint64_t magnitudeUs) {
+  if (magnitudeUs < kSubBuckets) {
+    return static_cast<std::size_t>(magnitudeUs);
+  }
+  const auto exponent = static_cast<uint32_t>(floorLog2(magnitudeUs));
+  if (exponent > kMaxExponent) {
+    return kBucketCount - 1;
+  }
+  const uint32_t shift = exponent - kSubBucketBits;
+  const auto subBucket = static_cast<std::size_t>((magnitudeUs >> shift) & (kSubBuckets - 1));
+  return static_cast<std::size_t>(shift + 1) * kSubBuckets + subBucket;
+}
+
+double LatencyHistogram::bucketMidpointUs(std::size_t index) {
+  if (index < kSubBuckets) {
+    return static_cast<double>(index);
+  }
+  const std::size_t shift = index / kSubBuckets - 1;
+  const std::size_t subBucket = index % kSubBuckets;
+  const double lower = static_cast<double>((kSubBuckets + subBucket) << shift);
+  return lower + static_cast<double>(std::size_t{ 1 } << shift) * 0.5;
+}
+
+void LatencyHistogram::record(double valueMs) {
+  if (!std::isfinite(valueMs) || std::abs(valueMs) > kMaxMagnitudeMs) {
+    return;
+  }
+  const auto valueUs = static_cast<int64_t>(std::llround(valueMs * 1000.0));
+  const uint64_t magnitude = static_cast<uint64_t>(valueUs < 0 ? -valueUs : valueUs);
+  auto& buckets = valueUs < 0 ? mNegative : mPositive;
+  buckets[bucketIndex(magnitude)].fetch_add(1, std::memory_order_relaxed);
+
+  mSumUs.fetch_add(valueUs, std::memory_order_relaxed);
+  double squares = mSumSquaresMs.load(std::memory_order_relaxed);
+  while (!mSumSquaresMs.compare_exchange_weak(squares, squares + valueMs * valueMs, std::memory_order_relaxed)) {
+  }
+  int64_t current = mMinUs.load(std::memory_order_relaxed);
+  while (valueUs < current && !mMinUs.compare_exchange_weak(current, valueUs, std::memory_order_relaxed)) {
+  }
+  current = mMaxUs.load(std::memory_order_relaxed);
+  while (valueUs > current && !mMaxUs.compare_exchange_weak(current, valueUs, std::memory_order_relaxed)) {
+  }
+}
+
+void LatencyHistogram::reset() {
+  for (std::size_t i = 0; i < kBucketCount; ++i) {
+    mPositive[i].store(0, std::memory_order_relaxed);
+    mNegative[i].store(0, std::memory_order_relaxed);
+  }
+  mMinUs.store(std::numeric_limits<int64_t>::max(), std::memory_order_relaxed);
+  mMaxUs.store(std::numeric_limits<int64_t>::min(), std::memory_order_relaxed);
+  mSumUs.store(0, std::memory_order_relaxed);
+  mSumSquaresMs.store(0.0, std::memory_order_relaxed);
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+  Snapshot snapshot{};
+  std::array<uint32_t, kBucketCount> positive{};
+  std::array<uint32_t, kBucketCount> negative{};
+  uint64_t total = 0;
+  for (std::size_t i = 0; i < kBucketCount; ++i) {
+    positive[i] = mPositive[i].load(std::memory_order_relaxed);
+    negative[i] = mNegative[i].load(std::memory_order_relaxed);
+    total += positive[i] + negative[i];
+  }
+  if (total == 0) {
+    return snapshot;
+  }
+  snapshot.count = total;
+  snapshot.minMs = static_cast<double>(mMinUs.load(std::memory_order_relaxed)) / 1000.0;
+  snapshot.maxMs = static_cast<double>(mMaxUs.load(std::memory_order_relaxed)) / 1000.0;
+  const double count = static_cast<double>(total);
+  snapshot.meanMs = static_cast<double>(mSumUs.load(std::memory_order_relaxed)) / 1000.0 / count;
+  const double meanSquare = mSumSquaresMs.load(std::memory_order_relaxed) / count;
+  snapshot.stddevMs = std::sqrt(std::max(0.0, meanSquare - snapshot.meanMs * snapshot.meanMs));
+
+  // Walk from the most negative bucket up; each percentile reports the
+  // midpoint of the bucket holding its rank, clamped to the exact extremes.
+  constexpr double kQuantiles[] = { 0.5, 0.9, 0.95, 0.99, 0.999 };
+  double* outputs[] = { &snapshot.p50Ms, &snapshot.p90Ms, &snapshot.p95Ms, &snapshot.p99Ms, &snapshot.p999Ms };
+  std::size_t next = 0;
+  uint64_t seen = 0;
+  const auto visit = [&](uint32_t bucketCount, double valueUs) {
+    seen += bucketCount;
+    while (next < std::size(kQuantiles) &&
+           static_cast<double>(seen) >= std::ceil(kQuantiles[next] * count)) {
+      *outputs[next] = std::clamp(valueUs / 1000.0, snapshot.minMs, snapshot.maxMs);
+      ++next;
+    }
+  };
+  for (std::size_t i = kBucketCount; i-- > 0;) {
+    if (negative[i] > 0) {
+      visit(negative[i], -bucketMidpointUs(i));
+    }
+  }
+  for (std::size_t i = 0; i < kBucketCount; ++i) {
+    if (positive[i] > 0) {
+      visit(positive[i], bucketMidpointUs(i));
+    }
+  }
+  return snapshot;
+}
+
+LatencyHistograms& LatencyHistograms::shared() {
+  static LatencyHistograms* instance = new LatencyHistograms();
+  return *instance;
+}
+
+void LatencyHistograms::record(OutputChannel channel, LatencyMetric metric, double valueMs) {
+  mHistograms[static_cast<std::size_t>(channel)][static_cast<std::size_t>(metric)].record(valueMs);
+}
+
+void LatencyHistograms::reset() {
+  for (auto& channel : mHistograms) {
+    for (auto& histogram : channel) {
+      histogram.reset();
+    }
+  }
+}
+
+LatencyHistogram::Snapshot LatencyHistograms::snapshot(OutputChannel channel, LatencyMetric metric) const {
+  return mHistograms[static_cast<std::size_t>(channel)][static_cast<std::size_t>(metric)].snapshot();
+}
+
+void writeSnapshotJson(std::ostream& stream, const LatencyHistogram::Snapshot& snapshot) {
+  stream << "{\"count\":" << snapshot.count
+         << ",\"minMs\":" << snapshot.minMs
+         << ",\"maxMs\":" << snapshot.maxMs
+         << ",\"meanMs\":" << snapshot.meanMs
+         << ",\"stddevMs\":" << snapshot.stddevMs
+         << ",\"p50Ms\":" << snapshot.p50Ms
+         << ",\"p90Ms\":" << snapshot.p90Ms
+         << ",\"p95Ms\":" << snapshot.p95Ms
+         << ",\"p99Ms\":" << snapshot.p99Ms
+         << ",\"p999Ms\":" << snapshot.p999Ms
+         << "}";
+}
+
+std::string LatencyHistograms::toJson() const {
+  std::ostringstream stream;
+  stream.setf(std::ios::fixed, std::ios::floatfield);
+  stream << std::setprecision(3) << "{";
+  bool firstChannel = true;
+  for (std::size_t c = 0; c < kOutputChannelCount; ++c) {
+    const auto channel = static_cast<OutputChannel>(c);
+    bool firstMetric = true;
+    for (std::size_t m = 0; m < kLatencyMetricCount; ++m) {
+      const auto metric = static_cast<LatencyMetric>(m);
+      const LatencyHistogram::Snapshot snapshot = this->snapshot(channel, metric);
+      if (snapshot.count == 0) {
+        continue;
+      }
+      if (firstMetric) {
+        stream << (firstChannel ? "" : ",") << "\"" << outputChannelName(channel) << "\":{";
+        firstChannel = false;
+        firstMetric = false;
+      } else {
+        stream << ",";
+      }
+      stream << "\"" << latencyMetricName(metric) << "\":";
+      writeSnapshotJson(stream, snapshot);
+    }
+    if (!firstMetric) {
+      stream << "}";
+    }
+  }
+  stream << "}";
+  return stream.str();
+}
+
+} // namespace margelo::nitro::morse
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#include "ChannelLatencyTracker.hpp"
+
+namespace margelo::nitro::morse {
+
+enum class LatencyMetric : uint8_t {
+  // Observed output start minus the timeline's expected start (signed).
+  StartSkew = 0,
+  // Dispatch (tone request / JNI call) to the moment the output committed.
+  DispatchToCommit,
+  // Audio callback to the frames reaching the DAC, from the stream timestamp.
+  CallbackToPresentation,
+  // Pattern start skew the drift corrector has not removed yet (smoothed,
+  // one sample per played symbol).
+  DriftResidual,
+};
+
+constexpr std::size_t kLatencyMetricCount = 4;
+
+const char* latencyMetricName(LatencyMetric metric);
+
+// Fixed-memory log-linear histogram (HDR style). Values are kept in signed
+// microseconds: 16 linear sub-buckets per power of two bound the relative
+// error to ~3% from 16 us up to ~18 minutes, and min/max are exact. record()
+// is a handful of relaxed atomic ops, so it is safe on the audio callback and
+// from any number of threads.
+class LatencyHistogram {
+ public:
+  struct Snapshot {
+    uint64_t count;
+    double minMs;
+    double maxMs;
+    double meanMs;
+    double stddevMs;
+    double p50Ms;
+    double p90Ms;
+    double p95Ms;
+    double p99Ms;
+    double p999Ms;
+  };
+
+  LatencyHistogram();
+
+  void record(double valueMs);
+  void reset();
+  Snapshot snapshot() const;
+
+ private:
+  static constexpr uint32_t kSubBucketBits = 4;
+  static constexpr uint32_t kSubBuckets = 1u << kSubBucketBits;
+  static constexpr uint32_t kMaxExponent = 30;
+  static constexpr std::size_t kBucketCount = (kMaxExponent - kSubBucketBits + 2) * kSubBuckets;
+
+  static std::size_t bucketIndex(uint64_t magnitudeUs);
+  static double bucketMidpointUs(std::size_t index);
+
+  std::array<std::atomic<uint32_t>, kBucketCount> mPositive;
+  std::array<std::atomic<uint32_t>, kBucketCount> mNegative;
+  std::atomic<int64_t> mMinUs;
+  std::atomic<int64_t> mMaxUs;
+  std::atomic<int64_t> mSumUs;
+  std::atomic<double> mSumSquaresMs;
+};
+
+// Writes a snapshot as a JSON object ({"count":..,"minMs":..,...}); the
+// stream's number formatting is left to the caller.
+void writeSnapshotJson(std::ostream& stream, const LatencyHistogram::Snapshot& snapshot);
+
+// Process-wide grid of histograms, one per output channel and metric.
+class LatencyHistograms {
+ public:
+  static LatencyHistograms& shared();
+
+  void record(OutputChannel channel, LatencyMetric metric, double valueMs);
+  void reset();
+  LatencyHistogram::Snapshot snapshot(OutputChannel channel, LatencyMetric metric) const;
+  // Only metrics with samples are included.
+  std::string toJson() const;
+
+ private:
+  LatencyHistograms() = default;
+
+  std::array<std::array<LatencyHistogram, kLatencyMetricCount>, kOutputChannelCount> mHistograms;
+};
+
+} // namespace margelo::nitro::morse
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace margelo::nitro::morse {
+
+// Bounded multi-producer/multi-consumer ring (Vyukov). Every slot carries a
+// sequence counter so producers and consumers claim slots with a single CAS and
+// never take a lock; a full queue rejects the push instead of blocking.
+template <typename T, std::size_t Capacity>
+class LockFreeQueue {
+  static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                "LockFreeQueue capacity must be a power of two");
+  static_assert(std::is_trivially_copyable_v<T>,
+                "LockFreeQueue only carries trivially copyable payloads");
+
+ public:
+  LockFreeQueue() : mEnqueuePos(0), mDequeuePos(0) {
+    for (std::size_t i = 0; i < Capacity; ++i) {
+      mSlots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  LockFreeQueue(const LockFreeQueue&) = delete;
+  LockFreeQueue& operator=(const LockFreeQueue&) = delete;
+
+  bool tryPush(const T& value) {
+    std::size_t position = mEnqueuePos.load(std::memory_order_relaxed);
+    Slot* slot = nullptr;
+    for (;;) {
+      slot = &mSlots[position & kMask];
+      const std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+      if (diff == 0) {
+        if (mEnqueuePos.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        position = mEnqueuePos.load(std::memory_order_relaxed);
+      }
+    }
+    slot->value = value;
+    slot->sequence.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool tryPop(T& out) {
+    std::size_t position = mDequeuePos.load(std::memory_order_relaxed);
+    Slot* slot = nullptr;
+    for (;;) {
+      slot = &mSlots[position & kMask];
+      const std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+      const auto diff =
+          static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+      if (diff == 0) {
+        if (mDequeuePos.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        position = mDequeuePos.load(std::memory_order_relaxed);
+      }
+    }
+    out = slot->value;
+    slot->sequence.store(position + kMask + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool empty() const {
+    return mEnqueuePos.load(std::memory_order_acquire) == mDequeuePos.load(std::memory_order_acquire);
+  }
+
+  static constexpr std::size_t capacity() { return Capacity; }
+
+ private:
+  static constexpr std::size_t kMask = Capacity - 1;
+  static constexpr std::size_t kCacheLine = 64;
+
+  struct Slot {
+    std::atomic<std::size_t> sequence;
+    T value;
+  };
+
+  std::array<Slot, Capacity> mSlots;
+  alignas(kCacheLine) std::atomic<std::size_t> mEnqueuePos;
+  alignas(kCacheLine) std::atomic<std::size_t> mDequeuePos;
+};
+
+} // namespace margelo::nitro::morse
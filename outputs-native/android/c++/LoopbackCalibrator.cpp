@@ -0,0 +1,280 @@
+#include "LoopbackCalibrator.hpp"
+
+#include "Fft.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+
+namespace margelo::nitro::morse {
+
+namespace {
+constexpr double kTwoPi = 6.283185307179586476925286766559;
+// Raised-cosine taper on each end of the chirp, as a fraction of its length;
+// keeps the probe from clicking and its correlation sidelobes down.
+constexpr double kTaperFraction = 0.1;
+// Arrivals may precede the reported presentation by this much.
+constexpr double kEarlyWindowMs = 50.0;
+// The first envelope point this close to the window's peak is the direct
+// path; a stronger reflection further on must not win.
+constexpr double kDirectPathFraction = 0.5;
+constexpr double kCaptureSlackMs = 1000.0;
+constexpr double kInputLatencyWeight = 0.1;
+
+double median(std::vector<double> values) {
+  const std::size_t middle = values.size() / 2;
+  std::nth_element(values.begin(), values.begin() + middle, values.end());
+  if (values.size() % 2 == 1) {
+    return values[middle];
+  }
+  const double upper = values[middle];
+  const double lower = *std::max_element(values.begin(), values.begin() + middle);
+  return 0.5 * (lower + upper);
+}
+} // namespace
+
+LoopbackCalibrator::Config LoopbackCalibrator::defaultConfig(double sampleRate) {
+  Config config{};
+  config.sampleRate = sampleRate;
+  config.probeCount = 8;
+  config.leadInMs = 300.0;
+  config.probeIntervalMs = 500.0;
+  config.chirpMs = 20.0;
+  config.chirpStartHz = 1500.0;
+  config.chirpEndHz = 6000.0;
+  config.gain = 0.5f;
+  config.maxLatencyMs = 400.0;
+  config.minPeakRatio = 5.0;
+  return config;
+}
+
+void LoopbackCalibrator::configure(const Config& config) {
+  mConfig = config;
+  const double sampleRate = std::max(config.sampleRate, 1.0);
+  const std::size_t probeFrames = std::max<std::size_t>(
+      1, static_cast<std::size_t>(std::llround(config.chirpMs * sampleRate / 1000.0)));
+  mProbe.assign(probeFrames, 0.0f);
+  const double durationS = static_cast<double>(probeFrames) / sampleRate;
+  const double sweepHzPerS = (config.chirpEndHz - config.chirpStartHz) / durationS;
+  const std::size_t taperFrames = std::max<std::size_t>(
+      1, static_cast<std::size_t>(static_cast<double>(probeFrames) * kTaperFraction));
+  for (std::size_t i = 0; i < probeFrames; ++i) {
+    const double t = static_cast<double>(i) / sampleRate;
+    const double phase = kTwoPi * (config.chirpStartHz * t + 0.5 * sweepHzPerS * t * t);
+    double window = 1.0;
+    const std::size_t edge = std::min(i, probeFrames - 1 - i);
+    if (edge < taperFrames) {
+      window = 0.5 - 0.5 * std::cos(0.5 * kTwoPi * static_cast<double>(edge) / static_cast<double>(taperFrames));
+    }
+    mProbe[i] = static_cast<float>(config.gain * window * std::sin(phase));
+  }
+
+  mLeadInFrames = std::llround(config.leadInMs * sampleRate / 1000.0);
+  mIntervalFrames = std::max<int64_t>(static_cast<int64_t>(probeFrames),
+                                      std::llround(config.probeIntervalMs * sampleRate / 1000.0));
+  mOutputFrames = 0;
+  mEmitPresentationMs.assign(config.probeCount, 0.0);
+  mEmitRenderMs.assign(config.probeCount, 0.0);
+  mEmitted.store(0, std::memory_order_release);
+
+  const double captureMs = config.leadInMs + config.probeIntervalMs * config.probeCount + config.maxLatencyMs +
+                           kCaptureSlackMs;
+  mCapture.assign(static_cast<std::size_t>(captureMs * sampleRate / 1000.0), 0.0f);
+  mCaptured.store(0, std::memory_order_release);
+  mCaptureOriginMs.store(0.0, std::memory_order_relaxed);
+  mInputLatencyMs = 0.0;
+  mInputBlocks = 0;
+  mInputTimestamped = false;
+  mCaptureFull.store(false, std::memory_order_release);
+}
+
+void LoopbackCalibrator::renderOutput(float* mix, int32_t frames, double presentationMs, double renderMs) {
+  const double frameMs = 1000.0 / mConfig.sampleRate;
+  const int64_t blockStart = mOutputFrames;
+  const int64_t blockEnd = blockStart + frames;
+  const int64_t probeFrames = static_cast<int64_t>(mProbe.size());
+  mOutputFrames = blockEnd;
+  const int64_t sinceLeadIn = blockStart - mLeadInFrames - probeFrames;
+  const uint32_t firstProbe = sinceLeadIn > 0 ? static_cast<uint32_t>(sinceLeadIn / mIntervalFrames) : 0;
+  for (uint32_t k = firstProbe; k < mConfig.probeCount; ++k) {
+    const int64_t probeStart = mLeadInFrames + static_cast<int64_t>(k) * mIntervalFrames;
+    if (probeStart >= blockEnd) {
+      break;
+    }
+    if (probeStart + probeFrames <= blockStart) {
+      continue;
+    }
+    if (probeStart >= blockStart) {
+      const double offsetMs = static_cast<double>(probeStart - blockStart) * frameMs;
+      mEmitPresentationMs[k] = presentationMs + offsetMs;
+      mEmitRenderMs[k] = renderMs + offsetMs;
+      mEmitted.store(k + 1, std::memory_order_release);
+    }
+    const int64_t from = std::max(blockStart, probeStart);
+    const int64_t to = std::min(blockEnd, probeStart + probeFrames);
+    for (int64_t frame = from; frame < to; ++frame) {
+      mix[frame - blockStart] += mProbe[static_cast<std::size_t>(frame - probeStart)];
+    }
+  }
+}
+
+bool LoopbackCalibrator::outputDone() const {
+  return mEmitted.load(std::memory_order_acquire) >= mConfig.probeCount;
+}
+
+void LoopbackCalibrator::captureInput(const float* input,
+                                      int32_t frames,
+                                      int32_t channels,
+                                      double captureMs,
+                                      double deliveredMs,
+                                      bool timestamped) {
+  const std::size_t captured = mCaptured.load(std::memory_order_relaxed);
+  const double frameMs = 1000.0 / mConfig.sampleRate;
+  // The first timestamped block anchors the whole capture; estimated times
+  // are only used until one arrives.
+  if (captured == 0 || (timestamped && !mInputTimestamped)) {
+    mCaptureOriginMs.store(captureMs - static_cast<double>(captured) * frameMs, std::memory_order_relaxed);
+    mInputTimestamped = timestamped;
+  }
+  const double lagMs = deliveredMs - (captureMs + static_cast<double>(frames) * frameMs);
+  mInputLatencyMs = mInputBlocks == 0 ? lagMs : mInputLatencyMs + kInputLatencyWeight * (lagMs - mInputLatencyMs);
+  ++mInputBlocks;
+
+  const std::size_t room = mCapture.size() - captured;
+  const std::size_t count = std::min(room, static_cast<std::size_t>(std::max(frames, 0)));
+  const int32_t stride = std::max(channels, 1);
+  for (std::size_t i = 0; i < count; ++i) {
+    // First channel only; a stereo mic pair would only blur the arrival.
+    mCapture[captured + i] = input[i * stride];
+  }
+  mCaptured.store(captured + count, std::memory_order_release);
+  if (count == room) {
+    mCaptureFull.store(true, std::memory_order_release);
+  }
+}
+
+bool LoopbackCalibrator::captureDone() const {
+  if (mCaptureFull.load(std::memory_order_acquire)) {
+    return true;
+  }
+  const uint32_t emitted = mEmitted.load(std::memory_order_acquire);
+  const std::size_t captured = mCaptured.load(std::memory_order_acquire);
+  if (emitted < mConfig.probeCount || captured == 0) {
+    return false;
+  }
+  const double capturedUntilMs =
+      mCaptureOriginMs.load(std::memory_order_relaxed) + static_cast<double>(captured) * 1000.0 / mConfig.sampleRate;
+  return capturedUntilMs >= mEmitPresentationMs[emitted - 1] + mConfig.maxLatencyMs + mConfig.chirpMs;
+}
+
+LoopbackCalibrator::Result LoopbackCalibrator::analyze() const {
+  Result result{};
+  result.probes = mConfig.probeCount;
+  result.inputTimestamped = mInputTimestamped;
+  const uint32_t emitted = mEmitted.load(std::memory_order_acquire);
+  const std::size_t captured = mCaptured.load(std::memory_order_acquire);
+  const std::size_t probeFrames = mProbe.size();
+  if (emitted == 0 || captured < probeFrames * 2) {
+    return result;
+  }
+
+  // Matched filter, one search window per probe: correlate the capture with
+  // the chirp in the frequency domain, keeping only positive frequencies so
+  // the inverse transform is the analytic signal and its magnitude a smooth
+  // envelope without the carrier. Windows rather than the whole capture keep
+  // the transforms small; the chirp's spectrum is shared by all of them.
+  const double sampleRate = mConfig.sampleRate;
+  const auto toFrames = [&](double ms) { return static_cast<int64_t>(std::llround(ms * sampleRate / 1000.0)); };
+  const std::size_t lags = static_cast<std::size_t>(toFrames(kEarlyWindowMs + mConfig.maxLatencyMs)) + 1;
+  const Fft fft(lags + probeFrames - 1);
+  const std::size_t size = fft.size();
+  std::vector<std::complex<float>> reference(size);
+  for (std::size_t i = 0; i < probeFrames; ++i) {
+    reference[i] = mProbe[i];
+  }
+  fft.forward(reference.data());
+  for (std::size_t i = 0; i < size; ++i) {
+    const float weight = i == 0 || i == size / 2 ? 1.0f : (i < size / 2 ? 2.0f : 0.0f);
+    reference[i] = std::conj(reference[i]) * weight;
+  }
+  std::vector<std::complex<float>> signal(size);
+  std::vector<float> envelope(lags);
+
+  const double originMs = mCaptureOriginMs.load(std::memory_order_relaxed);
+  std::vector<double> errors;
+  std::vector<double> roundTrips;
+  std::vector<double> ratios;
+  for (uint32_t k = 0; k < emitted; ++k) {
+    const int64_t windowStart = toFrames(mEmitPresentationMs[k] - originMs - kEarlyWindowMs);
+    const int64_t first = std::max<int64_t>(0, windowStart);
+    const int64_t available = static_cast<int64_t>(captured) - static_cast<int64_t>(probeFrames) - first + 1;
+    const int64_t last = first + std::min<int64_t>(static_cast<int64_t>(lags) - (first - windowStart), available) - 1;
+    if (last - first < 3) {
+      continue;
+    }
+    const std::size_t segment = std::min<std::size_t>(size, captured - static_cast<std::size_t>(first));
+    std::fill(signal.begin(), signal.end(), std::complex<float>());
+    for (std::size_t i = 0; i < segment; ++i) {
+      signal[i] = mCapture[static_cast<std::size_t>(first) + i];
+    }
+    fft.forward(signal.data());
+    for (std::size_t i = 0; i < size; ++i) {
+      // Conjugated for the inverse transform (forward of the conjugate).
+      signal[i] = std::conj(signal[i] * reference[i]);
+    }
+    fft.forward(signal.data());
+    const std::size_t count = static_cast<std::size_t>(last - first + 1);
+    float peak = 0.0f;
+    double energy = 0.0;
+    for (std::size_t i = 0; i < count; ++i) {
+      envelope[i] = std::abs(signal[i]);
+      peak = std::max(peak, envelope[i]);
+      energy += static_cast<double>(envelope[i]) * envelope[i];
+    }
+    const double rms = std::sqrt(energy / static_cast<double>(count));
+    const double ratio = rms > 0.0 ? peak / rms : 0.0;
+    if (ratio < mConfig.minPeakRatio) {
+      continue;
+    }
+    std::size_t index = 0;
+    while (index + 1 < count && envelope[index] < kDirectPathFraction * peak) {
+      ++index;
+    }
+    while (index + 1 < count && envelope[index + 1] >= envelope[index]) {
+      ++index;
+    }
+    double fraction = 0.0;
+    if (index > 0 && index + 1 < count) {
+      const double left = envelope[index - 1];
+      const double centre = envelope[index];
+      const double right = envelope[index + 1];
+      const double curvature = left - 2.0 * centre + right;
+      if (curvature < 0.0) {
+        fraction = std::clamp(0.5 * (left - right) / curvature, -0.5, 0.5);
+      }
+    }
+    const double arrivalMs =
+        originMs + (static_cast<double>(first) + static_cast<double>(index) + fraction) * 1000.0 / sampleRate;
+    errors.push_back(arrivalMs - mEmitPresentationMs[k]);
+    roundTrips.push_back(arrivalMs - mEmitRenderMs[k] + mInputLatencyMs);
+    ratios.push_back(ratio);
+  }
+
+  result.detected = static_cast<uint32_t>(errors.size());
+  if (result.detected < std::max<uint32_t>(3, mConfig.probeCount / 2)) {
+    return result;
+  }
+  result.presentationErrorMs = median(errors);
+  result.roundTripMs = median(roundTrips);
+  result.peakRatio = median(ratios);
+  std::vector<double> deviations;
+  deviations.reserve(errors.size());
+  for (const double error : errors) {
+    deviations.push_back(std::abs(error - result.presentationErrorMs));
+  }
+  result.spreadMs = median(std::move(deviations));
+  result.valid = true;
+  return result;
+}
+
+} // namespace margelo::nitro::morse
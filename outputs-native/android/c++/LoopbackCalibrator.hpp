@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace margelo::nitro::morse {
+
+// Measures output latency with a full-duplex loop: a train of chirps is mixed
+// into the output, the input records what comes back, and a matched filter
+// (FFT cross-correlation with the chirp) finds each arrival. Comparing the
+// arrival with the time the output stream said the chirp would be heard gives
+// the latency its timestamps miss; comparing with the render time gives the
+// whole round trip. No platform code: AudioEngine/CalibrationInputStream feed
+// it on device, tools/latency-loopback.cpp from a simulated loop or WAV files.
+//
+// renderOutput and captureInput each have a single realtime caller and do not
+// allocate; configure and analyze run elsewhere, before and after a run.
+class LoopbackCalibrator {
+ public:
+  struct Config {
+    double sampleRate;
+    uint32_t probeCount;
+    // First probe after this much output, so the input is already running.
+    double leadInMs;
+    double probeIntervalMs;
+    double chirpMs;
+    double chirpStartHz;
+    double chirpEndHz;
+    float gain;
+    // Arrivals are searched this far after the presentation time; must stay
+    // below the probe interval.
+    double maxLatencyMs;
+    // Weaker correlation peaks (against the search window's RMS) are noise.
+    double minPeakRatio;
+  };
+
+  struct Result {
+    bool valid;
+    // Median arrival minus presentation time: latency the output timestamps
+    // did not report (plus whatever the input timestamps get wrong).
+    double presentationErrorMs;
+    // Median arrival minus render time, plus the observed input latency.
+    double roundTripMs;
+    // Median absolute deviation of the per-probe presentation errors.
+    double spreadMs;
+    double peakRatio;
+    // Whether arrivals were placed with input stream timestamps; without them
+    // the input buffering lands in presentationErrorMs.
+    bool inputTimestamped;
+    uint32_t detected;
+    uint32_t probes;
+  };
+
+  static Config defaultConfig(double sampleRate);
+
+  // Sizes the capture buffer and re-arms; not concurrent with a run.
+  void configure(const Config& config);
+  const Config& config() const { return mConfig; }
+
+  // Output thread: adds the probes falling into this slice to `mix`.
+  // presentationMs is when mix[0] is heard according to the output stream,
+  // without any calibrated offset; renderMs is when the slice is rendered.
+  void renderOutput(float* mix, int32_t frames, double presentationMs, double renderMs);
+  bool outputDone() const;
+
+  // Input thread: captureMs is when input[0] reached the ADC, deliveredMs when
+  // the callback saw it. `timestamped` marks captureMs as coming from stream
+  // timestamps rather than being estimated from deliveredMs.
+  void captureInput(const float* input,
+                    int32_t frames,
+                    int32_t channels,
+                    double captureMs,
+                    double deliveredMs,
+                    bool timestamped);
+  // Every probe has been emitted and its search window captured.
+  bool captureDone() const;
+
+  // After captureDone (or on a timeout, with whatever arrived).
+  Result analyze() const;
+
+  // Chirp as rendered, for tools and tests.
+  const std::vector<float>& probe() const { return mProbe; }
+
+ private:
+  Config mConfig{};
+  std::vector<float> mProbe;
+  int64_t mLeadInFrames = 0;
+  int64_t mIntervalFrames = 0;
+
+  // Output side.
+  int64_t mOutputFrames = 0;
+  std::vector<double> mEmitPresentationMs;
+  std::vector<double> mEmitRenderMs;
+  std::atomic<uint32_t> mEmitted{ 0 };
+
+  // Input side. Samples are stored back to back; captured sample i is taken
+  // to have reached the ADC at mCaptureOriginMs + i / sampleRate.
+  std::vector<float> mCapture;
+  std::atomic<std::size_t> mCaptured{ 0 };
+  // Read by captureDone from the polling thread.
+  std::atomic<double> mCaptureOriginMs{ 0.0 };
+  double mInputLatencyMs = 0.0;
+  uint32_t mInputBlocks = 0;
+  bool mInputTimestamped = false;
+  std::atomic<bool> mCaptureFull{ false };
+};
+
+} // namespace margelo::nitro::morse
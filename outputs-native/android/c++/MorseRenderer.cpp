@@ -0,0 +1,108 @@
+#include "MorseRenderer.hpp"
+
+#include "MorseTable.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <random>
+
+namespace margelo::nitro::morse {
+
+namespace {
+constexpr double kTwoPi = 6.283185307179586476925286766559;
+constexpr int kDashUnits = 3;
+constexpr int kSymbolGapUnits = 1;
+constexpr int kLetterGapUnits = 3;
+constexpr int kWordGapUnits = 7;
+
+struct Mark {
+  double startMs;
+  double durationMs;
+};
+
+// Walks the text the way playMorse schedules it and returns the end time.
+template <typename Visitor>
+double layout(std::string_view text, double unitMs, Visitor&& visit) {
+  double cursorMs = 0.0;
+  bool letterOpen = false;
+  bool wordGapPending = false;
+  for (const char raw : text) {
+    if (raw == ' ') {
+      wordGapPending = letterOpen;
+      continue;
+    }
+    const auto pattern = encodeMorseChar(static_cast<char>(std::toupper(static_cast<unsigned char>(raw))));
+    if (!pattern.has_value()) {
+      continue;
+    }
+    if (letterOpen) {
+      cursorMs += unitMs * (wordGapPending ? kWordGapUnits : kLetterGapUnits);
+    }
+    wordGapPending = false;
+    for (std::size_t i = 0; i < pattern->size(); ++i) {
+      if (i > 0) {
+        cursorMs += unitMs * kSymbolGapUnits;
+      }
+      const double durationMs = (*pattern)[i] == '-' ? unitMs * kDashUnits : unitMs;
+      visit(Mark{ cursorMs, durationMs });
+      cursorMs += durationMs;
+    }
+    letterOpen = true;
+  }
+  return cursorMs;
+}
+} // namespace
+
+MorseRenderer::MorseRenderer(const Config& config) : mConfig(config) {}
+
+double MorseRenderer::durationMs(std::string_view text, double unitMs) {
+  return layout(text, unitMs, [](const Mark&) {});
+}
+
+void MorseRenderer::render(const MorseRenderVoice& voice, std::vector<float>& mix) const {
+  const double sampleRate = mConfig.sampleRate;
+  const double framesPerMs = sampleRate / 1000.0;
+  const float rampUp = 1.0f / static_cast<float>(std::max(1.0, mConfig.attackMs * framesPerMs));
+  const float rampDown = 1.0f / static_cast<float>(std::max(1.0, mConfig.releaseMs * framesPerMs));
+  const double phaseIncrement = kTwoPi * voice.toneHz / sampleRate;
+  const double releaseTailMs = mConfig.releaseMs + 1.0;
+
+  layout(voice.text, voice.unitMs, [&](const Mark& mark) {
+    const auto first = static_cast<int64_t>(std::llround((voice.startMs + mark.startMs) * framesPerMs));
+    const auto keyUp = static_cast<int64_t>(std::llround((voice.startMs + mark.startMs + mark.durationMs) * framesPerMs));
+    const auto last = keyUp + static_cast<int64_t>(std::ceil(releaseTailMs * framesPerMs));
+    if (first < 0) {
+      return;
+    }
+    if (static_cast<int64_t>(mix.size()) < last) {
+      mix.resize(static_cast<std::size_t>(last), 0.0f);
+    }
+    // Phase runs continuously from the voice start, like the live oscillator.
+    double phase = std::fmod(phaseIncrement * static_cast<double>(first), kTwoPi);
+    float gain = 0.0f;
+    for (int64_t frame = first; frame < last; ++frame) {
+      const float target = frame < keyUp ? 1.0f : 0.0f;
+      if (gain < target) {
+        gain = std::min(target, gain + rampUp);
+      } else if (gain > target) {
+        gain = std::max(target, gain - rampDown);
+      }
+      mix[static_cast<std::size_t>(frame)] += voice.gain * gain * static_cast<float>(std::sin(phase));
+      phase += phaseIncrement;
+      if (phase >= kTwoPi) {
+        phase -= kTwoPi;
+      }
+    }
+  });
+}
+
+void MorseRenderer::addNoise(std::vector<float>& mix, float rms, uint32_t seed) {
+  std::mt19937 generator(seed);
+  std::normal_distribution<float> distribution(0.0f, rms);
+  for (float& sample : mix) {
+    sample += distribution(generator);
+  }
+}
+
+} // namespace margelo::nitro::morse
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace margelo::nitro::morse {
+
+struct MorseRenderVoice {
+  std::string text;
+  double toneHz;
+  double unitMs;
+  float gain;
+  double startMs;
+};
+
+// Offline counterpart of the OutputsAudio oscillator: keys a sine with the
+// same per-sample linear attack/release ramps and the same 1/3/7 unit timing,
+// so synthetic recordings look like what the app actually plays.
+class MorseRenderer {
+ public:
+  struct Config {
+    double sampleRate;
+    double attackMs;
+    double releaseMs;
+  };
+
+  explicit MorseRenderer(const Config& config);
+
+  // Mixes one voice into `mix` (mono), growing it as needed.
+  void render(const MorseRenderVoice& voice, std::vector<float>& mix) const;
+  // Adds Gaussian noise with the given RMS; the seed keeps runs repeatable.
+  static void addNoise(std::vector<float>& mix, float rms, uint32_t seed);
+  static double durationMs(std::string_view text, double unitMs);
+
+ private:
+  Config mConfig;
+};
+
+} // namespace margelo::nitro::morse
@@ -0,0 +1,44 @@
+#include "MorseTable.hpp"
+
+#include <array>
+#include <cctype>
+#include <utility>
+
+namespace margelo::nitro::morse {
+
+namespace {
+constexpr std::array<std::pair<char, std::string_view>, 36> kMorseTable = { {
+    { 'A', ".-" },    { 'B', "-..." },  { 'C', "-.-." },  { 'D', "-.." },   { 'E', "." },
+    { 'F', "..-." },  { 'G', "--." },   { 'H', "...." },  { 'I', ".." },    { 'J', ".---" },
+    { 'K', "-.-" },   { 'L', ".-.." },  { 'M', "--" },    { 'N', "-." },    { 'O', "---" },
+    { 'P', ".--." },  { 'Q', "--.-" },  { 'R', ".-." },   { 'S', "..." },   { 'T', "-" },
+    { 'U', "..-" },   { 'V', "...-" },  { 'W', ".--" },   { 'X', "-..-" },  { 'Y', "-.--" },
+    { 'Z', "--.." },  { '1', ".----" }, { '2', "..---" }, { '3', "...--" }, { '4', "....-" },
+    { '5', "....." }, { '6', "-...." }, { '7', "--..." }, { '8', "---.." }, { '9', "----." },
+    { '0', "-----" },
+} };
+} // namespace
+
+std::optional<char> decodeMorsePattern(std::string_view pattern) {
+  if (pattern.empty()) {
+    return std::nullopt;
+  }
+  for (const auto& [character, code] : kMorseTable) {
+    if (code == pattern) {
+      return character;
+    }
+  }
+  return std::nullopt;
+}
+
+std::optional<std::string_view> encodeMorseChar(char character) {
+  const char upper = static_cast<char>(std::toupper(static_cast<unsigned char>(character)));
+  for (const auto& [entry, code] : kMorseTable) {
+    if (entry == upper) {
+      return code;
+    }
+  }
+  return std::nullopt;
+}
+
+} // namespace margelo::nitro::morse
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <optional>
+#include <string_view>
+
+namespace margelo::nitro::morse {
+
+// Native mirror of the character table in `utils/morse.ts`. Patterns use '.'
+// and '-' exactly like the JS helpers so decoded output matches what the
+// lessons expect.
+std::optional<char> decodeMorsePattern(std::string_view pattern);
+std::optional<std::string_view> encodeMorseChar(char character);
+
+} // namespace margelo::nitro::morse
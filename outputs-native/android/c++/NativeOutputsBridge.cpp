@@ -0,0 +1,652 @@
+#include "NativeOutputsBridge.hpp"
+
+#include "LatencyHistogram.hpp"
+
+#include <android/log.h>
+#include <fbjni/fbjni.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <mutex>
+#include <optional>
+#include <sstream>
+
+namespace margelo::nitro::morse {
+
+namespace {
+constexpr const char* kLogPrefix = "[outputs-audio]";
+constexpr const char* kTag = "OutputsAudio";
+constexpr const char* kDispatcherClass = "com/csparks113/MorseCodeApp/NativeOutputsDispatcher";
+
+struct DispatcherMethods {
+  facebook::jni::global_ref<facebook::jni::JClass> clazz;
+  facebook::jni::JStaticMethod<void(jboolean)> setTorchEnabled;
+  facebook::jni::JStaticMethod<jboolean(jboolean)> setTorchEnabledSync;
+  facebook::jni::JStaticMethod<void(jlong)> vibrate;
+  facebook::jni::JStaticMethod<jboolean(jlongArray)> vibrateWaveform;
+  facebook::jni::JStaticMethod<void()> cancelVibration;
+  facebook::jni::JStaticMethod<facebook::jni::local_ref<jobject>(jint)> createHapticEffect;
+  facebook::jni::JStaticMethod<jboolean(jobject)> playHapticEffect;
+  facebook::jni::JStaticMethod<jboolean(jboolean, jdouble)> setFlashOverlayState;
+  facebook::jni::JStaticMethod<jboolean(jdouble, jint)> setFlashOverlayAppearance;
+  facebook::jni::JStaticMethod<jboolean(jobject, jobject)> setFlashOverlayOverride;
+  facebook::jni::JStaticMethod<void(jboolean)> setScreenBrightnessBoost;
+  facebook::jni::JStaticMethod<facebook::jni::local_ref<jstring>()> getOverlayAvailabilityDebugString;
+  facebook::jni::JStaticMethod<jboolean(jlong)> awaitOverlayReady;
+  facebook::jni::JStaticMethod<facebook::jni::local_ref<jstring>(jint)> getActiveAudioRoute;
+  facebook::jni::JStaticMethod<facebook::jni::local_ref<jstring>()> getCacheDirectory;
+};
+
+std::once_flag gResolveOnce;
+DispatcherMethods* gMethods = nullptr;
+
+enum class BridgeMethod : uint8_t {
+  SetTorchEnabled = 0,
+  SetTorchEnabledSync,
+  Vibrate,
+  VibrateWaveform,
+  CancelVibration,
+  SetFlashOverlayState,
+  SetFlashOverlayAppearance,
+  SetFlashOverlayOverride,
+  SetScreenBrightnessBoost,
+  GetOverlayAvailabilityDebugString,
+  AwaitOverlayReady,
+  CreateHapticEffect,
+  PlayHapticEffect,
+  GetActiveAudioRoute,
+  GetCacheDirectory,
+};
+
+constexpr std::size_t kBridgeMethodCount = 15;
+
+// Named after the Java statics so the JSON lines up with the dispatcher.
+const char* bridgeMethodName(BridgeMethod method) {
+  switch (method) {
+    case BridgeMethod::SetTorchEnabled:
+      return "setTorchEnabled";
+    case BridgeMethod::SetTorchEnabledSync:
+      return "setTorchEnabledSync";
+    case BridgeMethod::Vibrate:
+      return "vibrate";
+    case BridgeMethod::VibrateWaveform:
+      return "vibrateWaveform";
+    case BridgeMethod::CancelVibration:
+      return "cancelVibration";
+    case BridgeMethod::SetFlashOverlayState:
+      return "setFlashOverlayState";
+    case BridgeMethod::SetFlashOverlayAppearance:
+      return "setFlashOverlayAppearance";
+    case BridgeMethod::SetFlashOverlayOverride:
+      return "setFlashOverlayOverride";
+    case BridgeMethod::SetScreenBrightnessBoost:
+      return "setScreenBrightnessBoost";
+    case BridgeMethod::GetOverlayAvailabilityDebugString:
+      return "getOverlayAvailabilityDebugString";
+    case BridgeMethod::AwaitOverlayReady:
+      return "awaitOverlayReady";
+    case BridgeMethod::CreateHapticEffect:
+      return "createHapticEffect";
+    case BridgeMethod::PlayHapticEffect:
+      return "playHapticEffect";
+    case BridgeMethod::GetActiveAudioRoute:
+      return "getActiveAudioRoute";
+    case BridgeMethod::GetCacheDirectory:
+      return "getCacheDirectory";
+  }
+  return "unknown";
+}
+
+struct BridgeMethodStats {
+  std::atomic<uint64_t> calls{ 0 };
+  std::atomic<uint64_t> failures{ 0 };
+  // No-op transitions dropped by an OverlayShadow; not counted in calls.
+  std::atomic<uint64_t> suppressed{ 0 };
+  LatencyHistogram latency;
+};
+
+std::array<BridgeMethodStats, kBridgeMethodCount> gStats;
+
+// Times one bridge call from entry to return, including the thread-attach
+// check in methods(). Method IDs are resolved once from JNI_OnLoad through
+// resolveNativeOutputsBridge, so no lookup lands inside a timed call.
+// A call fails when the bridge is unresolved, the JNI call throws or the
+// callee reports false. Only relaxed atomics, so it is cheap enough for the
+// actuator thread's hot path.
+class BridgeCallTimer {
+ public:
+  explicit BridgeCallTimer(BridgeMethod method)
+      : mStats(gStats[static_cast<std::size_t>(method)]), mStart(std::chrono::steady_clock::now()), mFailed(false) {}
+
+  ~BridgeCallTimer() {
+    const auto elapsed = std::chrono::steady_clock::now() - mStart;
+    mStats.calls.fetch_add(1, std::memory_order_relaxed);
+    if (mFailed) {
+      mStats.failures.fetch_add(1, std::memory_order_relaxed);
+    }
+    mStats.latency.record(std::chrono::duration<double, std::milli>(elapsed).count());
+  }
+
+  BridgeCallTimer(const BridgeCallTimer&) = delete;
+  BridgeCallTimer& operator=(const BridgeCallTimer&) = delete;
+
+  void fail() { mFailed = true; }
+  bool result(bool ok) {
+    mFailed = !ok;
+    return ok;
+  }
+
+ private:
+  BridgeMethodStats& mStats;
+  std::chrono::steady_clock::time_point mStart;
+  bool mFailed;
+};
+
+struct OverlayStateValue {
+  bool enabled;
+  double brightnessPercent;
+
+  // Off is off whatever brightness it was requested with.
+  bool operator==(const OverlayStateValue& other) const {
+    return enabled == other.enabled && (!enabled || brightnessPercent == other.brightnessPercent);
+  }
+};
+
+struct OverlayAppearanceValue {
+  double brightnessPercent;
+  int colorArgb;
+
+  bool operator==(const OverlayAppearanceValue& other) const = default;
+};
+
+struct OverlayOverrideValue {
+  std::optional<double> brightnessPercent;
+  std::optional<int> colorArgb;
+
+  bool operator==(const OverlayOverrideValue& other) const = default;
+};
+
+// Last value the dispatcher accepted for one overlay setter. begin() claims a
+// ticket for a call that changes something and forgets the value while it is
+// in flight; finish() only records the outcome if no later call claimed in
+// between, so callers on different threads never leave a stale shadow. The
+// JNI call itself runs outside the lock.
+template <typename T>
+class OverlayShadow {
+ public:
+  bool begin(const T& value, uint64_t& ticket) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mKnown && mValue == value) {
+      return false;
+    }
+    mKnown = false;
+    ticket = ++mVersion;
+    return true;
+  }
+
+  void finish(uint64_t ticket, const T& value, bool applied) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (ticket != mVersion) {
+      return;
+    }
+    mKnown = applied;
+    if (applied) {
+      mValue = value;
+    }
+  }
+
+  void invalidate() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mKnown = false;
+    ++mVersion;
+  }
+
+ private:
+  std::mutex mMutex;
+  uint64_t mVersion = 0;
+  bool mKnown = false;
+  T mValue{};
+};
+
+OverlayShadow<OverlayStateValue> gOverlayStateShadow;
+OverlayShadow<OverlayAppearanceValue> gOverlayAppearanceShadow;
+OverlayShadow<OverlayOverrideValue> gOverlayOverrideShadow;
+
+void recordSuppressed(BridgeMethod method) {
+  gStats[static_cast<std::size_t>(method)].suppressed.fetch_add(1, std::memory_order_relaxed);
+}
+
+void resolveMethodsOnce() {
+  try {
+    facebook::jni::Environment::ensureCurrentThreadIsAttached();
+    auto* methods = new DispatcherMethods();
+    methods->clazz = facebook::jni::make_global(facebook::jni::findClassStatic(kDispatcherClass));
+    auto& clazz = methods->clazz;
+    methods->setTorchEnabled = clazz->getStaticMethod<void(jboolean)>("setTorchEnabled");
+    methods->setTorchEnabledSync = clazz->getStaticMethod<jboolean(jboolean)>("setTorchEnabledSync");
+    methods->vibrate = clazz->getStaticMethod<void(jlong)>("vibrate");
+    methods->vibrateWaveform = clazz->getStaticMethod<jboolean(jlongArray)>("vibrateWaveform");
+    methods->cancelVibration = clazz->getStaticMethod<void()>("cancelVibration");
+    methods->createHapticEffect =
+        clazz->getStaticMethod<facebook::jni::local_ref<jobject>(jint)>("createHapticEffect");
+    methods->playHapticEffect = clazz->getStaticMethod<jboolean(jobject)>("playHapticEffect");
+    methods->setFlashOverlayState =
+        clazz->getStaticMethod<jboolean(jboolean, jdouble)>("setFlashOverlayState");
+    methods->setFlashOverlayAppearance =
+        clazz->getStaticMethod<jboolean(jdouble, jint)>("setFlashOverlayAppearance");
+    methods->setFlashOverlayOverride =
+        clazz->getStaticMethod<jboolean(jobject, jobject)>("setFlashOverlayOverride");
+    methods->setScreenBrightnessBoost =
+        clazz->getStaticMethod<void(jboolean)>("setScreenBrightnessBoost");
+    methods->getOverlayAvailabilityDebugString =
+        clazz->getStaticMethod<facebook::jni::local_ref<jstring>()>("getOverlayAvailabilityDebugString");
+    methods->awaitOverlayReady = clazz->getStaticMethod<jboolean(jlong)>("awaitOverlayReady");
+    methods->getActiveAudioRoute =
+        clazz->getStaticMethod<facebook::jni::local_ref<jstring>(jint)>("getActiveAudioRoute");
+    methods->getCacheDirectory =
+        clazz->getStaticMethod<facebook::jni::local_ref<jstring>()>("getCacheDirectory");
+    gMethods = methods;
+    __android_log_print(ANDROID_LOG_DEBUG, kTag, "%s bridge.resolved", kLogPrefix);
+  } catch (...) {
+    __android_log_print(ANDROID_LOG_WARN, kTag, "%s bridge.resolve.failed", kLogPrefix);
+  }
+}
+
+// VibrationEffect per NativeHapticEffect, null where the device has none.
+// Built once and leaked with the rest of the bridge.
+std::once_flag gHapticEffectsOnce;
+std::array<facebook::jni::global_ref<jobject>, kNativeHapticEffectCount>* gHapticEffects = nullptr;
+std::size_t gHapticEffectsResolved = 0;
+
+DispatcherMethods* methods();
+
+void resolveHapticEffectsOnce() {
+  auto* bridge = methods();
+  if (bridge == nullptr) {
+    return;
+  }
+  auto* effects = new std::array<facebook::jni::global_ref<jobject>, kNativeHapticEffectCount>();
+  std::size_t resolved = 0;
+  for (std::size_t i = 0; i < kNativeHapticEffectCount; ++i) {
+    BridgeCallTimer timer(BridgeMethod::CreateHapticEffect);
+    try {
+      auto effect = bridge->createHapticEffect(bridge->clazz, static_cast<jint>(i));
+      if (timer.result(static_cast<bool>(effect))) {
+        (*effects)[i] = facebook::jni::make_global(effect);
+        ++resolved;
+      }
+    } catch (...) {
+      timer.fail();
+      __android_log_print(ANDROID_LOG_WARN, kTag, "%s haptic.effect.failed id=%zu", kLogPrefix, i);
+    }
+  }
+  gHapticEffectsResolved = resolved;
+  gHapticEffects = effects;
+  __android_log_print(ANDROID_LOG_DEBUG, kTag, "%s haptic.effects resolved=%zu/%zu", kLogPrefix, resolved,
+                      kNativeHapticEffectCount);
+}
+
+// Method IDs are normally resolved from JNI_OnLoad; the lazy path only covers
+// callers that run before the library finished loading.
+DispatcherMethods* methods() {
+  std::call_once(gResolveOnce, resolveMethodsOnce);
+  if (gMethods != nullptr) {
+    facebook::jni::Environment::ensureCurrentThreadIsAttached();
+  }
+  return gMethods;
+}
+} // namespace
+
+void resolveNativeOutputsBridge() {
+  std::call_once(gResolveOnce, resolveMethodsOnce);
+}
+
+void setNativeTorchEnabled(bool enabled) {
+  BridgeCallTimer timer(BridgeMethod::SetTorchEnabled);
+  try {
+    auto* bridge = methods();
+    if (bridge == nullptr) {
+      timer.fail();
+      return;
+    }
+    bridge->setTorchEnabled(bridge->clazz, static_cast<jboolean>(enabled));
+  } catch (...) {
+    timer.fail();
+    __android_log_print(ANDROID_LOG_WARN, kTag, "%s torch dispatch failed", kLogPrefix);
+  }
+}
+
+bool setNativeTorchEnabledSync(bool enabled) {
+  BridgeCallTimer timer(BridgeMethod::SetTorchEnabledSync);
+  try {
+    auto* bridge = methods();
+    if (bridge == nullptr) {
+      timer.fail();
+      return false;
+    }
+    const jboolean result = bridge->setTorchEnabledSync(bridge->clazz, static_cast<jboolean>(enabled));
+    return timer.result(result == JNI_TRUE);
+  } catch (...) {
+    timer.fail();
+    __android_log_print(ANDROID_LOG_WARN, kTag, "%s torch dispatch failed", kLogPrefix);
+    return false;
+  }
+}
+
+void triggerNativeVibration(long durationMs) {
+  if (durationMs <= 0) {
+    return;
+  }
+  BridgeCallTimer timer(BridgeMethod::Vibrate);
+  try {
+    auto* bridge = methods();
+    if (bridge == nullptr) {
+      timer.fail();
+      return;
+    }
+    bridge->vibrate(bridge->clazz, static_cast<jlong>(durationMs));
+  } catch (...) {
+    timer.fail();
+    __android_log_print(ANDROID_LOG_WARN, kTag, "%s haptic dispatch failed", kLogPrefix);
+  }
+}
+
+bool triggerNativeVibrationWaveform(const std::vector<int64_t>& timings) {
+  if (timings.size() < 2) {
+    return false;
+  }
+  BridgeCallTimer timer(BridgeMethod::VibrateWaveform);
+  try {
+    auto* bridge = methods();
+    if (bridge == nullptr) {
+      timer.fail();
+      return false;
+    }
+    auto array = facebook::jni::JArrayLong::newArray(timings.size());
+    array->setRegion(0, static_cast<jsize>(timings.size()), reinterpret_cast<const jlong*>(timings.data()));
+    const jboolean result = bridge->vibrateWaveform(bridge->clazz, array.get());
+    return timer.result(result == JNI_TRUE);
+  } catch (...) {
+    timer.fail();
+    __android_log_print(ANDROID_LOG_WARN, kTag, "%s haptic waveform dispatch failed", kLogPrefix);
+    return false;
+  }
+}
+
+void cancelNativeVibration() {
+  BridgeCallTimer timer(BridgeMethod::CancelVibration);
+  try {
+    auto* bridge = methods();
+    if (bridge == nullptr) {
+      timer.fail();
+      return;
+    }
+    bridge->cancelVibration(bridge->clazz);
+  } catch (...) {
+    timer.fail();
+    __android_log_print(ANDROID_LOG_WARN, kTag, "%s haptic cancel failed", kLogPrefix);
+  }
+}
+
+std::size_t prepareNativeHapticEffects() {
+  std::call_once(gHapticEffectsOnce, resolveHapticEffectsOnce);
+  return gHapticEffectsResolved;
+}
+
+bool playNativeHapticEffect(NativeHapticEffect effect) {
+  const auto index = static_cast<std::size_t>(effect);
+  if (prepareNativeHapticEffects() == 0 || index >= kNativeHapticEffectCount ||
+      (*gHapticEffects)[index].get() == nullptr) {
+    return false;
+  }
+  BridgeCallTimer timer(BridgeMethod::PlayHapticEffect);
+  try {
+    auto* bridge = methods();
+    if (bridge == nullptr) {
+      timer.fail();
+      return false;
+    }
+    const jboolean result = bridge->playHapticEffect(bridge->clazz, (*gHapticEffects)[index].get());
+    return timer.result(result == JNI_TRUE);
+  } catch (...) {
+    timer.fail();
+    __android_log_print(ANDROID_LOG_WARN, kTag, "%s haptic dispatch failed", kLogPrefix);
+    return false;
+  }
+}
+
+bool setNativeFlashOverlayState(bool enabled, double brightnessPercent) {
+  const OverlayStateValue value{ enabled, brightnessPercent };
+  uint64_t ticket = 0;
+  if (!gOverlayStateShadow.begin(value, ticket)) {
+    recordSuppressed(BridgeMethod::SetFlashOverlayState);
+    return true;
+  }
+  BridgeCallTimer timer(BridgeMethod::SetFlashOverlayState);
+  bool applied = false;
+  try {
+    auto* bridge = methods();
+    if (bridge == nullptr) {
+      timer.fail();
+    } else {
+      const jboolean result = bridge->setFlashOverlayState(
+          bridge->clazz, static_cast<jboolean>(enabled), static_cast<jdouble>(brightnessPercent));
+      applied = timer.result(result == JNI_TRUE);
+    }
+  } catch (...) {
+    timer.fail();
+    __android_log_print(ANDROID_LOG_WARN, kTag, "%s overlay dispatch failed", kLogPrefix);
+  }
+  gOverlayStateShadow.finish(ticket, value, applied);
+  return applied;
+}
+
+bool setNativeFlashOverlayAppearance(double brightnessPercent, int colorArgb) {
+  const OverlayAppearanceValue value{ brightnessPercent, colorArgb };
+  uint64_t ticket = 0;
+  if (!gOverlayAppearanceShadow.begin(value, ticket)) {
+    recordSuppressed(BridgeMethod::SetFlashOverlayAppearance);
+    return true;
+  }
+  BridgeCallTimer timer(BridgeMethod::SetFlashOverlayAppearance);
+  bool applied = false;
+  try {
+    auto* bridge = methods();
+    if (bridge == nullptr) {
+      timer.fail();
+    } else {
+      const jboolean result = bridge->setFlashOverlayAppearance(
+          bridge->clazz, static_cast<jdouble>(brightnessPercent), static_cast<jint>(colorArgb));
+      applied = timer.result(result == JNI_TRUE);
+    }
+  } catch (...) {
+    timer.fail();
+    __android_log_print(ANDROID_LOG_WARN, kTag, "%s appearance dispatch failed", kLogPrefix);
+  }
+  gOverlayAppearanceShadow.finish(ticket, value, applied);
+  return applied;
+}
+
+bool setNativeFlashOverlayOverride(std::optional<double> brightnessPercent,
+                                   std::optional<int> colorArgb) {
+  const OverlayOverrideValue value{ brightnessPercent, colorArgb };
+  uint64_t ticket = 0;
+  if (!gOverlayOverrideShadow.begin(value, ticket)) {
+    recordSuppressed(BridgeMethod::SetFlashOverlayOverride);
+    return true;
+  }
+  BridgeCallTimer timer(BridgeMethod::SetFlashOverlayOverride);
+  bool applied = false;
+  try {
+    auto* bridge = methods();
+    if (bridge == nullptr) {
+      timer.fail();
+      gOverlayOverrideShadow.finish(ticket, value, false);
+      return false;
+    }
+    facebook::jni::local_ref<jobject> brightnessArg = nullptr;
+    facebook::jni::local_ref<jobject> tintArg = nullptr;
+    if (brightnessPercent.has_value()) {
+      brightnessArg = facebook::jni::JDouble::valueOf(brightnessPercent.value());
+    }
+    if (colorArgb.has_value()) {
+      tintArg = facebook::jni::JInteger::valueOf(colorArgb.value());
+    }
+    const jboolean result =
+        bridge->setFlashOverlayOverride(bridge->clazz,
+                                        brightnessArg ? brightnessArg.get() : nullptr,
+                                        tintArg ? tintArg.get() : nullptr);
+    applied = timer.result(result == JNI_TRUE);
+  } catch (...) {
+    timer.fail();
+    __android_log_print(ANDROID_LOG_WARN, kTag, "%s appearance override failed", kLogPrefix);
+  }
+  gOverlayOverrideShadow.finish(ticket, value, applied);
+  return applied;
+}
+
+void setNativeScreenBrightnessBoost(bool enabled) {
+  BridgeCallTimer timer(BridgeMethod::SetScreenBrightnessBoost);
+  try {
+    auto* bridge = methods();
+    if (bridge == nullptr) {
+      timer.fail();
+      return;
+    }
+    bridge->setScreenBrightnessBoost(bridge->clazz, static_cast<jboolean>(enabled));
+  } catch (...) {
+    timer.fail();
+    __android_log_print(ANDROID_LOG_WARN, kTag, "%s brightness boost failed", kLogPrefix);
+  }
+}
+
+std::string getNativeOverlayAvailabilityDebugString() {
+  BridgeCallTimer timer(BridgeMethod::GetOverlayAvailabilityDebugString);
+  try {
+    auto* bridge = methods();
+    if (bridge == nullptr) {
+      timer.fail();
+      return std::string();
+    }
+    auto result = bridge->getOverlayAvailabilityDebugString(bridge->clazz);
+    if (result) {
+      return result->toStdString();
+    }
+  } catch (...) {
+    timer.fail();
+    __android_log_print(ANDROID_LOG_WARN, kTag, "%s overlay.debug.failed", kLogPrefix);
+  }
+  return std::string();
+}
+
+bool awaitNativeOverlayReady(double timeoutMs) {
+  BridgeCallTimer timer(BridgeMethod::AwaitOverlayReady);
+  try {
+    auto* bridge = methods();
+    if (bridge == nullptr) {
+      timer.fail();
+      return false;
+    }
+    const jboolean result = bridge->awaitOverlayReady(bridge->clazz, static_cast<jlong>(timeoutMs));
+    if (result == JNI_TRUE) {
+      return true;
+    }
+    timer.fail();
+  } catch (...) {
+    timer.fail();
+    __android_log_print(ANDROID_LOG_WARN, kTag, "%s overlay.await_ready.failed", kLogPrefix);
+  }
+  // The view may have been detached and rebuilt; do not trust what we think
+  // it shows.
+  gOverlayStateShadow.invalidate();
+  return false;
+}
+
+std::optional<NativeAudioRouteInfo> getNativeActiveAudioRoute(int32_t deviceId) {
+  BridgeCallTimer timer(BridgeMethod::GetActiveAudioRoute);
+  std::string description;
+  try {
+    auto* bridge = methods();
+    if (bridge == nullptr) {
+      timer.fail();
+      return std::nullopt;
+    }
+    auto result = bridge->getActiveAudioRoute(bridge->clazz, static_cast<jint>(deviceId));
+    if (result) {
+      description = result->toStdString();
+    }
+  } catch (...) {
+    timer.fail();
+    __android_log_print(ANDROID_LOG_WARN, kTag, "%s audio.route.failed", kLogPrefix);
+    return std::nullopt;
+  }
+  // "<route id>|<product name>"; the name may itself contain '|'.
+  const std::size_t separator = description.find('|');
+  if (separator == std::string::npos || separator == 0) {
+    timer.fail();
+    return std::nullopt;
+  }
+  const int routeId = std::atoi(description.substr(0, separator).c_str());
+  if (routeId < 0 || routeId >= static_cast<int>(kAudioRouteCount)) {
+    timer.fail();
+    return std::nullopt;
+  }
+  return NativeAudioRouteInfo{ static_cast<AudioRoute>(routeId), description.substr(separator + 1) };
+}
+
+std::string getNativeCacheDirectory() {
+  BridgeCallTimer timer(BridgeMethod::GetCacheDirectory);
+  try {
+    auto* bridge = methods();
+    if (bridge == nullptr) {
+      timer.fail();
+      return std::string();
+    }
+    auto result = bridge->getCacheDirectory(bridge->clazz);
+    if (result) {
+      return result->toStdString();
+    }
+  } catch (...) {
+    __android_log_print(ANDROID_LOG_WARN, kTag, "%s cache.directory.failed", kLogPrefix);
+  }
+  timer.fail();
+  return std::string();
+}
+
+std::string getNativeBridgeStatsJson() {
+  std::ostringstream stream;
+  stream.setf(std::ios::fixed, std::ios::floatfield);
+  stream << std::setprecision(3) << "{";
+  bool first = true;
+  for (std::size_t i = 0; i < kBridgeMethodCount; ++i) {
+    const BridgeMethodStats& stats = gStats[i];
+    const uint64_t calls = stats.calls.load(std::memory_order_relaxed);
+    const uint64_t suppressed = stats.suppressed.load(std::memory_order_relaxed);
+    if (calls == 0 && suppressed == 0) {
+      continue;
+    }
+    stream << (first ? "" : ",") << "\"" << bridgeMethodName(static_cast<BridgeMethod>(i)) << "\":{"
+           << "\"calls\":" << calls
+           << ",\"failures\":" << stats.failures.load(std::memory_order_relaxed)
+           << ",\"suppressed\":" << suppressed << ",\"latency\":";
+    writeSnapshotJson(stream, stats.latency.snapshot());
+    stream << "}";
+    first = false;
+  }
+  stream << "}";
+  return stream.str();
+}
+
+void resetNativeBridgeStats() {
+  for (BridgeMethodStats& stats : gStats) {
+    stats.calls.store(0, std::memory_order_relaxed);
+    stats.failures.store(0, std::memory_order_relaxed);
+    stats.suppressed.store(0, std::memory_order_relaxed);
+    stats.latency.reset();
+  }
+}
+
+} // namespace margelo::nitro::morse
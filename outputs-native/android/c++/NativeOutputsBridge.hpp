@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "AudioRoute.hpp"
+
+namespace margelo::nitro::morse {
+
+// Effects NativeOutputsDispatcher.createHapticEffect builds; the values are
+// the ids passed to it.
+enum class NativeHapticEffect : uint8_t {
+  Tick = 0,
+  Click,
+  HeavyClick,
+  DoubleClick,
+  Success,
+  Warning,
+  Error,
+};
+
+constexpr std::size_t kNativeHapticEffectCount = 7;
+
+struct NativeAudioRouteInfo {
+  AudioRoute route;
+  // AudioDeviceInfo product name, e.g. the headset's Bluetooth name.
+  std::string deviceName;
+};
+
+// JNI entry points into `com.csparks113.MorseCodeApp.NativeOutputsDispatcher`.
+// The class and its static method IDs are resolved once from JNI_OnLoad so the
+// playback and actuator threads never pay for a lookup on the hot path.
+void resolveNativeOutputsBridge();
+
+void setNativeTorchEnabled(bool enabled);
+bool setNativeTorchEnabledSync(bool enabled);
+void triggerNativeVibration(long durationMs);
+// `timings` alternates off/on milliseconds, starting with the initial delay.
+bool triggerNativeVibrationWaveform(const std::vector<int64_t>& timings);
+void cancelNativeVibration();
+// Builds every NativeHapticEffect once and keeps the VibrationEffect handles
+// as global refs, so a tap only pays for the vibrate call. Later calls are
+// free; returns how many effects this device supports.
+std::size_t prepareNativeHapticEffects();
+// False when the effect could not be built here (API < 26) or did not play.
+bool playNativeHapticEffect(NativeHapticEffect effect);
+// The overlay setters are shadowed: a state, appearance or override equal to
+// the last one the dispatcher accepted returns true without crossing JNI
+// (counted as suppressed in the stats below). A failed call or readiness
+// check forgets the shadowed value so the next call goes through.
+bool setNativeFlashOverlayState(bool enabled, double brightnessPercent);
+bool setNativeFlashOverlayAppearance(double brightnessPercent, int colorArgb);
+bool setNativeFlashOverlayOverride(std::optional<double> brightnessPercent,
+                                   std::optional<int> colorArgb);
+void setNativeScreenBrightnessBoost(bool enabled);
+std::string getNativeOverlayAvailabilityDebugString();
+bool awaitNativeOverlayReady(double timeoutMs);
+// Output device `deviceId` (a stream's getDeviceId(), 0 when unknown) as a
+// route and product name; nullopt below API 23 or when the lookup failed.
+std::optional<NativeAudioRouteInfo> getNativeActiveAudioRoute(int32_t deviceId);
+// App-private directory for native caches; empty when the dispatcher has not
+// been initialised yet.
+std::string getNativeCacheDirectory();
+
+// Every call above is timed (count, failures, latency histogram per Java
+// method) so a skew spike can be pinned on the audio path or on a slow
+// callee. Methods never called are omitted from the JSON.
+std::string getNativeBridgeStatsJson();
+void resetNativeBridgeStats();
+
+} // namespace margelo::nitro::morse
@@ -1,7 +1,17 @@
 #include "OutputsAudio.hpp"
+#include "AllocationAudit.hpp"
+#include "AudioCapabilityCache.hpp"
+#include "AudioFrameClock.hpp"
+#include "NativeOutputsBridge.hpp"
+#include "ChannelLatencyTracker.hpp"
+#include "CorrelationLog.hpp"
+#include "DriftCorrector.hpp"
+#include "CwChannelizer.hpp"
+#include "LatencyHistogram.hpp"
+#include "TraceRecorder.hpp"
+#include "WavReader.hpp"
 
 #include <android/log.h>
-#include <fbjni/fbjni.h>
 
 #include <algorithm>
 #include <chrono>
@@ -14,17 +24,11 @@
 #include <thread>
 #include <utility>
 #include <exception>
+#include <future>
 
 namespace margelo::nitro::morse {
 
 
-void OutputsAudio::StreamDeleter::operator()(oboe::AudioStream* stream) const {
-  if (stream != nullptr) {
-    stream->close();
-    delete stream;
-  }
-}
-
 namespace {
 constexpr const char* kLogPrefix = "[outputs-audio]";
 constexpr const char* kTag = "OutputsAudio";
@@ -33,15 +37,39 @@ constexpr float kMinGain = 0.0f;
 constexpr float kMaxGain = 1.0f;
 constexpr float kDefaultAttackMs = 2.5f;
 constexpr float kDefaultReleaseMs = 6.0f;
+// Release used when a pattern is cancelled or preempted: short enough that
+// the next tone starts on a silent oscillator, long enough not to click.
+constexpr float kCancelReleaseMs = 3.0f;
 constexpr double kTwoPi = 6.283185307179586476925286766559;
 constexpr std::chrono::milliseconds kSleepQuantum(1);
-constexpr int kDashUnits = 3;
-constexpr int kSymbolGapUnits = 1;
 constexpr double kToneStartLeadMs = 4.0;
+constexpr double kMaxToneLeadMs = 40.0;
+constexpr double kMaxChannelLeadMs = 150.0;
+// Bluetooth routes can need a few hundred milliseconds; past this the profile
+// is more likely wrong than the route that slow.
+constexpr double kMaxRouteShiftMs = 400.0;
+// A calibration that has not seen all its probes by the end of the probe
+// train plus this much is analysed with what it has.
+constexpr double kCalibrationTimeoutSlackMs = 2000.0;
+// Only consistent measurements become the route's offset.
+constexpr double kMaxCalibrationSpreadMs = 2.0;
+constexpr double kActuatorLookaheadMs = 50.0;
 constexpr double kMinDispatchOffsetMs = 12.0;
+// How far ahead of the playhead the pattern timeline is compiled.
+constexpr double kScheduleHorizonMs = 8000.0;
+// Haptic chunks only split on gaps this much longer than the haptic lead, and
+// never before they have run this long.
+constexpr double kHapticChunkGuardMs = 20.0;
+constexpr double kHapticChunkMinMs = 1000.0;
+constexpr double kDefaultGlideMs = 10.0;
+constexpr double kMaxGlideMs = 500.0;
 constexpr double kPulsePercentOff = 0.0;
+// Budget for the dispatcher to attach and lay out the overlay view.
+constexpr double kOverlayPrepareTimeoutMs = 180.0;
 constexpr double kDefaultFlashAppearancePercent = 80.0;
 constexpr int32_t kDefaultFlashTintColorArgb = 0xFFFFFFFF;
+// Set on pattern threads, so a cancel issued from one does not wait for itself.
+thread_local bool tIsPlaybackThread = false;
 
 inline float clampGain(float value) {
   return std::clamp(value, kMinGain, kMaxGain);
@@ -84,138 +112,11 @@ std::string formatOptionalTint(const std::optional<int>& value) {
   return formatTint(value.value());
 }
 
-facebook::jni::global_ref<facebook::jni::JClass>& getNativeDispatcherClass() {
-  facebook::jni::Environment::ensureCurrentThreadIsAttached();
-  static facebook::jni::global_ref<facebook::jni::JClass> clazz =
-      facebook::jni::make_global(
-          facebook::jni::findClassStatic("com/csparks113/MorseCodeApp/NativeOutputsDispatcher"));
-  return clazz;
-}
-
-void setNativeTorchEnabled(bool enabled) {
-  try {
-    facebook::jni::Environment::ensureCurrentThreadIsAttached();
-    auto& clazz = getNativeDispatcherClass();
-    static auto method = clazz->getStaticMethod<void(jboolean)>("setTorchEnabled");
-    method(clazz, static_cast<jboolean>(enabled));
-  } catch (...) {
-    __android_log_print(ANDROID_LOG_WARN, kTag, "%s torch dispatch failed", kLogPrefix);
-  }
-}
-
-void triggerNativeVibration(long durationMs) {
-  if (durationMs <= 0) {
-    return;
-  }
-  try {
-    facebook::jni::Environment::ensureCurrentThreadIsAttached();
-    auto& clazz = getNativeDispatcherClass();
-    static auto method = clazz->getStaticMethod<void(jlong)>("vibrate");
-    method(clazz, static_cast<jlong>(durationMs));
-  } catch (...) {
-    __android_log_print(ANDROID_LOG_WARN, kTag, "%s haptic dispatch failed", kLogPrefix);
-  }
-}
-
-bool setNativeFlashOverlayState(bool enabled, double brightnessPercent) {
-  try {
-    facebook::jni::Environment::ensureCurrentThreadIsAttached();
-    auto& clazz = getNativeDispatcherClass();
-    static auto method = clazz->getStaticMethod<jboolean(jboolean, jdouble)>("setFlashOverlayState");
-    const jboolean result =
-        method(clazz, static_cast<jboolean>(enabled), static_cast<jdouble>(brightnessPercent));
-    return result == JNI_TRUE;
-  } catch (...) {
-    __android_log_print(ANDROID_LOG_WARN, kTag, "%s overlay dispatch failed", kLogPrefix);
-    return false;
-  }
-}
-
-bool setNativeFlashOverlayAppearance(double brightnessPercent, int colorArgb) {
-  try {
-    facebook::jni::Environment::ensureCurrentThreadIsAttached();
-    auto& clazz = getNativeDispatcherClass();
-    static auto method =
-        clazz->getStaticMethod<jboolean(jdouble, jint)>("setFlashOverlayAppearance");
-    const jboolean result =
-        method(clazz, static_cast<jdouble>(brightnessPercent), static_cast<jint>(colorArgb));
-    return result == JNI_TRUE;
-  } catch (...) {
-    __android_log_print(ANDROID_LOG_WARN, kTag, "%s appearance dispatch failed", kLogPrefix);
-    return false;
-  }
-}
-
-bool setNativeFlashOverlayOverride(std::optional<double> brightnessPercent,
-                                   std::optional<int> colorArgb) {
-  try {
-    facebook::jni::Environment::ensureCurrentThreadIsAttached();
-    auto& clazz = getNativeDispatcherClass();
-    static auto method =
-        clazz->getStaticMethod<jboolean(jobject, jobject)>("setFlashOverlayOverride");
-    facebook::jni::local_ref<jobject> brightnessArg = nullptr;
-    facebook::jni::local_ref<jobject> tintArg = nullptr;
-    if (brightnessPercent.has_value()) {
-      brightnessArg = facebook::jni::JDouble::valueOf(brightnessPercent.value());
-    }
-    if (colorArgb.has_value()) {
-      tintArg = facebook::jni::JInteger::valueOf(colorArgb.value());
-    }
-    const jboolean result =
-        method(clazz,
-               brightnessArg ? brightnessArg.get() : nullptr,
-               tintArg ? tintArg.get() : nullptr);
-    return result == JNI_TRUE;
-  } catch (...) {
-    __android_log_print(ANDROID_LOG_WARN, kTag, "%s appearance override failed", kLogPrefix);
-    return false;
-  }
-}
-
-[[maybe_unused]] void setNativeScreenBrightnessBoost(bool enabled) {
-  try {
-    facebook::jni::Environment::ensureCurrentThreadIsAttached();
-    auto& clazz = getNativeDispatcherClass();
-    static auto method = clazz->getStaticMethod<void(jboolean)>("setScreenBrightnessBoost");
-    method(clazz, static_cast<jboolean>(enabled));
-  } catch (...) {
-    __android_log_print(ANDROID_LOG_WARN, kTag, "%s brightness boost failed", kLogPrefix);
-  }
-}
-
-std::string getNativeOverlayAvailabilityDebugString() {
-  try {
-    facebook::jni::Environment::ensureCurrentThreadIsAttached();
-    auto& clazz = getNativeDispatcherClass();
-    static auto method =
-        clazz->getStaticMethod<facebook::jni::local_ref<jstring>()>("getOverlayAvailabilityDebugString");
-    auto result = method(clazz);
-    if (result) {
-      return result->toStdString();
-    }
-  } catch (...) {
-    __android_log_print(ANDROID_LOG_WARN, kTag, "%s overlay.debug.failed", kLogPrefix);
-  }
-  return std::string();
-}
-
-bool awaitNativeOverlayReady(double timeoutMs) {
-  try {
-    facebook::jni::Environment::ensureCurrentThreadIsAttached();
-    auto& clazz = getNativeDispatcherClass();
-    static auto method = clazz->getStaticMethod<jboolean(jlong)>("awaitOverlayReady");
-    const jboolean result = method(clazz, static_cast<jlong>(timeoutMs));
-    return result == JNI_TRUE;
-  } catch (...) {
-    __android_log_print(ANDROID_LOG_WARN, kTag, "%s overlay.await_ready.failed", kLogPrefix);
-  }
-  return false;
-}
 } // namespace
 
 OutputsAudio::OutputsAudio()
-    : HybridOutputsAudioSpec(), margelo::nitro::HybridObject(HybridOutputsAudioSpec::TAG), mStream(nullptr),
-      mSampleRate(48000.0),
+    : margelo::nitro::HybridObject(HybridOutputsAudioSpec::TAG), HybridOutputsAudioSpec(),
+      mEngineClient(false),
       mFrequency(600.0),
       mTargetGain(0.0f),
       mCurrentGain(0.0f),
@@ -224,18 +125,44 @@ OutputsAudio::OutputsAudio()
       mStreamReady(false),
       mSupportKnown(false),
       mSupported(false),
+      mWarmupState(WarmupState::Idle),
+      mWarmupElapsedMs(0.0),
       mEnvelopeConfig{ kDefaultAttackMs, kDefaultReleaseMs },
       mPhase(0.0),
-      mPlaybackCancel(false),
-      mPlaybackRunning(false),
-      mSymbolSequence(0),
-      mPatternStartTimestampMs(0.0),
+      mGlideMs(0.0),
+      mOscillatorHz(600.0),
+      mGlideTargetHz(600.0),
+      mGlideStepHz(0.0),
       mToneActive(false),
       mToneStartLogged(false),
       mToneSteadyLogged(false),
       mToneStopLogged(false),
       mToneStartRequestedMs(0.0),
       mToneActualStartMs(0.0),
+      mToneExpectedStartMs(0.0),
+      mToneSequence(0),
+      mToneGeneration(0),
+      mToneCorrelationTag(0),
+      mPatternRouteShiftMs(0.0),
+      mSymbolSequence(0),
+      mPatternStartTimestampMs(0.0),
+      mLivePlaybackThreads(0),
+      mPlaybackRunId(0),
+      mPlaybackRunning(false),
+      mPlaybackControlPending(false),
+      mPauseRequested(false),
+      mPlaybackPaused(false),
+      mPauseRequestedAtMs(0.0),
+      mPausedPosition{ 0, 0, 0.0 },
+      mSeekTarget(PlaybackSeekTarget::None),
+      mSeekIndex(0),
+      mPatternSymbolCount(0),
+      mPatternCharacterCount(0),
+      mRequestedUnitMs(0.0),
+      mRequestedToneHz(0.0),
+      mRequestedGlideMs(0.0),
+      mActuatorGeneration(0),
+      mHapticWaveformActive(false),
       mReplayFlashEnabled(false),
       mReplayHapticsEnabled(false),
       mReplayTorchEnabled(false),
@@ -243,44 +170,110 @@ OutputsAudio::OutputsAudio()
       mReplayFlashTintColorArgb(kDefaultFlashTintColorArgb),
       mReplayFlashOverridePercent(std::nullopt),
       mReplayFlashOverrideTintArgb(std::nullopt),
-      mNativeOverlayAvailable(false),
+      mOverlayReadiness(OverlayReadiness::Unavailable),
       mNativeOverlayActive(false),
       mExternalOverlayActive(false),
-      mScreenBrightnessBoostEnabled(false) {
+      mScreenBrightnessBoostEnabled(false),
+      mKeyerToneHz(600.0),
+      mKeyerGain(kDefaultGain),
+      mKeyerStepUp(0.0f),
+      mKeyerStepDown(0.0f),
+      mCwInput(mCwReceiver),
+      mCalibrationInput(mCalibrator),
+      mCalibrationRendering(false),
+      mCalibrationInRender(false),
+      mCalibrationState(CalibrationState::Idle),
+      mCalibrationStartedMs(0.0),
+      mCalibrationRoute(AudioRoute::Other) {
+  ActuatorThread::shared().attachListener(this);
   logEvent("constructor");
 }
 
 OutputsAudio::~OutputsAudio() {
   teardown();
+  ActuatorThread::shared().detachListener(this);
 }
 
 void OutputsAudio::loadHybridMethods() {
   HybridOutputsAudioSpec::loadHybridMethods();
   registerHybrids(this, [](Prototype& prototype) {
+    prototype.registerHybridMethod("isSupportedAsync", &OutputsAudio::isSupportedAsync);
+    prototype.registerHybridMethod("warmupAsync", &OutputsAudio::warmupAsync);
+    prototype.registerHybridMethod("getWarmupStatus", &OutputsAudio::getWarmupStatus);
     prototype.registerHybridMethod("setSymbolDispatchCallback", &OutputsAudio::setSymbolDispatchCallback);
+    prototype.registerHybridMethod("setPlaybackProgressCallback", &OutputsAudio::setPlaybackProgressCallback);
     prototype.registerHybridMethod("setFlashOverlayState", &OutputsAudio::setFlashOverlayState);
     prototype.registerHybridMethod("setFlashOverlayAppearance", &OutputsAudio::setFlashOverlayAppearance);
     prototype.registerHybridMethod("setFlashOverlayOverride", &OutputsAudio::setFlashOverlayOverride);
     prototype.registerHybridMethod("setScreenBrightnessBoost", &OutputsAudio::setScreenBrightnessBoost);
+    prototype.registerHybridMethod("getChannelLatencyProfile", &OutputsAudio::getChannelLatencyProfile);
+    prototype.registerHybridMethod("seedChannelLatency", &OutputsAudio::seedChannelLatency);
+    prototype.registerHybridMethod("getAudioRouteProfiles", &OutputsAudio::getAudioRouteProfiles);
+    prototype.registerHybridMethod("setAudioRouteProfile", &OutputsAudio::setAudioRouteProfile);
+    prototype.registerHybridMethod("startLatencyCalibration", &OutputsAudio::startLatencyCalibration);
+    prototype.registerHybridMethod("getLatencyCalibration", &OutputsAudio::getLatencyCalibration);
+    prototype.registerHybridMethod("cancelLatencyCalibration", &OutputsAudio::cancelLatencyCalibration);
+    prototype.registerHybridMethod("getNativeClockMs", &OutputsAudio::getNativeClockMs);
+    prototype.registerHybridMethod("getAudioFrameClock", &OutputsAudio::getAudioFrameClock);
+    prototype.registerHybridMethod("getCorrelatedCommits", &OutputsAudio::getCorrelatedCommits);
+    prototype.registerHybridMethod("configureKeyer", &OutputsAudio::configureKeyer);
+    prototype.registerHybridMethod("setKeyerEnabled", &OutputsAudio::setKeyerEnabled);
+    prototype.registerHybridMethod("setKeyerPaddle", &OutputsAudio::setKeyerPaddle);
+    prototype.registerHybridMethod("resetPressClassifier", &OutputsAudio::resetPressClassifier);
+    prototype.registerHybridMethod("pushPressEdge", &OutputsAudio::pushPressEdge);
+    prototype.registerHybridMethod("flushPressClassifier", &OutputsAudio::flushPressClassifier);
+    prototype.registerHybridMethod("getPressClassifierState", &OutputsAudio::getPressClassifierState);
+    prototype.registerHybridMethod("startCwReceiver", &OutputsAudio::startCwReceiver);
+    prototype.registerHybridMethod("stopCwReceiver", &OutputsAudio::stopCwReceiver);
+    prototype.registerHybridMethod("pollCwReceiver", &OutputsAudio::pollCwReceiver);
+    prototype.registerHybridMethod("getCwReceiverState", &OutputsAudio::getCwReceiverState);
+    prototype.registerHybridMethod("decodeWavFile", &OutputsAudio::decodeWavFile);
+    prototype.registerHybridMethod("decodePileupWavFile", &OutputsAudio::decodePileupWavFile);
+    prototype.registerHybridMethod("getLatencyHistograms", &OutputsAudio::getLatencyHistograms);
+    prototype.registerHybridMethod("resetLatencyHistograms", &OutputsAudio::resetLatencyHistograms);
+    prototype.registerHybridMethod("getBridgeStats", &OutputsAudio::getBridgeStats);
+    prototype.registerHybridMethod("resetBridgeStats", &OutputsAudio::resetBridgeStats);
+    prototype.registerHybridMethod("startTrace", &OutputsAudio::startTrace);
+    prototype.registerHybridMethod("stopTrace", &OutputsAudio::stopTrace);
+    prototype.registerHybridMethod("exportTrace", &OutputsAudio::exportTrace);
+    prototype.registerHybridMethod("playMorseCode", &OutputsAudio::playMorseCode);
+    prototype.registerHybridMethod("pausePlayback", &OutputsAudio::pausePlayback);
+    prototype.registerHybridMethod("resumePlayback", &OutputsAudio::resumePlayback);
+    prototype.registerHybridMethod("seekPlaybackToSymbol", &OutputsAudio::seekPlaybackToSymbol);
+    prototype.registerHybridMethod("seekPlaybackToCharacter", &OutputsAudio::seekPlaybackToCharacter);
+    prototype.registerHybridMethod("getPlaybackPosition", &OutputsAudio::getPlaybackPosition);
+    prototype.registerHybridMethod("setPlaybackUnitMs", &OutputsAudio::setPlaybackUnitMs);
+    prototype.registerHybridMethod("setPlaybackToneHz", &OutputsAudio::setPlaybackToneHz);
   });
 }
 
 void OutputsAudio::setSymbolDispatchCallback(const std::optional<std::function<void(const PlaybackDispatchEvent&)>>& callback) {
+  auto shared = callback.has_value()
+                    ? std::make_shared<const std::function<void(const PlaybackDispatchEvent&)>>(*callback)
+                    : nullptr;
   std::lock_guard<std::mutex> lock(mCallbackMutex);
-  mSymbolDispatchCallback = callback;
+  mSymbolDispatchCallback = std::move(shared);
 }
 
-void OutputsAudio::emitSymbolDispatchEvent(const PlaybackDispatchEvent& event) {
-  std::function<void(const PlaybackDispatchEvent&)> callback;
+void OutputsAudio::emitSymbolDispatchEvent(PlaybackDispatchEvent& event, uint32_t correlationTag) {
+  std::shared_ptr<const std::function<void(const PlaybackDispatchEvent&)>> callback;
   {
     std::lock_guard<std::mutex> lock(mCallbackMutex);
-    if (!mSymbolDispatchCallback.has_value()) {
-      return;
+    callback = mSymbolDispatchCallback;
+  }
+  if (!callback) {
+    return;
+  }
+  // Nitro hops the event to the JS thread, which allocates on its side.
+  AllocationAuditExemption exemption;
+  if (correlationTag != 0) {
+    std::string correlationId = CorrelationLog::shared().name(correlationTag);
+    if (!correlationId.empty()) {
+      event.correlationId = std::move(correlationId);
     }
-    callback = *mSymbolDispatchCallback;
   }
   try {
-    callback(event);
+    (*callback)(event);
   } catch (const std::exception& exception) {
     logEvent("dispatch.callback.error", "message=%s", exception.what());
   } catch (...) {
@@ -288,6 +281,158 @@ void OutputsAudio::emitSymbolDispatchEvent(const PlaybackDispatchEvent& event) {
   }
 }
 
+void OutputsAudio::setPlaybackProgressCallback(
+    const std::optional<std::function<void(const PlaybackProgressEvent&)>>& callback) {
+  auto shared = callback.has_value()
+                    ? std::make_shared<const std::function<void(const PlaybackProgressEvent&)>>(*callback)
+                    : nullptr;
+  std::lock_guard<std::mutex> lock(mCallbackMutex);
+  mPlaybackProgressCallback = std::move(shared);
+}
+
+void OutputsAudio::emitPlaybackProgressEvent(PlaybackProgressEvent& event, uint32_t correlationTag) {
+  std::shared_ptr<const std::function<void(const PlaybackProgressEvent&)>> callback;
+  {
+    std::lock_guard<std::mutex> lock(mCallbackMutex);
+    callback = mPlaybackProgressCallback;
+  }
+  if (!callback) {
+    return;
+  }
+  AllocationAuditExemption exemption;
+  if (correlationTag != 0) {
+    std::string correlationId = CorrelationLog::shared().name(correlationTag);
+    if (!correlationId.empty()) {
+      event.correlationId = std::move(correlationId);
+    }
+  }
+  try {
+    (*callback)(event);
+  } catch (const std::exception& exception) {
+    logEvent("progress.callback.error", "message=%s", exception.what());
+  } catch (...) {
+    logEvent("progress.callback.error", "message=unknown");
+  }
+}
+
+void OutputsAudio::submitActuatorCommand(ActuatorCommandType type,
+                                         bool enabled,
+                                         double value,
+                                         double targetTimeMs,
+                                         double leadMs,
+                                         uint64_t sequence,
+                                         uint64_t generation,
+                                         uint32_t correlationTag) {
+  ActuatorCommand command{};
+  command.type = type;
+  command.enabled = enabled;
+  command.value = value;
+  command.enqueuedAtMs = toMillis(std::chrono::steady_clock::now());
+  command.dueTimeMs = targetTimeMs > 0.0 ? targetTimeMs - leadMs : 0.0;
+  command.targetTimeMs = targetTimeMs;
+  command.sequence = sequence;
+  command.generation = generation;
+  command.listener = this;
+  command.correlationTag = correlationTag;
+  ActuatorThread::shared().submit(command);
+}
+
+void OutputsAudio::submitCleanupCommand(ActuatorCommandType type, double value) {
+  ActuatorCommand command{};
+  command.type = type;
+  command.enabled = false;
+  command.value = value;
+  command.enqueuedAtMs = toMillis(std::chrono::steady_clock::now());
+  command.listener = nullptr;
+  ActuatorThread::shared().submit(command);
+}
+
+bool OutputsAudio::isActuatorCommandCurrent(const ActuatorCommand& command) const {
+  if (command.generation != mActuatorGeneration.load(std::memory_order_acquire)) {
+    return false;
+  }
+  // Once a pulse has failed, the ones queued behind it are dropped here rather
+  // than each failing through JNI in turn.
+  return command.type != ActuatorCommandType::OverlayState || !command.enabled || overlayReady();
+}
+
+void OutputsAudio::onActuatorCommandCompleted(const ActuatorCommand& command,
+                                              bool success,
+                                              double dispatchedAtMs,
+                                              double committedAtMs) {
+  if (success && command.enabled) {
+    std::optional<OutputChannel> channel;
+    switch (command.type) {
+      case ActuatorCommandType::Torch:
+        channel = OutputChannel::Torch;
+        break;
+      case ActuatorCommandType::OverlayState:
+        channel = OutputChannel::Overlay;
+        break;
+      case ActuatorCommandType::Vibrate:
+      case ActuatorCommandType::VibrateWaveform:
+        channel = OutputChannel::Haptics;
+        break;
+      case ActuatorCommandType::BrightnessBoost:
+      case ActuatorCommandType::CancelVibration:
+      case ActuatorCommandType::HapticEffect:
+        break;
+    }
+    if (channel.has_value()) {
+      const double dispatchToCommitMs = committedAtMs - dispatchedAtMs;
+      ChannelLatencyTracker::shared().record(*channel, dispatchToCommitMs);
+      auto& histograms = LatencyHistograms::shared();
+      histograms.record(*channel, LatencyMetric::DispatchToCommit, dispatchToCommitMs);
+      if (command.targetTimeMs > 0.0) {
+        histograms.record(*channel, LatencyMetric::StartSkew, committedAtMs - command.targetTimeMs);
+      }
+      CorrelationLog::shared().record(CorrelationLog::Record{ command.correlationTag,
+                                                              *channel,
+                                                              command.sequence,
+                                                              dispatchedAtMs,
+                                                              committedAtMs,
+                                                              command.targetTimeMs });
+    }
+  }
+  if (command.type != ActuatorCommandType::OverlayState || !command.enabled) {
+    return;
+  }
+  if (success) {
+    mNativeOverlayActive.store(true, std::memory_order_release);
+    return;
+  }
+  // Runs on the actuator thread, so the debug lookup never stalls the timeline;
+  // only the failure that takes the overlay down pays for it.
+  if (!markOverlayUnavailable()) {
+    return;
+  }
+  // Both bridge calls below allocate on the JNI side, and this runs inside the
+  // actuator worker's audit scope.
+  std::string overlayDebug;
+  {
+    AllocationAuditExemption bridgeExemption;
+    overlayDebug = getNativeOverlayAvailabilityDebugString();
+  }
+  if (!overlayDebug.empty()) {
+    logEvent("overlay.symbol.unavailable",
+             "sequence=%llu brightness=%.1f committedAt=%.3f %s",
+             static_cast<unsigned long long>(command.sequence),
+             command.value,
+             committedAtMs,
+             overlayDebug.c_str());
+  } else {
+    logEvent("overlay.symbol.unavailable",
+             "sequence=%llu brightness=%.1f committedAt=%.3f",
+             static_cast<unsigned long long>(command.sequence),
+             command.value,
+             committedAtMs);
+  }
+  if (mScreenBrightnessBoostEnabled.exchange(false, std::memory_order_acq_rel)) {
+    AllocationAuditExemption bridgeExemption;
+    setNativeScreenBrightnessBoost(false);
+  }
+}
+
 void OutputsAudio::logEvent(const char* event, const char* fmt, ...) const {
   if (event == nullptr) {
     return;
@@ -313,23 +458,7 @@ bool OutputsAudio::isSupported() {
 
   std::lock_guard<std::mutex> lock(mStreamMutex);
   if (!mSupportKnown.load(std::memory_order_relaxed)) {
-    oboe::AudioStreamBuilder builder;
-    builder.setDirection(oboe::Direction::Output);
-    builder.setPerformanceMode(oboe::PerformanceMode::LowLatency);
-    builder.setSharingMode(oboe::SharingMode::Exclusive);
-    builder.setChannelCount(1);
-    builder.setFormat(oboe::AudioFormat::Float);
-
-    oboe::AudioStream* testStream = nullptr;
-    const oboe::Result result = builder.openStream(&testStream);
-    if (result == oboe::Result::OK && testStream != nullptr) {
-      mSupported = true;
-      testStream->close();
-      testStream = nullptr;
-    } else {
-      mSupported = false;
-      logEvent("isSupported.failed", "error=%s", oboe::convertToText(result));
-    }
+    mSupported = AudioEngine::shared().isSupported();
     mSupportKnown.store(true, std::memory_order_release);
   }
 
@@ -337,88 +466,36 @@ bool OutputsAudio::isSupported() {
 }
 
 void OutputsAudio::ensureStreamLocked(double toneHz) {
-  if (mStreamReady.load(std::memory_order_acquire) && mStream) {
-    return;
-  }
-
-  if (mStream) {
-    mStream.reset();
-  }
-
-  oboe::AudioStreamBuilder builder;
-  builder.setDirection(oboe::Direction::Output);
-  builder.setPerformanceMode(oboe::PerformanceMode::LowLatency);
-  builder.setSharingMode(oboe::SharingMode::Exclusive);
-  builder.setUsage(oboe::Usage::Game);
-  builder.setContentType(oboe::ContentType::Sonification);
-  builder.setChannelCount(1);
-  builder.setFormat(oboe::AudioFormat::Float);
-  builder.setCallback(this);
-  builder.setErrorCallback(this);
-
-  oboe::AudioStream* rawStream = nullptr;
-  const oboe::Result result = builder.openStream(&rawStream);
-  if (result != oboe::Result::OK || rawStream == nullptr) {
-    logEvent("stream.open.failed", "error=%s", oboe::convertToText(result));
-    if (rawStream != nullptr) {
-      rawStream->close();
-      delete rawStream;
+  auto& engine = AudioEngine::shared();
+  if (!mEngineClient) {
+    if (!engine.acquire(this)) {
+      mStreamReady.store(false, std::memory_order_release);
+      return;
     }
-    mStreamReady.store(false, std::memory_order_release);
+    mEngineClient = true;
+  }
+  if (engine.isReady()) {
+    mStreamReady.store(true, std::memory_order_release);
     return;
   }
 
-  mStream = StreamPtr(rawStream);
-  auto* stream = mStream.get();
-  mSampleRate = static_cast<double>(stream->getSampleRate());
+  // Nothing renders this voice while the engine stream is down, so its
+  // oscillator can be reset before the stream comes back.
   mPhase = 0.0;
   mFrequency.store(toneHz, std::memory_order_relaxed);
+  mOscillatorHz = toneHz;
+  mGlideTargetHz = toneHz;
   mTargetGain.store(0.0f, std::memory_order_relaxed);
   mCurrentGain.store(0.0f, std::memory_order_relaxed);
-
-  const int32_t burst = stream->getFramesPerBurst();
-  if (burst > 0) {
-    stream->setBufferSizeInFrames(burst);
-  }
-
-  logEvent("stream.open", "sampleRate=%.1f burst=%d api=%d",
-           mSampleRate,
-           burst,
-           static_cast<int>(stream->getAudioApi()));
-
-  startStreamLocked();
-}
-
-void OutputsAudio::startStreamLocked() {
-  auto* stream = mStream.get();
-  if (stream == nullptr) {
-    return;
-  }
-
-  const oboe::Result result = stream->requestStart();
-  if (result != oboe::Result::OK) {
-    logEvent("stream.start.failed", "error=%s", oboe::convertToText(result));
-    mStreamReady.store(false, std::memory_order_release);
-    return;
-  }
-
-  mStreamReady.store(true, std::memory_order_release);
+  mStreamReady.store(engine.start(), std::memory_order_release);
 }
 
-void OutputsAudio::closeStreamLocked() {
-  auto* stream = mStream.get();
-  if (stream == nullptr) {
+void OutputsAudio::releaseEngineLocked() {
+  if (!mEngineClient) {
     return;
   }
-
-  if (mStreamReady.load(std::memory_order_acquire)) {
-    const oboe::Result stopResult = stream->requestStop();
-    if (stopResult != oboe::Result::OK) {
-      logEvent("stream.stop.failed", "error=%s", oboe::convertToText(stopResult));
-    }
-  }
-
-  mStream.reset();
+  AudioEngine::shared().release(this);
+  mEngineClient = false;
   mStreamReady.store(false, std::memory_order_release);
   mTargetGain.store(0.0f, std::memory_order_relaxed);
   mCurrentGain.store(0.0f, std::memory_order_relaxed);
@@ -447,10 +524,11 @@ OutputsAudio::EnvelopeConfig OutputsAudio::resolveEnvelope(
 }
 
 float OutputsAudio::computeRampStep(float magnitude, float durationMs) const {
-  if (durationMs <= 0.0f || mSampleRate <= 0.0) {
+  const double sampleRate = AudioEngine::shared().sampleRate();
+  if (durationMs <= 0.0f || sampleRate <= 0.0) {
     return magnitude;
   }
-  const double frames = std::max(1.0, (mSampleRate * static_cast<double>(durationMs)) / 1000.0);
+  const double frames = std::max(1.0, (sampleRate * static_cast<double>(durationMs)) / 1000.0);
   return magnitude / static_cast<float>(frames);
 }
 
@@ -460,24 +538,49 @@ void OutputsAudio::startToneInternal(const ToneStartOptions& options, bool cance
   }
 
   if (cancelPlayback) {
-    cancelPlaybackThread(true);
-  }
+    cancelPlaybackThread(false);
+  }
+  const uint32_t correlationTag =
+      options.correlationId.has_value() ? CorrelationLog::shared().intern(options.correlationId.value()) : 0;
+  startResolvedTone(options.toneHz,
+                    resolveGain(options.gain),
+                    resolveEnvelope(options.envelope),
+                    0.0,
+                    correlationTag);
+}
+
+void OutputsAudio::startResolvedTone(double toneHz,
+                                     float gain,
+                                     const EnvelopeConfig& envelope,
+                                     double expectedStartMs,
+                                     uint32_t correlationTag) {
+  std::lock_guard<std::mutex> lock(mStreamMutex);
+  startResolvedToneLocked(toneHz, gain, envelope, expectedStartMs, 0, 0, correlationTag);
+}
 
+void OutputsAudio::startResolvedToneLocked(double toneHz,
+                                           float gain,
+                                           const EnvelopeConfig& envelope,
+                                           double expectedStartMs,
+                                           uint64_t sequence,
+                                           uint64_t generation,
+                                           uint32_t correlationTag) {
   const double requestedAtMs = toMillis(std::chrono::steady_clock::now());
   mToneStartRequestedMs.store(requestedAtMs, std::memory_order_relaxed);
   mToneActualStartMs.store(0.0, std::memory_order_relaxed);
+  mToneExpectedStartMs.store(expectedStartMs, std::memory_order_relaxed);
+  mToneSequence.store(sequence, std::memory_order_relaxed);
+  mToneGeneration.store(generation, std::memory_order_relaxed);
+  mToneCorrelationTag.store(correlationTag, std::memory_order_relaxed);
   mToneStartLogged.store(false, std::memory_order_relaxed);
   mToneSteadyLogged.store(false, std::memory_order_relaxed);
   mToneStopLogged.store(false, std::memory_order_relaxed);
 
-  std::lock_guard<std::mutex> lock(mStreamMutex);
-  ensureStreamLocked(options.toneHz);
+  ensureStreamLocked(toneHz);
   if (!mStreamReady.load(std::memory_order_acquire)) {
     return;
   }
 
-  const float gain = resolveGain(options.gain);
-  const EnvelopeConfig envelope = resolveEnvelope(options.envelope);
   mEnvelopeConfig = envelope;
 
   const float current = mCurrentGain.load(std::memory_order_relaxed);
@@ -487,34 +590,138 @@ void OutputsAudio::startToneInternal(const ToneStartOptions& options, bool cance
 
   mGainStepUp.store(rampUpStep, std::memory_order_relaxed);
   mGainStepDown.store(rampDownStep, std::memory_order_relaxed);
-  mFrequency.store(options.toneHz, std::memory_order_relaxed);
+  mFrequency.store(toneHz, std::memory_order_relaxed);
   mTargetGain.store(gain, std::memory_order_release);
   mToneActive.store(true, std::memory_order_release);
 
   logEvent("start", "hz=%.1f gain=%.3f attack=%.2f release=%.2f",
-           options.toneHz,
+           toneHz,
            gain,
            envelope.attackMs,
            envelope.releaseMs);
   logEvent("tone.request", "hz=%.1f gain=%.3f requestedAt=%.3f",
-           options.toneHz,
+           toneHz,
            gain,
            requestedAtMs);
 }
 
-void OutputsAudio::warmup(const WarmupOptions& options) {
-  if (!isSupported()) {
-    return;
-  }
+bool OutputsAudio::warmStream(double toneHz) {
   std::lock_guard<std::mutex> lock(mStreamMutex);
-  ensureStreamLocked(options.toneHz);
+  ensureStreamLocked(toneHz);
   if (!mStreamReady.load(std::memory_order_acquire)) {
-    return;
+    return false;
   }
-  mFrequency.store(options.toneHz, std::memory_order_relaxed);
+  mFrequency.store(toneHz, std::memory_order_relaxed);
   mTargetGain.store(0.0f, std::memory_order_relaxed);
   mCurrentGain.store(0.0f, std::memory_order_relaxed);
-  logEvent("warmup", "hz=%.1f", options.toneHz);
+  return true;
+}
+
+void OutputsAudio::warmup(const WarmupOptions& options) {
+  const double startedAtMs = toMillis(std::chrono::steady_clock::now());
+  if (!isSupported()) {
+    mWarmupState.store(WarmupState::Unsupported, std::memory_order_release);
+    return;
+  }
+  const bool ready = warmStream(options.toneHz);
+  mWarmupElapsedMs.store(toMillis(std::chrono::steady_clock::now()) - startedAtMs, std::memory_order_relaxed);
+  mWarmupState.store(ready ? WarmupState::Ready : WarmupState::Failed, std::memory_order_release);
+  if (ready) {
+    logEvent("warmup", "hz=%.1f", options.toneHz);
+  }
+}
+
+std::shared_ptr<Promise<bool>> OutputsAudio::isSupportedAsync() {
+  if (mSupportKnown.load(std::memory_order_acquire)) {
+    auto promise = Promise<bool>::create();
+    promise->resolve(mSupported);
+    return promise;
+  }
+  // The probe runs on the engine, which is never destroyed; the result is
+  // published like isSupported() does only if this object is still alive.
+  std::weak_ptr<HybridObject> weakSelf = weak_from_this();
+  return Promise<bool>::async([weakSelf]() {
+    const bool supported = AudioEngine::shared().isSupported();
+    if (auto self = std::dynamic_pointer_cast<OutputsAudio>(weakSelf.lock())) {
+      std::lock_guard<std::mutex> lock(self->mStreamMutex);
+      if (!self->mSupportKnown.load(std::memory_order_relaxed)) {
+        self->mSupported = supported;
+        self->mSupportKnown.store(true, std::memory_order_release);
+      }
+    }
+    return supported;
+  });
+}
+
+std::shared_ptr<Promise<bool>> OutputsAudio::warmupAsync(const WarmupOptions& options) {
+  std::lock_guard<std::mutex> lock(mWarmupMutex);
+  if (mWarmupThread.joinable()) {
+    const WarmupState state = mWarmupState.load(std::memory_order_acquire);
+    if (state == WarmupState::Probing || state == WarmupState::Opening) {
+      return mWarmupPromise;
+    }
+    mWarmupThread.join();
+  }
+  auto promise = Promise<bool>::create();
+  mWarmupPromise = promise;
+  mWarmupState.store(WarmupState::Probing, std::memory_order_release);
+  const double toneHz = options.toneHz;
+  // The probe and the first open can take a few hundred ms on some devices;
+  // JS gets a promise and keeps rendering. Joined by the next warmupAsync or
+  // by teardown.
+  mWarmupThread = std::thread([this, promise, toneHz]() {
+    const double startedAtMs = toMillis(std::chrono::steady_clock::now());
+    bool ready = false;
+    WarmupState state = WarmupState::Unsupported;
+    if (isSupported()) {
+      mWarmupState.store(WarmupState::Opening, std::memory_order_release);
+      ready = warmStream(toneHz);
+      state = ready ? WarmupState::Ready : WarmupState::Failed;
+    }
+    const double elapsedMs = toMillis(std::chrono::steady_clock::now()) - startedAtMs;
+    mWarmupElapsedMs.store(elapsedMs, std::memory_order_relaxed);
+    {
+      // Published under the mutex so a concurrent warmupAsync either shares
+      // this promise or starts after it has settled.
+      std::lock_guard<std::mutex> warmupLock(mWarmupMutex);
+      mWarmupState.store(state, std::memory_order_release);
+    }
+    logEvent("warmup.async", "hz=%.1f ready=%d elapsed=%.1f", toneHz, ready ? 1 : 0, elapsedMs);
+    promise->resolve(ready);
+  });
+  return promise;
+}
+
+std::optional<std::string> OutputsAudio::getWarmupStatus() {
+  const char* state = "idle";
+  switch (mWarmupState.load(std::memory_order_acquire)) {
+    case WarmupState::Idle:
+      state = "idle";
+      break;
+    case WarmupState::Probing:
+      state = "probing";
+      break;
+    case WarmupState::Opening:
+      state = "opening";
+      break;
+    case WarmupState::Ready:
+      state = "ready";
+      break;
+    case WarmupState::Unsupported:
+      state = "unsupported";
+      break;
+    case WarmupState::Failed:
+      state = "failed";
+      break;
+  }
+  std::ostringstream stream;
+  stream.setf(std::ios::fixed, std::ios::floatfield);
+  stream << std::setprecision(1) << "{\"state\":\"" << state << "\""
+         << ",\"elapsedMs\":" << mWarmupElapsedMs.load(std::memory_order_relaxed)
+         << ",\"supportKnown\":" << (mSupportKnown.load(std::memory_order_acquire) ? "true" : "false")
+         << ",\"streamReady\":" << (mStreamReady.load(std::memory_order_acquire) ? "true" : "false")
+         << ",\"capabilities\":" << AudioCapabilityCache::shared().toJson() << "}";
+  return stream.str();
 }
 
 void OutputsAudio::startTone(const ToneStartOptions& options) {
@@ -527,72 +734,65 @@ void OutputsAudio::stopTone() {
   }
 
   std::lock_guard<std::mutex> lock(mStreamMutex);
+  stopToneLocked(mEnvelopeConfig.releaseMs);
+}
+
+void OutputsAudio::stopToneLocked(float releaseMs) {
   if (!mStreamReady.load(std::memory_order_acquire)) {
     return;
   }
 
   const float current = mCurrentGain.load(std::memory_order_relaxed);
-  const float rampDownStep = computeRampStep(std::max(current, 0.0f), mEnvelopeConfig.releaseMs);
+  const float rampDownStep = computeRampStep(std::max(current, 0.0f), releaseMs);
   mGainStepDown.store(rampDownStep, std::memory_order_relaxed);
   mTargetGain.store(0.0f, std::memory_order_release);
   mToneActive.store(false, std::memory_order_release);
   mToneSteadyLogged.store(false, std::memory_order_relaxed);
   mToneStopLogged.store(false, std::memory_order_relaxed);
-  logEvent("stop", "gain=%.3f release=%.2f", current, mEnvelopeConfig.releaseMs);
+  logEvent("stop", "gain=%.3f release=%.2f", current, releaseMs);
 }
 
 bool OutputsAudio::setFlashOverlayState(bool enabled, double brightnessPercent) {
   const double clamped = std::clamp(brightnessPercent, 0.0, 100.0);
-  if (enabled) {
-    constexpr double kAwaitTimeoutMs = 180.0;
-    if (!awaitNativeOverlayReady(kAwaitTimeoutMs)) {
-      logEvent("overlay.await.timeout", "timeout=%.1f", kAwaitTimeoutMs);
-      mNativeOverlayAvailable.store(false, std::memory_order_release);
+  if (enabled && !overlayReady()) {
+    // Joins the preparation playMorse may already have started; once the
+    // overlay is known ready there is nothing to wait for.
+    const auto ready = prepareOverlay();
+    const auto timeout = std::chrono::duration<double, std::milli>(kOverlayPrepareTimeoutMs);
+    if (ready.wait_for(timeout) != std::future_status::ready) {
+      logEvent("overlay.await.timeout", "timeout=%.1f", kOverlayPrepareTimeoutMs);
+      return false;
+    }
+    if (!ready.get()) {
+      logEvent("overlay.external.enable_failed", "brightness=%.1f unavailable=1", clamped);
       return false;
     }
   }
   const bool success = setNativeFlashOverlayState(enabled, clamped);
   if (enabled) {
-    mNativeOverlayAvailable.store(success, std::memory_order_release);
     mNativeOverlayActive.store(success, std::memory_order_release);
     mExternalOverlayActive.store(success, std::memory_order_release);
-    if (success) {
-      logEvent("overlay.external.enable", "brightness=%.1f", clamped);
-    } else {
-      const auto overlayDebug = getNativeOverlayAvailabilityDebugString();
-      if (!overlayDebug.empty()) {
-        logEvent("overlay.external.enable_failed",
-                 "brightness=%.1f %s",
-                 clamped,
-                 overlayDebug.c_str());
-      } else {
-        logEvent("overlay.external.enable_failed", "brightness=%.1f", clamped);
-      }
-    }
   } else {
     mExternalOverlayActive.store(false, std::memory_order_release);
-    if (success) {
-      logEvent("overlay.external.disable", "brightness=%.1f", clamped);
-    } else {
-      const auto overlayDebug = getNativeOverlayAvailabilityDebugString();
-      if (!overlayDebug.empty()) {
-        logEvent("overlay.external.disable_failed",
-                 "brightness=%.1f %s",
-                 clamped,
-                 overlayDebug.c_str());
-      } else {
-        logEvent("overlay.external.disable_failed", "brightness=%.1f", clamped);
-      }
-    }
     mNativeOverlayActive.store(false, std::memory_order_release);
   }
-  if (!success) {
-    mNativeOverlayAvailable.store(false, std::memory_order_release);
+  if (success) {
+    // A disable succeeds even with no view attached, so only an enable proves
+    // the overlay works.
     if (enabled) {
-      mExternalOverlayActive.store(false, std::memory_order_release);
+      mOverlayReadiness.store(OverlayReadiness::Ready, std::memory_order_release);
     }
+    logEvent(enabled ? "overlay.external.enable" : "overlay.external.disable", "brightness=%.1f", clamped);
+    return true;
   }
-  return success;
+  const char* event = enabled ? "overlay.external.enable_failed" : "overlay.external.disable_failed";
+  const auto overlayDebug = markOverlayUnavailable() ? getNativeOverlayAvailabilityDebugString() : std::string();
+  if (!overlayDebug.empty()) {
+    logEvent(event, "brightness=%.1f %s", clamped, overlayDebug.c_str());
+  } else {
+    logEvent(event, "brightness=%.1f", clamped);
+  }
+  return false;
 }
 
 bool OutputsAudio::setFlashOverlayAppearance(double brightnessPercent, double colorArgb) {
@@ -648,77 +848,424 @@ void OutputsAudio::setScreenBrightnessBoost(bool enabled) {
   logEvent("overlay.external.brightness_boost", "enabled=%d", enabled ? 1 : 0);
 }
 
-void OutputsAudio::cancelPlaybackThread(bool join) {
-  std::thread localThread;
+bool OutputsAudio::configureKeyer(double toneHz,
+                                  double unitMs,
+                                  const std::string& mode,
+                                  double weighting,
+                                  const std::optional<double>& gain) {
+  const auto parsedMode = parseKeyerMode(mode);
+  if (!parsedMode.has_value() || !std::isfinite(toneHz) || toneHz <= 0.0 || !std::isfinite(unitMs) ||
+      unitMs <= 0.0) {
+    logEvent("keyer.configure.rejected", "hz=%.1f unit=%.1f mode=%s", toneHz, unitMs, mode.c_str());
+    return false;
+  }
+  if (!isSupported()) {
+    return false;
+  }
+
+  const float resolvedGain = resolveGain(gain);
+  const double resolvedWeighting = std::isfinite(weighting) ? weighting : 0.5;
   {
-    std::lock_guard<std::mutex> lock(mPlaybackMutex);
-    if (!mPlaybackThread.joinable()) {
-      mPlaybackRunning.store(false, std::memory_order_release);
-      mPlaybackCancel.store(false, std::memory_order_release);
-      resetSymbolInfo();
-      setNativeTorchEnabled(false);
-      const bool externalOverlay = mExternalOverlayActive.load(std::memory_order_acquire);
-      if (mNativeOverlayAvailable.load(std::memory_order_relaxed) && !externalOverlay) {
-        setNativeFlashOverlayState(false, kPulsePercentOff);
-        mNativeOverlayActive.store(false, std::memory_order_release);
-      }
-      if (!externalOverlay) {
-        mScreenBrightnessBoostEnabled.store(false, std::memory_order_release);
-        setNativeScreenBrightnessBoost(false);
-      }
-      return;
+    std::lock_guard<std::mutex> lock(mStreamMutex);
+    ensureStreamLocked(toneHz);
+    if (!mStreamReady.load(std::memory_order_acquire)) {
+      logEvent("keyer.configure.skip", "stream=closed");
+      return false;
+    }
+    mKeyerToneHz = toneHz;
+    mKeyerGain.store(resolvedGain, std::memory_order_relaxed);
+    mKeyerStepUp.store(computeRampStep(resolvedGain, kDefaultAttackMs), std::memory_order_relaxed);
+    mKeyerStepDown.store(computeRampStep(resolvedGain, kDefaultReleaseMs), std::memory_order_relaxed);
+    if (mKeyer.isEnabled()) {
+      mFrequency.store(toneHz, std::memory_order_relaxed);
     }
-    mPlaybackCancel.store(true, std::memory_order_release);
-    localThread = std::move(mPlaybackThread);
   }
+  mKeyer.configure(KeyerEngine::Config{ unitMs, parsedMode.value(), resolvedWeighting, 3.0 });
+  logEvent("keyer.configure",
+           "hz=%.1f unit=%.1f mode=%s weighting=%.2f gain=%.3f",
+           toneHz,
+           unitMs,
+           mode.c_str(),
+           resolvedWeighting,
+           resolvedGain);
+  return true;
+}
 
-  if (localThread.joinable()) {
-    if (join && localThread.get_id() != std::this_thread::get_id()) {
-      localThread.join();
-    } else {
-      localThread.detach();
-    }
+bool OutputsAudio::setKeyerEnabled(bool enabled) {
+  if (!enabled) {
+    mKeyer.setEnabled(false);
+    logEvent("keyer.disable");
+    return true;
+  }
+  if (!isSupported()) {
+    return false;
   }
+  // Replay and keyer share the sidetone oscillator; a running pattern would
+  // otherwise fight the keyer for the gain target.
+  cancelPlaybackThread(false);
+  std::lock_guard<std::mutex> lock(mStreamMutex);
+  ensureStreamLocked(mKeyerToneHz);
+  if (!mStreamReady.load(std::memory_order_acquire)) {
+    logEvent("keyer.enable.skip", "stream=closed");
+    return false;
+  }
+  mFrequency.store(mKeyerToneHz, std::memory_order_relaxed);
+  mKeyer.setEnabled(true);
+  logEvent("keyer.enable", "hz=%.1f", mKeyerToneHz);
+  return true;
+}
 
-  mPlaybackRunning.store(false, std::memory_order_release);
-  mPlaybackCancel.store(false, std::memory_order_release);
-  resetSymbolInfo();
-  setNativeTorchEnabled(false);
-  const bool externalOverlay = mExternalOverlayActive.load(std::memory_order_acquire);
-  if (mNativeOverlayAvailable.load(std::memory_order_relaxed) && !externalOverlay) {
-    setNativeFlashOverlayState(false, kPulsePercentOff);
-    mNativeOverlayActive.store(false, std::memory_order_release);
+bool OutputsAudio::setKeyerPaddle(const std::string& paddle, bool down) {
+  const auto parsed = parseKeyerPaddle(paddle);
+  if (!parsed.has_value() || !mKeyer.isEnabled()) {
+    return false;
   }
-  if (!externalOverlay) {
-    mScreenBrightnessBoostEnabled.store(false, std::memory_order_release);
-    setNativeScreenBrightnessBoost(false);
+  // Live keying outranks replay: a pattern that started while the keyer was
+  // on (e.g. a prompt) is cut at the next frame rather than mixed under the
+  // sidetone.
+  if (down && mPlaybackRunning.load(std::memory_order_acquire)) {
+    cancelPlaybackThread(false);
+    logEvent("playMorse.preempt", "source=keyer paddle=%s", paddle.c_str());
+  }
+  if (!mKeyer.postPaddle(parsed.value(), down)) {
+    logEvent("keyer.paddle.dropped", "paddle=%s down=%d", paddle.c_str(), down ? 1 : 0);
+    return false;
   }
+  return true;
 }
 
-void OutputsAudio::resetSymbolInfo() {
+void OutputsAudio::resetPressClassifier(double unitMs) {
+  std::lock_guard<std::mutex> lock(mPressClassifierMutex);
+  mPressClassifier.reset(unitMs);
+  logEvent("classifier.reset", "unit=%.1f", unitMs);
+}
+
+std::optional<std::string> OutputsAudio::pushPressEdge(bool down, double timestampMs) {
+  std::vector<DecodedMorseEvent> events;
   {
-    std::lock_guard<std::mutex> lock(mSymbolInfoMutex);
-    mSymbolSequence = 0;
-    mPatternStartTimestampMs = 0.0;
-    mSymbolSnapshots.clear();
+    std::lock_guard<std::mutex> lock(mPressClassifierMutex);
+    if (down) {
+      mPressClassifier.keyDown(timestampMs, events);
+    } else {
+      mPressClassifier.keyUp(timestampMs);
+    }
   }
+  if (events.empty()) {
+    return std::nullopt;
+  }
+  return PressClassifier::toJson(events);
+}
+
+std::optional<std::string> OutputsAudio::flushPressClassifier(double nowMs) {
+  std::vector<DecodedMorseEvent> events;
   {
-    std::lock_guard<std::mutex> scheduleLock(mScheduleMutex);
-    mScheduledSymbols.clear();
+    std::lock_guard<std::mutex> lock(mPressClassifierMutex);
+    mPressClassifier.flush(nowMs, events);
+  }
+  if (events.empty()) {
+    return std::nullopt;
   }
+  return PressClassifier::toJson(events);
 }
 
-void OutputsAudio::playMorse(const PlaybackRequest& request) {
-  if (!isSupported()) {
-  logEvent("playMorse.skip", "unsupported=1");
-  return;
+std::optional<std::string> OutputsAudio::getPressClassifierState() {
+  std::lock_guard<std::mutex> lock(mPressClassifierMutex);
+  return PressClassifier::toJson(mPressClassifier.summarize());
 }
 
-  if (request.pattern.empty()) {
-    return;
+bool OutputsAudio::startCwReceiver(double toneHz, double unitMs) {
+  if (!(toneHz > 0.0) || !(unitMs > 0.0)) {
+    logEvent("receiver.start.invalid", "hz=%.1f unit=%.1f", toneHz, unitMs);
+    return false;
   }
+  std::lock_guard<std::mutex> lock(mCwReceiverMutex);
+  return mCwInput.start(toneHz, unitMs);
+}
 
-  const float gain = resolveGain(request.gain);
+void OutputsAudio::stopCwReceiver() {
+  std::lock_guard<std::mutex> lock(mCwReceiverMutex);
+  mCwInput.stop();
+}
+
+std::optional<std::string> OutputsAudio::pollCwReceiver() {
+  std::vector<DecodedMorseEvent> events;
+  {
+    std::lock_guard<std::mutex> lock(mCwReceiverMutex);
+    if (!mCwInput.isRunning()) {
+      return std::nullopt;
+    }
+    mCwReceiver.poll(events);
+  }
+  if (events.empty()) {
+    return std::nullopt;
+  }
+  return PressClassifier::toJson(events);
+}
+
+std::optional<std::string> OutputsAudio::getCwReceiverState() {
+  std::lock_guard<std::mutex> lock(mCwReceiverMutex);
+  if (!mCwInput.isRunning()) {
+    return std::nullopt;
+  }
+  return CwReceiver::toJson(mCwReceiver.summarize());
+}
+
+std::optional<std::string> OutputsAudio::decodeWavFile(const std::string& path, double toneHz, double unitMs) {
+  std::string error;
+  const auto wav = readWavFile(path, &error);
+  if (!wav.has_value()) {
+    logEvent("receiver.wav.failed", "path=%s error=%s", path.c_str(), error.c_str());
+    return std::nullopt;
+  }
+  // Offline decode runs on a private receiver so it never disturbs a live
+  // capture session.
+  CwReceiver receiver;
+  receiver.configure(CwReceiver::Config{ wav->sampleRate, toneHz, unitMs });
+  std::vector<DecodedMorseEvent> events;
+  receiver.process(wav->samples.data(), static_cast<int32_t>(wav->frames()), wav->channels, events);
+  receiver.finish(events);
+  logEvent("receiver.wav.decoded",
+           "path=%s frames=%lld events=%zu",
+           path.c_str(),
+           static_cast<long long>(wav->frames()),
+           events.size());
+  return PressClassifier::toJson(events);
+}
+
+std::optional<std::string> OutputsAudio::decodePileupWavFile(const std::string& path, double unitMs) {
+  std::string error;
+  const auto wav = readWavFile(path, &error);
+  if (!wav.has_value()) {
+    logEvent("pileup.wav.failed", "path=%s error=%s", path.c_str(), error.c_str());
+    return std::nullopt;
+  }
+  CwChannelizer channelizer;
+  channelizer.configure(CwChannelizer::Config{ wav->sampleRate, unitMs, 300.0, 2500.0, 16, 0 });
+  std::vector<CwChannelizer::ChannelEvent> events;
+  channelizer.process(wav->samples.data(), static_cast<int32_t>(wav->frames()), wav->channels, events);
+  channelizer.finish(events);
+  logEvent("pileup.wav.decoded",
+           "path=%s frames=%lld events=%zu threads=%zu",
+           path.c_str(),
+           static_cast<long long>(wav->frames()),
+           events.size(),
+           channelizer.concurrency());
+  return CwChannelizer::toJson(events);
+}
+
+std::optional<std::string> OutputsAudio::getLatencyHistograms() {
+  return LatencyHistograms::shared().toJson();
+}
+
+void OutputsAudio::resetLatencyHistograms() {
+  LatencyHistograms::shared().reset();
+  logEvent("histograms.reset");
+}
+
+std::optional<std::string> OutputsAudio::getBridgeStats() {
+  return getNativeBridgeStatsJson();
+}
+
+void OutputsAudio::resetBridgeStats() {
+  resetNativeBridgeStats();
+  logEvent("bridge.stats.reset");
+}
+
+bool OutputsAudio::startTrace(const std::string& path, double capacityEvents) {
+  std::string error;
+  const auto capacity = static_cast<std::size_t>(std::max(0.0, capacityEvents));
+  if (!TraceRecorder::shared().start(path, capacity, error)) {
+    logEvent("trace.start.failed", "path=%s error=%s", path.c_str(), error.c_str());
+    return false;
+  }
+  logEvent("trace.start", "path=%s capacity=%zu", path.c_str(), capacity);
+  return true;
+}
+
+void OutputsAudio::stopTrace() {
+  TraceRecorder::shared().stop();
+  logEvent("trace.stop");
+}
+
+bool OutputsAudio::exportTrace(const std::string& jsonPath) {
+  std::string error;
+  if (!TraceRecorder::shared().exportChromeTrace(jsonPath, error)) {
+    logEvent("trace.export.failed", "path=%s error=%s", jsonPath.c_str(), error.c_str());
+    return false;
+  }
+  logEvent("trace.export", "path=%s", jsonPath.c_str());
+  return true;
+}
+
+void OutputsAudio::cancelPlaybackThread(bool join) {
+  // Cancelling is a request, not a handshake: the run id bump below is what
+  // stops the pattern thread, which notices it within one sleep quantum and
+  // exits without touching shared state again. Everything done here is an
+  // atomic store or a push onto the actuator queue, so a JS caller never waits
+  // on the old thread or on JNI: the thread is detached and the run id keeps
+  // it off shared state. Only teardown (join) blocks until every pattern
+  // thread has exited.
+  // Commands queued ahead by the cancelled pattern are dropped by the actuator
+  // thread once their generation no longer matches.
+  mActuatorGeneration.fetch_add(1, std::memory_order_acq_rel);
+  mPlaybackRunId.fetch_add(1, std::memory_order_acq_rel);
+  bool wasRunning = false;
+  {
+    std::lock_guard<std::mutex> lock(mPlaybackMutex);
+    if (mPlaybackThread.joinable()) {
+      wasRunning = true;
+      mPlaybackThread.detach();
+    }
+  }
+  if (wasRunning) {
+    {
+      // Taken so a paused playback thread cannot miss the wake-up.
+      std::lock_guard<std::mutex> controlLock(mPlaybackControlMutex);
+    }
+    mPlaybackControlCondition.notify_all();
+    // The stale thread can no longer touch the oscillator; release whatever
+    // mark it left sounding with a short ramp the callback applies from its
+    // next frame.
+    std::lock_guard<std::mutex> streamLock(mStreamMutex);
+    stopToneLocked(kCancelReleaseMs);
+  }
+
+  if (join) {
+    std::unique_lock<std::mutex> lock(mPlaybackMutex);
+    const uint32_t self = tIsPlaybackThread ? 1 : 0;
+    mPlaybackThreadsDone.wait(lock, [this, self]() { return mLivePlaybackThreads <= self; });
+  }
+
+  mPlaybackRunning.store(false, std::memory_order_release);
+  resetSymbolInfo();
+  {
+    std::lock_guard<std::mutex> controlLock(mPlaybackControlMutex);
+    mPauseRequested = false;
+    mPlaybackPaused = false;
+    mSeekTarget = PlaybackSeekTarget::None;
+    mPlaybackControlPending.store(false, std::memory_order_release);
+  }
+  // Listener-less, so that on teardown they still run after the destructor
+  // has detached this object.
+  if (mHapticWaveformActive.exchange(false, std::memory_order_acq_rel)) {
+    submitCleanupCommand(ActuatorCommandType::CancelVibration);
+  }
+  submitCleanupCommand(ActuatorCommandType::Torch);
+  const bool externalOverlay = mExternalOverlayActive.load(std::memory_order_acquire);
+  if (overlayReady() && !externalOverlay) {
+    submitCleanupCommand(ActuatorCommandType::OverlayState, kPulsePercentOff);
+    mNativeOverlayActive.store(false, std::memory_order_release);
+  }
+  if (!externalOverlay) {
+    mScreenBrightnessBoostEnabled.store(false, std::memory_order_release);
+    submitCleanupCommand(ActuatorCommandType::BrightnessBoost);
+  }
+  if (wasRunning) {
+    logEvent("playMorse.cancel", "join=%d", join ? 1 : 0);
+  }
+}
+
+std::shared_future<bool> OutputsAudio::prepareOverlay() {
+  std::lock_guard<std::mutex> lock(mOverlayPrepareMutex);
+  if (mOverlayPrepareThread.joinable()) {
+    if (mOverlayReadyFuture.wait_for(std::chrono::milliseconds(0)) != std::future_status::ready) {
+      return mOverlayReadyFuture;
+    }
+    mOverlayPrepareThread.join();
+  }
+  OverlayReadiness expected = OverlayReadiness::Unavailable;
+  mOverlayReadiness.compare_exchange_strong(expected, OverlayReadiness::Pending, std::memory_order_acq_rel);
+  std::promise<bool> promise;
+  mOverlayReadyFuture = promise.get_future().share();
+  // awaitOverlayReady polls the main thread for up to the full budget, so it
+  // runs here rather than on the JS thread. The thread is joined by the next
+  // preparation or by teardown.
+  mOverlayPrepareThread = std::thread([this, promise = std::move(promise)]() mutable {
+    const double startedAtMs = toMillis(std::chrono::steady_clock::now());
+    const bool ready = awaitNativeOverlayReady(kOverlayPrepareTimeoutMs) &&
+                       setNativeFlashOverlayState(false, kPulsePercentOff);
+    const double elapsedMs = toMillis(std::chrono::steady_clock::now()) - startedAtMs;
+    if (ready) {
+      mOverlayReadiness.store(OverlayReadiness::Ready, std::memory_order_release);
+      logEvent("overlay.prepare.ready", "elapsed=%.1f", elapsedMs);
+    } else {
+      const auto overlayDebug = markOverlayUnavailable() ? getNativeOverlayAvailabilityDebugString() : std::string();
+      if (!overlayDebug.empty()) {
+        logEvent("overlay.prepare.failed", "elapsed=%.1f %s", elapsedMs, overlayDebug.c_str());
+      } else {
+        logEvent("overlay.prepare.failed", "elapsed=%.1f", elapsedMs);
+      }
+      if (mScreenBrightnessBoostEnabled.exchange(false, std::memory_order_acq_rel)) {
+        submitActuatorCommand(ActuatorCommandType::BrightnessBoost, false, 0.0, 0.0, 0.0, 0,
+                              mActuatorGeneration.load(std::memory_order_acquire));
+      }
+    }
+    promise.set_value(ready);
+  });
+  return mOverlayReadyFuture;
+}
+
+bool OutputsAudio::markOverlayUnavailable() {
+  return mOverlayReadiness.exchange(OverlayReadiness::Unavailable, std::memory_order_acq_rel) !=
+         OverlayReadiness::Unavailable;
+}
+
+void OutputsAudio::resetSymbolInfo() {
+  {
+    std::lock_guard<std::mutex> lock(mSymbolInfoMutex);
+    mSymbolSequence = 0;
+    mPatternStartTimestampMs = 0.0;
+    mSymbolSnapshots.clear();
+  }
+  {
+    std::lock_guard<std::mutex> scheduleLock(mScheduleMutex);
+    mScheduleWindow.clear();
+  }
+}
+
+OutputsAudio::ChannelLeads OutputsAudio::resolveChannelLeads(bool torchEnabled,
+                                                             bool overlayEnabled,
+                                                             bool hapticsEnabled) const {
+  auto& tracker = ChannelLatencyTracker::shared();
+  ChannelLeads leads{};
+  leads.toneMs = std::clamp(tracker.estimateMs(OutputChannel::Tone, kToneStartLeadMs), 0.0, kMaxToneLeadMs);
+  leads.torchMs = torchEnabled
+                      ? std::clamp(tracker.estimateMs(OutputChannel::Torch, 0.0), 0.0, kMaxChannelLeadMs)
+                      : 0.0;
+  leads.overlayMs = overlayEnabled
+                        ? std::clamp(tracker.estimateMs(OutputChannel::Overlay, 0.0), 0.0, kMaxChannelLeadMs)
+                        : 0.0;
+  leads.hapticsMs = hapticsEnabled
+                        ? std::clamp(tracker.estimateMs(OutputChannel::Haptics, 0.0), 0.0, kMaxChannelLeadMs)
+                        : 0.0;
+  leads.preRollMs = std::max({ leads.toneMs, leads.torchMs, leads.overlayMs, leads.hapticsMs });
+  leads.routeShiftMs = std::clamp(AudioRouteProfiles::shared().audibleLatencyMs(), 0.0, kMaxRouteShiftMs);
+  return leads;
+}
+
+void OutputsAudio::playMorse(const PlaybackRequest& request) {
+  if (request.pattern.empty()) {
+    return;
+  }
+  startPattern(request, nullptr);
+}
+
+void OutputsAudio::playMorseCode(const PlaybackRequest& request, const std::string& code) {
+  // request.pattern is ignored; character and word gaps come from the text,
+  // which is what lets seekPlaybackToCharacter find character boundaries.
+  if (code.find_first_of(".-") == std::string::npos) {
+    return;
+  }
+  startPattern(request, &code);
+}
+
+void OutputsAudio::startPattern(const PlaybackRequest& request, const std::string* code) {
+  if (!isSupported()) {
+  logEvent("playMorse.skip", "unsupported=1");
+  return;
+}
+
+  const float gain = resolveGain(request.gain);
   {
     std::lock_guard<std::mutex> lock(mStreamMutex);
     ensureStreamLocked(request.toneHz);
@@ -727,159 +1274,536 @@ void OutputsAudio::playMorse(const PlaybackRequest& request) {
       return;
     }
   }
+  // Before the overlay is prepared below: this queues the hide for whatever
+  // the previous pattern left on screen.
+  cancelPlaybackThread(false);
+
+  const bool flashRequested = request.flashEnabled.value_or(false);
+  const ChannelLeads leads = resolveChannelLeads(request.torchEnabled.value_or(false),
+                                                 flashRequested,
+                                                 request.hapticsEnabled.value_or(false));
+  mPatternRouteShiftMs.store(leads.routeShiftMs, std::memory_order_relaxed);
 
+  // Symbols start one pre-roll after the pattern origin so the slowest enabled
+  // channel can be dispatched ahead of the first tone.
   const auto patternStart = std::chrono::steady_clock::now();
   const double patternStartMs = toMillis(patternStart);
-  std::vector<ScheduledSymbol> scheduledSymbols;
-  scheduledSymbols.reserve(request.pattern.size());
-  double expectedOffsetMs = 0.0;
-  uint64_t scheduledSequence = 0;
-  for (std::size_t i = 0; i < request.pattern.size(); ++i) {
-    const PlaybackSymbol symbol = request.pattern[i];
-    const int symbolValue = static_cast<int>(symbol);
-    const bool isDash = symbolValue == 1;
-    const bool isDot = symbolValue == 0;
-
-    if (!isDash && !isDot) {
-      expectedOffsetMs += request.unitMs * 3.0;
-      continue;
-    }
-
-    const double symbolDurationMs =
-        request.unitMs * (isDash ? static_cast<double>(kDashUnits) : 1.0);
-
-    ScheduledSymbol info;
-    info.sequence = ++scheduledSequence;
-    info.symbol = symbol;
-    info.expectedTimestampMs = patternStartMs + expectedOffsetMs;
-    info.durationMs = symbolDurationMs;
-    info.offsetMs = expectedOffsetMs;
-    scheduledSymbols.push_back(info);
-
-    expectedOffsetMs += symbolDurationMs;
-    if (i + 1 < request.pattern.size()) {
-      expectedOffsetMs += request.unitMs * static_cast<double>(kSymbolGapUnits);
+  // Symbols are compiled lazily on the playback thread, so time-to-first-tone
+  // does not depend on the pattern length.
+  PatternTimeline timeline =
+      code != nullptr
+          ? PatternTimeline::fromCode(*code, request.unitMs, leads.preRollMs, patternStartMs)
+          : PatternTimeline(request.pattern, request.unitMs, leads.preRollMs, patternStartMs);
+  // Ids are interned here, on the JS thread; only tags reach the playback
+  // thread.
+  std::vector<uint32_t> correlationTags;
+  if (request.correlationIds.has_value()) {
+    const auto& ids = request.correlationIds.value();
+    correlationTags.reserve(std::min(ids.size(), timeline.symbolCount()));
+    auto& correlationLog = CorrelationLog::shared();
+    for (std::size_t i = 0; i < ids.size() && i < timeline.symbolCount(); ++i) {
+      correlationTags.push_back(correlationLog.intern(ids[i]));
     }
   }
-  {
-    std::lock_guard<std::mutex> scheduleLock(mScheduleMutex);
-    mScheduledSymbols = std::move(scheduledSymbols);
+  // Sized for a full window so haptic chunks never grow it mid-pattern.
+  std::vector<int64_t> hapticTimings;
+  if (request.hapticsEnabled.value_or(false)) {
+    hapticTimings.reserve(kScheduleWindowCapacity * 2);
   }
   {
     std::lock_guard<std::mutex> infoLock(mSymbolInfoMutex);
     mPatternStartTimestampMs = patternStartMs;
   }
 
-  mReplayFlashEnabled = request.flashEnabled.value_or(false);
+  mReplayFlashEnabled = flashRequested;
   mReplayHapticsEnabled = request.hapticsEnabled.value_or(false);
   mReplayTorchEnabled = request.torchEnabled.value_or(false);
   mReplayFlashBrightnessPercent = request.flashBrightnessPercent.value_or(0.0);
   bool screenBrightnessBoostEnabled =
       request.screenBrightnessBoost.value_or(false) && mReplayFlashEnabled;
   if (mReplayFlashEnabled) {
-    const bool overlayReady = setNativeFlashOverlayState(false, kPulsePercentOff);
-    mNativeOverlayAvailable.store(overlayReady, std::memory_order_release);
-    if (!overlayReady) {
-      const auto overlayDebug = getNativeOverlayAvailabilityDebugString();
-      if (!overlayDebug.empty()) {
-        logEvent("overlay.prepare.failed",
-                 "brightness=%.1f %s",
-                 mReplayFlashBrightnessPercent,
-                 overlayDebug.c_str());
-      } else {
-        logEvent("overlay.prepare.failed", "brightness=%.1f", mReplayFlashBrightnessPercent);
-      }
-      mNativeOverlayActive.store(false, std::memory_order_release);
-      screenBrightnessBoostEnabled = false;
-    }
+    // Not waited for: runPattern only queues pulses while the overlay is
+    // Ready, and symbols played before that are left to the JS flash.
+    prepareOverlay();
   } else {
-    mNativeOverlayAvailable.store(false, std::memory_order_release);
     mNativeOverlayActive.store(false, std::memory_order_release);
-    setNativeFlashOverlayState(false, kPulsePercentOff);
     screenBrightnessBoostEnabled = false;
   }
   mScreenBrightnessBoostEnabled.store(screenBrightnessBoostEnabled, std::memory_order_release);
+  if (screenBrightnessBoostEnabled) {
+    submitActuatorCommand(ActuatorCommandType::BrightnessBoost, true, 0.0, 0.0, 0.0, 0,
+                          mActuatorGeneration.load(std::memory_order_acquire));
+  }
+  mRequestedUnitMs.store(0.0, std::memory_order_release);
+  mRequestedToneHz.store(0.0, std::memory_order_release);
+  mRequestedGlideMs.store(0.0, std::memory_order_relaxed);
+  mPatternSymbolCount.store(timeline.symbolCount(), std::memory_order_release);
+  mPatternCharacterCount.store(timeline.characterCount(), std::memory_order_release);
 
-  cancelPlaybackThread(true);
-  setNativeScreenBrightnessBoost(screenBrightnessBoostEnabled);
+  ReplayOutputs outputs{};
+  {
+    // The tone path rewrites the envelope under this lock.
+    std::lock_guard<std::mutex> streamLock(mStreamMutex);
+    outputs.envelope = mEnvelopeConfig;
+  }
+  outputs.torchEnabled = mReplayTorchEnabled;
+  outputs.hapticsEnabled = mReplayHapticsEnabled;
+  outputs.flashEnabled = mReplayFlashEnabled;
+  outputs.flashVisible = mReplayFlashEnabled && mReplayFlashBrightnessPercent > 0.0;
+  outputs.pulsePercent = mReplayFlashOverridePercent.has_value()
+                             ? std::clamp(mReplayFlashOverridePercent.value(), 0.0, 100.0)
+                             : std::clamp(mReplayFlashBrightnessPercent, 0.0, 100.0);
 
   {
     std::lock_guard<std::mutex> lock(mPlaybackMutex);
-    mPlaybackCancel.store(false, std::memory_order_release);
     mPlaybackRunning.store(true, std::memory_order_release);
+    const uint64_t generation = mActuatorGeneration.load(std::memory_order_acquire);
+    const uint64_t runId = mPlaybackRunId.load(std::memory_order_acquire);
+    mLivePlaybackThreads += 1;
     mPlaybackThread = std::thread(
         [this,
-         pattern = request.pattern,
+         timeline = std::move(timeline),
+         hapticTimings = std::move(hapticTimings),
+         correlationTags = std::move(correlationTags),
          toneHz = request.toneHz,
          gain,
          unitMs = request.unitMs,
+         leads,
+         outputs,
+         generation,
+         runId,
          patternStart]() mutable {
-          runPattern(std::move(pattern), toneHz, gain, unitMs, patternStart);
+          tIsPlaybackThread = true;
+          runPattern(std::move(timeline),
+                     std::move(hapticTimings),
+                     std::move(correlationTags),
+                     toneHz,
+                     gain,
+                     unitMs,
+                     leads,
+                     outputs,
+                     generation,
+                     runId,
+                     patternStart);
+          // Signalled only once the thread is gone, so teardown cannot free
+          // the object under it.
+          std::unique_lock<std::mutex> lock(mPlaybackMutex);
+          mLivePlaybackThreads -= 1;
+          std::notify_all_at_thread_exit(mPlaybackThreadsDone, std::move(lock));
         });
   }
 }
 
-void OutputsAudio::runPattern(std::vector<PlaybackSymbol> pattern,
+void OutputsAudio::runPattern(PatternTimeline timeline,
+                              std::vector<int64_t> hapticTimings,
+                              std::vector<uint32_t> correlationTags,
                               double toneHz,
                               float gain,
                               double unitMs,
+                              ChannelLeads leads,
+                              ReplayOutputs outputs,
+                              uint64_t generation,
+                              uint64_t runId,
                               std::chrono::steady_clock::time_point patternStart) {
-  logEvent("playMorse.start", "count=%zu unit=%.1f", pattern.size(), unitMs);
-  const bool replayTorchEnabled = mReplayTorchEnabled;
-  const bool replayHapticsEnabled = mReplayHapticsEnabled;
-
-  const auto sleepUntil = [&](const std::chrono::steady_clock::time_point& deadline) {
-    while (!mPlaybackCancel.load(std::memory_order_acquire) &&
-           std::chrono::steady_clock::now() < deadline) {
-      std::this_thread::sleep_for(kSleepQuantum);
-    }
-  };
-  const double patternStartMs = toMillis(patternStart);
-  double expectedOffsetMs = 0.0;
+  // Everything below runs after playMorse returned: the schedule window,
+  // haptic buffer and snapshot ring are all sized up front, so this thread
+  // must not touch the heap (checked in allocation-audit builds, counting this
+  // thread only).
+  AllocationAuditScope auditScope;
+  logEvent("playMorse.start",
+           "count=%zu unit=%.1f leadTone=%.3f leadTorch=%.3f leadOverlay=%.3f leadHaptics=%.3f route=%s shift=%.3f",
+           timeline.patternLength(),
+           unitMs,
+           leads.toneMs,
+           leads.torchMs,
+           leads.overlayMs,
+           leads.hapticsMs,
+           audioRouteName(AudioRouteProfiles::shared().activeRoute()),
+           leads.routeShiftMs);
+  const EnvelopeConfig patternEnvelope = outputs.envelope;
+  // Trims the tone lead from the skew of the symbols already played.
+  DriftCorrector drift;
+  const bool replayTorchEnabled = outputs.torchEnabled;
+  const bool replayHapticsEnabled = outputs.hapticsEnabled;
+  const bool replayFlashEnabled = outputs.flashEnabled;
+  const bool replayFlashVisible = outputs.flashVisible;
+  // A cancel does not wait for this thread. Once the run id moves on, the
+  // next pattern may already own the window, snapshots, oscillator and
+  // actuator generation, so every write below re-checks under its lock.
+  const auto cancelled = [&]() { return mPlaybackRunId.load(std::memory_order_acquire) != runId; };
+
+  // Not const: pause/resume and seeks move the origin (see applyControl).
+  double patternStartMs = toMillis(patternStart);
   double previousExpectedStartMs = patternStartMs;
   double previousActualStartMs = patternStartMs;
   double previousExpectedEndOffsetMs = 0.0;
   bool isFirstSymbol = true;
+  bool overlayRequested = false;
+  // Glide for a setPlaybackToneHz pitch, applied with the next mark start.
+  double pendingGlideMs = 0.0;
+  // Character whose start was reported and whose end was not yet; a seek can
+  // land mid-character, so starts are keyed on the index changing rather
+  // than on the first mark.
+  constexpr uint32_t kNoCharacter = UINT32_MAX;
+  uint32_t openCharacter = kNoCharacter;
+  const double requestedPulsePercent = outputs.pulsePercent;
+
+  // Only the next kScheduleHorizonMs of the timeline is compiled into the
+  // window; it is topped up after every symbol, so startup cost and memory do
+  // not depend on the pattern length.
+  const auto compileThrough = [&](double horizonMs) {
+    std::lock_guard<std::mutex> scheduleLock(mScheduleMutex);
+    if (cancelled()) {
+      return;
+    }
+    while (!timeline.done() && mScheduleWindow.size() < kScheduleWindowCapacity &&
+           patternStartMs + timeline.nextOffsetMs() <= horizonMs) {
+      ScheduledSymbol symbol = timeline.next();
+      symbol.correlationTag =
+          symbol.sequence <= correlationTags.size() ? correlationTags[symbol.sequence - 1] : 0;
+      mScheduleWindow.push(symbol);
+    }
+  };
+
+  // Haptics are handed to the vibrator as waveforms built from the window, so
+  // the platform clocks every on/off edge instead of each symbol paying its
+  // own JNI and vibrator-service start latency. A chunk runs to the end of the
+  // window, cut back to the last gap long enough that the next chunk's lead
+  // cannot clip this one's final mark. Caller holds mScheduleMutex.
+  const double hapticSplitGapMs = leads.hapticsMs + kHapticChunkGuardMs;
+  const auto queueHapticChunkLocked = [&](std::size_t first) {
+    const std::size_t windowSize = mScheduleWindow.size();
+    const double chunkOriginMs = mScheduleWindow[first].offsetMs;
+    std::size_t last = windowSize - 1;
+    if (!timeline.done()) {
+      for (std::size_t j = windowSize - 1; j > first; --j) {
+        const ScheduledSymbol& before = mScheduleWindow[j - 1];
+        const double gapMs = mScheduleWindow[j].offsetMs - (before.offsetMs + before.durationMs);
+        if (gapMs >= hapticSplitGapMs && before.offsetMs + before.durationMs - chunkOriginMs >= kHapticChunkMinMs) {
+          last = j - 1;
+          break;
+        }
+      }
+    }
+    hapticTimings.clear();
+    // Edges are rounded against the chunk origin rather than per segment so
+    // millisecond rounding never accumulates across a long chunk.
+    int64_t previousEdgeMs = 0;
+    for (std::size_t j = first; j <= last; ++j) {
+      ScheduledSymbol& entry = mScheduleWindow[j];
+      const int64_t onMs = std::llround(entry.offsetMs - chunkOriginMs);
+      const int64_t offMs = std::llround(entry.offsetMs + entry.durationMs - chunkOriginMs);
+      hapticTimings.push_back(std::max<int64_t>(0, onMs - previousEdgeMs));
+      hapticTimings.push_back(std::max<int64_t>(1, offMs - onMs));
+      previousEdgeMs = offMs;
+      entry.hapticQueued = true;
+    }
+    const ScheduledSymbol& firstEntry = mScheduleWindow[first];
+    ActuatorCommand command{};
+    command.type = ActuatorCommandType::VibrateWaveform;
+    command.enabled = true;
+    command.value = static_cast<double>(previousEdgeMs);
+    command.targetTimeMs = firstEntry.expectedTimestampMs + leads.routeShiftMs;
+    command.dueTimeMs = command.targetTimeMs - leads.hapticsMs;
+    command.enqueuedAtMs = toMillis(std::chrono::steady_clock::now());
+    command.sequence = firstEntry.sequence;
+    command.generation = generation;
+    command.listener = this;
+    // The waveform commits once, so it is logged under its first symbol's press.
+    command.correlationTag = firstEntry.correlationTag;
+    mHapticWaveformActive.store(true, std::memory_order_release);
+    ActuatorThread::shared().submitWaveform(command, hapticTimings);
+    logEvent("haptics.waveform",
+             "sequence=%llu segments=%zu total=%.1f due=%.3f",
+             static_cast<unsigned long long>(command.sequence),
+             last - first + 1,
+             command.value,
+             command.dueTimeMs);
+  };
+
+  // Actuator commands are queued ahead of the tone with each channel's own
+  // lead, so torch and overlay commit at the expected symbol start rather than
+  // at the moment the playback thread wakes up. The cursor indexes the window
+  // and moves back by one whenever the played symbol is popped.
+  std::size_t actuatorCursor = 0;
+  const double maxActuatorLeadMs = std::max({ leads.torchMs, leads.overlayMs, leads.hapticsMs });
+  const auto queueActuatorsThrough = [&](double horizonMs) {
+    std::lock_guard<std::mutex> scheduleLock(mScheduleMutex);
+    if (cancelled()) {
+      return;
+    }
+    while (actuatorCursor < mScheduleWindow.size()) {
+      ScheduledSymbol& entry = mScheduleWindow[actuatorCursor];
+      const double startMs = entry.expectedTimestampMs + leads.routeShiftMs;
+      const double endMs = startMs + entry.durationMs;
+      if (startMs - maxActuatorLeadMs > horizonMs) {
+        break;
+      }
+      if (replayTorchEnabled) {
+        submitActuatorCommand(ActuatorCommandType::Torch, true, 0.0, startMs, leads.torchMs,
+                              entry.sequence, generation, entry.correlationTag);
+        submitActuatorCommand(ActuatorCommandType::Torch, false, 0.0, endMs, leads.torchMs,
+                              entry.sequence, generation, entry.correlationTag);
+      }
+      const bool overlayCandidate = replayFlashEnabled && requestedPulsePercent > 0.0 && overlayReady();
+      if (overlayCandidate) {
+        submitActuatorCommand(ActuatorCommandType::OverlayState, true, requestedPulsePercent,
+                              startMs, leads.overlayMs, entry.sequence, generation, entry.correlationTag);
+        submitActuatorCommand(ActuatorCommandType::OverlayState, false, kPulsePercentOff,
+                              endMs, leads.overlayMs, entry.sequence, generation, entry.correlationTag);
+        entry.overlayQueued = true;
+        overlayRequested = true;
+      }
+      if (replayHapticsEnabled && !entry.hapticQueued) {
+        queueHapticChunkLocked(actuatorCursor);
+      }
+      ++actuatorCursor;
+    }
+  };
+
+  // Invalidates every actuator command queued for the current schedule and
+  // leaves torch, overlay and vibrator off.
+  const auto dropQueuedActuators = [&]() {
+    // Compare-exchange so a stale thread cannot invalidate the commands of
+    // the pattern that replaced it; the cancel already cleared its outputs.
+    uint64_t expected = generation;
+    if (!mActuatorGeneration.compare_exchange_strong(expected, generation + 1, std::memory_order_acq_rel)) {
+      return;
+    }
+    generation += 1;
+    if (mHapticWaveformActive.exchange(false, std::memory_order_acq_rel)) {
+      submitActuatorCommand(ActuatorCommandType::CancelVibration, false, 0.0, 0.0, 0.0, 0, generation);
+    }
+    if (replayTorchEnabled) {
+      submitActuatorCommand(ActuatorCommandType::Torch, false, 0.0, 0.0, 0.0, 0, generation);
+    }
+    if (overlayRequested || mNativeOverlayActive.load(std::memory_order_relaxed)) {
+      submitActuatorCommand(ActuatorCommandType::OverlayState, false, kPulsePercentOff, 0.0, 0.0, 0,
+                            generation);
+      mNativeOverlayActive.store(false, std::memory_order_release);
+    }
+  };
+
+  // The oscillator is shared with manual tones and the next pattern, so the
+  // run id is checked under the stream lock the canceller's release ramp takes.
+  const auto startPatternTone = [&](const ScheduledSymbol& symbol, double expectedStartMs) -> bool {
+    std::lock_guard<std::mutex> streamLock(mStreamMutex);
+    if (cancelled()) {
+      return false;
+    }
+    if (pendingGlideMs > 0.0) {
+      // The glide must be visible before the new target; the callback
+      // consumes both together.
+      mGlideMs.store(pendingGlideMs, std::memory_order_relaxed);
+      mFrequency.store(toneHz, std::memory_order_release);
+      pendingGlideMs = 0.0;
+    }
+    startResolvedToneLocked(toneHz,
+                            gain,
+                            patternEnvelope,
+                            expectedStartMs,
+                            symbol.sequence,
+                            generation,
+                            symbol.correlationTag);
+    return true;
+  };
+  const auto stopPatternTone = [&]() {
+    std::lock_guard<std::mutex> streamLock(mStreamMutex);
+    if (!cancelled()) {
+      stopToneLocked(patternEnvelope.releaseMs);
+    }
+  };
+
+  // Pause and seek requests land here, mid-gap or mid-mark. Outputs are
+  // silenced, queued actuator work is dropped, and the timeline cursor moves
+  // to the resume point through its checkpoint index. On resume the origin is
+  // shifted so every remaining offset maps onto the clock unchanged: a pause
+  // inside a gap keeps the rest of that gap, an interrupted mark restarts.
+  // Returns false when the request was withdrawn before this thread saw it.
+  const auto applyControl = [&]() -> bool {
+    std::unique_lock<std::mutex> control(mPlaybackControlMutex);
+    if (cancelled()) {
+      return false;
+    }
+    mPlaybackControlPending.store(false, std::memory_order_release);
+    if (!mPauseRequested && mSeekTarget == PlaybackSeekTarget::None) {
+      return false;
+    }
+
+    stopPatternTone();
+    dropQueuedActuators();
+
+    uint64_t resumeSequence = 0;
+    double nextMarkOffsetMs = 0.0;
+    {
+      std::lock_guard<std::mutex> scheduleLock(mScheduleMutex);
+      if (cancelled()) {
+        return false;
+      }
+      if (!mScheduleWindow.empty()) {
+        resumeSequence = mScheduleWindow[0].sequence;
+        nextMarkOffsetMs = mScheduleWindow[0].offsetMs;
+      }
+      mScheduleWindow.clear();
+      actuatorCursor = 0;
+    }
+    // Silence still owed before the next mark; kept across the rewind below
+    // because a retimed timeline may recompile offsets from a checkpoint.
+    double gapBeforeMarkMs = 0.0;
+    if (mPauseRequested && mSeekTarget == PlaybackSeekTarget::None) {
+      const double pausedAtOffsetMs = mPauseRequestedAtMs - patternStartMs;
+      if (pausedAtOffsetMs < nextMarkOffsetMs) {
+        gapBeforeMarkMs = nextMarkOffsetMs - std::max(pausedAtOffsetMs, previousExpectedEndOffsetMs);
+      }
+    }
+    double playheadOffsetMs = nextMarkOffsetMs - gapBeforeMarkMs;
+
+    for (;;) {
+      if (mSeekTarget != PlaybackSeekTarget::None) {
+        const bool bySymbol = mSeekTarget == PlaybackSeekTarget::Symbol;
+        const bool seeked = bySymbol ? timeline.seekToSymbol(mSeekIndex)
+                                     : timeline.seekToCharacter(static_cast<std::size_t>(mSeekIndex));
+        logEvent("playMorse.seek",
+                 "target=%s index=%llu ok=%d sequence=%llu offset=%.3f",
+                 bySymbol ? "symbol" : "character",
+                 static_cast<unsigned long long>(mSeekIndex),
+                 seeked ? 1 : 0,
+                 static_cast<unsigned long long>(timeline.nextSequence()),
+                 timeline.nextOffsetMs());
+        if (seeked) {
+          resumeSequence = timeline.nextSequence();
+          gapBeforeMarkMs = 0.0;
+        }
+        mSeekTarget = PlaybackSeekTarget::None;
+      }
+      if (resumeSequence != 0) {
+        // The window was compiled ahead of the playhead; rewind the cursor.
+        timeline.seekToSymbol(resumeSequence);
+        nextMarkOffsetMs = timeline.nextOffsetMs();
+        playheadOffsetMs = nextMarkOffsetMs - gapBeforeMarkMs;
+      }
+      if (!mPauseRequested || cancelled()) {
+        break;
+      }
+      mPausedPosition = PlaybackPosition{ resumeSequence, timeline.nextCharacter(), playheadOffsetMs };
+      if (!mPlaybackPaused) {
+        mPlaybackPaused = true;
+        logEvent("playMorse.paused",
+                 "sequence=%llu offset=%.3f",
+                 static_cast<unsigned long long>(resumeSequence),
+                 playheadOffsetMs);
+      }
+      mPlaybackControlCondition.wait(control, [&] {
+        return mPlaybackControlPending.load(std::memory_order_acquire) || cancelled();
+      });
+      mPlaybackControlPending.store(false, std::memory_order_release);
+    }
+    if (cancelled()) {
+      return false;
+    }
+    mPlaybackPaused = false;
+    control.unlock();
+    if (resumeSequence == 0) {
+      return true;
+    }
+
+    // Leave at least the pre-roll before the next mark so every channel can be
+    // dispatched ahead of it again.
+    const double leadRoomMs = std::max(0.0, leads.preRollMs - gapBeforeMarkMs);
+    const auto now = std::chrono::steady_clock::now();
+    patternStart = now + toMicros(leadRoomMs - playheadOffsetMs);
+    patternStartMs = toMillis(patternStart);
+    timeline.rebase(patternStartMs);
+    previousExpectedEndOffsetMs = playheadOffsetMs - leadRoomMs;
+    isFirstSymbol = true;
+    {
+      std::lock_guard<std::mutex> infoLock(mSymbolInfoMutex);
+      if (cancelled()) {
+        return false;
+      }
+      mSymbolSequence = resumeSequence - 1;
+      mPatternStartTimestampMs = patternStartMs;
+    }
+    compileThrough(patternStartMs + nextMarkOffsetMs + kScheduleHorizonMs);
+    logEvent("playMorse.resume",
+             "sequence=%llu offset=%.3f leadRoom=%.3f origin=%.3f",
+             static_cast<unsigned long long>(resumeSequence),
+             playheadOffsetMs,
+             leadRoomMs,
+             patternStartMs);
+    return true;
+  };
+
+  // Returns true when a pause or seek moved the playhead while waiting; the
+  // caller then restarts from the new front of the window.
+  const auto sleepUntil = [&](const std::chrono::steady_clock::time_point& deadline) {
+    for (;;) {
+      while (!cancelled() &&
+             !mPlaybackControlPending.load(std::memory_order_acquire) &&
+             std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(kSleepQuantum);
+      }
+      if (cancelled() || !mPlaybackControlPending.load(std::memory_order_acquire)) {
+        return false;
+      }
+      if (applyControl()) {
+        return true;
+      }
+    }
+  };
 
   {
     std::lock_guard<std::mutex> infoLock(mSymbolInfoMutex);
-    mPatternStartTimestampMs = patternStartMs;
+    if (!cancelled()) {
+      mPatternStartTimestampMs = patternStartMs;
+    }
   }
 
-  for (std::size_t i = 0; i < pattern.size(); ++i) {
-    if (mPlaybackCancel.load(std::memory_order_acquire)) {
-      break;
+  compileThrough(patternStartMs + kScheduleHorizonMs);
+  while (!cancelled()) {
+    ScheduledSymbol entry{};
+    {
+      std::lock_guard<std::mutex> scheduleLock(mScheduleMutex);
+      if (cancelled() || mScheduleWindow.empty()) {
+        break;
+      }
+      entry = mScheduleWindow[0];
     }
-
-    const PlaybackSymbol symbolType = pattern[i];
-    const bool isDash = symbolType == PlaybackSymbol::DASH;
-    const bool isDot = symbolType == PlaybackSymbol::DOT;
-
-    if (!isDash && !isDot) {
-      const double invalidGapMs = unitMs * 3.0;
-      expectedOffsetMs += invalidGapMs;
-      const auto gapDeadline = std::chrono::steady_clock::now() + toMicros(invalidGapMs);
-      sleepUntil(gapDeadline);
-      continue;
+    const PlaybackSymbol symbolType = entry.symbol;
+    const double symbolDurationMs = entry.durationMs;
+    const double expectedStartOffsetMs = entry.offsetMs;
+    // The next wake-up happens once this symbol ends, so everything due before
+    // then (plus a margin) has to be in the actuator queue already.
+    queueActuatorsThrough(entry.expectedTimestampMs + symbolDurationMs + kActuatorLookaheadMs);
+    {
+      std::lock_guard<std::mutex> scheduleLock(mScheduleMutex);
+      if (!mScheduleWindow.empty()) {
+        entry.overlayQueued = mScheduleWindow[0].overlayQueued;
+      }
     }
 
-    const double symbolDurationMs = unitMs * (isDash ? static_cast<double>(kDashUnits) : 1.0);
-    const double expectedStartOffsetMs = expectedOffsetMs;
     const double availableGapLead = std::max(0.0, expectedStartOffsetMs - previousExpectedEndOffsetMs);
     const double maxLeadFromGap = std::max(0.0, availableGapLead - kMinDispatchOffsetMs);
-    double leadCandidate = std::min(kToneStartLeadMs, expectedStartOffsetMs);
+    const double toneLeadMs = std::clamp(leads.toneMs + drift.correctionMs(), 0.0, kMaxToneLeadMs);
+    double leadCandidate = std::min(toneLeadMs, expectedStartOffsetMs);
     leadCandidate = std::min(leadCandidate, maxLeadFromGap);
     const double leadMs = std::max(0.0, leadCandidate);
     const double dispatchOffsetMs = expectedStartOffsetMs - leadMs;
     const auto dispatchTime = patternStart + toMicros(dispatchOffsetMs);
     const double dispatchTimestampMs = patternStartMs + dispatchOffsetMs;
-    const uint64_t upcomingSequence = mSymbolSequence + 1;
+    uint64_t upcomingSequence = 0;
+    {
+      // Written under this lock by resetSymbolInfo and by a resume or seek.
+      std::lock_guard<std::mutex> infoLock(mSymbolInfoMutex);
+      upcomingSequence = mSymbolSequence + 1;
+    }
     logEvent("playMorse.dispatch",
-             "sequence=%llu symbol=%c offset=%.3f lead=%.3f dispatchAt=%.3f gapLead=%.3f",
+             "sequence=%llu symbol=%c offset=%.3f lead=%.3f drift=%.3f dispatchAt=%.3f gapLead=%.3f",
              static_cast<unsigned long long>(upcomingSequence),
              toSymbolChar(symbolType),
              expectedStartOffsetMs,
              leadMs,
+             drift.correctionMs(),
              dispatchTimestampMs,
              availableGapLead);
     PlaybackDispatchEvent scheduledEvent;
@@ -901,9 +1825,8 @@ void OutputsAudio::runPattern(std::vector<PlaybackSymbol> pattern,
     scheduledEvent.expectedSincePriorMs =
         isFirstSymbol ? std::nullopt : std::optional<double>(expectedStartOffsetMs - previousExpectedEndOffsetMs);
     scheduledEvent.sincePriorMs = std::nullopt;
-    if (mReplayFlashEnabled && mReplayFlashBrightnessPercent > 0.0) {
-      const bool nativeOverlayAvailable =
-          mNativeOverlayAvailable.load(std::memory_order_relaxed);
+    if (replayFlashVisible) {
+      const bool nativeOverlayAvailable = overlayReady();
       scheduledEvent.nativeFlashAvailable = nativeOverlayAvailable;
       if (nativeOverlayAvailable) {
         scheduledEvent.flashHandledNatively = true;
@@ -914,17 +1837,27 @@ void OutputsAudio::runPattern(std::vector<PlaybackSymbol> pattern,
       scheduledEvent.nativeFlashAvailable = std::nullopt;
       scheduledEvent.flashHandledNatively = std::nullopt;
     }
-    emitSymbolDispatchEvent(scheduledEvent);
-    sleepUntil(dispatchTime);
+    TraceRecorder::shared().record(TraceEventType::DispatchScheduled,
+                                   static_cast<int64_t>(upcomingSequence),
+                                   leadMs);
+    if (!cancelled()) {
+      emitSymbolDispatchEvent(scheduledEvent, entry.correlationTag);
+    }
+    if (sleepUntil(dispatchTime)) {
+      continue;
+    }
+    if (cancelled()) {
+      break;
+    }
 
-    ToneStartOptions startOptions;
-    startOptions.toneHz = toneHz;
-    startOptions.gain = static_cast<double>(gain);
-    ToneEnvelopeOptions envelope;
-    envelope.attackMs = static_cast<double>(mEnvelopeConfig.attackMs);
-    envelope.releaseMs = static_cast<double>(mEnvelopeConfig.releaseMs);
-    startOptions.envelope = envelope;
-    startToneInternal(startOptions, false);
+    const double requestedToneHz = mRequestedToneHz.exchange(0.0, std::memory_order_acq_rel);
+    if (requestedToneHz > 0.0 && requestedToneHz != toneHz) {
+      toneHz = requestedToneHz;
+      pendingGlideMs = mRequestedGlideMs.load(std::memory_order_relaxed);
+    }
+    if (!startPatternTone(entry, patternStartMs + expectedStartOffsetMs)) {
+      break;
+    }
 
     const auto startedAt = std::chrono::steady_clock::now();
     const double startedAtMs = toMillis(startedAt);
@@ -938,9 +1871,12 @@ void OutputsAudio::runPattern(std::vector<PlaybackSymbol> pattern,
     uint64_t sequenceValue = 0;
     {
       std::lock_guard<std::mutex> infoLock(mSymbolInfoMutex);
+      if (cancelled()) {
+        break;
+      }
       mSymbolSequence += 1;
       sequenceValue = mSymbolSequence;
-      SymbolSnapshot snapshot;
+      SymbolSnapshot snapshot{};
       snapshot.sequence = sequenceValue;
       snapshot.symbol = symbolType;
       snapshot.timestampMs = audioStartMs;
@@ -951,11 +1887,7 @@ void OutputsAudio::runPattern(std::vector<PlaybackSymbol> pattern,
       snapshot.batchElapsedMs = batchElapsedMs;
       snapshot.expectedSincePriorMs = expectedSincePriorMs;
       snapshot.sincePriorMs = sincePriorMs;
-      mSymbolSnapshots.emplace_back(std::move(snapshot));
-      constexpr std::size_t kMaxSnapshots = 64;
-      while (mSymbolSnapshots.size() > kMaxSnapshots) {
-        mSymbolSnapshots.pop_front();
-      }
+      mSymbolSnapshots.push(snapshot);
     }
     logEvent("playMorse.symbol.start",
              "sequence=%llu symbol=%c expected=%.3f actual=%.3f skew=%.3f batchElapsed=%.3f",
@@ -965,39 +1897,10 @@ void OutputsAudio::runPattern(std::vector<PlaybackSymbol> pattern,
              audioStartMs,
              startSkewMs,
              batchElapsedMs);
-    const double requestedPulsePercent =
-        mReplayFlashOverridePercent.has_value()
-            ? std::clamp(mReplayFlashOverridePercent.value(), 0.0, 100.0)
-            : std::clamp(mReplayFlashBrightnessPercent, 0.0, 100.0);
-    bool overlayActiveForSymbol = false;
-    const bool overlayCandidate =
-        mReplayFlashEnabled && requestedPulsePercent > 0.0 &&
-        mNativeOverlayAvailable.load(std::memory_order_relaxed);
-    if (overlayCandidate) {
-      overlayActiveForSymbol = setNativeFlashOverlayState(true, requestedPulsePercent);
-      if (!overlayActiveForSymbol) {
-        mNativeOverlayAvailable.store(false, std::memory_order_release);
-        const auto overlayDebug = getNativeOverlayAvailabilityDebugString();
-        if (!overlayDebug.empty()) {
-          logEvent("overlay.symbol.unavailable",
-                   "sequence=%llu brightness=%.1f %s",
-                   static_cast<unsigned long long>(sequenceValue),
-                   requestedPulsePercent,
-                   overlayDebug.c_str());
-        } else {
-          logEvent("overlay.symbol.unavailable",
-                   "sequence=%llu brightness=%.1f",
-                   static_cast<unsigned long long>(sequenceValue),
-                   requestedPulsePercent);
-        }
-        if (mScreenBrightnessBoostEnabled.load(std::memory_order_acquire)) {
-          mScreenBrightnessBoostEnabled.store(false, std::memory_order_release);
-          setNativeScreenBrightnessBoost(false);
-        }
-      } else {
-        mNativeOverlayActive.store(true, std::memory_order_release);
-      }
-    }
+    // A pulse queued before the overlay went down was dropped by the actuator
+    // thread, and one not queued while it was being prepared never existed;
+    // either way the JS flash has to cover the symbol.
+    const bool overlayActiveForSymbol = entry.overlayQueued && overlayReady();
     PlaybackDispatchEvent actualEvent;
     actualEvent.phase = PlaybackDispatchPhase::ACTUAL;
     actualEvent.symbol = symbolType;
@@ -1018,18 +1921,27 @@ void OutputsAudio::runPattern(std::vector<PlaybackSymbol> pattern,
         isFirstSymbol ? std::nullopt : std::optional<double>(expectedSincePriorMs);
     actualEvent.sincePriorMs = isFirstSymbol ? std::nullopt : std::optional<double>(sincePriorMs);
     actualEvent.flashHandledNatively = overlayActiveForSymbol;
-    if (mReplayFlashEnabled && requestedPulsePercent > 0.0) {
-      actualEvent.nativeFlashAvailable =
-          mNativeOverlayAvailable.load(std::memory_order_relaxed);
+    if (replayFlashEnabled && requestedPulsePercent > 0.0) {
+      actualEvent.nativeFlashAvailable = overlayActiveForSymbol;
     } else {
       actualEvent.nativeFlashAvailable = std::nullopt;
     }
-    emitSymbolDispatchEvent(actualEvent);
-    if (replayTorchEnabled) {
-      setNativeTorchEnabled(true);
+    TraceRecorder::shared().record(TraceEventType::DispatchActual,
+                                   static_cast<int64_t>(sequenceValue),
+                                   startSkewMs);
+    if (!cancelled()) {
+      emitSymbolDispatchEvent(actualEvent, entry.correlationTag);
     }
-    if (replayHapticsEnabled) {
-      triggerNativeVibration(static_cast<long>(std::llround(symbolDurationMs)));
+    if (entry.character != openCharacter && !cancelled()) {
+      openCharacter = entry.character;
+      PlaybackProgressEvent progress(PlaybackProgressPhase::STARTED,
+                                     static_cast<double>(entry.character),
+                                     static_cast<double>(entry.word),
+                                     static_cast<double>(sequenceValue),
+                                     false,
+                                     audioStartMs,
+                                     std::nullopt);
+      emitPlaybackProgressEvent(progress, entry.correlationTag);
     }
 
     previousExpectedStartMs = expectedStartMs;
@@ -1037,48 +1949,266 @@ void OutputsAudio::runPattern(std::vector<PlaybackSymbol> pattern,
     isFirstSymbol = false;
 
     const auto symbolDeadline = startedAt + toMicros(leadMs + symbolDurationMs);
-    sleepUntil(symbolDeadline);
-    if (replayTorchEnabled) {
-      setNativeTorchEnabled(false);
+    const bool interrupted = sleepUntil(symbolDeadline);
+    if (cancelled()) {
+      break;
     }
     if (overlayActiveForSymbol) {
-      setNativeFlashOverlayState(false, kPulsePercentOff);
       mNativeOverlayActive.store(false, std::memory_order_release);
     }
+    if (interrupted) {
+      continue;
+    }
+    // Set by the callback on the frame the tone rose; still 0 if it never did.
+    const double toneActualStartMs = mToneActualStartMs.load(std::memory_order_relaxed);
+    if (toneActualStartMs > 0.0 && drift.update(toneActualStartMs - expectedStartMs)) {
+      LatencyHistograms::shared().record(OutputChannel::Tone, LatencyMetric::DriftResidual, drift.residualMs());
+    }
 
-    stopTone();
+    stopPatternTone();
+
+    // Character and word ends are reported once, after the last mark rather
+    // than per symbol, so a highlighter needs no bookkeeping of its own.
+    if (entry.characterEnd && !cancelled()) {
+      openCharacter = kNoCharacter;
+      PlaybackProgressEvent progress(PlaybackProgressPhase::FINISHED,
+                                     static_cast<double>(entry.character),
+                                     static_cast<double>(entry.word),
+                                     static_cast<double>(sequenceValue),
+                                     entry.wordEnd,
+                                     audioStartMs + symbolDurationMs,
+                                     std::nullopt);
+      emitPlaybackProgressEvent(progress, entry.correlationTag);
+    }
 
     const double expectedEndOffsetMs = expectedStartOffsetMs + symbolDurationMs;
-    expectedOffsetMs += symbolDurationMs;
-    if (i + 1 < pattern.size()) {
-      expectedOffsetMs += unitMs * static_cast<double>(kSymbolGapUnits);
-      const double gapTargetMs = patternStartMs + expectedOffsetMs;
+    {
+      std::lock_guard<std::mutex> scheduleLock(mScheduleMutex);
+      if (cancelled()) {
+        break;
+      }
+      if (!mScheduleWindow.empty()) {
+        mScheduleWindow.popFront();
+      }
+      if (actuatorCursor > 0) {
+        --actuatorCursor;
+      }
+    }
+    // Tempo changes land on this boundary: the mark that just ended keeps its
+    // length, its trailing gap and everything after it use the new unit.
+    const double requestedUnitMs = mRequestedUnitMs.exchange(0.0, std::memory_order_acq_rel);
+    if (requestedUnitMs > 0.0 && requestedUnitMs != unitMs) {
+      dropQueuedActuators();
+      {
+        std::lock_guard<std::mutex> scheduleLock(mScheduleMutex);
+        if (cancelled()) {
+          break;
+        }
+        timeline.retime(entry.sequence, expectedStartOffsetMs, symbolDurationMs, requestedUnitMs);
+        mScheduleWindow.clear();
+        actuatorCursor = 0;
+      }
+      logEvent("playMorse.retime",
+               "sequence=%llu unit=%.3f->%.3f",
+               static_cast<unsigned long long>(entry.sequence),
+               unitMs,
+               requestedUnitMs);
+      unitMs = requestedUnitMs;
+    }
+    compileThrough(entry.expectedTimestampMs + kScheduleHorizonMs);
+    std::optional<double> nextOffset;
+    {
+      std::lock_guard<std::mutex> scheduleLock(mScheduleMutex);
+      if (!mScheduleWindow.empty()) {
+        nextOffset = mScheduleWindow[0].offsetMs;
+      }
+    }
+    if (nextOffset.has_value()) {
+      const double nextOffsetMs = nextOffset.value();
       logEvent("playMorse.gap",
                "sequence=%llu nextOffset=%.3f gapTarget=%.3f",
                static_cast<unsigned long long>(sequenceValue),
-               expectedOffsetMs,
-               gapTargetMs);
+               nextOffsetMs,
+               patternStartMs + nextOffsetMs);
     }
     previousExpectedEndOffsetMs = expectedEndOffsetMs;
   }
 
-  stopTone();
-  if (replayTorchEnabled) {
-    setNativeTorchEnabled(false);
+  // A cancelled run leaves the cleanup to cancelPlaybackThread, which has
+  // already done it (or is about to) for whichever pattern is current.
+  const bool wasCancelled = cancelled();
+  if (!wasCancelled) {
+    stopPatternTone();
+    if (replayTorchEnabled) {
+      submitActuatorCommand(ActuatorCommandType::Torch, false, 0.0, 0.0, 0.0, 0, generation);
+    }
+    if (overlayRequested || mNativeOverlayActive.load(std::memory_order_relaxed)) {
+      submitActuatorCommand(ActuatorCommandType::OverlayState, false, kPulsePercentOff, 0.0, 0.0, 0,
+                            generation);
+      mNativeOverlayActive.store(false, std::memory_order_release);
+    }
+    mScreenBrightnessBoostEnabled.store(false, std::memory_order_release);
+    submitActuatorCommand(ActuatorCommandType::BrightnessBoost, false, 0.0, 0.0, 0.0, 0, generation);
+    mHapticWaveformActive.store(false, std::memory_order_release);
   }
-  if (mNativeOverlayActive.load(std::memory_order_relaxed)) {
-    setNativeFlashOverlayState(false, kPulsePercentOff);
-    mNativeOverlayActive.store(false, std::memory_order_release);
+  {
+    std::lock_guard<std::mutex> controlLock(mPlaybackControlMutex);
+    if (!cancelled()) {
+      mPauseRequested = false;
+      mPlaybackPaused = false;
+      mSeekTarget = PlaybackSeekTarget::None;
+    }
   }
-  mScreenBrightnessBoostEnabled.store(false, std::memory_order_release);
-  setNativeScreenBrightnessBoost(false);
-  mPlaybackRunning.store(false, std::memory_order_release);
-  const bool cancelled = mPlaybackCancel.load(std::memory_order_acquire);
-  mPlaybackCancel.store(false, std::memory_order_release);
-  if (cancelled) {
-    resetSymbolInfo();
+  {
+    // startPattern sets the flag under this lock after bumping the run id.
+    std::lock_guard<std::mutex> lock(mPlaybackMutex);
+    if (!cancelled()) {
+      mPlaybackRunning.store(false, std::memory_order_release);
+    }
   }
-  logEvent("playMorse.end", "cancelled=%d", cancelled ? 1 : 0);
+  logEvent("playMorse.end",
+           "cancelled=%d drift=%.3f residual=%.3f samples=%u",
+           wasCancelled ? 1 : 0,
+           drift.correctionMs(),
+           drift.residualMs(),
+           drift.samples());
+
+#if defined(MORSE_ALLOCATION_AUDIT)
+  const AllocationAuditReport audit = AllocationAudit::report();
+  if (audit.allocations > 0) {
+    __android_log_assert(nullptr,
+                         kTag,
+                         "%s alloc.audit.failed allocations=%llu bytes=%llu largest=%zu",
+                         kLogPrefix,
+                         static_cast<unsigned long long>(audit.allocations),
+                         static_cast<unsigned long long>(audit.bytes),
+                         audit.largestBytes);
+  }
+  logEvent("alloc.audit", "allocations=0");
+#endif
+}
+
+bool OutputsAudio::pausePlayback() {
+  if (!mPlaybackRunning.load(std::memory_order_acquire)) {
+    return false;
+  }
+  {
+    std::lock_guard<std::mutex> controlLock(mPlaybackControlMutex);
+    if (!mPauseRequested) {
+      // Stamped here rather than when the playback thread wakes so the
+      // playhead is kept where the caller asked for it.
+      mPauseRequested = true;
+      mPauseRequestedAtMs = toMillis(std::chrono::steady_clock::now());
+      mPlaybackControlPending.store(true, std::memory_order_release);
+    }
+  }
+  mPlaybackControlCondition.notify_all();
+  return true;
+}
+
+bool OutputsAudio::resumePlayback() {
+  {
+    std::lock_guard<std::mutex> controlLock(mPlaybackControlMutex);
+    if (!mPauseRequested) {
+      return false;
+    }
+    mPauseRequested = false;
+    mPlaybackControlPending.store(true, std::memory_order_release);
+  }
+  mPlaybackControlCondition.notify_all();
+  return true;
+}
+
+bool OutputsAudio::requestPlaybackSeek(PlaybackSeekTarget target, uint64_t index) {
+  if (!mPlaybackRunning.load(std::memory_order_acquire)) {
+    return false;
+  }
+  const bool inRange = target == PlaybackSeekTarget::Symbol
+                           ? index >= 1 && index <= mPatternSymbolCount.load(std::memory_order_acquire)
+                           : index < mPatternCharacterCount.load(std::memory_order_acquire);
+  if (!inRange) {
+    logEvent("playMorse.seek.reject", "index=%llu", static_cast<unsigned long long>(index));
+    return false;
+  }
+  {
+    std::lock_guard<std::mutex> controlLock(mPlaybackControlMutex);
+    mSeekTarget = target;
+    mSeekIndex = index;
+    mPlaybackControlPending.store(true, std::memory_order_release);
+  }
+  mPlaybackControlCondition.notify_all();
+  return true;
+}
+
+bool OutputsAudio::seekPlaybackToSymbol(double sequence) {
+  if (!std::isfinite(sequence) || sequence < 1.0) {
+    return false;
+  }
+  return requestPlaybackSeek(PlaybackSeekTarget::Symbol, static_cast<uint64_t>(sequence));
+}
+
+bool OutputsAudio::seekPlaybackToCharacter(double character) {
+  if (!std::isfinite(character) || character < 0.0) {
+    return false;
+  }
+  return requestPlaybackSeek(PlaybackSeekTarget::Character, static_cast<uint64_t>(character));
+}
+
+bool OutputsAudio::setPlaybackUnitMs(double unitMs) {
+  if (!std::isfinite(unitMs) || unitMs <= 0.0 || !mPlaybackRunning.load(std::memory_order_acquire)) {
+    return false;
+  }
+  mRequestedUnitMs.store(unitMs, std::memory_order_release);
+  return true;
+}
+
+// Only a running pattern is retuned: manual and keyer tones take their pitch
+// from startTone and the keyer config, and the oscillator is shared with them.
+bool OutputsAudio::setPlaybackToneHz(double toneHz, const std::optional<double>& glideMs) {
+  if (!std::isfinite(toneHz) || toneHz <= 0.0 || !mPlaybackRunning.load(std::memory_order_acquire)) {
+    return false;
+  }
+  const double glide = glideMs.has_value() && std::isfinite(glideMs.value())
+                           ? std::clamp(glideMs.value(), 0.0, kMaxGlideMs)
+                           : kDefaultGlideMs;
+  // The playback thread takes the glide together with the pitch at the next
+  // mark start.
+  mRequestedGlideMs.store(glide, std::memory_order_relaxed);
+  mRequestedToneHz.store(toneHz, std::memory_order_release);
+  logEvent("tone.glide", "hz=%.1f glide=%.1f", toneHz, glide);
+  return true;
+}
+
+std::optional<std::string> OutputsAudio::getPlaybackPosition() {
+  if (!mPlaybackRunning.load(std::memory_order_acquire)) {
+    return std::nullopt;
+  }
+  bool paused = false;
+  PlaybackPosition position{};
+  {
+    std::lock_guard<std::mutex> controlLock(mPlaybackControlMutex);
+    paused = mPlaybackPaused;
+    position = mPausedPosition;
+  }
+  if (!paused) {
+    std::lock_guard<std::mutex> scheduleLock(mScheduleMutex);
+    if (mScheduleWindow.empty()) {
+      return std::nullopt;
+    }
+    const ScheduledSymbol& front = mScheduleWindow[0];
+    position = PlaybackPosition{ front.sequence, front.character, front.offsetMs };
+  }
+
+  std::ostringstream stream;
+  stream.setf(std::ios::fixed, std::ios::floatfield);
+  stream << "{\"state\":\"" << (paused ? "paused" : "playing") << "\""
+         << ",\"sequence\":" << position.sequence
+         << ",\"character\":" << position.character
+         << ",\"offsetMs\":" << std::setprecision(3) << position.offsetMs
+         << ",\"symbolCount\":" << mPatternSymbolCount.load(std::memory_order_acquire)
+         << ",\"characterCount\":" << mPatternCharacterCount.load(std::memory_order_acquire)
+         << "}";
+  return stream.str();
 }
 
 std::optional<std::string> OutputsAudio::getLatestSymbolInfo() {
@@ -1089,8 +2219,7 @@ std::optional<std::string> OutputsAudio::getLatestSymbolInfo() {
   if (mSymbolSnapshots.empty()) {
     return std::nullopt;
   }
-  const SymbolSnapshot snapshot = mSymbolSnapshots.front();
-  mSymbolSnapshots.pop_front();
+  const SymbolSnapshot snapshot = mSymbolSnapshots.popFront();
   const char symbolChar = toSymbolChar(snapshot.symbol);
   const double ageMs = std::max(0.0, fetchedAtMs - snapshot.timestampMs);
   std::ostringstream stream;
@@ -1120,16 +2249,18 @@ std::optional<std::string> OutputsAudio::getLatestSymbolInfo() {
 }
 
 std::optional<std::string> OutputsAudio::getScheduledSymbols() {
+  // Only the compiled window (the current symbol and up to
+  // kScheduleHorizonMs ahead of it) is available.
   std::lock_guard<std::mutex> lock(mScheduleMutex);
-  if (mScheduledSymbols.empty()) {
+  if (mScheduleWindow.empty()) {
     return std::nullopt;
   }
 
   std::ostringstream stream;
   stream.setf(std::ios::fixed, std::ios::floatfield);
   stream << "[";
-  for (std::size_t i = 0; i < mScheduledSymbols.size(); ++i) {
-    const auto& entry = mScheduledSymbols[i];
+  for (std::size_t i = 0; i < mScheduleWindow.size(); ++i) {
+    const auto& entry = mScheduleWindow[i];
     const char symbolChar = toSymbolChar(entry.symbol);
     stream << "{\"sequence\":" << entry.sequence
            << ",\"symbol\":\"" << symbolChar << "\""
@@ -1137,7 +2268,7 @@ std::optional<std::string> OutputsAudio::getScheduledSymbols() {
            << ",\"offsetMs\":" << std::setprecision(3) << entry.offsetMs
            << ",\"durationMs\":" << std::setprecision(3) << entry.durationMs
            << "}";
-    if (i + 1 < mScheduledSymbols.size()) {
+    if (i + 1 < mScheduleWindow.size()) {
       stream << ",";
     }
   }
@@ -1145,33 +2276,229 @@ std::optional<std::string> OutputsAudio::getScheduledSymbols() {
   return stream.str();
 }
 
-oboe::DataCallbackResult OutputsAudio::onAudioReady(oboe::AudioStream* stream,
-                                                   void* audioData,
-                                                   int32_t numFrames) {
-  if (stream == nullptr || audioData == nullptr || numFrames <= 0) {
-    return oboe::DataCallbackResult::Continue;
+std::optional<std::string> OutputsAudio::getChannelLatencyProfile() {
+  return ChannelLatencyTracker::shared().toJson();
+}
+
+bool OutputsAudio::seedChannelLatency(const std::string& channel, double latencyMs) {
+  const auto parsed = parseOutputChannel(channel);
+  if (!parsed.has_value() || !std::isfinite(latencyMs) || latencyMs < 0.0) {
+    logEvent("latency.seed.rejected", "channel=%s latency=%.3f", channel.c_str(), latencyMs);
+    return false;
+  }
+  ChannelLatencyTracker::shared().seed(parsed.value(), latencyMs);
+  logEvent("latency.seed", "channel=%s latency=%.3f", channel.c_str(), latencyMs);
+  return true;
+}
+
+double OutputsAudio::getNativeClockMs() {
+  return toMillis(std::chrono::steady_clock::now());
+}
+
+std::optional<std::string> OutputsAudio::getAudioFrameClock() {
+  return AudioFrameClock::shared().toJson();
+}
+
+std::optional<std::string> OutputsAudio::getCorrelatedCommits(double cursor) {
+  const uint64_t start = std::isfinite(cursor) && cursor > 0.0 ? static_cast<uint64_t>(cursor) : 0;
+  return CorrelationLog::shared().toJson(start);
+}
+
+std::optional<std::string> OutputsAudio::getAudioRouteProfiles() {
+  return AudioRouteProfiles::shared().toJson();
+}
+
+bool OutputsAudio::setAudioRouteProfile(const std::string& route,
+                                        const std::string& deviceName,
+                                        double presentationOffsetMs) {
+  const auto parsed = parseAudioRoute(route);
+  if (!parsed.has_value() ||
+      !AudioRouteProfiles::shared().setPresentationOffset(parsed.value(), deviceName, presentationOffsetMs, false)) {
+    logEvent("route.profile.rejected", "route=%s offset=%.3f", route.c_str(), presentationOffsetMs);
+    return false;
+  }
+  logEvent("route.profile", "route=%s device=%s offset=%.3f", route.c_str(), deviceName.c_str(),
+           presentationOffsetMs);
+  return true;
+}
+
+bool OutputsAudio::startLatencyCalibration() {
+  {
+    std::lock_guard<std::mutex> lock(mStreamMutex);
+    ensureStreamLocked(mFrequency.load(std::memory_order_relaxed));
+    if (!mStreamReady.load(std::memory_order_acquire)) {
+      logEvent("calibration.skip", "stream=closed");
+      return false;
+    }
+  }
+  // Pattern tones would land in the capture and blur the probes.
+  cancelPlaybackThread(false);
+
+  std::lock_guard<std::mutex> lock(mCalibrationMutex);
+  stopCalibrationLocked();
+  const double sampleRate = AudioEngine::shared().sampleRate();
+  mCalibrator.configure(LoopbackCalibrator::defaultConfig(sampleRate));
+  if (!mCalibrationInput.start(sampleRate)) {
+    mCalibrationState = CalibrationState::Idle;
+    return false;
+  }
+  auto& profiles = AudioRouteProfiles::shared();
+  mCalibrationRoute = profiles.activeRoute();
+  mCalibrationDevice = profiles.activeDeviceName();
+  mCalibrationResultJson.clear();
+  mCalibrationStartedMs = toMillis(std::chrono::steady_clock::now());
+  mCalibrationState = CalibrationState::Running;
+  mCalibrationRendering.store(true, std::memory_order_seq_cst);
+  logEvent("calibration.start",
+           "route=%s device=%s sampleRate=%.1f",
+           audioRouteName(mCalibrationRoute),
+           mCalibrationDevice.c_str(),
+           sampleRate);
+  return true;
+}
+
+std::optional<std::string> OutputsAudio::getLatencyCalibration() {
+  std::lock_guard<std::mutex> lock(mCalibrationMutex);
+  if (mCalibrationState == CalibrationState::Idle) {
+    return std::nullopt;
+  }
+  if (mCalibrationState == CalibrationState::Analyzing) {
+    if (mCalibrationAnalysis.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+      return std::string("{\"state\":\"analyzing\"}");
+    }
+    finishCalibrationLocked(mCalibrationAnalysis.get());
+  }
+  if (mCalibrationState == CalibrationState::Done) {
+    return mCalibrationResultJson;
+  }
+  const LoopbackCalibrator::Config& config = mCalibrator.config();
+  const double elapsedMs = toMillis(std::chrono::steady_clock::now()) - mCalibrationStartedMs;
+  const double timeoutMs = config.leadInMs + config.probeIntervalMs * config.probeCount + config.maxLatencyMs +
+                           kCalibrationTimeoutSlackMs;
+  if (!mCalibrator.captureDone() && elapsedMs < timeoutMs) {
+    std::ostringstream stream;
+    stream.setf(std::ios::fixed, std::ios::floatfield);
+    stream << "{\"state\":\"running\",\"elapsedMs\":" << std::setprecision(1) << elapsedMs
+           << ",\"durationMs\":" << std::setprecision(1) << timeoutMs - kCalibrationTimeoutSlackMs << "}";
+    return stream.str();
+  }
+
+  // The correlation takes tens of milliseconds on a phone, too long for the
+  // polling (JS) thread; it runs on its own and a later poll collects it.
+  stopCalibrationLocked();
+  mCalibrationAnalysis = std::async(std::launch::async, [this]() { return mCalibrator.analyze(); });
+  mCalibrationState = CalibrationState::Analyzing;
+  return std::string("{\"state\":\"analyzing\"}");
+}
+
+void OutputsAudio::finishCalibrationLocked(const LoopbackCalibrator::Result& result) {
+  // Without input timestamps the input buffering is part of the error, so it
+  // is reported but not applied.
+  const bool applied = result.valid && result.inputTimestamped && result.spreadMs <= kMaxCalibrationSpreadMs &&
+                       AudioRouteProfiles::shared().setPresentationOffset(
+                           mCalibrationRoute, mCalibrationDevice, result.presentationErrorMs, true);
+  mCalibrationState = CalibrationState::Done;
+  std::ostringstream stream;
+  stream.setf(std::ios::fixed, std::ios::floatfield);
+  stream << "{\"state\":\"" << (result.valid ? "done" : "failed") << "\""
+         << ",\"route\":\"" << audioRouteName(mCalibrationRoute) << "\""
+         << ",\"presentationErrorMs\":" << std::setprecision(3) << result.presentationErrorMs
+         << ",\"roundTripMs\":" << std::setprecision(3) << result.roundTripMs
+         << ",\"spreadMs\":" << std::setprecision(3) << result.spreadMs
+         << ",\"peakRatio\":" << std::setprecision(1) << result.peakRatio
+         << ",\"detected\":" << result.detected
+         << ",\"probes\":" << result.probes
+         << ",\"inputTimestamped\":" << (result.inputTimestamped ? "true" : "false")
+         << ",\"applied\":" << (applied ? "true" : "false")
+         << "}";
+  mCalibrationResultJson = stream.str();
+  logEvent("calibration.done",
+           "route=%s valid=%d error=%.3f roundTrip=%.3f spread=%.3f detected=%u/%u applied=%d",
+           audioRouteName(mCalibrationRoute),
+           result.valid ? 1 : 0,
+           result.presentationErrorMs,
+           result.roundTripMs,
+           result.spreadMs,
+           result.detected,
+           result.probes,
+           applied ? 1 : 0);
+}
+
+void OutputsAudio::cancelLatencyCalibration() {
+  std::lock_guard<std::mutex> lock(mCalibrationMutex);
+  stopCalibrationLocked();
+  mCalibrationState = CalibrationState::Idle;
+}
+
+void OutputsAudio::stopCalibrationLocked() {
+  mCalibrationRendering.store(false, std::memory_order_seq_cst);
+  while (mCalibrationInRender.load(std::memory_order_seq_cst)) {
+    std::this_thread::yield();
   }
+  mCalibrationInput.stop();
+  if (mCalibrationAnalysis.valid()) {
+    mCalibrationAnalysis.wait();
+  }
+}
 
-  auto* floatData = static_cast<float*>(audioData);
-  const int32_t channelCount = std::max(1, stream->getChannelCount());
-  const double sampleRate = stream->getSampleRate() > 0 ? stream->getSampleRate() : mSampleRate;
+void OutputsAudio::renderVoice(float* mix, int32_t numFrames, const AudioRenderInfo& info) {
+  // Runs inside AudioEngine's callback, which owns the audit scope, xrun and
+  // presentation sampling; this voice only adds its tone and keyer output.
+  TraceRecorder& trace = TraceRecorder::shared();
+  const bool tracing = info.tracing;
+  const int64_t firstFrame = info.firstFrame;
+  const double sampleRate = info.sampleRate;
   double phase = mPhase;
-  const double frequency = mFrequency.load(std::memory_order_relaxed);
+  const double targetHz = mFrequency.load(std::memory_order_acquire);
   float gain = mCurrentGain.load(std::memory_order_relaxed);
   const float targetGain = mTargetGain.load(std::memory_order_relaxed);
   const float rampUp = mGainStepUp.load(std::memory_order_relaxed);
   const float rampDown = mGainStepDown.load(std::memory_order_relaxed);
-  const double phaseIncrement = kTwoPi * frequency / std::max(sampleRate, 1.0);
+  if (targetHz != mGlideTargetHz) {
+    // Glides only matter while the tone is audible; a silent oscillator just
+    // jumps. The phase accumulator carries over either way, so there is no
+    // discontinuity in the waveform.
+    mGlideTargetHz = targetHz;
+    const double glideFrames = mGlideMs.exchange(0.0, std::memory_order_relaxed) * sampleRate / 1000.0;
+    const bool audible = gain > 0.0005f || targetGain > 0.0005f;
+    if (audible && glideFrames >= 1.0) {
+      mGlideStepHz = std::abs(targetHz - mOscillatorHz) / glideFrames;
+    } else {
+      mOscillatorHz = targetHz;
+    }
+  }
+  double oscillatorHz = mOscillatorHz;
+  double phaseIncrement = kTwoPi * oscillatorHz / std::max(sampleRate, 1.0);
   const bool toneActive = mToneActive.load(std::memory_order_acquire);
   bool toneStartLogged = mToneStartLogged.load(std::memory_order_relaxed);
   bool toneSteadyLogged = mToneSteadyLogged.load(std::memory_order_relaxed);
   bool toneStopLogged = mToneStopLogged.load(std::memory_order_relaxed);
+  const bool keyerEnabled = mKeyer.isEnabled();
+  const float keyerGain = mKeyerGain.load(std::memory_order_relaxed);
+  const float keyerStepUp = mKeyerStepUp.load(std::memory_order_relaxed);
+  const float keyerStepDown = mKeyerStepDown.load(std::memory_order_relaxed);
+  if (keyerEnabled) {
+    mKeyer.setSampleRate(sampleRate);
+    mKeyer.beginBlock();
+  }
 
   for (int32_t frame = 0; frame < numFrames; ++frame) {
-    if (gain < targetGain) {
-      gain = std::min(targetGain, gain + rampUp);
-    } else if (gain > targetGain) {
-      gain = std::max(targetGain, gain - rampDown);
+    float frameTarget = targetGain;
+    float stepUp = rampUp;
+    float stepDown = rampDown;
+    if (keyerEnabled) {
+      // The keyer is clocked by this loop, so element edges land on exact
+      // frames; the straight-key tone path still wins if it is louder.
+      if (mKeyer.nextFrame()) {
+        frameTarget = std::max(targetGain, keyerGain);
+      }
+      stepUp = keyerStepUp > 0.0f ? keyerStepUp : rampUp;
+      stepDown = keyerStepDown > 0.0f ? keyerStepDown : rampDown;
+    }
+    if (gain < frameTarget) {
+      gain = std::min(frameTarget, gain + stepUp);
+    } else if (gain > frameTarget) {
+      gain = std::max(frameTarget, gain - stepDown);
     }
 
     if (toneActive && !toneStartLogged && gain > 0.0005f) {
@@ -1179,7 +2506,39 @@ oboe::DataCallbackResult OutputsAudio::onAudioReady(oboe::AudioStream* stream,
       mToneActualStartMs.store(actualStartMs, std::memory_order_relaxed);
       mToneStartLogged.store(true, std::memory_order_relaxed);
       toneStartLogged = true;
+      if (tracing) {
+        trace.record(TraceEventType::ToneOn, firstFrame + frame);
+      }
       const double requestedMs = mToneStartRequestedMs.load(std::memory_order_relaxed);
+      ChannelLatencyTracker::shared().record(OutputChannel::Tone, actualStartMs - requestedMs);
+      LatencyHistograms::shared().record(OutputChannel::Tone, LatencyMetric::DispatchToCommit,
+                                         actualStartMs - requestedMs);
+      const double expectedStartMs = mToneExpectedStartMs.load(std::memory_order_relaxed);
+      if (expectedStartMs > 0.0) {
+        LatencyHistograms::shared().record(OutputChannel::Tone, LatencyMetric::StartSkew,
+                                           actualStartMs - expectedStartMs);
+      }
+      const uint64_t toneSequence = mToneSequence.load(std::memory_order_relaxed);
+      CorrelationLog::shared().record(CorrelationLog::Record{ mToneCorrelationTag.load(std::memory_order_relaxed),
+                                                              OutputChannel::Tone,
+                                                              toneSequence,
+                                                              requestedMs,
+                                                              actualStartMs,
+                                                              expectedStartMs });
+      if (toneSequence != 0) {
+        // The torch, overlay and vibrator follow this frame, not the playback
+        // thread's wake-up.
+        AudioFrameMark mark{};
+        mark.listener = this;
+        mark.generation = mToneGeneration.load(std::memory_order_relaxed);
+        mark.sequence = toneSequence;
+        mark.frame = firstFrame + frame;
+        mark.presentationMs = info.presentationMs + static_cast<double>(frame) * 1000.0 / sampleRate;
+        // Actuators were already scheduled for the audible time; the mark
+        // only corrects what the route profile got wrong.
+        mark.expectedTimestampMs = expectedStartMs + mPatternRouteShiftMs.load(std::memory_order_relaxed);
+        ActuatorThread::shared().publishFrameMark(mark);
+      }
       logEvent("tone.start.actual",
                "actual=%.3f requested=%.3f delta=%.3f",
                actualStartMs,
@@ -1203,40 +2562,72 @@ oboe::DataCallbackResult OutputsAudio::onAudioReady(oboe::AudioStream* stream,
       const double stopMs = toMillis(std::chrono::steady_clock::now());
       mToneStopLogged.store(true, std::memory_order_relaxed);
       toneStopLogged = true;
+      if (tracing) {
+        trace.record(TraceEventType::ToneOff, firstFrame + frame);
+      }
       logEvent("tone.stop.actual", "stoppedAt=%.3f", stopMs);
     }
 
-    const float sample = gain * static_cast<float>(std::sin(phase));
-    for (int32_t channel = 0; channel < channelCount; ++channel) {
-      floatData[frame * channelCount + channel] = sample;
-    }
+    mix[frame] += gain * static_cast<float>(std::sin(phase));
 
     phase += phaseIncrement;
     if (phase >= kTwoPi) {
       phase -= kTwoPi;
     }
+    if (oscillatorHz != targetHz) {
+      oscillatorHz = oscillatorHz < targetHz ? std::min(targetHz, oscillatorHz + mGlideStepHz)
+                                             : std::max(targetHz, oscillatorHz - mGlideStepHz);
+      phaseIncrement = kTwoPi * oscillatorHz / std::max(sampleRate, 1.0);
+    }
   }
 
   mPhase = phase;
+  mOscillatorHz = oscillatorHz;
   mCurrentGain.store(gain, std::memory_order_relaxed);
-  return oboe::DataCallbackResult::Continue;
-}
 
-void OutputsAudio::onErrorAfterClose(oboe::AudioStream*, oboe::Result error) {
-  logEvent("stream.error", "error=%s", oboe::convertToText(error));
-  std::lock_guard<std::mutex> lock(mStreamMutex);
-  mStream.reset();
-  mStreamReady.store(false, std::memory_order_release);
+  // seq_cst pairs with stopCalibrationLocked: either it sees this pass in
+  // flight, or this pass sees rendering already cleared.
+  mCalibrationInRender.store(true, std::memory_order_seq_cst);
+  if (mCalibrationRendering.load(std::memory_order_seq_cst)) {
+    // Probes are timed against the stream's own estimate; the offset being
+    // measured must not be in it.
+    mCalibrator.renderOutput(mix,
+                             numFrames,
+                             info.presentationMs - info.presentationOffsetMs,
+                             toMillis(std::chrono::steady_clock::now()));
+  }
+  mCalibrationInRender.store(false, std::memory_order_release);
 }
 
 void OutputsAudio::teardown() {
+  mKeyer.setEnabled(false);
+  stopCwReceiver();
+  cancelLatencyCalibration();
   cancelPlaybackThread(true);
+  std::thread overlayPrepare;
+  {
+    std::lock_guard<std::mutex> overlayLock(mOverlayPrepareMutex);
+    overlayPrepare = std::move(mOverlayPrepareThread);
+  }
+  if (overlayPrepare.joinable()) {
+    overlayPrepare.join();
+  }
+  std::thread warmupThread;
+  {
+    std::lock_guard<std::mutex> warmupLock(mWarmupMutex);
+    warmupThread = std::move(mWarmupThread);
+  }
+  if (warmupThread.joinable()) {
+    warmupThread.join();
+  }
   {
     std::lock_guard<std::mutex> callbackLock(mCallbackMutex);
     mSymbolDispatchCallback.reset();
+    mPlaybackProgressCallback.reset();
   }
+  // Only this client leaves; the engine keeps the stream warm for others.
   std::lock_guard<std::mutex> lock(mStreamMutex);
-  closeStreamLocked();
+  releaseEngineLocked();
 }
 
 } // namespace margelo::nitro::morse
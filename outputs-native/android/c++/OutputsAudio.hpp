@@ -2,15 +2,16 @@
 
 #include <cstdint>
 #include <atomic>
+#include <condition_variable>
+#include <future>
 #include <memory>
 #include <mutex>
 #include <optional>
-#include <deque>
 #include <thread>
 #include <string>
 #include <vector>
 
-#include <oboe/Oboe.h>
+#include <NitroModules/Promise.hpp>
 
 #include "HybridOutputsAudioSpec.hpp"
 #include "WarmupOptions.hpp"
@@ -19,22 +20,49 @@
 #include "ToneEnvelopeOptions.hpp"
 #include "PlaybackSymbol.hpp"
 #include "PlaybackDispatchEvent.hpp"
+#include "PlaybackProgressEvent.hpp"
+#include "ActuatorThread.hpp"
+#include "AudioEngine.hpp"
+#include "AudioRoute.hpp"
+#include "CalibrationInputStream.hpp"
+#include "KeyerEngine.hpp"
+#include "PressClassifier.hpp"
+#include "CwInputStream.hpp"
+#include "CwReceiver.hpp"
+#include "FixedRing.hpp"
+#include "LoopbackCalibrator.hpp"
+#include "PatternTimeline.hpp"
 #include <functional>
 
 namespace margelo::nitro::morse {
 
 class OutputsAudio final : public HybridOutputsAudioSpec,
-                           public oboe::AudioStreamCallback {
+                           public AudioVoice,
+                           public ActuatorListener {
  public:
   OutputsAudio();
   ~OutputsAudio() override;
 
   bool isSupported() override;
   void warmup(const WarmupOptions& options) override;
+  // Off the JS thread: the support probe, and the probe plus the stream open.
+  // Concurrent warmups share the one in flight.
+  std::shared_ptr<Promise<bool>> isSupportedAsync();
+  std::shared_ptr<Promise<bool>> warmupAsync(const WarmupOptions& options);
+  std::optional<std::string> getWarmupStatus();
   void startTone(const ToneStartOptions& options) override;
   void stopTone() override;
   void playMorse(const PlaybackRequest& request) override;
+  void playMorseCode(const PlaybackRequest& request, const std::string& code);
+  bool pausePlayback();
+  bool resumePlayback();
+  bool seekPlaybackToSymbol(double sequence);
+  bool seekPlaybackToCharacter(double character);
+  std::optional<std::string> getPlaybackPosition();
+  bool setPlaybackUnitMs(double unitMs);
+  bool setPlaybackToneHz(double toneHz, const std::optional<double>& glideMs);
   void setSymbolDispatchCallback(const std::optional<std::function<void(const PlaybackDispatchEvent&)>>& callback) override;
+  void setPlaybackProgressCallback(const std::optional<std::function<void(const PlaybackProgressEvent&)>>& callback);
   bool setFlashOverlayState(bool enabled, double brightnessPercent);
   bool setFlashOverlayAppearance(double brightnessPercent, double colorArgb);
   bool setFlashOverlayOverride(const std::optional<double>& brightnessPercent,
@@ -42,13 +70,52 @@ class OutputsAudio final : public HybridOutputsAudioSpec,
   void setScreenBrightnessBoost(bool enabled);
   std::optional<std::string> getLatestSymbolInfo() override;
   std::optional<std::string> getScheduledSymbols() override;
+  std::optional<std::string> getChannelLatencyProfile();
+  bool seedChannelLatency(const std::string& channel, double latencyMs);
+  std::optional<std::string> getAudioRouteProfiles();
+  bool setAudioRouteProfile(const std::string& route, const std::string& deviceName, double presentationOffsetMs);
+  bool startLatencyCalibration();
+  std::optional<std::string> getLatencyCalibration();
+  void cancelLatencyCalibration();
+  // Clock sync: steady_clock ms for JS ping-pong sampling, and the audio
+  // stream's frame clock fitted against it (AudioFrameClock JSON).
+  double getNativeClockMs();
+  std::optional<std::string> getAudioFrameClock();
+  // Tagged tone/actuator commits after `cursor` (CorrelationLog JSON).
+  std::optional<std::string> getCorrelatedCommits(double cursor);
+  bool configureKeyer(double toneHz,
+                      double unitMs,
+                      const std::string& mode,
+                      double weighting,
+                      const std::optional<double>& gain);
+  bool setKeyerEnabled(bool enabled);
+  bool setKeyerPaddle(const std::string& paddle, bool down);
+  void resetPressClassifier(double unitMs);
+  std::optional<std::string> pushPressEdge(bool down, double timestampMs);
+  std::optional<std::string> flushPressClassifier(double nowMs);
+  std::optional<std::string> getPressClassifierState();
+  bool startCwReceiver(double toneHz, double unitMs);
+  void stopCwReceiver();
+  std::optional<std::string> pollCwReceiver();
+  std::optional<std::string> getCwReceiverState();
+  std::optional<std::string> decodeWavFile(const std::string& path, double toneHz, double unitMs);
+  std::optional<std::string> decodePileupWavFile(const std::string& path, double unitMs);
+  std::optional<std::string> getLatencyHistograms();
+  void resetLatencyHistograms();
+  std::optional<std::string> getBridgeStats();
+  void resetBridgeStats();
+  bool startTrace(const std::string& path, double capacityEvents);
+  void stopTrace();
+  bool exportTrace(const std::string& jsonPath);
   void teardown() override;
   void loadHybridMethods() override;
 
-  oboe::DataCallbackResult onAudioReady(oboe::AudioStream* stream,
-                                        void* audioData,
-                                        int32_t numFrames) override;
-  void onErrorAfterClose(oboe::AudioStream* stream, oboe::Result error) override;
+  void renderVoice(float* mix, int32_t numFrames, const AudioRenderInfo& info) override;
+  bool isActuatorCommandCurrent(const ActuatorCommand& command) const override;
+  void onActuatorCommandCompleted(const ActuatorCommand& command,
+                                  bool success,
+                                  double dispatchedAtMs,
+                                  double committedAtMs) override;
 
  private:
   struct EnvelopeConfig {
@@ -56,16 +123,67 @@ class OutputsAudio final : public HybridOutputsAudioSpec,
     float releaseMs;
   };
 
-  struct StreamDeleter {
-    void operator()(oboe::AudioStream* stream) const;
+  // Per-channel scheduling leads for one pattern, taken from the latency
+  // tracker when playback starts.
+  struct ChannelLeads {
+    double toneMs;
+    double torchMs;
+    double overlayMs;
+    double hapticsMs;
+    double preRollMs;
+    // Torch, overlay and haptics targets are pushed back by the active
+    // route's audible latency, so they land when the tone is heard rather
+    // than when it is rendered.
+    double routeShiftMs;
   };
-  using StreamPtr = std::unique_ptr<oboe::AudioStream, StreamDeleter>;
 
-  struct ScheduledSymbol {
+  // Output settings for one pattern, resolved by startPattern and handed to
+  // the playback thread by value: a cancelled run is detached, so it must not
+  // read the members the next startPattern rewrites.
+  struct ReplayOutputs {
+    EnvelopeConfig envelope;
+    bool torchEnabled;
+    bool hapticsEnabled;
+    bool flashEnabled;
+    bool flashVisible;
+    double pulsePercent;
+  };
+
+  enum class CalibrationState : uint8_t {
+    Idle,
+    Running,
+    Analyzing,
+    Done,
+  };
+
+  // Progress of the last warmup or warmupAsync.
+  enum class WarmupState : uint8_t {
+    Idle,
+    Probing,
+    Opening,
+    Ready,
+    Unsupported,
+    Failed,
+  };
+
+  // Whether pattern pulses may be sent to the native overlay. Pending while
+  // the first preparation is in flight; a Ready overlay stays Ready while a
+  // later pattern re-validates it.
+  enum class OverlayReadiness : uint8_t {
+    Unavailable,
+    Pending,
+    Ready,
+  };
+
+  enum class PlaybackSeekTarget : uint8_t {
+    None,
+    Symbol,
+    Character,
+  };
+
+  struct PlaybackPosition {
     uint64_t sequence;
-    PlaybackSymbol symbol;
-    double expectedTimestampMs;
-    double durationMs;
+    uint32_t character;
     double offsetMs;
   };
 
@@ -83,25 +201,82 @@ class OutputsAudio final : public HybridOutputsAudioSpec,
   };
 
   void ensureStreamLocked(double toneHz);
-  void startStreamLocked();
-  void closeStreamLocked();
+  // Opens (or joins) the engine stream silently at toneHz; false when it did
+  // not come up.
+  bool warmStream(double toneHz);
+  void releaseEngineLocked();
   void startToneInternal(const ToneStartOptions& options, bool cancelPlayback);
+  void startResolvedTone(double toneHz,
+                         float gain,
+                         const EnvelopeConfig& envelope,
+                         double expectedStartMs,
+                         uint32_t correlationTag);
+  // sequence/generation identify a pattern symbol for frame marks; 0 for
+  // free-running tones. correlationTag (CorrelationLog) is logged with the
+  // first audible sample.
+  void startResolvedToneLocked(double toneHz,
+                               float gain,
+                               const EnvelopeConfig& envelope,
+                               double expectedStartMs,
+                               uint64_t sequence,
+                               uint64_t generation,
+                               uint32_t correlationTag);
+  void stopToneLocked(float releaseMs);
   float resolveGain(const std::optional<double>& gainOpt) const;
   EnvelopeConfig resolveEnvelope(const std::optional<ToneEnvelopeOptions>& envelopeOpt) const;
   float computeRampStep(float magnitude, float durationMs) const;
   void cancelPlaybackThread(bool join);
   void resetSymbolInfo();
-  void runPattern(std::vector<PlaybackSymbol> pattern,
+  // Checks the overlay on a background thread and resolves with the result;
+  // joins the preparation already in flight if there is one.
+  std::shared_future<bool> prepareOverlay();
+  bool overlayReady() const { return mOverlayReadiness.load(std::memory_order_acquire) == OverlayReadiness::Ready; }
+  // Returns true for the call that took the overlay down, which is the one
+  // worth a (JNI) debug-string lookup.
+  bool markOverlayUnavailable();
+  ChannelLeads resolveChannelLeads(bool torchEnabled, bool overlayEnabled, bool hapticsEnabled) const;
+  void startPattern(const PlaybackRequest& request, const std::string* code);
+  bool requestPlaybackSeek(PlaybackSeekTarget target, uint64_t index);
+  // correlationTags[i] tags symbol sequence i + 1; shorter than the
+  // pattern (or empty) leaves the rest untagged.
+  void runPattern(PatternTimeline timeline,
+                  std::vector<int64_t> hapticTimings,
+                  std::vector<uint32_t> correlationTags,
                   double toneHz,
                   float gain,
                   double unitMs,
+                  ChannelLeads leads,
+                  ReplayOutputs outputs,
+                  uint64_t generation,
+                  uint64_t runId,
                   std::chrono::steady_clock::time_point patternStart);
+  void submitActuatorCommand(ActuatorCommandType type,
+                             bool enabled,
+                             double value,
+                             double targetTimeMs,
+                             double leadMs,
+                             uint64_t sequence,
+                             uint64_t generation,
+                             uint32_t correlationTag = 0);
+  // Untimed outputs-off command with no listener: it runs even when the
+  // worker reaches it after this object detached, which teardown relies on.
+  void submitCleanupCommand(ActuatorCommandType type, double value = 0.0);
+  // Caller holds mCalibrationMutex. Waits out a callback still rendering
+  // probes and an analysis still running, so the calibrator can be read or
+  // reconfigured afterwards.
+  void stopCalibrationLocked();
+  // Caller holds mCalibrationMutex. Applies the result to the route profile
+  // and stores the JSON getLatencyCalibration reports from then on.
+  void finishCalibrationLocked(const LoopbackCalibrator::Result& result);
   void logEvent(const char* event, const char* fmt = nullptr, ...) const;
-  void emitSymbolDispatchEvent(const PlaybackDispatchEvent& event);
+  // Resolves correlationTag into the event's correlationId on the way out.
+  void emitSymbolDispatchEvent(PlaybackDispatchEvent& event, uint32_t correlationTag);
+  void emitPlaybackProgressEvent(PlaybackProgressEvent& event, uint32_t correlationTag);
 
+  // Guards this client's tone state and its registration with AudioEngine,
+  // which owns the actual stream.
   std::mutex mStreamMutex;
-  StreamPtr mStream;
-  double mSampleRate;
+  bool mEngineClient;
   std::atomic<double> mFrequency;
   std::atomic<float> mTargetGain;
   std::atomic<float> mCurrentGain;
@@ -110,8 +285,21 @@ class OutputsAudio final : public HybridOutputsAudioSpec,
   std::atomic<bool> mStreamReady;
   std::atomic<bool> mSupportKnown;
   bool mSupported;
+  // Last warmup (sync or async). The async one runs on mWarmupThread, which is
+  // joined by the next warmupAsync or by teardown.
+  std::atomic<WarmupState> mWarmupState;
+  std::atomic<double> mWarmupElapsedMs;
+  std::mutex mWarmupMutex;
+  std::thread mWarmupThread;
+  std::shared_ptr<Promise<bool>> mWarmupPromise;
   EnvelopeConfig mEnvelopeConfig;
   double mPhase;
+  // mFrequency is the target; the callback slews towards it over the
+  // requested glide (one-shot, consumed with the target change).
+  std::atomic<double> mGlideMs;
+  double mOscillatorHz;
+  double mGlideTargetHz;
+  double mGlideStepHz;
 
   std::atomic<bool> mToneActive;
   std::atomic<bool> mToneStartLogged;
@@ -119,19 +307,65 @@ class OutputsAudio final : public HybridOutputsAudioSpec,
   std::atomic<bool> mToneStopLogged;
   std::atomic<double> mToneStartRequestedMs;
   std::atomic<double> mToneActualStartMs;
+  // Timeline start of the current pattern tone, 0 for free-running tones.
+  std::atomic<double> mToneExpectedStartMs;
+  // Pattern symbol the current tone plays; the callback publishes an
+  // AudioFrameMark for it on the frame the tone starts.
+  std::atomic<uint64_t> mToneSequence;
+  std::atomic<uint64_t> mToneGeneration;
+  std::atomic<uint32_t> mToneCorrelationTag;
+  // routeShiftMs of the running pattern; frame marks expect the tone there.
+  std::atomic<double> mPatternRouteShiftMs;
 
   std::mutex mSymbolInfoMutex;
   uint64_t mSymbolSequence;
-  std::deque<SymbolSnapshot> mSymbolSnapshots;
+  static constexpr std::size_t kMaxSymbolSnapshots = 64;
+  FixedRing<SymbolSnapshot, kMaxSymbolSnapshots> mSymbolSnapshots;
   double mPatternStartTimestampMs;
+  // Compiled slice of the running pattern: the symbol being played plus what
+  // lies within kScheduleHorizonMs of it. Written by the playback thread.
+  static constexpr std::size_t kScheduleWindowCapacity = 512;
   std::mutex mScheduleMutex;
-  std::vector<ScheduledSymbol> mScheduledSymbols;
+  FixedRing<ScheduledSymbol, kScheduleWindowCapacity> mScheduleWindow;
   std::thread mPlaybackThread;
   std::mutex mPlaybackMutex;
-  std::atomic<bool> mPlaybackCancel;
+  // A cancelled pattern thread is detached rather than joined on the caller's
+  // thread. Pattern threads still alive, counted under mPlaybackMutex;
+  // teardown waits for the count to drop before the object can go away.
+  uint32_t mLivePlaybackThreads;
+  std::condition_variable mPlaybackThreadsDone;
+  // Bumped by every cancel. A pattern thread compares it with the id it was
+  // started with before each write to shared state, under the lock guarding
+  // that state, so a superseded thread can finish in the background.
+  std::atomic<uint64_t> mPlaybackRunId;
   std::atomic<bool> mPlaybackRunning;
+  // Pause and seek requests for the running pattern. The playback thread
+  // applies them at its next wake-up and parks on the condition while paused.
+  std::mutex mPlaybackControlMutex;
+  std::condition_variable mPlaybackControlCondition;
+  std::atomic<bool> mPlaybackControlPending;
+  bool mPauseRequested;
+  bool mPlaybackPaused;
+  double mPauseRequestedAtMs;
+  // Where a parked playback thread will resume; the window is empty meanwhile.
+  PlaybackPosition mPausedPosition;
+  PlaybackSeekTarget mSeekTarget;
+  uint64_t mSeekIndex;
+  std::atomic<uint64_t> mPatternSymbolCount;
+  std::atomic<uint64_t> mPatternCharacterCount;
+  // Live tempo and pitch for the running pattern, taken up by the playback
+  // thread at the next mark boundary; 0 means no change pending.
+  std::atomic<double> mRequestedUnitMs;
+  std::atomic<double> mRequestedToneHz;
+  // Glide for mRequestedToneHz, written before it.
+  std::atomic<double> mRequestedGlideMs;
+  std::atomic<uint64_t> mActuatorGeneration;
+  std::atomic<bool> mHapticWaveformActive;
   std::mutex mCallbackMutex;
-  std::optional<std::function<void(const PlaybackDispatchEvent&)>> mSymbolDispatchCallback;
+  // Shared so the playback thread can take a reference without copying the
+  // std::function (and its captured state) for every event.
+  std::shared_ptr<const std::function<void(const PlaybackDispatchEvent&)>> mSymbolDispatchCallback;
+  std::shared_ptr<const std::function<void(const PlaybackProgressEvent&)>> mPlaybackProgressCallback;
   bool mReplayFlashEnabled;
   bool mReplayHapticsEnabled;
   bool mReplayTorchEnabled;
@@ -139,10 +373,39 @@ class OutputsAudio final : public HybridOutputsAudioSpec,
   int32_t mReplayFlashTintColorArgb;
   std::optional<double> mReplayFlashOverridePercent;
   std::optional<int32_t> mReplayFlashOverrideTintArgb;
-  std::atomic<bool> mNativeOverlayAvailable;
+  std::atomic<OverlayReadiness> mOverlayReadiness;
+  std::mutex mOverlayPrepareMutex;
+  std::thread mOverlayPrepareThread;
+  std::shared_future<bool> mOverlayReadyFuture;
   std::atomic<bool> mNativeOverlayActive;
   std::atomic<bool> mExternalOverlayActive;
   std::atomic<bool> mScreenBrightnessBoostEnabled;
+  KeyerEngine mKeyer;
+  double mKeyerToneHz;
+  std::atomic<float> mKeyerGain;
+  std::atomic<float> mKeyerStepUp;
+  std::atomic<float> mKeyerStepDown;
+  std::mutex mPressClassifierMutex;
+  PressClassifier mPressClassifier;
+  // Guards start/stop and the consumer side of mCwReceiver; the input
+  // callback only touches its realtime half.
+  std::mutex mCwReceiverMutex;
+  CwReceiver mCwReceiver;
+  CwInputStream mCwInput;
+  // Loopback calibration. The callback renders probes while
+  // mCalibrationRendering is set and flags mCalibrationInRender around it;
+  // everything else is guarded by mCalibrationMutex.
+  std::mutex mCalibrationMutex;
+  LoopbackCalibrator mCalibrator;
+  CalibrationInputStream mCalibrationInput;
+  std::atomic<bool> mCalibrationRendering;
+  std::atomic<bool> mCalibrationInRender;
+  CalibrationState mCalibrationState;
+  std::future<LoopbackCalibrator::Result> mCalibrationAnalysis;
+  double mCalibrationStartedMs;
+  AudioRoute mCalibrationRoute;
+  std::string mCalibrationDevice;
+  std::string mCalibrationResultJson;
 };
 
 } // namespace margelo::nitro::morse
@@ -0,0 +1,210 @@
+#include "PatternTimeline.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+namespace margelo::nitro::morse {
+
+namespace {
+constexpr double kDashUnits = 3.0;
+constexpr double kSymbolGapUnits = 1.0;
+// Gap elements add to the one-unit gap that already follows every mark.
+constexpr double kCharacterGapUnits = 3.0 - kSymbolGapUnits;
+constexpr double kWordGapUnits = 7.0 - kSymbolGapUnits;
+} // namespace
+
+PatternTimeline::PatternTimeline(const std::vector<PlaybackSymbol>& pattern,
+                                 double unitMs,
+                                 double firstOffsetMs,
+                                 double patternStartMs) {
+  mElements.reserve(pattern.size());
+  for (const PlaybackSymbol symbol : pattern) {
+    switch (symbol) {
+      case PlaybackSymbol::DOT:
+        mElements.push_back(Element::Dot);
+        break;
+      case PlaybackSymbol::DASH:
+        mElements.push_back(Element::Dash);
+        break;
+      default:
+        mElements.push_back(Element::CharacterGap);
+        break;
+    }
+  }
+  initialise(unitMs, firstOffsetMs, patternStartMs);
+}
+
+PatternTimeline PatternTimeline::fromCode(const std::string& code,
+                                          double unitMs,
+                                          double firstOffsetMs,
+                                          double patternStartMs) {
+  PatternTimeline timeline;
+  timeline.mElements.reserve(code.size());
+  for (const char c : code) {
+    Element element;
+    if (c == '.') {
+      element = Element::Dot;
+    } else if (c == '-') {
+      element = Element::Dash;
+    } else if (c == ' ') {
+      element = Element::CharacterGap;
+    } else if (c == '/') {
+      element = Element::WordGap;
+    } else {
+      continue;
+    }
+    auto& elements = timeline.mElements;
+    const bool isGap = element == Element::CharacterGap || element == Element::WordGap;
+    if (isGap && !elements.empty() &&
+        (elements.back() == Element::CharacterGap || elements.back() == Element::WordGap)) {
+      // " / " and double spaces collapse into a single word gap.
+      elements.back() = Element::WordGap;
+      continue;
+    }
+    elements.push_back(element);
+  }
+  timeline.initialise(unitMs, firstOffsetMs, patternStartMs);
+  return timeline;
+}
+
+void PatternTimeline::initialise(double unitMs, double firstOffsetMs, double patternStartMs) {
+  mUnitMs = unitMs;
+  mPatternStartMs = patternStartMs;
+  mCursor = Cursor{ 0, firstOffsetMs, 0, 0, 0, false, false };
+  bool inCharacter = false;
+  bool inWord = false;
+  for (const Element element : mElements) {
+    const bool mark = element == Element::Dot || element == Element::Dash;
+    if (mark) {
+      ++mSymbolCount;
+      if (!inCharacter) {
+        ++mCharacterCount;
+      }
+      if (!inWord) {
+        ++mWordCount;
+      }
+    }
+    inCharacter = mark;
+    inWord = element != Element::WordGap && (inWord || mark);
+  }
+  mCheckpoints.reserve(mElements.size() / kCheckpointStride + 1);
+  mCheckpoints.push_back(mCursor);
+  skipGaps();
+}
+
+ScheduledSymbol PatternTimeline::next() {
+  const Element element = mElements[mCursor.index];
+  ScheduledSymbol info{};
+  info.symbol = element == Element::Dash ? PlaybackSymbol::DASH : PlaybackSymbol::DOT;
+  info.offsetMs = mCursor.offsetMs;
+  info.expectedTimestampMs = mPatternStartMs + mCursor.offsetMs;
+  info.durationMs = mUnitMs * (element == Element::Dash ? kDashUnits : 1.0);
+  advance();
+  info.sequence = mCursor.sequence;
+  info.character = mCursor.characters - 1;
+  info.word = mCursor.words - 1;
+  const bool atEnd = done();
+  info.characterEnd = atEnd || mElements[mCursor.index] == Element::CharacterGap ||
+                      mElements[mCursor.index] == Element::WordGap;
+  info.wordEnd = atEnd || mElements[mCursor.index] == Element::WordGap;
+  skipGaps();
+  return info;
+}
+
+bool PatternTimeline::seekToSymbol(uint64_t sequence) {
+  if (sequence == 0 || sequence > mSymbolCount) {
+    return false;
+  }
+  // Checkpoint 0 always satisfies the predicate, so the result is never begin().
+  const auto it = std::partition_point(mCheckpoints.begin(), mCheckpoints.end(), [&](const Cursor& cursor) {
+    return cursor.sequence < sequence;
+  });
+  mCursor = *std::prev(it);
+  skipGaps();
+  while (mCursor.sequence + 1 < sequence) {
+    advance();
+    skipGaps();
+  }
+  return true;
+}
+
+bool PatternTimeline::seekToCharacter(std::size_t character) {
+  if (character >= mCharacterCount) {
+    return false;
+  }
+  const auto it = std::partition_point(mCheckpoints.begin(), mCheckpoints.end(), [&](const Cursor& cursor) {
+    return cursor.characters <= character;
+  });
+  mCursor = *std::prev(it);
+  // Stop on the mark that starts the character: one that does not continue
+  // the previous mark run.
+  while (mCursor.characters < character || mCursor.inCharacter ||
+         (mElements[mCursor.index] != Element::Dot && mElements[mCursor.index] != Element::Dash)) {
+    advance();
+  }
+  return true;
+}
+
+void PatternTimeline::retime(uint64_t playedSequence,
+                             double playedOffsetMs,
+                             double playedDurationMs,
+                             double unitMs) {
+  if (!seekToSymbol(playedSequence)) {
+    mUnitMs = unitMs;
+    return;
+  }
+  mCheckpoints.resize(std::min(mCheckpoints.size(), mCursor.index / kCheckpointStride + 1));
+  mCursor.offsetMs = playedOffsetMs;
+  mUnitMs = unitMs;
+  const double retimedMarkMs = unitMs * (mElements[mCursor.index] == Element::Dash ? kDashUnits : 1.0);
+  const std::size_t checkpoints = mCheckpoints.size();
+  advance();
+  mCursor.offsetMs += playedDurationMs - retimedMarkMs;
+  if (mCheckpoints.size() != checkpoints) {
+    mCheckpoints.back().offsetMs = mCursor.offsetMs;
+  }
+  skipGaps();
+}
+
+void PatternTimeline::advance() {
+  const Element element = mElements[mCursor.index];
+  switch (element) {
+    case Element::Dot:
+    case Element::Dash:
+      if (!mCursor.inCharacter) {
+        ++mCursor.characters;
+        mCursor.inCharacter = true;
+        if (!mCursor.inWord) {
+          ++mCursor.words;
+          mCursor.inWord = true;
+        }
+      }
+      ++mCursor.sequence;
+      mCursor.offsetMs += mUnitMs * (element == Element::Dash ? kDashUnits : 1.0);
+      if (mCursor.index + 1 < mElements.size()) {
+        mCursor.offsetMs += mUnitMs * kSymbolGapUnits;
+      }
+      break;
+    case Element::CharacterGap:
+      mCursor.inCharacter = false;
+      mCursor.offsetMs += mUnitMs * kCharacterGapUnits;
+      break;
+    case Element::WordGap:
+      mCursor.inCharacter = false;
+      mCursor.inWord = false;
+      mCursor.offsetMs += mUnitMs * kWordGapUnits;
+      break;
+  }
+  ++mCursor.index;
+  if (mCursor.index % kCheckpointStride == 0 && mCursor.index / kCheckpointStride == mCheckpoints.size()) {
+    mCheckpoints.push_back(mCursor);
+  }
+}
+
+void PatternTimeline::skipGaps() {
+  while (!done() && mElements[mCursor.index] != Element::Dot && mElements[mCursor.index] != Element::Dash) {
+    advance();
+  }
+}
+
+} // namespace margelo::nitro::morse
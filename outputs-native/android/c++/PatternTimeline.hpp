@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "PlaybackSymbol.hpp"
+
+namespace margelo::nitro::morse {
+
+struct ScheduledSymbol {
+  uint64_t sequence;
+  PlaybackSymbol symbol;
+  // 0-based index of the character this mark belongs to.
+  uint32_t character;
+  // 0-based index of the word that character belongs to.
+  uint32_t word;
+  // Last mark of its character, and of its word (a pattern's end closes both).
+  bool characterEnd;
+  bool wordEnd;
+  double expectedTimestampMs;
+  double durationMs;
+  double offsetMs;
+  // Set once the overlay pulse for this symbol has been queued.
+  bool overlayQueued;
+  // Set once the symbol is covered by a queued haptic waveform chunk.
+  bool hapticQueued;
+  // CorrelationLog tag of the press behind this symbol; 0 when untagged.
+  uint32_t correlationTag;
+};
+
+// Lazy timeline over a playback pattern. Symbols are compiled one at a time as
+// the playback thread asks for them, so a pattern of any length costs the same
+// to start and only the window ahead of the playhead is ever materialised.
+// Timing follows the usual 1/3 unit marks with a one-unit intra-character gap,
+// three units between characters and seven between words.
+//
+// Every kCheckpointStride elements the compiler records its full cursor, which
+// gives seeks an index over the part of the timeline compiled so far: a binary
+// search to the nearest checkpoint plus at most one stride of stepping.
+class PatternTimeline {
+ public:
+  PatternTimeline() = default;
+  PatternTimeline(const std::vector<PlaybackSymbol>& pattern,
+                  double unitMs,
+                  double firstOffsetMs,
+                  double patternStartMs);
+
+  // Morse text: '.' and '-' are marks, a space separates characters and '/'
+  // or a run of spaces separates words. Anything else is ignored.
+  static PatternTimeline fromCode(const std::string& code,
+                                  double unitMs,
+                                  double firstOffsetMs,
+                                  double patternStartMs);
+
+  bool done() const { return mCursor.index >= mElements.size(); }
+  // Offset and sequence of the symbol next() returns; only meaningful while
+  // !done().
+  double nextOffsetMs() const { return mCursor.offsetMs; }
+  uint64_t nextSequence() const { return mCursor.sequence + 1; }
+  uint32_t nextCharacter() const { return mCursor.inCharacter ? mCursor.characters - 1 : mCursor.characters; }
+  ScheduledSymbol next();
+
+  // Repositions the cursor so next() returns the symbol with the given
+  // 1-based sequence, or the first mark of the given 0-based character.
+  // Seeking past the compiled region compiles up to the target once; returns
+  // false (cursor untouched) when the target does not exist.
+  bool seekToSymbol(uint64_t sequence);
+  bool seekToCharacter(std::size_t character);
+
+  // Moves the origin the offsets are measured from (pause/resume).
+  void rebase(double patternStartMs) { mPatternStartMs = patternStartMs; }
+
+  // Switches to a new unit from the gap after an already played mark. The
+  // mark keeps the offset and length it actually played with, so the rest of
+  // the schedule continues from where the audio is. Checkpoints beyond it are
+  // dropped and rebuilt as the cursor moves forward again; earlier ones keep
+  // their old offsets, so a seek back across a retime plays at the new unit
+  // and callers rebase onto the offset the seek lands on.
+  void retime(uint64_t playedSequence, double playedOffsetMs, double playedDurationMs, double unitMs);
+  double unitMs() const { return mUnitMs; }
+
+  std::size_t patternLength() const { return mElements.size(); }
+  std::size_t symbolCount() const { return mSymbolCount; }
+  std::size_t characterCount() const { return mCharacterCount; }
+  std::size_t wordCount() const { return mWordCount; }
+
+ private:
+  enum class Element : uint8_t {
+    Dot,
+    Dash,
+    CharacterGap,
+    WordGap,
+  };
+
+  struct Cursor {
+    std::size_t index;
+    double offsetMs;
+    // Marks emitted and characters and words started before index.
+    uint64_t sequence;
+    uint32_t characters;
+    uint32_t words;
+    bool inCharacter;
+    bool inWord;
+  };
+
+  static constexpr std::size_t kCheckpointStride = 64;
+
+  void initialise(double unitMs, double firstOffsetMs, double patternStartMs);
+  void advance();
+  void skipGaps();
+
+  std::vector<Element> mElements;
+  // mCheckpoints[k] is the cursor at element k * kCheckpointStride; reserved
+  // up front so compiling never allocates on the playback thread.
+  std::vector<Cursor> mCheckpoints;
+  Cursor mCursor{};
+  double mUnitMs = 0.0;
+  double mPatternStartMs = 0.0;
+  std::size_t mSymbolCount = 0;
+  std::size_t mCharacterCount = 0;
+  std::size_t mWordCount = 0;
+};
+
+} // namespace margelo::nitro::morse
@@ -0,0 +1,313 @@
+#include "PressClassifier.hpp"
+
+#include "MorseTable.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+namespace margelo::nitro::morse {
+
+namespace {
+constexpr double kMinUnitMs = 10.0;
+constexpr double kMaxUnitMs = 1200.0;
+// Cluster centroids move by this fraction of the log error per sample.
+constexpr double kClusterRate = 0.2;
+// The cluster that did not receive the sample is pulled gently towards the
+// canonical 1:3 ratio so a run of dots still tracks a change of speed.
+constexpr double kCoupledRate = 0.05;
+constexpr double kIntraGapRate = 0.15;
+constexpr double kMinDashToDotRatio = 1.8;
+// Marks shorter than this fraction of a dot are treated as contact bounce.
+constexpr double kBounceFraction = 0.25;
+// Marks shorter than this fraction of a dot are decoded but not learned from,
+// so a burst of glitches cannot walk the speed estimate down.
+constexpr double kLearnMinDots = 0.5;
+// Marks longer than this many dashes are classified but not learned from.
+constexpr double kOutlierDashes = 2.5;
+// Recent marks are re-split once this many are known, at the widest gap
+// between them if it is at least this ratio and leaves two marks per side.
+constexpr std::size_t kMinResplitMarks = 6;
+constexpr double kMinResplitRatio = 1.5;
+constexpr std::size_t kMinResplitSide = 2;
+constexpr double kInterCharUnits = 3.0;
+constexpr double kWordUnits = 7.0;
+
+inline double moveInLog(double current, double target, double rate) {
+  return std::exp(std::log(current) + rate * (std::log(target) - std::log(current)));
+}
+
+// 0 on the boundary, 1 at (or past) the cluster centre, measured in log time.
+inline double logConfidence(double value, double boundary, double centre) {
+  const double span = std::fabs(std::log(centre) - std::log(boundary));
+  if (span <= 0.0) {
+    return 0.0;
+  }
+  return std::clamp(std::fabs(std::log(value) - std::log(boundary)) / span, 0.0, 1.0);
+}
+} // namespace
+
+PressClassifier::PressClassifier(double unitMs) {
+  reset(unitMs);
+}
+
+void PressClassifier::reset(double unitMs) {
+  const double unit = std::clamp(std::isfinite(unitMs) ? unitMs : 60.0, kMinUnitMs, kMaxUnitMs);
+  mDotMs = unit;
+  mDashMs = unit * 3.0;
+  mIntraGapMs = unit;
+  mMarks = 0;
+  mRecentMarksMs.fill(0.0);
+  mRecentMarkCount = 0;
+  mRecentMarkNext = 0;
+  mKeyDown = false;
+  mKeyDownAtMs = 0.0;
+  mLastKeyUpMs = 0.0;
+  mHasKeyUp = false;
+  mPattern.clear();
+  mLetterConfidence = 1.0;
+  mLetterStartMs = 0.0;
+  mLetterEndMs = 0.0;
+  mWord.clear();
+  mWordConfidence = 1.0;
+  mWordStartMs = 0.0;
+  mWordEndMs = 0.0;
+}
+
+double PressClassifier::unitEstimateMs() const {
+  return std::clamp(0.5 * (mDotMs + mDashMs / 3.0), kMinUnitMs, kMaxUnitMs);
+}
+
+double PressClassifier::markThresholdMs() const {
+  return std::sqrt(mDotMs * mDashMs);
+}
+
+double PressClassifier::letterGapThresholdMs() const {
+  return std::sqrt(mIntraGapMs * unitEstimateMs() * kInterCharUnits);
+}
+
+double PressClassifier::wordGapThresholdMs() const {
+  const double unit = unitEstimateMs();
+  return std::sqrt(unit * kInterCharUnits * unit * kWordUnits);
+}
+
+void PressClassifier::observeMark(double durationMs, bool isDash) {
+  mMarks += 1;
+  if (isDash) {
+    mDashMs = moveInLog(mDashMs, durationMs, kClusterRate);
+    mDotMs = moveInLog(mDotMs, mDashMs / 3.0, kCoupledRate);
+  } else {
+    mDotMs = moveInLog(mDotMs, durationMs, kClusterRate);
+    mDashMs = moveInLog(mDashMs, mDotMs * 3.0, kCoupledRate);
+  }
+  mDotMs = std::clamp(mDotMs, kMinUnitMs, kMaxUnitMs);
+  mDashMs = std::clamp(mDashMs, mDotMs * kMinDashToDotRatio, kMaxUnitMs * 3.0);
+}
+
+void PressClassifier::rememberMark(double durationMs) {
+  mRecentMarksMs[mRecentMarkNext] = durationMs;
+  mRecentMarkNext = (mRecentMarkNext + 1) % kRecentMarks;
+  mRecentMarkCount = std::min(mRecentMarkCount + 1, kRecentMarks);
+}
+
+void PressClassifier::resplitFromRecentMarks() {
+  if (mRecentMarkCount < kMinResplitMarks) {
+    return;
+  }
+  std::array<double, kRecentMarks> sorted = mRecentMarksMs;
+  std::sort(sorted.begin(), sorted.begin() + static_cast<std::ptrdiff_t>(mRecentMarkCount));
+  std::size_t split = 0;
+  double widestRatio = 0.0;
+  for (std::size_t i = kMinResplitSide - 1; i + kMinResplitSide < mRecentMarkCount; ++i) {
+    const double ratio = sorted[i + 1] / sorted[i];
+    if (ratio > widestRatio) {
+      widestRatio = ratio;
+      split = i;
+    }
+  }
+  // A run of one kind of mark has no gap this wide; the clusters keep
+  // following it through observeMark.
+  if (widestRatio < kMinResplitRatio) {
+    return;
+  }
+  const double threshold = markThresholdMs();
+  if (threshold > sorted[split] && threshold <= sorted[split + 1]) {
+    return;
+  }
+  double dotLog = 0.0;
+  double dashLog = 0.0;
+  for (std::size_t i = 0; i < mRecentMarkCount; ++i) {
+    (i <= split ? dotLog : dashLog) += std::log(sorted[i]);
+  }
+  mDotMs = std::clamp(std::exp(dotLog / static_cast<double>(split + 1)), kMinUnitMs, kMaxUnitMs);
+  mDashMs = std::clamp(std::exp(dashLog / static_cast<double>(mRecentMarkCount - split - 1)),
+                       mDotMs * kMinDashToDotRatio,
+                       kMaxUnitMs * 3.0);
+}
+
+void PressClassifier::keyDown(double timestampMs, std::vector<DecodedMorseEvent>& events) {
+  if (mKeyDown) {
+    return;
+  }
+  if (mHasKeyUp && !mPattern.empty()) {
+    const double gapMs = timestampMs - mLastKeyUpMs;
+    const double letterThreshold = letterGapThresholdMs();
+    const double wordThreshold = wordGapThresholdMs();
+    if (gapMs >= letterThreshold) {
+      const double interCentre = unitEstimateMs() * kInterCharUnits;
+      const double letterGapConfidence = gapMs >= wordThreshold
+                                             ? logConfidence(gapMs, wordThreshold, unitEstimateMs() * kWordUnits)
+                                             : std::min(logConfidence(gapMs, letterThreshold, interCentre),
+                                                        logConfidence(gapMs, wordThreshold, interCentre));
+      completeLetter(events, letterGapConfidence);
+      if (gapMs >= wordThreshold) {
+        completeWord(events, letterGapConfidence);
+      }
+    } else {
+      mLetterConfidence =
+          std::min(mLetterConfidence, logConfidence(gapMs, letterThreshold, mIntraGapMs));
+      mIntraGapMs = moveInLog(mIntraGapMs, std::max(gapMs, kMinUnitMs * 0.5), kIntraGapRate);
+    }
+  } else if (mHasKeyUp && !mWord.empty() && timestampMs - mLastKeyUpMs >= wordGapThresholdMs()) {
+    completeWord(events, logConfidence(timestampMs - mLastKeyUpMs,
+                                       wordGapThresholdMs(),
+                                       unitEstimateMs() * kWordUnits));
+  }
+  mKeyDown = true;
+  mKeyDownAtMs = timestampMs;
+}
+
+void PressClassifier::keyUp(double timestampMs) {
+  if (!mKeyDown) {
+    return;
+  }
+  mKeyDown = false;
+  const double durationMs = timestampMs - mKeyDownAtMs;
+  if (!(durationMs > mDotMs * kBounceFraction)) {
+    // Bounce: ignore the mark but keep the previous key-up as the gap origin.
+    return;
+  }
+
+  rememberMark(durationMs);
+  resplitFromRecentMarks();
+  const double threshold = markThresholdMs();
+  const bool isDash = durationMs >= threshold;
+  const double confidence = logConfidence(durationMs, threshold, isDash ? mDashMs : mDotMs);
+  if (durationMs >= mDotMs * kLearnMinDots && durationMs <= mDashMs * kOutlierDashes) {
+    observeMark(durationMs, isDash);
+  }
+
+  if (mPattern.empty()) {
+    mLetterStartMs = mKeyDownAtMs;
+    mLetterConfidence = 1.0;
+  }
+  mPattern.push_back(isDash ? '-' : '.');
+  mLetterConfidence = std::min(mLetterConfidence, confidence);
+  mLetterEndMs = timestampMs;
+  mLastKeyUpMs = timestampMs;
+  mHasKeyUp = true;
+}
+
+void PressClassifier::flush(double nowMs, std::vector<DecodedMorseEvent>& events) {
+  if (mKeyDown || !mHasKeyUp) {
+    return;
+  }
+  const double gapMs = nowMs - mLastKeyUpMs;
+  if (!mPattern.empty() && gapMs >= letterGapThresholdMs()) {
+    // The gap is still growing, so only the letter/inter boundary is certain.
+    completeLetter(events, logConfidence(gapMs, letterGapThresholdMs(), unitEstimateMs() * kInterCharUnits));
+  }
+  if (mPattern.empty() && !mWord.empty() && gapMs >= wordGapThresholdMs()) {
+    completeWord(events, logConfidence(gapMs, wordGapThresholdMs(), unitEstimateMs() * kWordUnits));
+  }
+}
+
+void PressClassifier::completeLetter(std::vector<DecodedMorseEvent>& events, double gapConfidence) {
+  if (mPattern.empty()) {
+    return;
+  }
+  const auto decoded = decodeMorsePattern(mPattern);
+  DecodedMorseEvent event;
+  event.kind = DecodedMorseEvent::Kind::Letter;
+  event.text = std::string(1, decoded.value_or('?'));
+  event.pattern = mPattern;
+  event.confidence = decoded.has_value() ? std::min(mLetterConfidence, gapConfidence) : 0.0;
+  event.startMs = mLetterStartMs;
+  event.endMs = mLetterEndMs;
+
+  if (mWord.empty()) {
+    mWordStartMs = mLetterStartMs;
+    mWordConfidence = 1.0;
+  }
+  mWord += event.text;
+  mWordConfidence = std::min(mWordConfidence, event.confidence);
+  mWordEndMs = mLetterEndMs;
+
+  events.push_back(std::move(event));
+  mPattern.clear();
+  mLetterConfidence = 1.0;
+}
+
+void PressClassifier::completeWord(std::vector<DecodedMorseEvent>& events, double gapConfidence) {
+  if (mWord.empty()) {
+    return;
+  }
+  DecodedMorseEvent event;
+  event.kind = DecodedMorseEvent::Kind::Word;
+  event.text = mWord;
+  event.confidence = std::min(mWordConfidence, gapConfidence);
+  event.startMs = mWordStartMs;
+  event.endMs = mWordEndMs;
+  events.push_back(std::move(event));
+  mWord.clear();
+  mWordConfidence = 1.0;
+}
+
+PressClassifier::Summary PressClassifier::summarize() const {
+  return Summary{ unitEstimateMs(),   mDotMs,
+                  mDashMs,            mIntraGapMs,
+                  markThresholdMs(),  letterGapThresholdMs(),
+                  wordGapThresholdMs(), mMarks };
+}
+
+std::string PressClassifier::toJson(const std::vector<DecodedMorseEvent>& events) {
+  std::ostringstream stream;
+  stream.setf(std::ios::fixed, std::ios::floatfield);
+  stream << "[";
+  for (std::size_t i = 0; i < events.size(); ++i) {
+    const auto& event = events[i];
+    const bool isLetter = event.kind == DecodedMorseEvent::Kind::Letter;
+    stream << "{\"type\":\"" << (isLetter ? "letter" : "word") << "\""
+           << ",\"text\":\"" << event.text << "\"";
+    if (isLetter) {
+      stream << ",\"pattern\":\"" << event.pattern << "\"";
+    }
+    stream << ",\"confidence\":" << std::setprecision(3) << event.confidence
+           << ",\"startMs\":" << std::setprecision(3) << event.startMs
+           << ",\"endMs\":" << std::setprecision(3) << event.endMs
+           << "}";
+    if (i + 1 < events.size()) {
+      stream << ",";
+    }
+  }
+  stream << "]";
+  return stream.str();
+}
+
+std::string PressClassifier::toJson(const Summary& summary) {
+  std::ostringstream stream;
+  stream.setf(std::ios::fixed, std::ios::floatfield);
+  stream << "{\"unitMs\":" << std::setprecision(3) << summary.unitMs
+         << ",\"dotMs\":" << std::setprecision(3) << summary.dotMs
+         << ",\"dashMs\":" << std::setprecision(3) << summary.dashMs
+         << ",\"intraGapMs\":" << std::setprecision(3) << summary.intraGapMs
+         << ",\"markThresholdMs\":" << std::setprecision(3) << summary.markThresholdMs
+         << ",\"letterGapThresholdMs\":" << std::setprecision(3) << summary.letterGapThresholdMs
+         << ",\"wordGapThresholdMs\":" << std::setprecision(3) << summary.wordGapThresholdMs
+         << ",\"marks\":" << summary.marks
+         << "}";
+  return stream.str();
+}
+
+} // namespace margelo::nitro::morse
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace margelo::nitro::morse {
+
+struct DecodedMorseEvent {
+  enum class Kind : uint8_t {
+    Letter,
+    Word,
+  };
+
+  Kind kind;
+  // Decoded character for letters ('?' when the pattern is not in the table),
+  // accumulated text for words.
+  std::string text;
+  std::string pattern;
+  double confidence;
+  double startMs;
+  double endMs;
+};
+
+// Incremental key-down/key-up decoder. Dot and dash lengths are tracked as two
+// log-domain clusters so the dot/dash boundary follows the sender's speed and
+// weighting; gap thresholds are derived from the same unit estimate. Letters
+// and words are emitted as soon as the silence after them is long enough, each
+// with a 0..1 confidence taken from the least certain decision that formed it.
+// When the clusters stop separating the recent marks (a seed far off the
+// sender's speed), they are re-split from those marks instead of being walked
+// there one sample at a time.
+class PressClassifier {
+ public:
+  struct Summary {
+    double unitMs;
+    double dotMs;
+    double dashMs;
+    double intraGapMs;
+    double markThresholdMs;
+    double letterGapThresholdMs;
+    double wordGapThresholdMs;
+    uint32_t marks;
+  };
+
+  explicit PressClassifier(double unitMs = 60.0);
+
+  void reset(double unitMs);
+  void keyDown(double timestampMs, std::vector<DecodedMorseEvent>& events);
+  void keyUp(double timestampMs);
+  // Completes the pending letter/word once enough silence has elapsed.
+  void flush(double nowMs, std::vector<DecodedMorseEvent>& events);
+  Summary summarize() const;
+
+  static std::string toJson(const std::vector<DecodedMorseEvent>& events);
+  static std::string toJson(const Summary& summary);
+
+ private:
+  double unitEstimateMs() const;
+  double markThresholdMs() const;
+  double letterGapThresholdMs() const;
+  double wordGapThresholdMs() const;
+  void observeMark(double durationMs, bool isDash);
+  void rememberMark(double durationMs);
+  void resplitFromRecentMarks();
+  void completeLetter(std::vector<DecodedMorseEvent>& events, double gapConfidence);
+  void completeWord(std::vector<DecodedMorseEvent>& events, double gapConfidence);
+
+  double mDotMs;
+  double mDashMs;
+  double mIntraGapMs;
+  uint32_t mMarks;
+  static constexpr std::size_t kRecentMarks = 16;
+  std::array<double, kRecentMarks> mRecentMarksMs;
+  std::size_t mRecentMarkCount;
+  std::size_t mRecentMarkNext;
+
+  bool mKeyDown;
+  double mKeyDownAtMs;
+  double mLastKeyUpMs;
+  bool mHasKeyUp;
+
+  std::string mPattern;
+  double mLetterConfidence;
+  double mLetterStartMs;
+  double mLetterEndMs;
+
+  std::string mWord;
+  double mWordConfidence;
+  double mWordStartMs;
+  double mWordEndMs;
+};
+
+} // namespace margelo::nitro::morse
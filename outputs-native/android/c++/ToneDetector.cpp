@@ -0,0 +1,53 @@
+#include "ToneDetector.hpp"
+
+#include <algorithm>
+
+namespace margelo::nitro::morse {
+
+namespace {
+constexpr double kTwoPi = 6.283185307179586476925286766559;
+} // namespace
+
+ToneDetector::ToneDetector()
+    : mSampleRate(48000.0),
+      mCoeff(0.0),
+      mMagnitudeScale(1.0),
+      mBlockSize(0),
+      mBlockFill(0),
+      mS1(0.0),
+      mS2(0.0),
+      mFramesProcessed(0) {}
+
+void ToneDetector::configure(const Config& config) {
+  mSampleRate = config.sampleRate > 0.0 ? config.sampleRate : 48000.0;
+  const double blockMs = std::clamp(config.blockMs, 1.0, 20.0);
+  mBlockSize = std::max<uint32_t>(16, static_cast<uint32_t>(std::lround(mSampleRate * blockMs / 1000.0)));
+
+  // Snap the tone to the nearest bin centre of this block length so the
+  // Goertzel response peaks exactly on it.
+  const double toneHz = std::clamp(config.toneHz, 100.0, mSampleRate * 0.45);
+  const double bin = std::round(toneHz * static_cast<double>(mBlockSize) / mSampleRate);
+  const double omega = kTwoPi * bin / static_cast<double>(mBlockSize);
+  mCoeff = 2.0 * std::cos(omega);
+
+  mWindow.assign(mBlockSize, 0.0f);
+  double windowSum = 0.0;
+  for (uint32_t i = 0; i < mBlockSize; ++i) {
+    const double w = 0.5 - 0.5 * std::cos(kTwoPi * static_cast<double>(i) / static_cast<double>(mBlockSize - 1));
+    mWindow[i] = static_cast<float>(w);
+    windowSum += w;
+  }
+  // A full-scale sine at the bin centre reads as amplitude 1.0.
+  mMagnitudeScale = windowSum > 0.0 ? 2.0 / windowSum : 1.0;
+  reset();
+}
+
+void ToneDetector::reset() {
+  mBlockFill = 0;
+  mS1 = 0.0;
+  mS2 = 0.0;
+  mFramesProcessed = 0;
+  mTracker.reset();
+}
+
+} // namespace margelo::nitro::morse
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "KeyingTracker.hpp"
+
+namespace margelo::nitro::morse {
+
+// Block Goertzel detector for a single CW tone. Each block yields one
+// magnitude, which KeyingTracker turns into keying edges. `process` is
+// allocation-free and safe to call from an audio callback.
+class ToneDetector {
+ public:
+  struct Config {
+    double sampleRate;
+    double toneHz;
+    double blockMs;
+  };
+
+  struct Edge {
+    bool keyDown;
+    // Sample-clock time of the transition, ms since the last reset().
+    double timestampMs;
+    float level;
+  };
+
+  using Summary = KeyingTracker::Summary;
+
+  ToneDetector();
+
+  // Allocates the analysis window; call off the audio thread.
+  void configure(const Config& config);
+  void reset();
+  Summary summarize() const { return mTracker.summarize(); }
+  double elapsedMs() const { return static_cast<double>(mFramesProcessed) * 1000.0 / mSampleRate; }
+
+  template <typename Sink>
+  void process(const float* samples, int32_t frames, int32_t channels, Sink&& sink) {
+    if (samples == nullptr || frames <= 0 || mBlockSize == 0) {
+      return;
+    }
+    const int32_t stride = channels > 0 ? channels : 1;
+    const float channelScale = 1.0f / static_cast<float>(stride);
+    for (int32_t frame = 0; frame < frames; ++frame) {
+      float sample = 0.0f;
+      for (int32_t channel = 0; channel < stride; ++channel) {
+        sample += samples[frame * stride + channel];
+      }
+      sample *= channelScale;
+      const double s0 = static_cast<double>(sample * mWindow[mBlockFill]) + mCoeff * mS1 - mS2;
+      mS2 = mS1;
+      mS1 = s0;
+      ++mFramesProcessed;
+      if (++mBlockFill == mBlockSize) {
+        finishBlock(sink);
+      }
+    }
+  }
+
+ private:
+  template <typename Sink>
+  void finishBlock(Sink& sink) {
+    const double power = std::max(0.0, mS1 * mS1 + mS2 * mS2 - mCoeff * mS1 * mS2);
+    const double level = std::sqrt(power) * mMagnitudeScale;
+    mS1 = 0.0;
+    mS2 = 0.0;
+    mBlockFill = 0;
+    if (mTracker.update(level)) {
+      // Attribute the transition to the centre of the block that detected it.
+      const double blockCentreMs =
+          (static_cast<double>(mFramesProcessed) -
+           (static_cast<double>(KeyingTracker::kDebounceBlocks) - 0.5) * static_cast<double>(mBlockSize)) *
+          1000.0 / mSampleRate;
+      sink(Edge{ mTracker.keyed(), blockCentreMs, static_cast<float>(level) });
+    }
+  }
+
+  double mSampleRate;
+  double mCoeff;
+  double mMagnitudeScale;
+  std::vector<float> mWindow;
+  uint32_t mBlockSize;
+  uint32_t mBlockFill;
+  double mS1;
+  double mS2;
+  int64_t mFramesProcessed;
+  KeyingTracker mTracker;
+};
+
+} // namespace margelo::nitro::morse
@@ -0,0 +1,360 @@
+#include "TraceRecorder.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <new>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace margelo::nitro::morse {
+
+namespace {
+constexpr char kMagic[8] = { 'M', 'O', 'R', 'S', 'E', 'T', 'R', 'C' };
+constexpr uint32_t kVersion = 1;
+constexpr std::size_t kMinCapacity = 1024;
+constexpr std::size_t kMaxCapacity = std::size_t{ 1 } << 22;
+// Pseudo thread id for the tone track; real tids never collide with it.
+constexpr uint32_t kToneTrackId = 1;
+
+// Indexed by ActuatorCommandType.
+constexpr const char* kActuatorNames[] = {
+  "jni.torch", "jni.overlay", "jni.vibrate", "jni.brightness", "jni.waveform", "jni.vibrate.cancel", "jni.haptic",
+};
+
+inline int64_t nowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+inline uint32_t currentThreadId() {
+  static thread_local const uint32_t tid = static_cast<uint32_t>(gettid());
+  return tid;
+}
+
+std::size_t roundUpPowerOfTwo(std::size_t value) {
+  std::size_t result = 1;
+  while (result < value) {
+    result <<= 1;
+  }
+  return result;
+}
+
+const char* actuatorName(uint16_t detail) {
+  constexpr std::size_t count = sizeof(kActuatorNames) / sizeof(kActuatorNames[0]);
+  return detail < count ? kActuatorNames[detail] : "jni.unknown";
+}
+} // namespace
+
+struct TraceRecorder::Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t eventSize;
+  uint64_t capacity;
+  std::atomic<uint64_t> writeIndex;
+};
+
+// A slot is valid once `stamp` equals its ring index + 1; writers zero the
+// stamp first so a reader racing a wrap-around sees a mismatch, not a torn
+// record.
+struct TraceRecorder::Event {
+  std::atomic<uint64_t> stamp;
+  int64_t timestampNs;
+  int64_t arg0;
+  double arg1;
+  uint32_t threadId;
+  uint16_t type;
+  uint16_t detail;
+};
+
+TraceRecorder& TraceRecorder::shared() {
+  static TraceRecorder instance;
+  return instance;
+}
+
+bool TraceRecorder::start(const std::string& path, std::size_t capacityEvents, std::string& error) {
+  std::lock_guard<std::mutex> lock(mControlMutex);
+  if (mActive.load(std::memory_order_acquire)) {
+    error = "trace already active";
+    return false;
+  }
+  static_assert(std::atomic<uint64_t>::is_always_lock_free, "trace ring needs lock-free 64-bit atomics");
+  static_assert(sizeof(Event) == 40, "trace events are a fixed on-disk record");
+  const std::size_t capacity =
+      roundUpPowerOfTwo(std::clamp(capacityEvents, kMinCapacity, kMaxCapacity));
+  const std::size_t bytes = sizeof(Header) + capacity * sizeof(Event);
+
+  const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    error = std::string("open failed: ") + std::strerror(errno);
+    return false;
+  }
+  if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+    error = std::string("ftruncate failed: ") + std::strerror(errno);
+    ::close(fd);
+    return false;
+  }
+  void* mapping = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (mapping == MAP_FAILED) {
+    error = std::string("mmap failed: ") + std::strerror(errno);
+    ::close(fd);
+    return false;
+  }
+
+  // ftruncate zero-fills, so every slot starts with stamp 0 (invalid).
+  auto* header = new (mapping) Header();
+  std::memcpy(header->magic, kMagic, sizeof(kMagic));
+  header->version = kVersion;
+  header->eventSize = sizeof(Event);
+  header->capacity = capacity;
+  header->writeIndex.store(0, std::memory_order_relaxed);
+
+  mHeader = header;
+  mEvents = reinterpret_cast<Event*>(static_cast<char*>(mapping) + sizeof(Header));
+  mMask = capacity - 1;
+  mMappedBytes = bytes;
+  mFd = fd;
+  mPath = path;
+  mActive.store(true);
+  return true;
+}
+
+void TraceRecorder::stop() {
+  std::lock_guard<std::mutex> lock(mControlMutex);
+  if (!mActive.load(std::memory_order_acquire)) {
+    return;
+  }
+  mActive.store(false);
+  // Writers announce themselves before re-checking mActive, so once the count
+  // drains nobody can touch the mapping.
+  while (mWriters.load() != 0) {
+    std::this_thread::yield();
+  }
+  ::msync(mHeader, mMappedBytes, MS_ASYNC);
+  ::munmap(mHeader, mMappedBytes);
+  ::close(mFd);
+  mHeader = nullptr;
+  mEvents = nullptr;
+  mMappedBytes = 0;
+  mFd = -1;
+}
+
+void TraceRecorder::record(TraceEventType type, int64_t arg0, double arg1, uint16_t detail) {
+  if (!mActive.load(std::memory_order_relaxed)) {
+    return;
+  }
+  mWriters.fetch_add(1);
+  if (!mActive.load()) {
+    mWriters.fetch_sub(1);
+    return;
+  }
+  const int64_t timestampNs = nowNs();
+  const uint64_t index = mHeader->writeIndex.fetch_add(1, std::memory_order_relaxed);
+  Event& event = mEvents[index & mMask];
+  event.stamp.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  event.timestampNs = timestampNs;
+  event.arg0 = arg0;
+  event.arg1 = arg1;
+  event.threadId = currentThreadId();
+  event.type = static_cast<uint16_t>(type);
+  event.detail = detail;
+  event.stamp.store(index + 1, std::memory_order_release);
+  mWriters.fetch_sub(1, std::memory_order_release);
+}
+
+bool TraceRecorder::exportChromeTrace(const std::string& jsonPath, std::string& error) {
+  std::string path;
+  {
+    std::lock_guard<std::mutex> lock(mControlMutex);
+    path = mPath;
+  }
+  if (path.empty()) {
+    error = "no trace recorded";
+    return false;
+  }
+  return exportChromeTrace(path, jsonPath, error);
+}
+
+bool TraceRecorder::exportChromeTrace(const std::string& ringPath,
+                                      const std::string& jsonPath,
+                                      std::string& error) {
+  const int fd = ::open(ringPath.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    error = std::string("open failed: ") + std::strerror(errno);
+    return false;
+  }
+  struct stat info {};
+  if (::fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < sizeof(Header)) {
+    error = "not a trace file";
+    ::close(fd);
+    return false;
+  }
+  const std::size_t bytes = static_cast<std::size_t>(info.st_size);
+  void* mapping = ::mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (mapping == MAP_FAILED) {
+    error = std::string("mmap failed: ") + std::strerror(errno);
+    return false;
+  }
+
+  const auto* header = static_cast<const Header*>(mapping);
+  const uint64_t capacity = header->capacity;
+  if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 || header->version != kVersion ||
+      header->eventSize != sizeof(Event) || capacity == 0 || (capacity & (capacity - 1)) != 0 ||
+      bytes < sizeof(Header) + capacity * sizeof(Event)) {
+    ::munmap(mapping, bytes);
+    error = "not a trace file";
+    return false;
+  }
+  const auto* events =
+      reinterpret_cast<const Event*>(static_cast<const char*>(mapping) + sizeof(Header));
+
+  struct Record {
+    int64_t timestampNs;
+    int64_t arg0;
+    double arg1;
+    uint32_t threadId;
+    uint16_t type;
+    uint16_t detail;
+  };
+  std::vector<Record> records;
+  const uint64_t writeIndex = header->writeIndex.load(std::memory_order_acquire);
+  const uint64_t first = writeIndex > capacity ? writeIndex - capacity : 0;
+  records.reserve(static_cast<std::size_t>(writeIndex - first));
+  for (uint64_t index = first; index < writeIndex; ++index) {
+    const Event& event = events[index & (capacity - 1)];
+    if (event.stamp.load(std::memory_order_acquire) != index + 1) {
+      continue;
+    }
+    Record record{ event.timestampNs, event.arg0, event.arg1, event.threadId, event.type, event.detail };
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (event.stamp.load(std::memory_order_relaxed) != index + 1) {
+      continue;
+    }
+    records.push_back(record);
+  }
+  ::munmap(mapping, bytes);
+  // Slots are claimed in order but stamped after the clock read, so threads
+  // can interleave by a few hundred nanoseconds.
+  std::stable_sort(records.begin(), records.end(), [](const Record& a, const Record& b) {
+    return a.timestampNs < b.timestampNs;
+  });
+
+  std::ofstream out(jsonPath, std::ios::trunc);
+  if (!out) {
+    error = "cannot write " + jsonPath;
+    return false;
+  }
+  out << std::fixed << std::setprecision(3);
+  out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool firstEvent = true;
+  const auto begin = [&](const char* name, const char* phase, double tsUs, uint32_t tid) {
+    out << (firstEvent ? "" : ",") << "\n{\"name\":\"" << name << "\",\"ph\":\"" << phase
+        << "\",\"ts\":" << tsUs << ",\"pid\":1,\"tid\":" << tid;
+    firstEvent = false;
+  };
+  const auto toUs = [](int64_t ns) { return static_cast<double>(ns) / 1000.0; };
+
+  std::unordered_map<uint32_t, const char*> threadNames;
+  std::unordered_map<uint32_t, int64_t> openCallbacks;
+  std::unordered_map<uint32_t, Record> openActuators;
+  Record openTone{};
+  bool hasOpenTone = false;
+  for (const Record& record : records) {
+    const double tsUs = toUs(record.timestampNs);
+    switch (static_cast<TraceEventType>(record.type)) {
+      case TraceEventType::CallbackBegin:
+        threadNames.emplace(record.threadId, "audio callback");
+        openCallbacks[record.threadId] = record.timestampNs;
+        break;
+      case TraceEventType::CallbackEnd: {
+        const auto it = openCallbacks.find(record.threadId);
+        if (it == openCallbacks.end()) {
+          break;
+        }
+        begin("callback", "X", toUs(it->second), record.threadId);
+        out << ",\"dur\":" << toUs(record.timestampNs - it->second) << ",\"args\":{\"frames\":"
+            << record.arg0 << "}}";
+        openCallbacks.erase(it);
+        break;
+      }
+      case TraceEventType::ToneOn:
+        openTone = record;
+        hasOpenTone = true;
+        break;
+      case TraceEventType::ToneOff:
+        if (!hasOpenTone) {
+          break;
+        }
+        begin("tone", "X", toUs(openTone.timestampNs), kToneTrackId);
+        out << ",\"dur\":" << toUs(record.timestampNs - openTone.timestampNs)
+            << ",\"args\":{\"startFrame\":" << openTone.arg0 << ",\"endFrame\":" << record.arg0
+            << ",\"frames\":" << (record.arg0 - openTone.arg0) << "}}";
+        hasOpenTone = false;
+        break;
+      case TraceEventType::DispatchScheduled:
+        threadNames.emplace(record.threadId, "playback");
+        begin("dispatch.scheduled", "i", tsUs, record.threadId);
+        out << ",\"s\":\"t\",\"args\":{\"sequence\":" << record.arg0 << ",\"leadMs\":" << record.arg1
+            << "}}";
+        break;
+      case TraceEventType::DispatchActual:
+        threadNames.emplace(record.threadId, "playback");
+        begin("dispatch.actual", "i", tsUs, record.threadId);
+        out << ",\"s\":\"t\",\"args\":{\"sequence\":" << record.arg0 << ",\"skewMs\":" << record.arg1
+            << "}}";
+        break;
+      case TraceEventType::ActuatorBegin:
+        threadNames.emplace(record.threadId, "actuator");
+        openActuators[record.threadId] = record;
+        break;
+      case TraceEventType::ActuatorEnd: {
+        const auto it = openActuators.find(record.threadId);
+        if (it == openActuators.end()) {
+          break;
+        }
+        begin(actuatorName(it->second.detail), "X", toUs(it->second.timestampNs), record.threadId);
+        out << ",\"dur\":" << toUs(record.timestampNs - it->second.timestampNs)
+            << ",\"args\":{\"sequence\":" << it->second.arg0
+            << ",\"success\":" << (record.arg1 != 0.0 ? "true" : "false") << "}}";
+        openActuators.erase(it);
+        break;
+      }
+      case TraceEventType::Xrun:
+        begin("xrun", "i", tsUs, record.threadId);
+        out << ",\"s\":\"p\",\"args\":{\"count\":" << record.arg0 << "}}";
+        begin("xruns", "C", tsUs, record.threadId);
+        out << ",\"args\":{\"count\":" << record.arg0 << "}}";
+        break;
+      case TraceEventType::FrameMark:
+        threadNames.emplace(record.threadId, "actuator");
+        begin("frame.mark", "i", tsUs, record.threadId);
+        out << ",\"s\":\"t\",\"args\":{\"sequence\":" << record.arg0 << ",\"offsetMs\":" << record.arg1
+            << "}}";
+        break;
+    }
+  }
+  threadNames.emplace(kToneTrackId, "tone output");
+  for (const auto& [tid, name] : threadNames) {
+    begin("thread_name", "M", 0.0, tid);
+    out << ",\"args\":{\"name\":\"" << name << "\"}}";
+  }
+  out << "\n]}\n";
+  if (!out) {
+    error = "write failed: " + jsonPath;
+    return false;
+  }
+  return true;
+}
+
+} // namespace margelo::nitro::morse
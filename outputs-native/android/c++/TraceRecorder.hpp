@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace margelo::nitro::morse {
+
+enum class TraceEventType : uint16_t {
+  CallbackBegin = 1,
+  CallbackEnd,
+  // arg0 = absolute output frame of the edge.
+  ToneOn,
+  ToneOff,
+  // arg0 = symbol sequence, arg1 = lead (scheduled) or start skew (actual).
+  DispatchScheduled,
+  DispatchActual,
+  // detail = ActuatorCommandType, arg0 = sequence, arg1 = success on end.
+  ActuatorBegin,
+  ActuatorEnd,
+  // arg0 = cumulative xrun count reported by the stream.
+  Xrun,
+  // arg0 = symbol sequence, arg1 = audio presentation minus timeline (ms).
+  FrameMark,
+};
+
+// Binary session trace for the output paths. Events are fixed 40-byte records
+// in a power-of-two ring that lives in a MAP_SHARED file mapping, so the
+// kernel keeps the data even if the process dies mid-session and the file can
+// be pulled with adb afterwards. record() is wait-free (one fetch_add plus a
+// per-slot sequence stamp, seqlock style) and safe on the audio callback.
+class TraceRecorder {
+ public:
+  static TraceRecorder& shared();
+
+  bool start(const std::string& path, std::size_t capacityEvents, std::string& error);
+  void stop();
+  bool isActive() const { return mActive.load(std::memory_order_relaxed); }
+
+  void record(TraceEventType type, int64_t arg0 = 0, double arg1 = 0.0, uint16_t detail = 0);
+
+  // Converts the current (or last) ring file to Chrome trace JSON, which
+  // ui.perfetto.dev and chrome://tracing both load.
+  bool exportChromeTrace(const std::string& jsonPath, std::string& error);
+  // Works on any ring file, including one pulled from a device.
+  static bool exportChromeTrace(const std::string& ringPath, const std::string& jsonPath, std::string& error);
+
+ private:
+  struct Header;
+  struct Event;
+
+  TraceRecorder() = default;
+
+  std::mutex mControlMutex;
+  std::atomic<bool> mActive{ false };
+  std::atomic<uint32_t> mWriters{ 0 };
+  Header* mHeader = nullptr;
+  Event* mEvents = nullptr;
+  uint64_t mMask = 0;
+  std::size_t mMappedBytes = 0;
+  int mFd = -1;
+  std::string mPath;
+};
+
+} // namespace margelo::nitro::morse
@@ -0,0 +1,104 @@
+#include "WavReader.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace margelo::nitro::morse {
+
+namespace {
+constexpr uint16_t kFormatPcm = 1;
+constexpr uint16_t kFormatFloat = 3;
+constexpr uint16_t kFormatExtensible = 0xFFFE;
+
+inline uint16_t readU16(const uint8_t* data) {
+  return static_cast<uint16_t>(data[0] | (data[1] << 8));
+}
+
+inline uint32_t readU32(const uint8_t* data) {
+  return static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+         (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+}
+
+inline std::optional<WavData> fail(std::string* error, const char* message) {
+  if (error != nullptr) {
+    *error = message;
+  }
+  return std::nullopt;
+}
+} // namespace
+
+std::optional<WavData> readWavFile(const std::string& path, std::string* error) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return fail(error, "open failed");
+  }
+  const std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  if (bytes.size() < 12 || std::memcmp(bytes.data(), "RIFF", 4) != 0 ||
+      std::memcmp(bytes.data() + 8, "WAVE", 4) != 0) {
+    return fail(error, "not a RIFF/WAVE file");
+  }
+
+  uint16_t format = 0;
+  uint16_t channels = 0;
+  uint32_t sampleRate = 0;
+  uint16_t bitsPerSample = 0;
+  const uint8_t* pcm = nullptr;
+  std::size_t pcmBytes = 0;
+
+  std::size_t offset = 12;
+  while (offset + 8 <= bytes.size()) {
+    const uint8_t* chunk = bytes.data() + offset;
+    const uint32_t chunkSize = readU32(chunk + 4);
+    const std::size_t available = std::min<std::size_t>(chunkSize, bytes.size() - offset - 8);
+    if (std::memcmp(chunk, "fmt ", 4) == 0 && available >= 16) {
+      format = readU16(chunk + 8);
+      channels = readU16(chunk + 10);
+      sampleRate = readU32(chunk + 12);
+      bitsPerSample = readU16(chunk + 22);
+      if (format == kFormatExtensible && available >= 26) {
+        format = readU16(chunk + 8 + 24);
+      }
+    } else if (std::memcmp(chunk, "data", 4) == 0) {
+      pcm = chunk + 8;
+      pcmBytes = available;
+    }
+    offset += 8 + chunkSize + (chunkSize & 1u);
+  }
+
+  if (pcm == nullptr || channels == 0 || sampleRate == 0) {
+    return fail(error, "missing fmt or data chunk");
+  }
+  const bool isFloat = format == kFormatFloat && bitsPerSample == 32;
+  const bool isPcm = format == kFormatPcm &&
+                     (bitsPerSample == 8 || bitsPerSample == 16 || bitsPerSample == 24 || bitsPerSample == 32);
+  if (!isFloat && !isPcm) {
+    return fail(error, "unsupported sample format");
+  }
+
+  const std::size_t bytesPerSample = bitsPerSample / 8;
+  const std::size_t sampleCount = pcmBytes / bytesPerSample;
+  WavData wav{ static_cast<double>(sampleRate), static_cast<int32_t>(channels), {} };
+  wav.samples.resize(sampleCount - sampleCount % channels);
+  for (std::size_t i = 0; i < wav.samples.size(); ++i) {
+    const uint8_t* sample = pcm + i * bytesPerSample;
+    float value = 0.0f;
+    if (isFloat) {
+      std::memcpy(&value, sample, sizeof(float));
+    } else if (bitsPerSample == 8) {
+      value = (static_cast<float>(sample[0]) - 128.0f) / 128.0f;
+    } else if (bitsPerSample == 16) {
+      value = static_cast<float>(static_cast<int16_t>(readU16(sample))) / 32768.0f;
+    } else if (bitsPerSample == 24) {
+      const int32_t raw = static_cast<int32_t>((sample[0] << 8) | (sample[1] << 16) | (sample[2] << 24)) >> 8;
+      value = static_cast<float>(raw) / 8388608.0f;
+    } else {
+      value = static_cast<float>(static_cast<int32_t>(readU32(sample))) / 2147483648.0f;
+    }
+    wav.samples[i] = value;
+  }
+  return wav;
+}
+
+} // namespace margelo::nitro::morse
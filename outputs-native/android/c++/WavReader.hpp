@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace margelo::nitro::morse {
+
+struct WavData {
+  double sampleRate;
+  int32_t channels;
+  // Interleaved samples normalised to [-1, 1].
+  std::vector<float> samples;
+
+  int64_t frames() const { return channels > 0 ? static_cast<int64_t>(samples.size()) / channels : 0; }
+};
+
+// Minimal RIFF/WAVE reader for PCM 8/16/24/32-bit and IEEE float 32-bit files,
+// enough to replay recorded CW through the receive pipeline off-device.
+std::optional<WavData> readWavFile(const std::string& path, std::string* error = nullptr);
+
+} // namespace margelo::nitro::morse
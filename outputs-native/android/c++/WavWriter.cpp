@@ -0,0 +1,71 @@
+#include "WavWriter.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace margelo::nitro::morse {
+
+namespace {
+void writeU32(std::ofstream& out, uint32_t value) {
+  const char bytes[4] = { static_cast<char>(value & 0xff),
+                          static_cast<char>((value >> 8) & 0xff),
+                          static_cast<char>((value >> 16) & 0xff),
+                          static_cast<char>((value >> 24) & 0xff) };
+  out.write(bytes, 4);
+}
+
+void writeU16(std::ofstream& out, uint16_t value) {
+  const char bytes[2] = { static_cast<char>(value & 0xff), static_cast<char>((value >> 8) & 0xff) };
+  out.write(bytes, 2);
+}
+} // namespace
+
+bool writeWavFile(const std::string& path,
+                  double sampleRate,
+                  int32_t channels,
+                  const std::vector<float>& samples,
+                  std::string* error) {
+  if (channels <= 0 || sampleRate <= 0.0) {
+    if (error != nullptr) {
+      *error = "invalid format";
+    }
+    return false;
+  }
+  std::ofstream out(path, std::ios::binary);
+  if (!out) {
+    if (error != nullptr) {
+      *error = "cannot open file";
+    }
+    return false;
+  }
+  const auto rate = static_cast<uint32_t>(std::lround(sampleRate));
+  const auto channelCount = static_cast<uint16_t>(channels);
+  const auto dataBytes = static_cast<uint32_t>(samples.size() * sizeof(int16_t));
+  out.write("RIFF", 4);
+  writeU32(out, 36 + dataBytes);
+  out.write("WAVE", 4);
+  out.write("fmt ", 4);
+  writeU32(out, 16);
+  writeU16(out, 1);
+  writeU16(out, channelCount);
+  writeU32(out, rate);
+  writeU32(out, rate * channelCount * sizeof(int16_t));
+  writeU16(out, static_cast<uint16_t>(channelCount * sizeof(int16_t)));
+  writeU16(out, 16);
+  out.write("data", 4);
+  writeU32(out, dataBytes);
+  for (const float sample : samples) {
+    const auto value = static_cast<int16_t>(std::lround(std::clamp(sample, -1.0f, 1.0f) * 32767.0f));
+    writeU16(out, static_cast<uint16_t>(value));
+  }
+  if (!out) {
+    if (error != nullptr) {
+      *error = "write failed";
+    }
+    return false;
+  }
+  return true;
+}
+
+} // namespace margelo::nitro::morse
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace margelo::nitro::morse {
+
+// Writes interleaved [-1, 1] samples as 16-bit PCM RIFF/WAVE. Counterpart of
+// readWavFile for producing synthetic test recordings.
+bool writeWavFile(const std::string& path,
+                  double sampleRate,
+                  int32_t channels,
+                  const std::vector<float>& samples,
+                  std::string* error = nullptr);
+
+} // namespace margelo::nitro::morse
@@ -0,0 +1,145 @@
+#include "WorkStealingPool.hpp"
+
+#include <algorithm>
+
+namespace margelo::nitro::morse {
+
+WorkStealingPool::WorkStealingPool(std::size_t threads) : mQueuedRanges(0), mStopping(false) {
+  if (threads == 0) {
+    threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+  }
+  mQueues.reserve(threads);
+  for (std::size_t i = 0; i < threads; ++i) {
+    mQueues.push_back(std::make_unique<Queue>());
+  }
+  // Queue 0 belongs to the submitting thread; workers own the rest.
+  mWorkers.reserve(threads - 1);
+  for (std::size_t i = 1; i < threads; ++i) {
+    mWorkers.emplace_back([this, i] { workerLoop(i); });
+  }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  {
+    std::lock_guard<std::mutex> lock(mWakeMutex);
+    mStopping = true;
+  }
+  mWakeCondition.notify_all();
+  for (auto& worker : mWorkers) {
+    worker.join();
+  }
+}
+
+void WorkStealingPool::parallelFor(std::size_t count,
+                                   const std::function<void(std::size_t)>& body,
+                                   std::size_t grain) {
+  if (count == 0) {
+    return;
+  }
+  if (mWorkers.empty() || count <= grain) {
+    for (std::size_t i = 0; i < count; ++i) {
+      body(i);
+    }
+    return;
+  }
+
+  std::lock_guard<std::mutex> submitLock(mSubmitMutex);
+  Batch batch{ &body, std::max<std::size_t>(1, grain), {} };
+  batch.remaining.store(count, std::memory_order_relaxed);
+  push(0, Range{ &batch, 0, count });
+
+  while (batch.remaining.load(std::memory_order_acquire) > 0) {
+    if (runOne(0)) {
+      continue;
+    }
+    // Everything left is already running on workers; wait for the last one.
+    std::unique_lock<std::mutex> lock(mWakeMutex);
+    mDoneCondition.wait(lock, [&] {
+      return batch.remaining.load(std::memory_order_acquire) == 0 ||
+             mQueuedRanges.load(std::memory_order_acquire) > 0;
+    });
+  }
+}
+
+void WorkStealingPool::workerLoop(std::size_t self) {
+  while (true) {
+    if (runOne(self)) {
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(mWakeMutex);
+    mWakeCondition.wait(lock, [this] { return mStopping || mQueuedRanges.load(std::memory_order_acquire) > 0; });
+    if (mStopping) {
+      return;
+    }
+  }
+}
+
+bool WorkStealingPool::runOne(std::size_t self) {
+  Range range{};
+  if (!popLocal(self, range) && !steal(self, range)) {
+    return false;
+  }
+  Batch* batch = range.batch;
+  // Split until the piece is small enough, publishing the back halves so idle
+  // threads can pick them up while this one works through the front.
+  while (range.end - range.begin > batch->grain) {
+    const std::size_t mid = range.begin + (range.end - range.begin) / 2;
+    push(self, Range{ batch, mid, range.end });
+    range.end = mid;
+  }
+  for (std::size_t i = range.begin; i < range.end; ++i) {
+    (*batch->body)(i);
+  }
+  const std::size_t done = range.end - range.begin;
+  if (batch->remaining.fetch_sub(done, std::memory_order_acq_rel) == done) {
+    std::lock_guard<std::mutex> lock(mWakeMutex);
+    mDoneCondition.notify_all();
+  }
+  return true;
+}
+
+void WorkStealingPool::push(std::size_t self, const Range& range) {
+  {
+    Queue& queue = *mQueues[self];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.ranges.push_back(range);
+  }
+  {
+    // Taking the wake mutex orders the count bump against waiters' predicate
+    // checks so no sleeper misses it.
+    std::lock_guard<std::mutex> lock(mWakeMutex);
+    mQueuedRanges.fetch_add(1, std::memory_order_acq_rel);
+  }
+  mWakeCondition.notify_one();
+  mDoneCondition.notify_one();
+}
+
+bool WorkStealingPool::popLocal(std::size_t self, Range& range) {
+  Queue& queue = *mQueues[self];
+  std::lock_guard<std::mutex> lock(queue.mutex);
+  if (queue.ranges.empty()) {
+    return false;
+  }
+  range = queue.ranges.back();
+  queue.ranges.pop_back();
+  mQueuedRanges.fetch_sub(1, std::memory_order_acq_rel);
+  return true;
+}
+
+bool WorkStealingPool::steal(std::size_t self, Range& range) {
+  const std::size_t queueCount = mQueues.size();
+  for (std::size_t offset = 1; offset < queueCount; ++offset) {
+    Queue& queue = *mQueues[(self + offset) % queueCount];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.ranges.empty()) {
+      continue;
+    }
+    range = queue.ranges.front();
+    queue.ranges.pop_front();
+    mQueuedRanges.fetch_sub(1, std::memory_order_acq_rel);
+    return true;
+  }
+  return false;
+}
+
+} // namespace margelo::nitro::morse
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace margelo::nitro::morse {
+
+// Fork/join pool for data-parallel DSP. parallelFor() hands the whole index
+// range to the calling thread's deque; whoever runs a range splits it in half,
+// keeps the front and leaves the back for idle workers to steal, so the work
+// spreads out in O(log n) steps without a central queue. Owners pop from the
+// back of their own deque (LIFO, cache-warm) and thieves take from the front.
+//
+// The calling thread always participates, so a pool of N threads starts N-1
+// workers. One parallelFor runs at a time; nested calls are not supported.
+class WorkStealingPool {
+ public:
+  explicit WorkStealingPool(std::size_t threads = 0);
+  ~WorkStealingPool();
+
+  WorkStealingPool(const WorkStealingPool&) = delete;
+  WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+  std::size_t concurrency() const { return mQueues.size(); }
+
+  // Runs body(i) for every i in [0, count) and returns once all have finished.
+  // Ranges are not split below `grain` indices.
+  void parallelFor(std::size_t count, const std::function<void(std::size_t)>& body, std::size_t grain = 1);
+
+ private:
+  struct Batch {
+    const std::function<void(std::size_t)>* body;
+    std::size_t grain;
+    std::atomic<std::size_t> remaining;
+  };
+
+  struct Range {
+    Batch* batch;
+    std::size_t begin;
+    std::size_t end;
+  };
+
+  struct alignas(64) Queue {
+    std::mutex mutex;
+    std::deque<Range> ranges;
+  };
+
+  void workerLoop(std::size_t self);
+  bool runOne(std::size_t self);
+  void push(std::size_t self, const Range& range);
+  bool popLocal(std::size_t self, Range& range);
+  bool steal(std::size_t self, Range& range);
+
+  std::vector<std::unique_ptr<Queue>> mQueues;
+  std::vector<std::thread> mWorkers;
+  std::mutex mSubmitMutex;
+  std::mutex mWakeMutex;
+  std::condition_variable mWakeCondition;
+  std::condition_variable mDoneCondition;
+  std::atomic<std::size_t> mQueuedRanges;
+  bool mStopping;
+};
+
+} // namespace margelo::nitro::morse
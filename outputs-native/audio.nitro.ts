@@ -11,6 +11,9 @@ export type ToneStartOptions = {
   toneHz: number;
   gain?: number;
   envelope?: ToneEnvelopeOptions;
+  // Press that caused the tone; its first audible sample is logged under it
+  // (getCorrelatedCommits).
+  correlationId?: string;
 };
 
 export type WarmupOptions = {
@@ -33,10 +36,237 @@ export type PlaybackRequest = {
     tintColorArgb?: number | null;
   };
   screenBrightnessBoost?: boolean;
+  // Per-symbol press ids, parallel to the marks of the pattern (or code);
+  // empty strings and missing entries are untagged. Carried through the tone
+  // and actuator commits and echoed on dispatch events.
+  correlationIds?: string[];
+};
+
+export type KeyerMode = 'iambicA' | 'iambicB';
+
+export type KeyerPaddle = 'dit' | 'dah';
+
+export type DecodedMorseEventType = 'letter' | 'word';
+
+/** Shape of each entry in the JSON arrays returned by the press classifier. */
+export type DecodedMorseEvent = {
+  type: DecodedMorseEventType;
+  text: string;
+  pattern?: string;
+  confidence: number;
+  startMs: number;
+  endMs: number;
+};
+
+/** Entries returned by the multi-signal (pileup) decoder. */
+export type ChannelDecodedMorseEvent = DecodedMorseEvent & {
+  channel: number;
+  toneHz: number;
+};
+
+export type LatencyHistogramMetric =
+  | 'startSkew'
+  | 'dispatchToCommit'
+  | 'callbackToPresentation'
+  | 'driftResidual';
+
+export type LatencyHistogramSnapshot = {
+  count: number;
+  minMs: number;
+  maxMs: number;
+  meanMs: number;
+  stddevMs: number;
+  p50Ms: number;
+  p90Ms: number;
+  p95Ms: number;
+  p99Ms: number;
+  p999Ms: number;
+};
+
+/** Keyed by output channel, then metric; empty metrics are omitted. */
+export type LatencyHistogramReport = Partial<
+  Record<'tone' | 'torch' | 'overlay' | 'haptics', Partial<Record<LatencyHistogramMetric, LatencyHistogramSnapshot>>>
+>;
+
+export type NativeBridgeMethod =
+  | 'setTorchEnabled'
+  | 'setTorchEnabledSync'
+  | 'vibrate'
+  | 'vibrateWaveform'
+  | 'cancelVibration'
+  | 'setFlashOverlayState'
+  | 'setFlashOverlayAppearance'
+  | 'setFlashOverlayOverride'
+  | 'setScreenBrightnessBoost'
+  | 'getOverlayAvailabilityDebugString'
+  | 'awaitOverlayReady'
+  | 'createHapticEffect'
+  | 'playHapticEffect'
+  | 'getActiveAudioRoute';
+
+/**
+ * Per NativeOutputsDispatcher method; methods never called are omitted.
+ * `suppressed` counts overlay calls dropped natively as no-op transitions.
+ */
+export type NativeBridgeStats = Partial<
+  Record<
+    NativeBridgeMethod,
+    { calls: number; failures: number; suppressed: number; latency: LatencyHistogramSnapshot }
+  >
+>;
+
+export type AudioRouteName = 'speaker' | 'wired' | 'bluetooth' | 'usb' | 'other';
+
+/**
+ * One output device's latency profile. presentationOffsetMs is what the
+ * stream timestamps miss (from calibration or a restored profile);
+ * outputLatencyMs is the callback-to-presentation lag observed on it.
+ */
+export type AudioRouteProfile = {
+  route: AudioRouteName;
+  device: string;
+  outputLatencyMs: number;
+  presentationOffsetMs: number;
+  latencySamples: number;
+  calibrations: number;
+  active: boolean;
+};
+
+export type AudioRouteProfiles = {
+  active: { route: AudioRouteName; device: string };
+  profiles: AudioRouteProfile[];
+};
+
+export type OutputLatencyChannel = 'tone' | 'torch' | 'overlay' | 'haptics';
+
+/**
+ * Rolling dispatch-to-commit latency per output channel, as returned by
+ * getChannelLatencyProfile. The schedulers lead each channel by medianMs once
+ * it has enough samples.
+ */
+export type ChannelLatencyProfile = Record<
+  OutputLatencyChannel,
+  { samples: number; medianMs: number; madMs: number; lastMs: number }
+>;
+
+/**
+ * Loopback calibration progress. Once done, presentationErrorMs is the
+ * measured offset; `applied` says whether it became the route's profile
+ * (it is not without input timestamps or with a wide spread).
+ */
+export type LatencyCalibrationStatus =
+  | { state: 'running'; elapsedMs: number; durationMs: number }
+  | { state: 'analyzing' }
+  | {
+      state: 'done' | 'failed';
+      route: AudioRouteName;
+      presentationErrorMs: number;
+      roundTripMs: number;
+      spreadMs: number;
+      peakRatio: number;
+      detected: number;
+      probes: number;
+      inputTimestamped: boolean;
+      applied: boolean;
+    };
+
+/**
+ * Output frame clock of the engine's stream against the native steady clock:
+ * frame f reaches the DAC at anchorMs + (f - anchorFrame) * msPerFrame, to
+ * within errorMs near the fitted span. `generation` changes on every stream
+ * (re)open, when frame counters restart.
+ */
+export type AudioFrameClock = {
+  valid: boolean;
+  generation: number;
+  sampleRate: number;
+  anchorFrame: number;
+  anchorMs: number;
+  msPerFrame: number;
+  driftPpm: number;
+  errorMs: number;
+  samples: number;
+  spanMs: number;
+  discontinuities: number;
+};
+
+/**
+ * A tone or actuator commit tagged with a press correlation id. Times are
+ * native steady-clock ms; targetMs/skewMs only for timeline-scheduled
+ * outputs.
+ */
+export type CorrelatedCommit = {
+  correlationId: string;
+  channel: 'tone' | 'torch' | 'overlay' | 'haptics';
+  sequence: number;
+  dispatchedMs: number;
+  committedMs: number;
+  latencyMs: number;
+  targetMs?: number;
+  skewMs?: number;
+};
+
+export type WarmupState = 'idle' | 'probing' | 'opening' | 'ready' | 'unsupported' | 'failed';
+
+/**
+ * Where startup audio warmup stands, with the capability cache it used.
+ * fromDisk means the support probe was skipped because this build's result
+ * was already cached; sampleRate is 0 until a stream has opened.
+ */
+export type WarmupStatus = {
+  state: WarmupState;
+  elapsedMs: number;
+  supportKnown: boolean;
+  streamReady: boolean;
+  capabilities: {
+    fingerprint: string;
+    fromDisk: boolean;
+    supported?: boolean;
+    sampleRate?: number;
+    framesPerBurst?: number;
+    sharingMode?: 'exclusive' | 'shared';
+    audioApi?: number;
+  };
+};
+
+export type CorrelatedCommits = {
+  records: CorrelatedCommit[];
+  // Pass back to read only newer commits.
+  cursor: number;
+  // Commits overwritten before they were read.
+  dropped: number;
+};
+
+// Position of a running pattern; sequence is 1-based, character 0-based.
+export type PlaybackPosition = {
+  state: 'playing' | 'paused';
+  sequence: number;
+  character: number;
+  offsetMs: number;
+  symbolCount: number;
+  characterCount: number;
 };
 
 export type PlaybackDispatchPhase = 'scheduled' | 'actual';
 
+export type PlaybackProgressPhase = 'started' | 'finished';
+
+/**
+ * Pushed once per character boundary of a running pattern: 'started' when
+ * its first played mark sounds, 'finished' when its last mark ends, with
+ * wordFinished set when that also ends the word. Indices are 0-based;
+ * timestampMs is native steady-clock ms.
+ */
+export type PlaybackProgressEvent = {
+  phase: PlaybackProgressPhase;
+  character: number;
+  word: number;
+  sequence: number;
+  wordFinished: boolean;
+  timestampMs: number;
+  correlationId?: string;
+};
+
 export type PlaybackDispatchEvent = {
   phase: PlaybackDispatchPhase;
   symbol: PlaybackSymbol;
@@ -57,21 +287,79 @@ export type PlaybackDispatchEvent = {
   sincePriorMs?: number;
   flashHandledNatively?: boolean;
   nativeFlashAvailable?: boolean;
+  correlationId?: string;
 };
 
 export interface OutputsAudio extends HybridObject<{ android: 'c++' }> {
   isSupported(): boolean;
   warmup(options: WarmupOptions): void;
+  // Same work off the JS thread; concurrent calls share one warmup.
+  isSupportedAsync?(): Promise<boolean>;
+  warmupAsync?(options: WarmupOptions): Promise<boolean>;
+  getWarmupStatus?(): string | null;
   startTone(options: ToneStartOptions): void;
   stopTone(): void;
   playMorse(request: PlaybackRequest): void;
   setSymbolDispatchCallback(callback: ((event: PlaybackDispatchEvent) => void) | null): void;
+  setPlaybackProgressCallback?(callback: ((event: PlaybackProgressEvent) => void) | null): void;
   setFlashOverlayState?(enabled: boolean, brightnessPercent: number): boolean;
   setFlashOverlayAppearance?(brightnessPercent: number, colorArgb: number): boolean;
   setFlashOverlayOverride?(brightnessPercent: number | null, colorArgb: number | null): boolean;
   setScreenBrightnessBoost?(enabled: boolean): void;
   getLatestSymbolInfo?(): string | null;
   getScheduledSymbols?(): string | null;
+  getChannelLatencyProfile?(): string | null;
+  seedChannelLatency?(channel: 'tone' | 'torch' | 'overlay' | 'haptics', latencyMs: number): boolean;
+  getAudioRouteProfiles?(): string | null;
+  setAudioRouteProfile?(route: AudioRouteName, deviceName: string, presentationOffsetMs: number): boolean;
+  // Plays chirps and records them back (needs RECORD_AUDIO); poll
+  // getLatencyCalibration until it reports done or failed.
+  startLatencyCalibration?(): boolean;
+  getLatencyCalibration?(): string | null;
+  cancelLatencyCalibration?(): void;
+  // steady_clock ms, for ping-pong clock sync (services/latency/clockSync).
+  getNativeClockMs?(): number;
+  getAudioFrameClock?(): string | null;
+  getCorrelatedCommits?(cursor: number): string | null;
+  configureKeyer?(
+    toneHz: number,
+    unitMs: number,
+    mode: KeyerMode,
+    weighting: number,
+    gain: number | null,
+  ): boolean;
+  setKeyerEnabled?(enabled: boolean): boolean;
+  setKeyerPaddle?(paddle: KeyerPaddle, down: boolean): boolean;
+  resetPressClassifier?(unitMs: number): void;
+  pushPressEdge?(down: boolean, timestampMs: number): string | null;
+  flushPressClassifier?(nowMs: number): string | null;
+  getPressClassifierState?(): string | null;
+  startCwReceiver?(toneHz: number, unitMs: number): boolean;
+  stopCwReceiver?(): void;
+  pollCwReceiver?(): string | null;
+  getCwReceiverState?(): string | null;
+  decodeWavFile?(path: string, toneHz: number, unitMs: number): string | null;
+  decodePileupWavFile?(path: string, unitMs: number): string | null;
+  getLatencyHistograms?(): string | null;
+  resetLatencyHistograms?(): void;
+  getBridgeStats?(): string | null;
+  resetBridgeStats?(): void;
+  startTrace?(path: string, capacityEvents: number): boolean;
+  stopTrace?(): void;
+  exportTrace?(jsonPath: string): boolean;
+  // Morse text ('.', '-', ' ' between characters, '/' between words);
+  // request.pattern is ignored.
+  playMorseCode?(request: PlaybackRequest, code: string): void;
+  pausePlayback?(): boolean;
+  resumePlayback?(): boolean;
+  seekPlaybackToSymbol?(sequence: number): boolean;
+  seekPlaybackToCharacter?(character: number): boolean;
+  getPlaybackPosition?(): string | null;
+  // Tempo applies from the next mark boundary; pitch glides (default 10 ms)
+  // from the next mark start and the running pattern keeps the new pitch for
+  // its remaining marks. Both return false when no pattern is playing.
+  setPlaybackUnitMs?(unitMs: number): boolean;
+  setPlaybackToneHz?(toneHz: number, glideMs?: number): boolean;
   teardown(): void;
 }
 
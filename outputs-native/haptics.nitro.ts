@@ -0,0 +1,36 @@
+import type { HybridObject } from 'react-native-nitro-modules';
+
+export type ImpactFeedbackStyle = 'light' | 'medium' | 'heavy' | 'soft' | 'rigid';
+
+export type NotificationFeedbackType = 'success' | 'warning' | 'error';
+
+export type AndroidHaptics =
+  | 'confirm'
+  | 'reject'
+  | 'gesture-start'
+  | 'gesture-end'
+  | 'toggle-on'
+  | 'toggle-off'
+  | 'clock-tick'
+  | 'context-click'
+  | 'drag-start'
+  | 'keyboard-tap'
+  | 'keyboard-press'
+  | 'keyboard-release'
+  | 'long-press'
+  | 'virtual-key'
+  | 'virtual-key-release'
+  | 'no-haptics'
+  | 'segment-tick'
+  | 'segment-frequent-tick'
+  | 'text-handle-move';
+
+// Implemented in C++ (outputs-native/android/c++/Haptics.*): effects are built
+// once and played from the shared actuator thread; request-to-commit latency
+// lands in the `haptics` latency histograms next to the tone.
+export interface Haptics extends HybridObject<{ android: 'c++' }> {
+  impact(style: ImpactFeedbackStyle): void;
+  notification(type: NotificationFeedbackType): void;
+  selection(): void;
+  performAndroidHaptics(type: AndroidHaptics): void;
+}
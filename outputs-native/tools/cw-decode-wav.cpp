@@ -0,0 +1,68 @@
+// Offline driver for the CW receive pipeline: decodes a WAV recording with the
+// same ToneDetector/PressClassifier code the app runs on-device and reports
+// how much faster than real time it ran.
+//
+//   g++ -std=c++20 -O2 -I outputs-native/android/c++ -o cw-decode-wav
+//       outputs-native/tools/cw-decode-wav.cpp
+//       outputs-native/android/c++/{CwReceiver,ToneDetector,KeyingTracker,PressClassifier,MorseTable,WavReader}.cpp
+//   ./cw-decode-wav recording.wav [toneHz=600] [unitMs=60]
+
+#include "CwReceiver.hpp"
+#include "WavReader.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace margelo::nitro::morse;
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::fprintf(stderr, "usage: %s file.wav [toneHz] [unitMs]\n", argv[0]);
+    return 2;
+  }
+  const double toneHz = argc > 2 ? std::atof(argv[2]) : 600.0;
+  const double unitMs = argc > 3 ? std::atof(argv[3]) : 60.0;
+
+  std::string error;
+  const auto wav = readWavFile(argv[1], &error);
+  if (!wav.has_value()) {
+    std::fprintf(stderr, "%s: %s\n", argv[1], error.c_str());
+    return 1;
+  }
+
+  CwReceiver receiver;
+  receiver.configure(CwReceiver::Config{ wav->sampleRate, toneHz, unitMs });
+  std::vector<DecodedMorseEvent> events;
+
+  // Feed the file in callback-sized chunks so the run matches live capture.
+  constexpr int64_t kChunkFrames = 192;
+  const auto startedAt = std::chrono::steady_clock::now();
+  for (int64_t frame = 0; frame < wav->frames(); frame += kChunkFrames) {
+    const auto frames = static_cast<int32_t>(std::min(kChunkFrames, wav->frames() - frame));
+    receiver.process(wav->samples.data() + frame * wav->channels, frames, wav->channels, events);
+  }
+  receiver.finish(events);
+  const double elapsedMs =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startedAt).count();
+
+  std::string text;
+  for (const auto& event : events) {
+    if (event.kind == DecodedMorseEvent::Kind::Word) {
+      text += event.text;
+      text += ' ';
+    }
+  }
+  const double audioMs = static_cast<double>(wav->frames()) * 1000.0 / wav->sampleRate;
+  std::printf("%s\n", text.c_str());
+  std::fprintf(stderr,
+               "audio=%.1fs decode=%.1fms speed=%.0fx realtime\n%s\n",
+               audioMs / 1000.0,
+               elapsedMs,
+               elapsedMs > 0.0 ? audioMs / elapsedMs : 0.0,
+               CwReceiver::toJson(receiver.summarize()).c_str());
+  return 0;
+}
@@ -0,0 +1,274 @@
+// Pileup driver for CwChannelizer: renders multi-station recordings with the
+// app's own MorseRenderer, decodes them on the work-stealing pool, and
+// measures how throughput scales with thread count.
+//
+//   g++ -std=c++20 -O2 -pthread -I outputs-native/android/c++ -o cw-pileup
+//       outputs-native/tools/cw-pileup.cpp
+//       outputs-native/android/c++/{CwChannelizer,Fft,KeyingTracker,MorseRenderer,MorseTable,
+//       PressClassifier,WavReader,WavWriter,WorkStealingPool}.cpp
+//   ./cw-pileup render out.wav [stations=8] [seconds=60] [snrDb=0]
+//   ./cw-pileup decode in.wav [unitMs=55] [threads=0]
+//   ./cw-pileup bench [stations=8] [seconds=60] [snrDb=0]
+
+#include "CwChannelizer.hpp"
+#include "MorseRenderer.hpp"
+#include "WavReader.hpp"
+#include "WavWriter.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace margelo::nitro::morse;
+
+namespace {
+constexpr double kSampleRate = 16000.0;
+constexpr double kSeedUnitMs = 55.0;
+constexpr int64_t kChunkFrames = 192;
+
+const char* const kCallsigns[] = { "K1ABC", "W7XYZ", "DL2QRP", "JA1NUT", "VK3DX",  "G4FOX",
+                                   "N0CALL", "F5MOR", "OH2BEE", "EA8CW",  "PY2SEA", "ZL1TOP" };
+
+struct Station {
+  MorseRenderVoice voice;
+  std::string expected;
+};
+
+std::vector<Station> makeStations(int count, double seconds) {
+  std::vector<Station> stations;
+  const int callsignCount = static_cast<int>(sizeof(kCallsigns) / sizeof(kCallsigns[0]));
+  for (int i = 0; i < count; ++i) {
+    const std::string call = kCallsigns[i % callsignCount];
+    const double wpm = 18.0 + static_cast<double>((i * 5) % 13);
+    const double unitMs = 1200.0 / wpm;
+    const std::string phrase = "CQ CQ DE " + call + " " + call + " K ";
+    std::string text;
+    double startMs = 250.0 + 370.0 * i;
+    while (MorseRenderer::durationMs(text + phrase, unitMs) + startMs < seconds * 1000.0 - 500.0) {
+      text += phrase;
+    }
+    while (!text.empty() && text.back() == ' ') {
+      text.pop_back();
+    }
+    // 140 Hz spacing keeps neighbours outside each other's guard bins.
+    const double toneHz = 450.0 + 140.0 * i;
+    const float gain = 0.06f + 0.02f * static_cast<float>(i % 4);
+    stations.push_back(Station{ MorseRenderVoice{ text, toneHz, unitMs, gain, startMs }, text });
+  }
+  return stations;
+}
+
+std::vector<float> renderPileup(const std::vector<Station>& stations, double seconds, double snrDb) {
+  std::vector<float> mix(static_cast<std::size_t>(seconds * kSampleRate), 0.0f);
+  const MorseRenderer renderer(MorseRenderer::Config{ kSampleRate, 2.5, 6.0 });
+  for (const auto& station : stations) {
+    renderer.render(station.voice, mix);
+  }
+  // SNR is quoted against the weakest station's tone power over the full band.
+  float weakest = 1.0f;
+  for (const auto& station : stations) {
+    weakest = std::min(weakest, station.voice.gain);
+  }
+  const double signalRms = weakest / std::sqrt(2.0);
+  MorseRenderer::addNoise(mix, static_cast<float>(signalRms / std::pow(10.0, snrDb / 20.0)), 1234);
+  return mix;
+}
+
+struct DecodeResult {
+  std::vector<CwChannelizer::ChannelEvent> events;
+  std::size_t threads;
+  double elapsedMs;
+};
+
+DecodeResult decode(const std::vector<float>& samples, double sampleRate, double unitMs, std::size_t threads) {
+  CwChannelizer channelizer;
+  channelizer.configure(CwChannelizer::Config{ sampleRate, unitMs, 300.0, 2500.0, 16, threads });
+  DecodeResult result{ {}, channelizer.concurrency(), 0.0 };
+  const auto frames = static_cast<int64_t>(samples.size());
+  const auto startedAt = std::chrono::steady_clock::now();
+  for (int64_t frame = 0; frame < frames; frame += kChunkFrames) {
+    const auto count = static_cast<int32_t>(std::min(kChunkFrames, frames - frame));
+    channelizer.process(samples.data() + frame, count, 1, result.events);
+  }
+  channelizer.finish(result.events);
+  result.elapsedMs =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startedAt).count();
+  return result;
+}
+
+std::map<uint32_t, std::pair<double, std::string>> transcripts(const std::vector<CwChannelizer::ChannelEvent>& events) {
+  std::map<uint32_t, std::pair<double, std::string>> byChannel;
+  for (const auto& entry : events) {
+    if (entry.event.kind != DecodedMorseEvent::Kind::Word) {
+      continue;
+    }
+    auto& transcript = byChannel[entry.channel];
+    transcript.first = entry.toneHz;
+    if (!transcript.second.empty()) {
+      transcript.second += ' ';
+    }
+    transcript.second += entry.event.text;
+  }
+  return byChannel;
+}
+
+std::size_t editDistance(const std::string& a, const std::string& b) {
+  std::vector<std::size_t> previous(b.size() + 1);
+  std::vector<std::size_t> current(b.size() + 1);
+  for (std::size_t j = 0; j <= b.size(); ++j) {
+    previous[j] = j;
+  }
+  for (std::size_t i = 1; i <= a.size(); ++i) {
+    current[0] = i;
+    for (std::size_t j = 1; j <= b.size(); ++j) {
+      const std::size_t substitution = previous[j - 1] + (a[i - 1] == b[j - 1] ? 0 : 1);
+      current[j] = std::min({ substitution, previous[j] + 1, current[j - 1] + 1 });
+    }
+    std::swap(previous, current);
+  }
+  return previous[b.size()];
+}
+
+void printTranscripts(const std::vector<CwChannelizer::ChannelEvent>& events) {
+  for (const auto& [channel, transcript] : transcripts(events)) {
+    std::printf("ch%-2u %7.1f Hz  %s\n", channel, transcript.first, transcript.second.c_str());
+  }
+}
+
+int runRender(int argc, char** argv) {
+  if (argc < 3) {
+    std::fprintf(stderr, "usage: %s render out.wav [stations] [seconds] [snrDb]\n", argv[0]);
+    return 2;
+  }
+  const int stationCount = argc > 3 ? std::atoi(argv[3]) : 8;
+  const double seconds = argc > 4 ? std::atof(argv[4]) : 60.0;
+  const double snrDb = argc > 5 ? std::atof(argv[5]) : 0.0;
+  const auto stations = makeStations(stationCount, seconds);
+  std::string error;
+  if (!writeWavFile(argv[2], kSampleRate, 1, renderPileup(stations, seconds, snrDb), &error)) {
+    std::fprintf(stderr, "%s: %s\n", argv[2], error.c_str());
+    return 1;
+  }
+  for (const auto& station : stations) {
+    std::printf("%7.1f Hz %4.1f wpm  %s\n", station.voice.toneHz, 1200.0 / station.voice.unitMs, station.expected.c_str());
+  }
+  return 0;
+}
+
+int runDecode(int argc, char** argv) {
+  if (argc < 3) {
+    std::fprintf(stderr, "usage: %s decode in.wav [unitMs] [threads]\n", argv[0]);
+    return 2;
+  }
+  const double unitMs = argc > 3 ? std::atof(argv[3]) : kSeedUnitMs;
+  const auto threads = static_cast<std::size_t>(argc > 4 ? std::atoi(argv[4]) : 0);
+  std::string error;
+  const auto wav = readWavFile(argv[2], &error);
+  if (!wav.has_value()) {
+    std::fprintf(stderr, "%s: %s\n", argv[2], error.c_str());
+    return 1;
+  }
+  std::vector<float> mono(static_cast<std::size_t>(wav->frames()));
+  for (int64_t frame = 0; frame < wav->frames(); ++frame) {
+    float sum = 0.0f;
+    for (int32_t channel = 0; channel < wav->channels; ++channel) {
+      sum += wav->samples[static_cast<std::size_t>(frame * wav->channels + channel)];
+    }
+    mono[static_cast<std::size_t>(frame)] = sum / static_cast<float>(wav->channels);
+  }
+  const auto result = decode(mono, wav->sampleRate, unitMs, threads);
+  printTranscripts(result.events);
+  const double audioMs = static_cast<double>(mono.size()) * 1000.0 / wav->sampleRate;
+  std::fprintf(stderr,
+               "threads=%zu audio=%.1fs decode=%.1fms speed=%.0fx realtime\n",
+               result.threads,
+               audioMs / 1000.0,
+               result.elapsedMs,
+               result.elapsedMs > 0.0 ? audioMs / result.elapsedMs : 0.0);
+  return 0;
+}
+
+int runBench(int argc, char** argv) {
+  const int stationCount = argc > 2 ? std::atoi(argv[2]) : 8;
+  const double seconds = argc > 3 ? std::atof(argv[3]) : 60.0;
+  const double snrDb = argc > 4 ? std::atof(argv[4]) : 0.0;
+  const auto stations = makeStations(stationCount, seconds);
+  const auto mix = renderPileup(stations, seconds, snrDb);
+
+  const std::size_t hardware = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+  std::vector<std::size_t> threadCounts;
+  for (std::size_t threads = 1; threads < hardware; threads *= 2) {
+    threadCounts.push_back(threads);
+  }
+  threadCounts.push_back(hardware);
+
+  double baselineMs = 0.0;
+  std::string baselineJson;
+  DecodeResult last{};
+  for (const std::size_t threads : threadCounts) {
+    last = decode(mix, kSampleRate, kSeedUnitMs, threads);
+    const std::string json = CwChannelizer::toJson(last.events);
+    if (baselineMs == 0.0) {
+      baselineMs = last.elapsedMs;
+      baselineJson = json;
+    }
+    std::printf("threads=%-3zu decode=%8.1fms speed=%6.0fx realtime scaling=%.2fx%s\n",
+                last.threads,
+                last.elapsedMs,
+                seconds * 1000.0 / last.elapsedMs,
+                baselineMs / last.elapsedMs,
+                json == baselineJson ? "" : "  OUTPUT DIFFERS");
+  }
+
+  // Score each station against the channel nearest its pitch.
+  const auto byChannel = transcripts(last.events);
+  std::size_t errors = 0;
+  std::size_t total = 0;
+  for (const auto& station : stations) {
+    const std::string* best = nullptr;
+    double bestDistance = 1e9;
+    for (const auto& [channel, transcript] : byChannel) {
+      const double distance = std::abs(transcript.first - station.voice.toneHz);
+      if (distance < bestDistance) {
+        bestDistance = distance;
+        best = &transcript.second;
+      }
+    }
+    const std::string decoded = best != nullptr && bestDistance < 60.0 ? *best : std::string();
+    const std::size_t distance = editDistance(decoded, station.expected);
+    errors += distance;
+    total += station.expected.size();
+    std::printf("%7.1f Hz %4.1f wpm  cer=%5.1f%%  %s\n",
+                station.voice.toneHz,
+                1200.0 / station.voice.unitMs,
+                100.0 * static_cast<double>(distance) / static_cast<double>(station.expected.size()),
+                decoded.substr(0, 60).c_str());
+  }
+  std::printf("channels=%zu stations=%d overall cer=%.2f%%\n",
+              byChannel.size(),
+              stationCount,
+              total > 0 ? 100.0 * static_cast<double>(errors) / static_cast<double>(total) : 0.0);
+  return 0;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+  const std::string mode = argc > 1 ? argv[1] : "bench";
+  if (mode == "render") {
+    return runRender(argc, argv);
+  }
+  if (mode == "decode") {
+    return runDecode(argc, argv);
+  }
+  if (mode == "bench") {
+    return runBench(argc, argv);
+  }
+  std::fprintf(stderr, "usage: %s render|decode|bench ...\n", argv[0]);
+  return 2;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdexcept>
+#include <string>
+
+namespace facebook::jsi {
+
+class Runtime;
+
+class Value {
+ public:
+  bool isString() const { return false; }
+};
+
+} // namespace facebook::jsi
+
+namespace margelo::nitro {
+
+namespace jsi = facebook::jsi;
+
+template <typename T, typename Enable = void>
+struct JSIConverter;
+
+template <>
+struct JSIConverter<std::string> final {
+  static std::string fromJSI(jsi::Runtime&, const jsi::Value&) { throw std::logic_error("no JSI on the host"); }
+  static jsi::Value toJSI(jsi::Runtime&, const std::string&) { throw std::logic_error("no JSI on the host"); }
+};
+
+} // namespace margelo::nitro
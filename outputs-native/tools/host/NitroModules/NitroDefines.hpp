@@ -0,0 +1,9 @@
+#pragma once
+
+// Host stand-ins for the NitroModules headers the generated enum and struct
+// headers include. Only what those headers touch is declared; the JSI
+// conversions are never called by the host tests.
+
+#define SWIFT_PRIVATE
+#define SWIFT_NAME(name)
+#define CLOSED_ENUM
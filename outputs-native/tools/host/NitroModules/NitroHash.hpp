@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace margelo::nitro {
+
+// FNV-1a, as in NitroModules.
+constexpr uint64_t hashString(const char* value, std::size_t length) {
+  uint64_t hash = 14695981039346656037ull;
+  for (std::size_t i = 0; i < length; ++i) {
+    hash ^= static_cast<unsigned char>(value[i]);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+template <std::size_t N>
+constexpr uint64_t hashString(const char (&value)[N]) {
+  return hashString(value, N - 1);
+}
+
+} // namespace margelo::nitro
@@ -0,0 +1,40 @@
+#pragma once
+
+// Host stand-in for the NDK logger used by the tests: debug and info lines are
+// dropped, warnings and errors go to stderr, and an assert aborts like
+// __android_log_assert does on a device.
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+
+enum {
+  ANDROID_LOG_VERBOSE = 2,
+  ANDROID_LOG_DEBUG,
+  ANDROID_LOG_INFO,
+  ANDROID_LOG_WARN,
+  ANDROID_LOG_ERROR,
+};
+
+inline int __android_log_print(int priority, const char* tag, const char* fmt, ...) {
+  if (priority < ANDROID_LOG_WARN) {
+    return 0;
+  }
+  std::fprintf(stderr, "%s: ", tag);
+  va_list args;
+  va_start(args, fmt);
+  const int written = std::vfprintf(stderr, fmt, args);
+  va_end(args);
+  std::fputc('\n', stderr);
+  return written;
+}
+
+[[noreturn]] inline void __android_log_assert(const char* /* condition */, const char* tag, const char* fmt, ...) {
+  std::fprintf(stderr, "%s: ", tag);
+  va_list args;
+  va_start(args, fmt);
+  std::vfprintf(stderr, fmt, args);
+  va_end(args);
+  std::fputc('\n', stderr);
+  std::abort();
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+// Host stand-in for fbjni: the actuator worker only asks to be attached to
+// the JVM, and the tests replace every bridge call with FakeOutputsBridge.
+
+namespace facebook::jni {
+
+struct Environment {
+  static void ensureCurrentThreadIsAttached() {}
+};
+
+} // namespace facebook::jni
@@ -0,0 +1,206 @@
+// Host stand-in for on-device loopback calibration: drives LoopbackCalibrator
+// through a simulated output -> air -> input loop per audio route, or through
+// WAV files so any real loop (ALSA loopback, a USB interface with a cable, a
+// phone recording the speaker) can be measured on Linux.
+//
+//   g++ -std=c++20 -O2 -I outputs-native/android/c++ -o latency-loopback
+//       outputs-native/tools/latency-loopback.cpp
+//       outputs-native/android/c++/{LoopbackCalibrator,Fft,WavReader,WavWriter}.cpp
+//   ./latency-loopback simulate [seed=1]
+//   ./latency-loopback write-probe probe.wav [sampleRate=48000]
+//   ./latency-loopback analyze recording.wav
+//
+// `simulate` renders each route in 192-frame callbacks. The output stream
+// reports presentation times that miss the route's hidden latency and jitter
+// by up to a millisecond. The loop adds speaker roll-off, a room reflection
+// and noise. The input side stamps ADC times, optionally skewed. Each route
+// prints the measured values next to the true ones. `analyze` treats the
+// start of both files as time 0, so its presentation error is the delay of
+// whatever loop recorded the probe file.
+
+#include "LoopbackCalibrator.hpp"
+#include "WavReader.hpp"
+#include "WavWriter.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace margelo::nitro::morse;
+
+namespace {
+constexpr double kSampleRate = 48000.0;
+constexpr int32_t kBurstFrames = 192;
+// steady_clock origin of the simulation; anything non-zero will do.
+constexpr double kClockOriginMs = 86400000.0;
+
+struct RouteModel {
+  const char* name;
+  // What the output stream's timestamps account for.
+  double reportedOutputMs;
+  // What they miss (codec, radio link, DAC FIFO).
+  double hiddenOutputMs;
+  double inputLatencyMs;
+  // Input timestamps may be off by this much.
+  double inputClockErrorMs;
+  bool inputTimestamped;
+  double snrDb;
+  // One-pole low-pass corner; 0 leaves the loop flat.
+  double lowpassHz;
+  double reflectionGain;
+  double reflectionMs;
+};
+
+const RouteModel kRoutes[] = {
+  { "speaker", 21.0, 0.0, 6.0, 0.0, true, 18.0, 4000.0, 0.6, 3.5 },
+  { "wired", 11.0, 1.5, 6.0, 0.0, true, 30.0, 0.0, 0.0, 0.0 },
+  { "usb", 14.0, 7.0, 5.0, 0.5, true, 30.0, 0.0, 0.0, 0.0 },
+  { "bluetooth", 38.0, 165.0, 6.0, 0.0, true, 20.0, 5000.0, 0.5, 4.0 },
+  { "bluetooth(no input ts)", 38.0, 165.0, 6.0, 0.0, false, 20.0, 5000.0, 0.5, 4.0 },
+};
+
+void printResult(const char* label, const LoopbackCalibrator::Result& result) {
+  std::printf("%-24s valid=%d detected=%u/%u error=%8.3f ms roundTrip=%8.3f ms spread=%6.3f ms peak=%6.1f ts=%d\n",
+              label,
+              result.valid ? 1 : 0,
+              result.detected,
+              result.probes,
+              result.presentationErrorMs,
+              result.roundTripMs,
+              result.spreadMs,
+              result.peakRatio,
+              result.inputTimestamped ? 1 : 0);
+}
+
+int simulate(uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> jitter(-1.0, 1.0);
+  std::normal_distribution<float> noise(0.0f, 1.0f);
+  const double frameMs = 1000.0 / kSampleRate;
+  int failures = 0;
+
+  for (const RouteModel& route : kRoutes) {
+    LoopbackCalibrator calibrator;
+    calibrator.configure(LoopbackCalibrator::defaultConfig(kSampleRate));
+    const auto& config = calibrator.config();
+    const double totalMs = config.leadInMs + config.probeIntervalMs * (config.probeCount + 2) + config.maxLatencyMs;
+    const int64_t totalFrames = static_cast<int64_t>(totalMs / frameMs);
+    const int64_t delayFrames = std::llround((route.reportedOutputMs + route.hiddenOutputMs) / frameMs);
+    const int64_t reflectionFrames = std::llround(route.reflectionMs / frameMs);
+    std::vector<float> air(static_cast<std::size_t>(totalFrames + delayFrames + reflectionFrames + kBurstFrames));
+    // Probe amplitude 0.5 through the loop; noise set against its RMS.
+    const float noiseLevel = static_cast<float>(0.5 / std::sqrt(2.0) * std::pow(10.0, -route.snrDb / 20.0));
+    const double alpha =
+        route.lowpassHz > 0.0 ? 1.0 - std::exp(-6.283185307179586 * route.lowpassHz / kSampleRate) : 1.0;
+    double lowpassState = 0.0;
+    std::vector<float> burst(kBurstFrames);
+    std::vector<float> input(kBurstFrames);
+
+    for (int64_t frame = 0; frame + kBurstFrames <= totalFrames && !calibrator.captureDone(); frame += kBurstFrames) {
+      const double renderMs = kClockOriginMs + static_cast<double>(frame) * frameMs;
+      std::fill(burst.begin(), burst.end(), 0.0f);
+      calibrator.renderOutput(burst.data(), kBurstFrames, renderMs + route.reportedOutputMs + jitter(rng), renderMs);
+      for (int32_t i = 0; i < kBurstFrames; ++i) {
+        air[frame + delayFrames + i] += burst[i];
+        air[frame + delayFrames + reflectionFrames + i] += static_cast<float>(route.reflectionGain) * burst[i];
+      }
+      // The input runs a burst behind so the air it reads is complete.
+      const int64_t adcFrame = frame - kBurstFrames;
+      if (adcFrame < 0) {
+        continue;
+      }
+      for (int32_t i = 0; i < kBurstFrames; ++i) {
+        lowpassState += alpha * (air[adcFrame + i] - lowpassState);
+        input[i] = static_cast<float>(lowpassState) + noiseLevel * noise(rng);
+      }
+      const double adcMs = kClockOriginMs + static_cast<double>(adcFrame) * frameMs;
+      const double deliveredMs = adcMs + kBurstFrames * frameMs + route.inputLatencyMs;
+      // Without timestamps the callback can only assume the burst just ended.
+      const double captureMs =
+          route.inputTimestamped ? adcMs + route.inputClockErrorMs : deliveredMs - kBurstFrames * frameMs;
+      calibrator.captureInput(input.data(), kBurstFrames, 1, captureMs, deliveredMs, route.inputTimestamped);
+    }
+
+    const LoopbackCalibrator::Result result = calibrator.analyze();
+    const double trueErrorMs =
+        route.hiddenOutputMs + route.inputClockErrorMs + (route.inputTimestamped ? 0.0 : route.inputLatencyMs);
+    const double trueRoundTripMs = route.reportedOutputMs + route.hiddenOutputMs + route.inputLatencyMs;
+    printResult(route.name, result);
+    std::printf("%-24s true  error=%8.3f ms roundTrip=%8.3f ms -> error off by %.3f ms, round trip by %.3f ms\n",
+                "",
+                trueErrorMs,
+                trueRoundTripMs,
+                result.presentationErrorMs - trueErrorMs,
+                result.roundTripMs - trueRoundTripMs);
+    // Jitter is +-1 ms per burst; the median should land well inside that.
+    if (!result.valid || std::abs(result.presentationErrorMs - trueErrorMs) > 1.0) {
+      ++failures;
+    }
+  }
+  return failures == 0 ? 0 : 1;
+}
+
+int writeProbe(const std::string& path, double sampleRate) {
+  LoopbackCalibrator calibrator;
+  calibrator.configure(LoopbackCalibrator::defaultConfig(sampleRate));
+  const auto& config = calibrator.config();
+  const double totalMs = config.leadInMs + config.probeIntervalMs * config.probeCount + config.maxLatencyMs;
+  std::vector<float> samples(static_cast<std::size_t>(totalMs * sampleRate / 1000.0));
+  for (std::size_t frame = 0; frame < samples.size(); frame += kBurstFrames) {
+    const int32_t frames = static_cast<int32_t>(std::min<std::size_t>(kBurstFrames, samples.size() - frame));
+    const double fileMs = static_cast<double>(frame) * 1000.0 / sampleRate;
+    calibrator.renderOutput(samples.data() + frame, frames, fileMs, fileMs);
+  }
+  std::string error;
+  if (!writeWavFile(path, sampleRate, 1, samples, &error)) {
+    std::fprintf(stderr, "write failed: %s\n", error.c_str());
+    return 1;
+  }
+  std::printf("wrote %s: %u probes, %.1f s at %.0f Hz\n", path.c_str(), config.probeCount, totalMs / 1000.0,
+              sampleRate);
+  return 0;
+}
+
+int analyze(const std::string& path) {
+  std::string error;
+  const auto wav = readWavFile(path, &error);
+  if (!wav) {
+    std::fprintf(stderr, "read failed: %s\n", error.c_str());
+    return 1;
+  }
+  LoopbackCalibrator calibrator;
+  calibrator.configure(LoopbackCalibrator::defaultConfig(wav->sampleRate));
+  const int64_t frames = wav->frames();
+  // Replays the probe schedule (into scratch) so the emission times match
+  // the file written by write-probe, then feeds the recording as input.
+  std::vector<float> scratch(kBurstFrames);
+  for (int64_t frame = 0; frame < frames; frame += kBurstFrames) {
+    const int32_t count = static_cast<int32_t>(std::min<int64_t>(kBurstFrames, frames - frame));
+    const double fileMs = static_cast<double>(frame) * 1000.0 / wav->sampleRate;
+    calibrator.renderOutput(scratch.data(), count, fileMs, fileMs);
+    calibrator.captureInput(wav->samples.data() + frame * wav->channels, count, wav->channels, fileMs,
+                            fileMs + count * 1000.0 / wav->sampleRate, true);
+  }
+  printResult(path.c_str(), calibrator.analyze());
+  return 0;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+  const std::string mode = argc > 1 ? argv[1] : "simulate";
+  if (mode == "simulate") {
+    return simulate(argc > 2 ? static_cast<uint32_t>(std::atoi(argv[2])) : 1u);
+  }
+  if (mode == "write-probe" && argc > 2) {
+    return writeProbe(argv[2], argc > 3 ? std::atof(argv[3]) : kSampleRate);
+  }
+  if (mode == "analyze" && argc > 2) {
+    return analyze(argv[2]);
+  }
+  std::fprintf(stderr, "usage: %s simulate [seed] | write-probe out.wav [rate] | analyze in.wav\n", argv[0]);
+  return 2;
+}
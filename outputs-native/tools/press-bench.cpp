@@ -0,0 +1,281 @@
+// Benchmark driver for PressClassifier: replays key-down/key-up logs through
+// the same classifier pushPressEdge feeds on-device and reports character
+// error rate against the text each log was keyed from, plus the cost per
+// edge.
+//
+//   g++ -std=c++20 -O2 -I outputs-native/android/c++ -o press-bench
+//       outputs-native/tools/press-bench.cpp
+//       outputs-native/android/c++/{PressClassifier,MorseTable}.cpp
+//   ./press-bench decode press.log
+//   ./press-bench bench [--min-accuracy=0.98] press.log...
+//   ./press-bench synth out.log [wpmStart=20] [wpmEnd=20] [jitter=0.1] [dashRatio=3] [seedWpm=0] [seed=1]
+//
+// A log is plain text, one edge per line: "d <ms>" or "u <ms>", with
+// "# text: ..." naming what was keyed and an optional "# seedUnitMs: ..." for
+// the classifier's starting unit (the app seeds it from the lesson speed).
+// Edges captured from pushPressEdge can be written in the same format.
+//
+// `synth` keys a text with a simple hand model: the unit drifts linearly from
+// wpmStart to wpmEnd, every mark and gap is scaled by its own normally
+// distributed error (sd = jitter), and dashes are dashRatio dots long. The
+// fixtures in fixtures/press-logs were written with it; their headers give
+// the exact command.
+
+#include "MorseTable.hpp"
+#include "PressClassifier.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace margelo::nitro::morse;
+
+namespace {
+constexpr const char* kSynthText =
+    "CQ CQ DE K1ABC K THE QUICK BROWN FOX JUMPS OVER THE LAZY DOG 1234567890 "
+    "PSE QSL VIA BURO TNX FER QSO 73 ES GL SK";
+// Long enough after the last edge for the classifier to close the word.
+constexpr double kFinalFlushMs = 60000.0;
+constexpr double kMinBenchMs = 200.0;
+
+struct Edge {
+  bool down;
+  double timestampMs;
+};
+
+struct PressLog {
+  std::string text;
+  double seedUnitMs = 60.0;
+  std::vector<Edge> edges;
+};
+
+bool readPressLog(const char* path, PressLog& log, std::string& error) {
+  std::ifstream file(path);
+  if (!file) {
+    error = "cannot open";
+    return false;
+  }
+  std::string line;
+  int lineNumber = 0;
+  while (std::getline(file, line)) {
+    ++lineNumber;
+    if (line.empty()) {
+      continue;
+    }
+    if (line[0] == '#') {
+      if (line.rfind("# text: ", 0) == 0) {
+        log.text = line.substr(8);
+      } else if (line.rfind("# seedUnitMs: ", 0) == 0) {
+        log.seedUnitMs = std::atof(line.c_str() + 14);
+      }
+      continue;
+    }
+    std::istringstream fields(line);
+    std::string kind;
+    Edge edge{};
+    if (!(fields >> kind >> edge.timestampMs) || (kind != "d" && kind != "u")) {
+      error = "bad edge on line " + std::to_string(lineNumber);
+      return false;
+    }
+    edge.down = kind == "d";
+    log.edges.push_back(edge);
+  }
+  return true;
+}
+
+// Polls flush() just before every edge, which is what the JS timer does
+// between presses, then closes the last word.
+std::string decodeLog(const PressLog& log, PressClassifier::Summary* summary = nullptr) {
+  PressClassifier classifier(log.seedUnitMs);
+  std::vector<DecodedMorseEvent> events;
+  for (const Edge& edge : log.edges) {
+    classifier.flush(edge.timestampMs, events);
+    if (edge.down) {
+      classifier.keyDown(edge.timestampMs, events);
+    } else {
+      classifier.keyUp(edge.timestampMs);
+    }
+  }
+  const double endMs = log.edges.empty() ? 0.0 : log.edges.back().timestampMs;
+  classifier.flush(endMs + kFinalFlushMs, events);
+  if (summary != nullptr) {
+    *summary = classifier.summarize();
+  }
+  std::string text;
+  for (const auto& event : events) {
+    if (event.kind == DecodedMorseEvent::Kind::Word) {
+      text += text.empty() ? "" : " ";
+      text += event.text;
+    }
+  }
+  return text;
+}
+
+std::size_t editDistance(const std::string& a, const std::string& b) {
+  std::vector<std::size_t> row(b.size() + 1);
+  for (std::size_t j = 0; j <= b.size(); ++j) {
+    row[j] = j;
+  }
+  for (std::size_t i = 1; i <= a.size(); ++i) {
+    std::size_t diagonal = row[0];
+    row[0] = i;
+    for (std::size_t j = 1; j <= b.size(); ++j) {
+      const std::size_t above = row[j];
+      row[j] = std::min({ row[j] + 1, row[j - 1] + 1, diagonal + (a[i - 1] == b[j - 1] ? 0 : 1) });
+      diagonal = above;
+    }
+  }
+  return row[b.size()];
+}
+
+int decode(const char* path) {
+  PressLog log;
+  std::string error;
+  if (!readPressLog(path, log, error)) {
+    std::fprintf(stderr, "%s: %s\n", path, error.c_str());
+    return 1;
+  }
+  std::printf("%s\n", decodeLog(log).c_str());
+  return 0;
+}
+
+int bench(int argc, char** argv) {
+  double minAccuracy = 0.0;
+  std::vector<const char*> paths;
+  for (int i = 2; i < argc; ++i) {
+    if (std::strncmp(argv[i], "--min-accuracy=", 15) == 0) {
+      minAccuracy = std::atof(argv[i] + 15);
+    } else {
+      paths.push_back(argv[i]);
+    }
+  }
+  if (paths.empty()) {
+    std::fprintf(stderr, "bench: no press logs given\n");
+    return 2;
+  }
+
+  int failures = 0;
+  std::printf("%-32s %6s %6s %8s %8s %10s\n", "log", "chars", "edges", "accuracy", "unitMs", "ns/edge");
+  for (const char* path : paths) {
+    PressLog log;
+    std::string error;
+    if (!readPressLog(path, log, error)) {
+      std::fprintf(stderr, "%s: %s\n", path, error.c_str());
+      ++failures;
+      continue;
+    }
+    PressClassifier::Summary summary{};
+    const std::string decoded = decodeLog(log, &summary);
+    const std::size_t distance = editDistance(log.text, decoded);
+    const double accuracy =
+        log.text.empty() ? 0.0 : 1.0 - static_cast<double>(distance) / static_cast<double>(log.text.size());
+
+    // Repeat the replay until the timing is long enough to be stable.
+    int runs = 0;
+    const auto startedAt = std::chrono::steady_clock::now();
+    double elapsedMs = 0.0;
+    do {
+      decodeLog(log);
+      ++runs;
+      elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startedAt).count();
+    } while (elapsedMs < kMinBenchMs);
+    const double nsPerEdge =
+        log.edges.empty() ? 0.0 : elapsedMs * 1e6 / (static_cast<double>(runs) * static_cast<double>(log.edges.size()));
+
+    const char* name = std::strrchr(path, '/') != nullptr ? std::strrchr(path, '/') + 1 : path;
+    std::printf("%-32s %6zu %6zu %7.2f%% %8.1f %10.1f\n",
+                name,
+                log.text.size(),
+                log.edges.size(),
+                accuracy * 100.0,
+                summary.unitMs,
+                nsPerEdge);
+    if (accuracy < minAccuracy) {
+      std::printf("  expected: %s\n  decoded:  %s\n", log.text.c_str(), decoded.c_str());
+      ++failures;
+    }
+  }
+  return failures == 0 ? 0 : 1;
+}
+
+int synth(int argc, char** argv) {
+  const char* path = argv[2];
+  const double wpmStart = argc > 3 ? std::atof(argv[3]) : 20.0;
+  const double wpmEnd = argc > 4 ? std::atof(argv[4]) : wpmStart;
+  const double jitter = argc > 5 ? std::atof(argv[5]) : 0.1;
+  const double dashRatio = argc > 6 ? std::atof(argv[6]) : 3.0;
+  const double seedWpm = argc > 7 ? std::atof(argv[7]) : 0.0;
+  const uint32_t seed = argc > 8 ? static_cast<uint32_t>(std::atoi(argv[8])) : 1u;
+
+  const std::string text = kSynthText;
+  std::mt19937 random(seed);
+  std::normal_distribution<double> error(1.0, jitter);
+  // PARIS timing: one unit is 1200 / WPM milliseconds.
+  const auto unitAt = [&](std::size_t index) {
+    const double progress = static_cast<double>(index) / static_cast<double>(text.size());
+    return 1200.0 / (wpmStart + (wpmEnd - wpmStart) * progress);
+  };
+  const auto scaled = [&](double lengthMs) { return lengthMs * std::clamp(error(random), 0.4, 1.6); };
+
+  std::ofstream out(path, std::ios::trunc);
+  if (!out) {
+    std::fprintf(stderr, "%s: cannot write\n", path);
+    return 1;
+  }
+  out << "# press log v1, synthetic: press-bench synth <out> " << wpmStart << " " << wpmEnd << " " << jitter << " "
+      << dashRatio << " " << seedWpm << " " << seed << "\n";
+  out << "# text: " << text << "\n";
+  out << "# seedUnitMs: " << (seedWpm > 0.0 ? 1200.0 / seedWpm : unitAt(0)) << "\n";
+  char edge[48];
+  double nowMs = 0.0;
+  for (std::size_t i = 0; i < text.size(); ++i) {
+    const double unitMs = unitAt(i);
+    if (text[i] == ' ') {
+      // The letter gap already taken plus four more units makes seven.
+      nowMs += scaled(4.0 * unitMs);
+      continue;
+    }
+    const auto pattern = encodeMorseChar(text[i]);
+    if (!pattern.has_value()) {
+      continue;
+    }
+    for (std::size_t j = 0; j < pattern->size(); ++j) {
+      if (j > 0) {
+        nowMs += scaled(unitMs);
+      }
+      std::snprintf(edge, sizeof(edge), "d %.3f\n", nowMs);
+      out << edge;
+      nowMs += scaled((*pattern)[j] == '-' ? dashRatio * unitMs : unitMs);
+      std::snprintf(edge, sizeof(edge), "u %.3f\n", nowMs);
+      out << edge;
+    }
+    nowMs += scaled(3.0 * unitMs);
+  }
+  return out ? 0 : 1;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+  const std::string mode = argc > 1 ? argv[1] : "";
+  if (mode == "decode" && argc > 2) {
+    return decode(argv[2]);
+  }
+  if (mode == "bench") {
+    return bench(argc, argv);
+  }
+  if (mode == "synth" && argc > 2) {
+    return synth(argc, argv);
+  }
+  std::fprintf(stderr,
+               "usage: %s decode in.log | bench [--min-accuracy=x] in.log... | "
+               "synth out.log [wpmStart] [wpmEnd] [jitter] [dashRatio] [seedWpm] [seed]\n",
+               argv[0]);
+  return 2;
+}
@@ -0,0 +1,47 @@
+#include "FakeOutputsBridge.hpp"
+
+#include "NativeOutputsBridge.hpp"
+
+namespace margelo::nitro::morse {
+
+FakeOutputsBridge& FakeOutputsBridge::shared() {
+  static FakeOutputsBridge instance;
+  return instance;
+}
+
+bool setNativeTorchEnabledSync(bool enabled) {
+  (enabled ? FakeOutputsBridge::shared().torchOn : FakeOutputsBridge::shared().torchOff)
+      .fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+void setNativeTorchEnabled(bool enabled) {
+  setNativeTorchEnabledSync(enabled);
+}
+
+bool setNativeFlashOverlayState(bool /* enabled */, double /* brightnessPercent */) {
+  FakeOutputsBridge::shared().overlayCalls.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+void triggerNativeVibration(long /* durationMs */) {
+  FakeOutputsBridge::shared().vibrations.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool triggerNativeVibrationWaveform(const std::vector<int64_t>& timings) {
+  FakeOutputsBridge::shared().waveforms.fetch_add(1, std::memory_order_relaxed);
+  FakeOutputsBridge::shared().waveformSegments.fetch_add(timings.size() / 2, std::memory_order_relaxed);
+  return true;
+}
+
+void cancelNativeVibration() {
+  FakeOutputsBridge::shared().cancels.fetch_add(1, std::memory_order_relaxed);
+}
+
+void setNativeScreenBrightnessBoost(bool /* enabled */) {}
+
+bool playNativeHapticEffect(NativeHapticEffect /* effect */) {
+  return true;
+}
+
+} // namespace margelo::nitro::morse
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace margelo::nitro::morse {
+
+// Host replacement for the JNI bridge the actuator worker calls. Every call
+// succeeds immediately and is counted, so tests can check what reached "Java".
+struct FakeOutputsBridge {
+  std::atomic<uint32_t> torchOn{ 0 };
+  std::atomic<uint32_t> torchOff{ 0 };
+  std::atomic<uint32_t> overlayCalls{ 0 };
+  std::atomic<uint32_t> vibrations{ 0 };
+  std::atomic<uint32_t> waveforms{ 0 };
+  // On/off pairs handed to the vibrator across all waveforms.
+  std::atomic<uint64_t> waveformSegments{ 0 };
+  std::atomic<uint32_t> cancels{ 0 };
+
+  static FakeOutputsBridge& shared();
+};
+
+} // namespace margelo::nitro::morse
@@ -0,0 +1,162 @@
+// Haptic waveform chunks queued ahead of each other. The playback thread can
+// hand over chunk N+1 before chunk N is due; each must reach the vibrator
+// with its own timings, and a chunk that finds every slot still waiting is
+// refused instead of overwriting one. Commands of a detached listener are
+// dropped, and their slots freed, while listener-less cleanup still runs.
+//
+//   cmake -S outputs-native/tools -B build && cmake --build build
+//   ctest --test-dir build -R actuator-waveform
+
+#include "ActuatorThread.hpp"
+#include "FakeOutputsBridge.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace margelo::nitro::morse;
+
+namespace {
+constexpr double kDueAfterMs = 100.0;
+constexpr double kCompletionTimeoutMs = 2000.0;
+
+class CountingListener final : public ActuatorListener {
+ public:
+  void onActuatorCommandCompleted(const ActuatorCommand& /* command */,
+                                  bool success,
+                                  double /* dispatchedAtMs */,
+                                  double /* committedAtMs */) override {
+    if (!success) {
+      failed.fetch_add(1, std::memory_order_relaxed);
+    }
+    completed.fetch_add(1, std::memory_order_release);
+  }
+
+  std::atomic<uint32_t> completed{ 0 };
+  std::atomic<uint32_t> failed{ 0 };
+};
+
+double nowMs() {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool awaitCompleted(const CountingListener& listener, uint32_t submitted) {
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::duration<double, std::milli>(kCompletionTimeoutMs);
+  while (listener.completed.load(std::memory_order_acquire) < submitted) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::yield();
+  }
+  return true;
+}
+
+// A chunk of `segments` on/off pairs, due a little later so that every chunk
+// of a batch is queued before the first one runs.
+bool submitChunk(uint64_t sequence, std::size_t segments, double dueTimeMs, ActuatorListener* listener) {
+  std::vector<int64_t> timings;
+  for (std::size_t i = 0; i < segments; ++i) {
+    timings.push_back(60);
+    timings.push_back(60);
+  }
+  ActuatorCommand command{};
+  command.type = ActuatorCommandType::VibrateWaveform;
+  command.enabled = true;
+  command.value = static_cast<double>(segments * 120);
+  command.dueTimeMs = dueTimeMs;
+  command.sequence = sequence;
+  command.generation = 1;
+  command.listener = listener;
+  return ActuatorThread::shared().submitWaveform(command, timings);
+}
+} // namespace
+
+int main() {
+  ActuatorThread& actuators = ActuatorThread::shared();
+  actuators.start();
+  FakeOutputsBridge& bridge = FakeOutputsBridge::shared();
+  CountingListener listener;
+  actuators.attachListener(&listener);
+
+  int failures = 0;
+  const auto check = [&failures](bool condition, const char* what) {
+    if (!condition) {
+      std::fprintf(stderr, "FAILED: %s\n", what);
+      ++failures;
+    }
+  };
+
+  // As many chunks as there are slots, all outstanding at once.
+  const double dueMs = nowMs() + kDueAfterMs;
+  uint32_t submitted = 0;
+  std::size_t expectedSegments = 0;
+  for (std::size_t i = 0; i < ActuatorThread::kWaveformSlots; ++i) {
+    const std::size_t segments = 10 + i;
+    if (submitChunk(1 + i * 100, segments, dueMs + static_cast<double>(i), &listener)) {
+      ++submitted;
+      expectedSegments += segments;
+    }
+  }
+  // One more while they are all still waiting.
+  const bool overflowAccepted = submitChunk(1000, 5, dueMs, &listener);
+  check(submitted == ActuatorThread::kWaveformSlots, "every outstanding chunk accepted");
+  check(!overflowAccepted, "chunk refused while every slot is waiting");
+  check(awaitCompleted(listener, submitted), "actuator worker committed every chunk");
+  check(listener.failed.load() == 0, "no chunk lost its timings");
+  check(bridge.waveforms.load() == submitted, "one vibrator waveform per chunk");
+  check(bridge.waveformSegments.load() == expectedSegments, "each chunk played with its own timings");
+
+  // Consumed slots are free again.
+  check(submitChunk(2000, 3, nowMs(), &listener), "slot reused once its chunk ran");
+  check(awaitCompleted(listener, submitted + 1), "reused slot committed");
+  check(listener.failed.load() == 0, "reused slot kept its timings");
+
+  actuators.detachListener(&listener);
+
+  // Queued for a listener that is gone by the time they run.
+  const double staleDueMs = nowMs() + kDueAfterMs;
+  ActuatorCommand torchOn{};
+  torchOn.type = ActuatorCommandType::Torch;
+  torchOn.enabled = true;
+  torchOn.dueTimeMs = staleDueMs;
+  torchOn.generation = 1;
+  torchOn.listener = &listener;
+  actuators.submit(torchOn);
+  uint32_t staleChunks = 0;
+  for (std::size_t i = 0; i < ActuatorThread::kWaveformSlots; ++i) {
+    staleChunks += submitChunk(3000 + i, 2, staleDueMs, &listener) ? 1 : 0;
+  }
+  ActuatorCommand torchOff{};
+  torchOff.type = ActuatorCommandType::Torch;
+  torchOff.enabled = false;
+  torchOff.dueTimeMs = staleDueMs + 1.0;
+  torchOff.listener = nullptr;
+  actuators.submit(torchOff);
+  const uint32_t waveformsBefore = bridge.waveforms.load();
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::duration<double, std::milli>(kCompletionTimeoutMs);
+  while (bridge.torchOff.load() == 0 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::yield();
+  }
+  check(staleChunks == ActuatorThread::kWaveformSlots, "stale chunks queued");
+  check(bridge.torchOff.load() == 1, "listener-less cleanup ran");
+  check(bridge.torchOn.load() == 0, "detached listener's torch command dropped");
+  check(bridge.waveforms.load() == waveformsBefore, "detached listener's chunks dropped");
+  check(listener.completed.load() == submitted + 1, "no callback into a detached listener");
+
+  CountingListener successor;
+  actuators.attachListener(&successor);
+  check(submitChunk(3000, 2, nowMs(), &successor), "dropped chunks freed their slots");
+  check(awaitCompleted(successor, 1), "successor chunk committed");
+  actuators.detachListener(&successor);
+
+  std::printf("chunks=%u waveforms=%u segments=%llu failed=%u\n",
+              submitted + 1,
+              bridge.waveforms.load(),
+              static_cast<unsigned long long>(bridge.waveformSegments.load()),
+              listener.failed.load());
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,181 @@
+// Steady-state allocation test for pattern playback. Replays what the
+// playback thread does after playMorse has returned -- the lazy timeline
+// feeding the fixed schedule window, torch commands and haptic waveform chunks
+// handed to the actuator worker, drift correction per played symbol -- inside
+// an AllocationAuditScope, with the global operator new counting (built with
+// MORSE_ALLOCATION_AUDIT). The actuator worker audits its own side. Any heap
+// allocation on either thread fails the test.
+//
+// The loop is rebuilt here from the same parts; OutputsAudio::runPattern and
+// its actuator completion callback need Oboe, JNI and Nitro and are only
+// audited in device builds (-Pmorse.allocationAudit=true).
+//
+//   cmake -S outputs-native/tools -B build && cmake --build build
+//   ctest --test-dir build -R allocation-audit
+
+#include "ActuatorThread.hpp"
+#include "AllocationAudit.hpp"
+#include "DriftCorrector.hpp"
+#include "FakeOutputsBridge.hpp"
+#include "FixedRing.hpp"
+#include "PatternTimeline.hpp"
+#include "TraceRecorder.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace margelo::nitro::morse;
+
+namespace {
+// Mirrors OutputsAudio::kScheduleWindowCapacity and kScheduleHorizonMs.
+constexpr std::size_t kWindowCapacity = 512;
+constexpr double kHorizonMs = 8000.0;
+constexpr double kUnitMs = 60.0;
+constexpr int kRepeats = 200;
+constexpr double kCompletionTimeoutMs = 2000.0;
+
+class CountingListener final : public ActuatorListener {
+ public:
+  void onActuatorCommandCompleted(const ActuatorCommand& /* command */,
+                                  bool success,
+                                  double /* dispatchedAtMs */,
+                                  double /* committedAtMs */) override {
+    if (!success) {
+      failed.fetch_add(1, std::memory_order_relaxed);
+    }
+    completed.fetch_add(1, std::memory_order_release);
+  }
+
+  std::atomic<uint32_t> completed{ 0 };
+  std::atomic<uint32_t> failed{ 0 };
+};
+
+// Stands in for the time that passes between symbols on a device: the next
+// symbol is only played once the worker has committed everything queued.
+bool awaitCompleted(const CountingListener& listener, uint32_t submitted) {
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::duration<double, std::milli>(kCompletionTimeoutMs);
+  while (listener.completed.load(std::memory_order_acquire) < submitted) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::yield();
+  }
+  return true;
+}
+
+ActuatorCommand makeCommand(ActuatorCommandType type, bool enabled, uint64_t sequence, ActuatorListener* listener) {
+  ActuatorCommand command{};
+  command.type = type;
+  command.enabled = enabled;
+  // Due immediately: the worker runs on the real clock, the pattern on a
+  // virtual one.
+  command.dueTimeMs = 0.0;
+  command.sequence = sequence;
+  command.generation = 1;
+  command.listener = listener;
+  return command;
+}
+} // namespace
+
+int main() {
+  // Setup that playMorse does on the JS thread before handing over.
+  std::string code;
+  for (int i = 0; i < kRepeats; ++i) {
+    code += ".--. .- .-. .. ... / ";
+  }
+  PatternTimeline timeline = PatternTimeline::fromCode(code, kUnitMs, 0.0, 0.0);
+  const std::size_t symbolCount = timeline.symbolCount();
+  std::vector<int64_t> hapticTimings;
+  hapticTimings.reserve(kWindowCapacity * 2);
+  static FixedRing<ScheduledSymbol, kWindowCapacity> window;
+
+  // Process-wide singletons are created when the app starts, long before the
+  // first pattern.
+  ActuatorThread& actuators = ActuatorThread::shared();
+  actuators.start();
+  TraceRecorder::shared();
+  FakeOutputsBridge& bridge = FakeOutputsBridge::shared();
+  CountingListener listener;
+  actuators.attachListener(&listener);
+
+  AllocationAudit::reset();
+  uint32_t submitted = 0;
+  std::size_t played = 0;
+  bool timedOut = false;
+  {
+    AllocationAuditScope auditScope;
+    DriftCorrector drift;
+    double playheadMs = 0.0;
+    while (!timeline.done() || !window.empty()) {
+      while (!timeline.done() && window.size() < kWindowCapacity && timeline.nextOffsetMs() <= playheadMs + kHorizonMs) {
+        window.push(timeline.next());
+      }
+      ScheduledSymbol& entry = window[0];
+      if (!entry.hapticQueued) {
+        // One waveform chunk over the rest of the window, edges relative to
+        // its first mark (as queueHapticChunkLocked builds them).
+        hapticTimings.clear();
+        int64_t previousEdgeMs = 0;
+        for (std::size_t j = 0; j < window.size(); ++j) {
+          ScheduledSymbol& chunkEntry = window[j];
+          const int64_t onMs = std::llround(chunkEntry.offsetMs - entry.offsetMs);
+          const int64_t offMs = std::llround(chunkEntry.offsetMs + chunkEntry.durationMs - entry.offsetMs);
+          hapticTimings.push_back(std::max<int64_t>(0, onMs - previousEdgeMs));
+          hapticTimings.push_back(std::max<int64_t>(1, offMs - onMs));
+          previousEdgeMs = offMs;
+          chunkEntry.hapticQueued = true;
+        }
+        ActuatorCommand waveform = makeCommand(ActuatorCommandType::VibrateWaveform, true, entry.sequence, &listener);
+        waveform.value = static_cast<double>(previousEdgeMs);
+        submitted += actuators.submitWaveform(waveform, hapticTimings) ? 1 : 0;
+      }
+      submitted += actuators.submit(makeCommand(ActuatorCommandType::Torch, true, entry.sequence, &listener)) ? 1 : 0;
+      submitted += actuators.submit(makeCommand(ActuatorCommandType::Torch, false, entry.sequence, &listener)) ? 1 : 0;
+      if (!awaitCompleted(listener, submitted)) {
+        timedOut = true;
+        break;
+      }
+      // A small, slowly creeping skew, as a device that runs late would feed.
+      drift.update(1.5 + 0.001 * static_cast<double>(played) - drift.correctionMs());
+      playheadMs = entry.offsetMs + entry.durationMs;
+      window.popFront();
+      ++played;
+    }
+  }
+  const AllocationAuditReport report = AllocationAudit::report();
+  actuators.detachListener(&listener);
+
+  std::printf("symbols=%zu played=%zu commands=%u failed=%u waveforms=%u segments=%llu\n",
+              symbolCount,
+              played,
+              submitted,
+              listener.failed.load(),
+              bridge.waveforms.load(),
+              static_cast<unsigned long long>(bridge.waveformSegments.load()));
+  std::printf("allocations=%llu bytes=%llu largest=%zu\n",
+              static_cast<unsigned long long>(report.allocations),
+              static_cast<unsigned long long>(report.bytes),
+              report.largestBytes);
+
+  int failures = 0;
+  const auto check = [&failures](bool condition, const char* what) {
+    if (!condition) {
+      std::fprintf(stderr, "FAILED: %s\n", what);
+      ++failures;
+    }
+  };
+  check(!timedOut, "actuator worker committed every command");
+  check(played == symbolCount, "every symbol played");
+  check(listener.failed.load() == 0, "no actuator command failed");
+  check(bridge.torchOn.load() == symbolCount && bridge.torchOff.load() == symbolCount, "one torch pulse per symbol");
+  check(bridge.waveformSegments.load() >= symbolCount, "every symbol covered by a waveform chunk");
+  check(report.allocations == 0, "no heap allocation in the steady state");
+  return failures == 0 ? 0 : 1;
+}
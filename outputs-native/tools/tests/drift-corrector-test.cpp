@@ -0,0 +1,127 @@
+// Virtual-clock harness for DriftCorrector. Each simulated symbol starts
+// (device latency - lead estimate - correction) late, plus seeded Gaussian
+// jitter, exactly as runPattern measures it; the correction is then updated
+// from that skew. No real time passes, so the bounds below are deterministic.
+//
+//   cmake -S outputs-native/tools -B build && cmake --build build
+//   ctest --test-dir build -R drift-corrector
+
+#include "DriftCorrector.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <random>
+
+using namespace margelo::nitro::morse;
+
+namespace {
+constexpr int kSymbols = 2000;
+constexpr double kJitterMs = 0.5;
+// Skew averaged over this many symbols when looking for convergence.
+constexpr int kConvergenceWindow = 10;
+constexpr double kConvergedMs = 0.5;
+constexpr int kTailSymbols = 500;
+
+struct Run {
+  // Tail mean skew the same device would show without correction.
+  double uncorrectedTailMs;
+  double tailMeanMs;
+  double tailRmsMs;
+  // First symbol from which every window mean stays within kConvergedMs;
+  // kSymbols when it never settles.
+  int convergedAt;
+  double finalCorrectionMs;
+};
+
+// `lateMs(i)` is how much later than its lead estimate the device starts
+// symbol i.
+Run simulate(const std::function<double(int)>& lateMs, uint32_t seed) {
+  DriftCorrector drift;
+  std::mt19937 random(seed);
+  std::normal_distribution<double> jitter(0.0, kJitterMs);
+  double skews[kSymbols];
+  for (int i = 0; i < kSymbols; ++i) {
+    skews[i] = lateMs(i) - drift.correctionMs() + jitter(random);
+    drift.update(skews[i]);
+  }
+
+  Run run{};
+  run.convergedAt = kSymbols;
+  for (int i = kSymbols - kConvergenceWindow; i >= 0; --i) {
+    double sum = 0.0;
+    for (int j = i; j < i + kConvergenceWindow; ++j) {
+      sum += skews[j];
+    }
+    if (std::abs(sum / kConvergenceWindow) > kConvergedMs) {
+      break;
+    }
+    run.convergedAt = i;
+  }
+  double uncorrectedSum = 0.0;
+  double tailSum = 0.0;
+  double tailSquares = 0.0;
+  for (int i = kSymbols - kTailSymbols; i < kSymbols; ++i) {
+    uncorrectedSum += lateMs(i);
+    tailSum += skews[i];
+    tailSquares += skews[i] * skews[i];
+  }
+  run.uncorrectedTailMs = uncorrectedSum / kTailSymbols;
+  run.tailMeanMs = tailSum / kTailSymbols;
+  run.tailRmsMs = std::sqrt(tailSquares / kTailSymbols);
+  run.finalCorrectionMs = drift.correctionMs();
+  return run;
+}
+
+void print(const char* name, const Run& run) {
+  std::printf("%-10s uncorrected=%.3f tail=%.3f tailRms=%.3f converged=%d correction=%.3f\n",
+              name,
+              run.uncorrectedTailMs,
+              run.tailMeanMs,
+              run.tailRmsMs,
+              run.convergedAt,
+              run.finalCorrectionMs);
+}
+} // namespace
+
+int main() {
+  int failures = 0;
+  const auto check = [&failures](bool condition, const char* what) {
+    if (!condition) {
+      std::fprintf(stderr, "FAILED: %s\n", what);
+      ++failures;
+    }
+  };
+
+  // A device 3 ms later than its calibrated lead throughout.
+  const Run constant = simulate([](int) { return 3.0; }, 1);
+  print("constant", constant);
+  check(constant.convergedAt <= 40, "constant offset converges within 40 symbols");
+  check(std::abs(constant.tailMeanMs) < 0.1, "constant offset leaves under 0.1 ms mean skew");
+  check(constant.tailRmsMs < 1.5 * kJitterMs, "constant offset tail RMS near the jitter floor");
+  check(std::abs(constant.finalCorrectionMs - 3.0) < 0.5, "constant offset correction matches the offset");
+
+  // Lateness creeping from 0 to 6 ms over the pattern.
+  const Run ramp = simulate([](int i) { return 6.0 * i / kSymbols; }, 2);
+  print("ramp", ramp);
+  check(ramp.convergedAt <= 40, "ramp tracked within 40 symbols");
+  check(std::abs(ramp.tailMeanMs) < 0.1, "ramp leaves under 0.1 ms mean skew");
+  check(ramp.tailRmsMs < 1.5 * kJitterMs, "ramp tail RMS near the jitter floor");
+
+  // More than the correction may take: clamped, never wound up beyond it.
+  const Run stuck = simulate([](int) { return 30.0; }, 3);
+  print("stuck", stuck);
+  check(stuck.finalCorrectionMs == DriftCorrector::defaultConfig().maxCorrectionMs, "correction clamped");
+
+  // A stall is not drift.
+  DriftCorrector drift;
+  for (int i = 0; i < 100; ++i) {
+    drift.update(2.0 - drift.correctionMs());
+  }
+  const double before = drift.correctionMs();
+  check(!drift.update(250.0), "stall rejected as an outlier");
+  check(drift.correctionMs() == before, "outlier leaves the correction alone");
+  check(drift.samples() == 100, "outlier not counted");
+
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,110 @@
+// Frame-by-frame harness for KeyerEngine. At 1 kHz and a 10 ms unit a dit is
+// 10 frames, a dah 30 and the element space 10, so each scenario posts its
+// paddle edges on given frames, clocks the engine one frame per block as the
+// audio callback would, and compares the resulting mark/space run lengths.
+//
+//   cmake -S outputs-native/tools -B build && cmake --build build
+//   ctest --test-dir build -R keyer-engine
+
+#include "KeyerEngine.hpp"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace margelo::nitro::morse;
+
+namespace {
+constexpr double kSampleRate = 1000.0;
+constexpr double kUnitMs = 10.0;
+constexpr int kFrames = 400;
+
+struct Edge {
+  int frame;
+  KeyerPaddle paddle;
+  bool down;
+};
+
+// Mark runs as positive frame counts, the spaces between them as negative
+// ones; silence before the first mark and after the last is dropped.
+std::vector<int> play(KeyerMode mode, const std::vector<Edge>& edges) {
+  KeyerEngine keyer;
+  keyer.setSampleRate(kSampleRate);
+  keyer.configure(KeyerEngine::Config{ kUnitMs, mode, 0.5, 3.0 });
+  keyer.setEnabled(true);
+
+  std::vector<int> runs;
+  bool previous = false;
+  int length = 0;
+  for (int frame = 0; frame < kFrames; ++frame) {
+    for (const Edge& edge : edges) {
+      if (edge.frame == frame) {
+        keyer.postPaddle(edge.paddle, edge.down);
+      }
+    }
+    keyer.beginBlock();
+    const bool mark = keyer.nextFrame();
+    if (mark != previous) {
+      if (previous || !runs.empty()) {
+        runs.push_back(previous ? length : -length);
+      }
+      previous = mark;
+      length = 0;
+    }
+    ++length;
+  }
+  if (previous) {
+    runs.push_back(length);
+  }
+  return runs;
+}
+
+std::string format(const std::vector<int>& runs) {
+  std::string text;
+  for (const int run : runs) {
+    if (!text.empty()) {
+      text += ' ';
+    }
+    text += std::to_string(run);
+  }
+  return text;
+}
+} // namespace
+
+int main() {
+  int failures = 0;
+  const auto check = [&failures](const char* what, const std::vector<int>& actual, const std::vector<int>& expected) {
+    std::printf("%-28s %s\n", what, format(actual).c_str());
+    if (actual != expected) {
+      std::fprintf(stderr, "FAILED: %s: expected %s\n", what, format(expected).c_str());
+      ++failures;
+    }
+  };
+
+  const std::vector<Edge> dit{ { 0, KeyerPaddle::Dit, true }, { 5, KeyerPaddle::Dit, false } };
+  check("single dit", play(KeyerMode::IambicB, dit), { 10 });
+
+  const std::vector<Edge> dah{ { 0, KeyerPaddle::Dah, true }, { 15, KeyerPaddle::Dah, false } };
+  check("single dah", play(KeyerMode::IambicB, dah), { 30 });
+
+  // Squeezed from the dit, both released halfway through the dah.
+  const std::vector<Edge> squeeze{
+    { 0, KeyerPaddle::Dit, true },
+    { 2, KeyerPaddle::Dah, true },
+    { 35, KeyerPaddle::Dit, false },
+    { 35, KeyerPaddle::Dah, false },
+  };
+  check("squeeze release, mode A", play(KeyerMode::IambicA, squeeze), { 10, -10, 30 });
+  check("squeeze release, mode B", play(KeyerMode::IambicB, squeeze), { 10, -10, 30, -10, 10 });
+
+  // Dah tapped and released while the dit is still sounding.
+  const std::vector<Edge> memory{
+    { 0, KeyerPaddle::Dit, true },
+    { 3, KeyerPaddle::Dit, false },
+    { 5, KeyerPaddle::Dah, true },
+    { 7, KeyerPaddle::Dah, false },
+  };
+  check("dah memory during dit", play(KeyerMode::IambicA, memory), { 10, -10, 30 });
+
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,27 @@
+// Converts a binary output trace (the ring file written by TraceRecorder,
+// e.g. pulled with `adb exec-out run-as <pkg> cat files/morse-trace.bin`) to
+// Chrome trace JSON for ui.perfetto.dev or chrome://tracing.
+//
+//   g++ -std=c++20 -O2 -I outputs-native/android/c++ -o trace-to-json
+//       outputs-native/tools/trace-to-json.cpp outputs-native/android/c++/TraceRecorder.cpp
+//   ./trace-to-json morse-trace.bin morse-trace.json
+
+#include "TraceRecorder.hpp"
+
+#include <cstdio>
+#include <string>
+
+using namespace margelo::nitro::morse;
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    std::fprintf(stderr, "usage: %s trace.bin trace.json\n", argv[0]);
+    return 2;
+  }
+  std::string error;
+  if (!TraceRecorder::exportChromeTrace(argv[1], argv[2], error)) {
+    std::fprintf(stderr, "export failed: %s\n", error.c_str());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,287 @@
+import type { AudioFrameClock } from '@/outputs-native/audio.nitro';
+import { nowMs, toMonotonicTime } from '@/utils/time';
+
+/**
+ * Native <-> JS clock synchronization.
+ *
+ * Native timestamps are steady_clock ms; JS uses performance.now(). On most
+ * builds both count from boot, but nothing guarantees it (and the JS clock can
+ * be rebased), so instead of assuming a shared epoch this samples the native
+ * clock with ping-pong calls: read JS, read native, read JS again. The native
+ * read happened somewhere inside that round trip, so each sample bounds the
+ * offset to +-rtt/2. Samples disturbed by GC or thread preemption have long
+ * round trips; only the fastest are kept (min-RTT filtering), and once they
+ * span long enough a line through them gives the drift as well. The audio
+ * stream's frame clock is fitted natively against steady_clock
+ * (AudioFrameClock) and chained on top, so frames, native events and JS times
+ * all convert with an error bound.
+ */
+
+export type NativeClockSource = {
+  nowMs(): number;
+  frameClock?(): AudioFrameClock | null;
+};
+
+/**
+ * native = js + offsetMs + driftPpm * 1e-6 * (js - referenceJsMs), to within
+ * errorMs at referenceJsMs.
+ */
+export type ClockSyncEstimate = {
+  offsetMs: number;
+  driftPpm: number;
+  referenceJsMs: number;
+  errorMs: number;
+  minRttMs: number;
+  points: number;
+  spanMs: number;
+  syncedAtMs: number;
+  // The offset is within its own error: both clocks share an epoch.
+  sharedEpoch: boolean;
+};
+
+export type SyncedTime = {
+  timeMs: number;
+  errorMs: number;
+};
+
+type SyncPoint = {
+  jsMidMs: number;
+  offsetMs: number;
+  rttMs: number;
+};
+
+const SYNC_ROUNDS = 8;
+const MAX_SYNC_POINTS = 32;
+const RESYNC_INTERVAL_MS = 10_000;
+// Points slower than this multiple of the best round trip (plus 50 us, so a
+// very fast best does not reject everything) are dropped.
+const RTT_ACCEPT_FACTOR = 2;
+const RTT_ACCEPT_SLACK_MS = 0.05;
+// Drift is only fitted once the accepted points span this long.
+const MIN_DRIFT_SPAN_MS = 30_000;
+// Rate uncertainty applied away from the reference point.
+const FITTED_DRIFT_UNCERTAINTY_PPM = 10;
+const UNFITTED_DRIFT_UNCERTAINTY_PPM = 100;
+const FRAME_CLOCK_REFRESH_MS = 1000;
+// Native timestamps further than this from native "now" are not treated as
+// native steady-clock values by normalizeNativeTimestamp.
+const NATIVE_TIMESTAMP_WINDOW_MS = 60_000;
+
+let source: NativeClockSource | null = null;
+let points: SyncPoint[] = [];
+let estimate: ClockSyncEstimate | null = null;
+let frameClock: AudioFrameClock | null = null;
+let frameClockFetchedAtMs = -Infinity;
+
+export function registerNativeClockSource(next: NativeClockSource | null): void {
+  source = next;
+  resetClockSync();
+  if (next) {
+    syncNativeClock();
+  }
+}
+
+export function resetClockSync(): void {
+  points = [];
+  estimate = null;
+  frameClock = null;
+  frameClockFetchedAtMs = -Infinity;
+}
+
+function samplePoint(clock: NativeClockSource, rounds: number): SyncPoint | null {
+  let best: SyncPoint | null = null;
+  for (let i = 0; i < rounds; i += 1) {
+    const sentMs = nowMs();
+    const nativeMs = clock.nowMs();
+    const receivedMs = nowMs();
+    if (!Number.isFinite(nativeMs)) {
+      return null;
+    }
+    const rttMs = Math.max(0, receivedMs - sentMs);
+    if (!best || rttMs < best.rttMs) {
+      const jsMidMs = sentMs + rttMs / 2;
+      best = { jsMidMs, offsetMs: nativeMs - jsMidMs, rttMs };
+    }
+  }
+  return best;
+}
+
+function fitEstimate(syncedAtMs: number): ClockSyncEstimate | null {
+  if (points.length === 0) {
+    return null;
+  }
+  const minRttMs = points.reduce((min, point) => Math.min(min, point.rttMs), Infinity);
+  const limit = Math.max(minRttMs * RTT_ACCEPT_FACTOR, minRttMs + RTT_ACCEPT_SLACK_MS);
+  const accepted = points.filter((point) => point.rttMs <= limit);
+  const newest = accepted[accepted.length - 1];
+  const spanMs = newest.jsMidMs - accepted[0].jsMidMs;
+
+  let offsetMs: number;
+  let driftPpm = 0;
+  let referenceJsMs: number;
+  let errorMs: number;
+  if (accepted.length >= 4 && spanMs >= MIN_DRIFT_SPAN_MS) {
+    // Least squares of offset against JS time, relative to the newest point.
+    referenceJsMs = newest.jsMidMs;
+    const meanX = accepted.reduce((sum, point) => sum + (point.jsMidMs - referenceJsMs), 0) / accepted.length;
+    const meanY = accepted.reduce((sum, point) => sum + point.offsetMs, 0) / accepted.length;
+    let sxx = 0;
+    let sxy = 0;
+    for (const point of accepted) {
+      const dx = point.jsMidMs - referenceJsMs - meanX;
+      sxx += dx * dx;
+      sxy += dx * (point.offsetMs - meanY);
+    }
+    const slope = sxx > 0 ? sxy / sxx : 0;
+    driftPpm = slope * 1e6;
+    offsetMs = meanY - slope * meanX;
+    let worst = 0;
+    for (const point of accepted) {
+      const fitted = offsetMs + slope * (point.jsMidMs - referenceJsMs);
+      worst = Math.max(worst, Math.abs(point.offsetMs - fitted));
+    }
+    errorMs = minRttMs / 2 + worst;
+  } else {
+    // Too short for a slope: the fastest point alone bounds the offset.
+    const best = accepted.reduce((min, point) => (point.rttMs < min.rttMs ? point : min), accepted[0]);
+    offsetMs = best.offsetMs;
+    referenceJsMs = best.jsMidMs;
+    errorMs = best.rttMs / 2;
+  }
+
+  return {
+    offsetMs,
+    driftPpm,
+    referenceJsMs,
+    errorMs,
+    minRttMs,
+    points: accepted.length,
+    spanMs,
+    syncedAtMs,
+    sharedEpoch: Math.abs(offsetMs) <= errorMs,
+  };
+}
+
+/**
+ * Takes one ping-pong burst and refits. Bursts are a few synchronous calls
+ * (microseconds each), so this is cheap enough to run inline.
+ */
+export function syncNativeClock(rounds: number = SYNC_ROUNDS): ClockSyncEstimate | null {
+  if (!source) {
+    return null;
+  }
+  let point: SyncPoint | null = null;
+  try {
+    point = samplePoint(source, Math.max(1, Math.floor(rounds)));
+  } catch (error) {
+    if (__DEV__) {
+      console.warn('[outputs] clock sync sample error', error);
+    }
+  }
+  if (!point) {
+    return estimate;
+  }
+  points.push(point);
+  if (points.length > MAX_SYNC_POINTS) {
+    points.splice(0, points.length - MAX_SYNC_POINTS);
+  }
+  estimate = fitEstimate(point.jsMidMs);
+  return estimate;
+}
+
+/** Current estimate, resynced first when older than RESYNC_INTERVAL_MS. */
+export function getClockSyncEstimate(): ClockSyncEstimate | null {
+  if (!source) {
+    return null;
+  }
+  if (!estimate || nowMs() - estimate.syncedAtMs > RESYNC_INTERVAL_MS) {
+    return syncNativeClock();
+  }
+  return estimate;
+}
+
+function driftUncertaintyPpm(current: ClockSyncEstimate): number {
+  return current.spanMs >= MIN_DRIFT_SPAN_MS ? FITTED_DRIFT_UNCERTAINTY_PPM : UNFITTED_DRIFT_UNCERTAINTY_PPM;
+}
+
+export function nativeToJsTime(nativeMs: number): SyncedTime | null {
+  const current = getClockSyncEstimate();
+  if (!current || !Number.isFinite(nativeMs)) {
+    return null;
+  }
+  const drift = current.driftPpm * 1e-6;
+  const timeMs = (nativeMs - current.offsetMs + drift * current.referenceJsMs) / (1 + drift);
+  const errorMs =
+    current.errorMs + Math.abs(timeMs - current.referenceJsMs) * driftUncertaintyPpm(current) * 1e-6;
+  return { timeMs, errorMs };
+}
+
+export function jsToNativeTime(jsMs: number): SyncedTime | null {
+  const current = getClockSyncEstimate();
+  if (!current || !Number.isFinite(jsMs)) {
+    return null;
+  }
+  const timeMs = jsMs + current.offsetMs + current.driftPpm * 1e-6 * (jsMs - current.referenceJsMs);
+  const errorMs = current.errorMs + Math.abs(jsMs - current.referenceJsMs) * driftUncertaintyPpm(current) * 1e-6;
+  return { timeMs, errorMs };
+}
+
+function getFrameClock(): AudioFrameClock | null {
+  if (!source?.frameClock) {
+    return null;
+  }
+  const now = nowMs();
+  if (now - frameClockFetchedAtMs > FRAME_CLOCK_REFRESH_MS) {
+    frameClockFetchedAtMs = now;
+    try {
+      frameClock = source.frameClock();
+    } catch (error) {
+      frameClock = null;
+      if (__DEV__) {
+        console.warn('[outputs] clock sync frame clock error', error);
+      }
+    }
+  }
+  return frameClock?.valid ? frameClock : null;
+}
+
+/**
+ * JS time at which an output frame of the current stream reaches the DAC
+ * (before any route presentation offset). Null before the stream has
+ * timestamps; frames from an earlier stream generation do not convert.
+ */
+export function audioFrameToJsTime(frame: number, generation?: number): SyncedTime | null {
+  const clock = getFrameClock();
+  if (!clock || (generation != null && generation !== clock.generation)) {
+    return null;
+  }
+  const nativeMs = clock.anchorMs + (frame - clock.anchorFrame) * clock.msPerFrame;
+  const synced = nativeToJsTime(nativeMs);
+  if (!synced) {
+    return null;
+  }
+  return { timeMs: synced.timeMs, errorMs: synced.errorMs + clock.errorMs };
+}
+
+/**
+ * Like toMonotonicTime, but a value that reads as native steady-clock ms
+ * (closer to native "now" than to JS "now") is converted through the sync
+ * instead of being assumed to share the JS epoch.
+ */
+export function normalizeNativeTimestamp(value?: number | null): number {
+  if (typeof value === 'number' && Number.isFinite(value) && value < 1e12) {
+    const jsNow = nowMs();
+    const nativeNow = jsToNativeTime(jsNow);
+    if (
+      nativeNow &&
+      Math.abs(value - nativeNow.timeMs) <= NATIVE_TIMESTAMP_WINDOW_MS &&
+      Math.abs(value - nativeNow.timeMs) < Math.abs(value - jsNow)
+    ) {
+      const synced = nativeToJsTime(value);
+      if (synced) {
+        return synced.timeMs;
+      }
+    }
+  }
+  return toMonotonicTime(value);
+}
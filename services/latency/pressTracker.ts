@@ -1,4 +1,4 @@
-﻿import { toMonotonicTime } from '@/utils/time';
+﻿import { normalizeNativeTimestamp } from '@/services/latency/clockSync';
 
 const SOURCE_SANITIZE = /[^a-zA-Z0-9]/g;
 
@@ -35,8 +35,10 @@ export interface PressTracker {
   reset(): void;
 }
 
+// Touch events carry native uptime ms; they go through the clock sync rather
+// than being assumed to share the JS clock's epoch.
 export function normalizePressTimestamp(rawTimestamp?: number | null): number {
-  return toMonotonicTime(typeof rawTimestamp === 'number' ? rawTimestamp : undefined);
+  return normalizeNativeTimestamp(typeof rawTimestamp === 'number' ? rawTimestamp : undefined);
 }
 
 export function createPressCorrelation(source: string, rawTimestamp?: number | null): PressCorrelation {
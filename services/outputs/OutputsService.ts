@@ -2,7 +2,7 @@ import React from 'react';
 import { Animated } from 'react-native';
 
 import type { PressTracker } from '@/services/latency/pressTracker';
-import { toMonotonicTime } from '@/utils/time';
+import { normalizeNativeTimestamp } from '@/services/latency/clockSync';
 import { defaultOutputsService } from './defaultOutputsService';
 
 export type MorseSymbol = '.' | '-';
@@ -64,6 +64,9 @@ export type PlayMorseOptions = {
   torchEnabled?: boolean;
   flashBrightnessPercent?: number;
   screenBrightnessBoost?: boolean;
+  // Press ids per mark of `morse`, for replays of keyed input; the native
+  // backend tags each symbol's commits with them.
+  correlationIds?: (string | null)[];
 };
 
 export type KeyerOutputsOptions = {
@@ -99,13 +102,13 @@ export function resolvePlaybackRequestedAt(context?: PlaybackSymbolContext): num
   }
   const expectedTimestamp = context.nativeExpectedTimestampMs;
   if (typeof expectedTimestamp === 'number') {
-    return toMonotonicTime(expectedTimestamp);
+    return normalizeNativeTimestamp(expectedTimestamp);
   }
   if (typeof context.monotonicTimestampMs === 'number') {
     return context.monotonicTimestampMs;
   }
   if (typeof context.nativeTimestampMs === 'number') {
-    return toMonotonicTime(context.nativeTimestampMs);
+    return normalizeNativeTimestamp(context.nativeTimestampMs);
   }
   if (typeof context.requestedAtMs === 'number') {
     return context.requestedAtMs;
@@ -1,10 +1,11 @@
 import { Animated, Platform, Vibration } from 'react-native';
 import * as Haptics from 'expo-haptics';
 
-import { playMorseCode, stopPlayback, createToneController, setOutputsFlashOverlayState, setOutputsFlashOverlayAppearance, setOutputsFlashOverlayOverride, setOutputsScreenBrightnessBoost } from '@/utils/audio';
+import { playMorseCode, stopPlayback, createToneController, drainNativeCorrelatedCommits, setOutputsFlashOverlayState, setOutputsFlashOverlayAppearance, setOutputsFlashOverlayOverride, setOutputsScreenBrightnessBoost } from '@/utils/audio';
 import type { NativeSymbolTimingContext } from '@/utils/audio';
 import { acquireTorch, releaseTorch, resetTorch, isTorchAvailable, forceTorchOff } from '@/utils/torch';
-import { nowMs, toMonotonicTime } from '@/utils/time';
+import { nowMs } from '@/utils/time';
+import { nativeToJsTime, normalizeNativeTimestamp } from '@/services/latency/clockSync';
 import { scheduleMonotonic } from '@/utils/scheduling';
 import { traceOutputs } from './trace';
 import { updateTorchSupport, recordTorchPulse, recordTorchFailure } from '@/store/useOutputsDiagnosticsStore';
@@ -49,6 +50,51 @@ const applyFlashOverride = (percent: number | null | undefined) => {
   setOutputsFlashOverlayOverride(clamped, null);
 };
 
+// Keyer presses whose tone was started natively with their id, so the tone
+// commit can be attributed to the press it belongs to.
+const NATIVE_PRESS_HISTORY = 32;
+const nativeTonePresses = new Map<string, { startedAt: number; source: string }>();
+
+const rememberNativeTonePress = (correlationId: string, startedAt: number, source: string) => {
+  nativeTonePresses.set(correlationId, { startedAt, source });
+  if (nativeTonePresses.size > NATIVE_PRESS_HISTORY) {
+    const oldest = nativeTonePresses.keys().next().value;
+    if (oldest !== undefined) {
+      nativeTonePresses.delete(oldest);
+    }
+  }
+};
+
+// Drains the native commit log: every tagged commit is traced, and tone
+// commits of keyer presses become touchToTone samples measured to the first
+// audible sample instead of to the JS startTone call returning.
+const attributeNativeCommits = () => {
+  const commits = drainNativeCorrelatedCommits();
+  for (const commit of commits) {
+    const committed = nativeToJsTime(commit.committedMs);
+    traceOutputs('outputs.native.commit', {
+      correlationId: commit.correlationId,
+      channel: commit.channel,
+      sequence: commit.sequence,
+      latencyMs: commit.latencyMs,
+      skewMs: commit.skewMs ?? null,
+      clockErrorMs: committed?.errorMs ?? null,
+      monotonicTimestampMs: committed?.timeMs ?? null,
+    });
+    const press = commit.channel === 'tone' ? nativeTonePresses.get(commit.correlationId) : undefined;
+    if (!press || !committed) {
+      continue;
+    }
+    nativeTonePresses.delete(commit.correlationId);
+    recordLatencySample('touchToTone', Math.max(0, committed.timeMs - press.startedAt), {
+      requestedAt: press.startedAt,
+      source: press.source,
+      correlationId: commit.correlationId,
+      metadata: { backend: 'nitro', committed: 'firstSample', clockErrorMs: committed.errorMs },
+    });
+  }
+};
+
 const clearFlashOverride = () => {
   if (Platform.OS !== 'android') {
     return;
@@ -756,13 +802,13 @@ const logOverlayDebugIfPresent = (event: string, payload?: Record<string, unknow
     });
   };
 
-  const startTone = async (startedAt: number) => {
+  const startTone = async (startedAt: number, correlationId: string | null) => {
     if (!options.audioEnabled) return;
     const hz = resolveToneHz();
     const volume = resolveToneVolume();
     try {
       toneController.setVolume?.(volume);
-      await toneController.start(hz);
+      await toneController.start(hz, correlationId);
       toneActive = true;
       const latencyMs = nowMs() - startedAt;
       traceOutputs('keyer.tone.start', {
@@ -772,9 +818,14 @@ const logOverlayDebugIfPresent = (event: string, payload?: Record<string, unknow
         backend: toneController.backend,
         monotonicTimestampMs: startedAt,
       });
-      recordChannelLatency('touchToTone', startedAt, latencyMs, {
-        metadata: { backend: toneController.backend, hz, volume },
-      });
+      if (toneController.backend === 'nitro' && correlationId) {
+        // Measured natively to the first audible sample; recorded at press end.
+        rememberNativeTonePress(correlationId, startedAt, contextSource);
+      } else {
+        recordChannelLatency('touchToTone', startedAt, latencyMs, {
+          metadata: { backend: toneController.backend, hz, volume },
+        });
+      }
     } catch (error) {
       toneActive = false;
       traceOutputs('keyer.tone.error', {
@@ -995,7 +1046,7 @@ const logOverlayDebugIfPresent = (event: string, payload?: Record<string, unknow
       };
       enableTorch(startedAt, torchOptions).catch(() => {});
     }
-    startTone(startedAt).catch(() => {});
+    startTone(startedAt, press.id).catch(() => {});
     schedulePressWatchdog(startedAt);
   };
 
@@ -1024,6 +1075,7 @@ const logOverlayDebugIfPresent = (event: string, payload?: Record<string, unknow
       disableTorch(endedAt, { source: contextSource, correlationId: currentPress?.id ?? null }).catch(() => {});
     }
     stopTone(endedAt).catch(() => {});
+    attributeNativeCommits();
   };
 
   const updateOptions = (next: KeyerOutputsOptions) => {
@@ -1249,7 +1301,7 @@ const defaultOutputsService: OutputsService = {
       monotonicTimestampMs != null
         ? monotonicTimestampMs
         : nativeTimestampFromMetadata != null
-          ? toMonotonicTime(nativeTimestampFromMetadata)
+          ? normalizeNativeTimestamp(nativeTimestampFromMetadata)
           : null;
     let schedulingMode: 'timeline' | 'audio-start' =
       normalizedTimelineOffset != null ? 'timeline' : 'audio-start';
@@ -1837,6 +1889,7 @@ const defaultOutputsService: OutputsService = {
     torchEnabled,
     flashBrightnessPercent,
     screenBrightnessBoost,
+    correlationIds,
   }: PlayMorseOptions) {
     const playbackSource = source ?? 'replay';
     const resolvedAudioEnabled = audioEnabled ?? true;
@@ -1892,7 +1945,7 @@ const defaultOutputsService: OutputsService = {
       const nativeAgeMs = native?.nativeAgeMs ?? null;
       const monotonicTimestampMs =
         native?.monotonicTimestampMs ??
-        (nativeTimestampMs != null ? toMonotonicTime(nativeTimestampMs) : null);
+        (nativeTimestampMs != null ? normalizeNativeTimestamp(nativeTimestampMs) : null);
       const correlationId = native?.correlationId ?? correlation.id;
       const contextPayload = {
         requestedAtMs,
@@ -1973,7 +2026,9 @@ const defaultOutputsService: OutputsService = {
         torchEnabled: resolvedTorchEnabled,
         flashBrightnessPercent: resolvedFlashBrightness,
         screenBrightnessBoost: resolvedScreenBrightnessBoost,
+        correlationIds,
       });
+      attributeNativeCommits();
       traceOutputs('playMorse.complete', {
         durationMs: nowMs() - startedAt,
         source: playbackSource,
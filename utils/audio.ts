@@ -42,13 +42,38 @@ async function ensureExpoAudioModule(): Promise<any | null> {
 // - Web: WebAudio oscillator + gain envelope for near-instant start
 // - Native (iOS/Android): expo-audio with preloaded tones, replayAsync(), pre-warm, and ping-pong players
 
-import { Platform } from 'react-native';
+import { PermissionsAndroid, Platform } from 'react-native';
+import AsyncStorage from '@react-native-async-storage/async-storage';
 import * as FileSystem from 'expo-file-system/legacy';
 import type { AudioContext as AudioApiContext, GainNode as AudioApiGainNode, OscillatorNode as AudioApiOscillatorNode } from 'react-native-audio-api';
-import type { OutputsAudio, PlaybackDispatchEvent, PlaybackSymbol } from '@/outputs-native/audio.nitro';
-import { nowMs, toMonotonicTime } from '@/utils/time';
+import type {
+  AudioFrameClock,
+  AudioRouteName,
+  AudioRouteProfiles,
+  ChannelDecodedMorseEvent,
+  ChannelLatencyProfile,
+  CorrelatedCommit,
+  CorrelatedCommits,
+  DecodedMorseEvent,
+  KeyerMode,
+  KeyerPaddle,
+  LatencyCalibrationStatus,
+  LatencyHistogramReport,
+  NativeBridgeStats,
+  OutputLatencyChannel,
+  OutputsAudio,
+  PlaybackDispatchEvent,
+  PlaybackPosition,
+  PlaybackProgressEvent,
+  PlaybackRequest,
+  PlaybackSymbol,
+  WarmupStatus,
+} from '@/outputs-native/audio.nitro';
+import type { Haptics as NativeHaptics, ImpactFeedbackStyle } from '@/outputs-native/haptics.nitro';
+import { nowMs } from '@/utils/time';
 import type { PlaybackSymbolContext } from '@/services/outputs/OutputsService';
 import { traceOutputs } from '@/services/outputs/trace';
+import { normalizeNativeTimestamp, registerNativeClockSource } from '@/services/latency/clockSync';
 import { scheduleMonotonic } from '@/utils/scheduling';
 import {
   setNativeFlashOverlayAppearance,
@@ -139,7 +164,7 @@ function createPlaybackCorrelation(source: string, rawTimestamp?: number | null)
   const base = source || 'playback';
   const normalized = base.replace(CORRELATION_SOURCE_SANITIZE, '-').replace(/-+/g, '-').replace(/^-|-$/g, '').toLowerCase();
   const token = Math.random().toString(36).slice(2, 10);
-  const startedAtMs = typeof rawTimestamp === 'number' ? toMonotonicTime(rawTimestamp) : nowMs();
+  const startedAtMs = typeof rawTimestamp === 'number' ? normalizeNativeTimestamp(rawTimestamp) : nowMs();
   return {
     id: `${normalized || 'playback'}:${token}`,
     source: base,
@@ -211,6 +236,8 @@ function loadOutputsAudio(): OutputsAudio | null {
     const instance = NitroModules.createHybridObject('OutputsAudio') as unknown as OutputsAudio | null;
     if (instance?.isSupported?.() === true) {
       outputsAudioModule = instance;
+      registerOutputsClockSource(instance);
+      void restoreChannelLatencyProfile(instance);
     } else {
       if (__DEV__ && !outputsAudioLoadLogged) {
         outputsAudioLoadLogged = true;
@@ -231,6 +258,118 @@ function loadOutputsAudio(): OutputsAudio | null {
   return outputsAudioModule;
 }
 
+function registerOutputsClockSource(instance: OutputsAudio): void {
+  const getNativeClockMs = instance.getNativeClockMs;
+  if (typeof getNativeClockMs !== 'function') {
+    return;
+  }
+  registerNativeClockSource({
+    nowMs: () => getNativeClockMs.call(instance),
+    frameClock: () => {
+      const payload = instance.getAudioFrameClock?.();
+      return payload ? (JSON.parse(payload) as AudioFrameClock) : null;
+    },
+  });
+}
+
+// The native latency tracker only lives as long as the process; without this
+// every cold start schedules torch, overlay and haptics with no lead until
+// each channel has collected its first samples again.
+const CHANNEL_LATENCY_STORAGE_KEY = 'outputs.channelLatencyProfile.v1';
+// Matches the tracker's minimum before it trusts a channel's median.
+const CHANNEL_LATENCY_MIN_SAMPLES = 5;
+const CHANNEL_LATENCY_SAVE_INTERVAL_MS = 30000;
+let channelLatencySavedAtMs = -Infinity;
+
+async function restoreChannelLatencyProfile(instance: OutputsAudio): Promise<void> {
+  if (typeof instance.seedChannelLatency !== 'function') {
+    return;
+  }
+  try {
+    const stored = await AsyncStorage.getItem(CHANNEL_LATENCY_STORAGE_KEY);
+    if (!stored) {
+      return;
+    }
+    const profile = JSON.parse(stored) as Partial<ChannelLatencyProfile>;
+    (Object.keys(profile) as OutputLatencyChannel[]).forEach((channel) => {
+      const entry = profile[channel];
+      if (entry && entry.samples >= CHANNEL_LATENCY_MIN_SAMPLES && Number.isFinite(entry.medianMs)) {
+        instance.seedChannelLatency?.(channel, entry.medianMs);
+      }
+    });
+  } catch (error) {
+    if (__DEV__) {
+      console.warn('[outputs] channel latency restore failed', error);
+    }
+  }
+}
+
+// Called after native playback; writes at most every 30 s.
+function saveChannelLatencyProfile(instance: OutputsAudio): void {
+  const now = nowMs();
+  if (now - channelLatencySavedAtMs < CHANNEL_LATENCY_SAVE_INTERVAL_MS) {
+    return;
+  }
+  const payload = instance.getChannelLatencyProfile?.();
+  if (!payload) {
+    return;
+  }
+  channelLatencySavedAtMs = now;
+  AsyncStorage.setItem(CHANNEL_LATENCY_STORAGE_KEY, payload).catch((error) => {
+    if (__DEV__) {
+      console.warn('[outputs] channel latency save failed', error);
+    }
+  });
+}
+
+let nativeHapticsModule: NativeHaptics | null = null;
+let nativeHapticsLoaded = false;
+
+// The C++ Haptics object plays prebuilt effects from the same actuator thread
+// as OutputsAudio, so it follows the same Nitro preference.
+function loadNativeHaptics(): NativeHaptics | null {
+  if (nativeHapticsLoaded) {
+    return nativeHapticsModule;
+  }
+  nativeHapticsLoaded = true;
+  if (Platform.OS !== 'android' || !shouldPreferNitroOutputs()) {
+    return nativeHapticsModule;
+  }
+  const nitro = loadNitroModules();
+  if (!nitro) {
+    return nativeHapticsModule;
+  }
+  try {
+    nativeHapticsModule = nitro.NitroModules.createHybridObject('Haptics') as unknown as NativeHaptics;
+  } catch (error) {
+    if (__DEV__) {
+      console.warn('[outputs] nitro Haptics unavailable', error);
+    }
+    nativeHapticsModule = null;
+  }
+  return nativeHapticsModule;
+}
+
+/**
+ * Plays an impact through the native Haptics object. Returns false when it is
+ * unavailable so callers can fall back to expo-haptics or Vibration.
+ */
+export function triggerNativeHapticImpact(style: ImpactFeedbackStyle): boolean {
+  const haptics = loadNativeHaptics();
+  if (!haptics) {
+    return false;
+  }
+  try {
+    haptics.impact(style);
+    return true;
+  } catch (error) {
+    if (__DEV__) {
+      console.warn('[outputs] nitro haptics impact error', error);
+    }
+    return false;
+  }
+}
+
 // Shared settings
 import { useSettingsStore } from '../store/useSettingsStore';
 import { toMorse } from './morse';
@@ -275,6 +414,9 @@ export type PlayOpts = {
   torchEnabled?: boolean;
   flashBrightnessPercent?: number;
   screenBrightnessBoost?: boolean;
+  // Press ids per mark of `code` (nitro backend only); null entries are
+  // untagged.
+  correlationIds?: (string | null)[];
 };
 
 const DEFAULT_AUDIO_VOLUME_PERCENT = 100;
@@ -554,6 +696,22 @@ async function configureExpoAudio(): Promise<void> {
   }
 }
 
+async function warmupNativeOutputs(outputsAudio: OutputsAudio, toneHz: number): Promise<void> {
+  // The async warmup opens the stream on a native thread, so app start is not
+  // held on the JS thread while the device spins up.
+  if (typeof outputsAudio.warmupAsync === 'function') {
+    try {
+      await outputsAudio.warmupAsync({ toneHz });
+      return;
+    } catch (error) {
+      if (__DEV__) {
+        console.warn('[outputs] nitro warmupAsync error', error);
+      }
+    }
+  }
+  outputsAudio.warmup({ toneHz });
+}
+
 export async function configureAudio(): Promise<void> {
   if (shouldPreferNitroOutputs()) {
     const outputsAudio = loadOutputsAudio();
@@ -562,7 +720,7 @@ export async function configureAudio(): Promise<void> {
       const resolvedHz = Number.isFinite(toneHz)
         ? Math.max(100, Math.min(2000, Math.floor(toneHz)))
         : NITRO_DEFAULT_TONE_HZ;
-      outputsAudio.warmup({ toneHz: resolvedHz });
+      await warmupNativeOutputs(outputsAudio, resolvedHz);
       return;
     }
   }
@@ -737,7 +895,8 @@ type ToneControllerBackend = 'nitro' | 'audio-api' | 'expo' | 'web' | 'noop';
 
 export type ToneController = {
   prepare(hz: number): Promise<void>;
-  start(hz?: number): Promise<void>;
+  // correlationId tags the tone's first audible sample natively (nitro only).
+  start(hz?: number, correlationId?: string | null): Promise<void>;
   stop(): Promise<void>;
   teardown(): Promise<void>;
   getCurrentHz(): number | null;
@@ -931,9 +1090,9 @@ function createNitroToneController(outputsAudio: OutputsAudio): ToneController {
       const toneHz = resolveHz(hz);
       outputsAudio.warmup({ toneHz });
     },
-    start: async (hz?: number) => {
+    start: async (hz?: number, correlationId?: string | null) => {
       const toneHz = resolveHz(hz);
-      outputsAudio.startTone({ toneHz, gain: currentGain });
+      outputsAudio.startTone({ toneHz, gain: currentGain, correlationId: correlationId ?? undefined });
       toneActive = true;
       appliedGain = currentGain;
     },
@@ -964,11 +1123,23 @@ async function playMorseCodeNitro(outputsAudio: OutputsAudio, code: string, unit
   const onSymbolStart = opts.onSymbolStart;
   const pattern: PlaybackSymbol[] = [];
   const token = ++nitroPlaybackToken;
+  // The native timeline keeps the gaps, so its progress events carry
+  // character and word boundaries; playMorse only sees the marks.
+  const nativeTimeline = typeof outputsAudio.playMorseCode === 'function';
+  // Gap after each mark in units, as the native timeline plays it.
+  const gapUnitsAfter: number[] = [];
 
   for (let i = 0; i < code.length; i += 1) {
-    const symbol = code[i] as '.' | '-' | ' ';
+    const symbol = code[i];
     if (symbol === '.' || symbol === '-') {
       pattern.push(symbol === '-' ? 'dash' : 'dot');
+      gapUnitsAfter.push(1);
+    } else if (nativeTimeline) {
+      const last = gapUnitsAfter.length - 1;
+      if (last >= 0) {
+        // " / " and double spaces collapse into one word gap natively too.
+        gapUnitsAfter[last] = symbol === '/' || gapUnitsAfter[last] !== 1 ? 7 : 3;
+      }
     } else {
       const gap = unitMs * 3;
       opts.onGap?.(gap);
@@ -1022,9 +1193,9 @@ async function playMorseCodeNitro(outputsAudio: OutputsAudio, code: string, unit
     if (typeof event.monotonicTimestampMs === 'number' && Number.isFinite(event.monotonicTimestampMs)) {
       monotonicTimestampMs = event.monotonicTimestampMs;
     } else if (typeof event.actualTimestampMs === 'number' && Number.isFinite(event.actualTimestampMs)) {
-      monotonicTimestampMs = toMonotonicTime(event.actualTimestampMs);
+      monotonicTimestampMs = normalizeNativeTimestamp(event.actualTimestampMs);
     } else if (typeof event.expectedTimestampMs === 'number' && Number.isFinite(event.expectedTimestampMs)) {
-      monotonicTimestampMs = toMonotonicTime(event.expectedTimestampMs);
+      monotonicTimestampMs = normalizeNativeTimestamp(event.expectedTimestampMs);
     } else {
       monotonicTimestampMs = nowMs();
     }
@@ -1034,6 +1205,10 @@ async function playMorseCodeNitro(outputsAudio: OutputsAudio, code: string, unit
     let correlation =
       correlationBySequence.get(sequence) ??
       createPlaybackCorrelation(playbackSource, event.actualTimestampMs ?? event.expectedTimestampMs ?? null);
+    if (typeof event.correlationId === 'string' && event.correlationId.length > 0) {
+      // The press this symbol replays; keeps its latency samples on that id.
+      correlation.id = event.correlationId;
+    }
     if (!correlationBySequence.has(sequence)) {
       correlationBySequence.set(sequence, correlation);
     }
@@ -1077,7 +1252,7 @@ async function playMorseCodeNitro(outputsAudio: OutputsAudio, code: string, unit
         }
         opts.onSymbolEnd?.(symbol, durationMs);
         if (patternIndex < pattern.length - 1) {
-          opts.onGap?.(unitMs);
+          opts.onGap?.(unitMs * (gapUnitsAfter[patternIndex] ?? 1));
         }
         if (isLastSymbol && playbackCompletedResolve) {
           playbackCompletedResolve();
@@ -1099,7 +1274,7 @@ async function playMorseCodeNitro(outputsAudio: OutputsAudio, code: string, unit
 
   try {
     outputsAudio.warmup({ toneHz: hz, gain });
-    outputsAudio.playMorse({
+    const request: PlaybackRequest = {
       toneHz: hz,
       unitMs,
       pattern,
@@ -1109,7 +1284,13 @@ async function playMorseCodeNitro(outputsAudio: OutputsAudio, code: string, unit
       torchEnabled: opts.torchEnabled ?? false,
       flashBrightnessPercent: opts.flashBrightnessPercent,
       screenBrightnessBoost: opts.screenBrightnessBoost ?? false,
-    });
+      correlationIds: opts.correlationIds?.map((id) => id ?? ''),
+    };
+    if (nativeTimeline && outputsAudio.playMorseCode) {
+      outputsAudio.playMorseCode(request, code);
+    } else {
+      outputsAudio.playMorse(request);
+    }
     await playbackCompleted;
   } catch (error) {
     if (playbackCompletedResolve) {
@@ -1136,6 +1317,7 @@ async function playMorseCodeNitro(outputsAudio: OutputsAudio, code: string, unit
       playbackCompletedResolve();
       playbackCompletedResolve = null;
     }
+    saveChannelLatencyProfile(outputsAudio);
   }
 }
 function createAudioApiToneController(audioApi: AudioApiModule): ToneController {
@@ -1564,6 +1746,649 @@ export function setOutputsScreenBrightnessBoost(enabled: boolean): boolean {
   return handled;
 }
 
+export type NativeKeyerOptions = {
+  toneHz: number;
+  unitMs: number;
+  mode?: KeyerMode;
+  weighting?: number;
+  gain?: number | null;
+};
+
+/**
+ * Configures the native iambic keyer. Returns false when Nitro outputs (or the
+ * keyer entry points) are unavailable so callers can stay on the JS keyer.
+ */
+export function configureNativeKeyer(options: NativeKeyerOptions): boolean {
+  if (!shouldPreferNitroOutputs()) {
+    return false;
+  }
+  const outputsAudio = loadOutputsAudio();
+  if (!outputsAudio || typeof outputsAudio.configureKeyer !== 'function') {
+    return false;
+  }
+  try {
+    return outputsAudio.configureKeyer(
+      options.toneHz,
+      options.unitMs,
+      options.mode ?? 'iambicB',
+      options.weighting ?? 0.5,
+      options.gain ?? null,
+    );
+  } catch (error) {
+    if (__DEV__) {
+      console.warn('[outputs] nitro configureKeyer error', error);
+    }
+    return false;
+  }
+}
+
+export function setNativeKeyerEnabled(enabled: boolean): boolean {
+  if (!shouldPreferNitroOutputs()) {
+    return false;
+  }
+  const outputsAudio = loadOutputsAudio();
+  if (!outputsAudio || typeof outputsAudio.setKeyerEnabled !== 'function') {
+    return false;
+  }
+  try {
+    return outputsAudio.setKeyerEnabled(enabled);
+  } catch (error) {
+    if (__DEV__) {
+      console.warn('[outputs] nitro setKeyerEnabled error', error);
+    }
+    return false;
+  }
+}
+
+export function setNativeKeyerPaddle(paddle: KeyerPaddle, down: boolean): boolean {
+  const outputsAudio = shouldPreferNitroOutputs() ? loadOutputsAudio() : null;
+  if (!outputsAudio || typeof outputsAudio.setKeyerPaddle !== 'function') {
+    return false;
+  }
+  try {
+    return outputsAudio.setKeyerPaddle(paddle, down);
+  } catch (error) {
+    if (__DEV__) {
+      console.warn('[outputs] nitro setKeyerPaddle error', error);
+    }
+    return false;
+  }
+}
+
+export type NativePressClassifier = {
+  push(down: boolean, timestampMs: number): DecodedMorseEvent[];
+  flush(nowMs: number): DecodedMorseEvent[];
+  reset(unitMs: number): void;
+};
+
+function parseDecodedEvents(payload: string | null | undefined): DecodedMorseEvent[] {
+  if (!payload) {
+    return [];
+  }
+  try {
+    const parsed = JSON.parse(payload);
+    return Array.isArray(parsed) ? (parsed as DecodedMorseEvent[]) : [];
+  } catch (error) {
+    if (__DEV__) {
+      console.warn('[outputs] nitro press classifier payload error', error);
+    }
+    return [];
+  }
+}
+
+/**
+ * Returns the native adaptive press classifier, seeded with `unitMs`, or null
+ * when Nitro outputs are unavailable so callers keep using `morseTiming.ts`.
+ */
+export function createNativePressClassifier(unitMs: number): NativePressClassifier | null {
+  const outputsAudio = shouldPreferNitroOutputs() ? loadOutputsAudio() : null;
+  if (
+    !outputsAudio ||
+    typeof outputsAudio.resetPressClassifier !== 'function' ||
+    typeof outputsAudio.pushPressEdge !== 'function' ||
+    typeof outputsAudio.flushPressClassifier !== 'function'
+  ) {
+    return null;
+  }
+  try {
+    outputsAudio.resetPressClassifier(unitMs);
+  } catch (error) {
+    if (__DEV__) {
+      console.warn('[outputs] nitro resetPressClassifier error', error);
+    }
+    return null;
+  }
+  return {
+    push(down, timestampMs) {
+      return parseDecodedEvents(outputsAudio.pushPressEdge?.(down, timestampMs));
+    },
+    flush(nowMs) {
+      return parseDecodedEvents(outputsAudio.flushPressClassifier?.(nowMs));
+    },
+    reset(nextUnitMs) {
+      outputsAudio.resetPressClassifier?.(nextUnitMs);
+    },
+  };
+}
+
+export type NativeCwReceiverState = {
+  elapsedMs: number;
+  noiseLevel: number;
+  signalLevel: number;
+  snrDb: number;
+  keyed: boolean;
+  droppedEdges: number;
+  classifier: {
+    unitMs: number;
+    dotMs: number;
+    dashMs: number;
+    marks: number;
+  };
+};
+
+export type NativeCwReceiver = {
+  poll(): DecodedMorseEvent[];
+  getState(): NativeCwReceiverState | null;
+  stop(): void;
+};
+
+async function ensureRecordAudioPermission(): Promise<boolean> {
+  if (Platform.OS !== 'android') {
+    return false;
+  }
+  try {
+    const permission = PermissionsAndroid.PERMISSIONS.RECORD_AUDIO;
+    if (await PermissionsAndroid.check(permission)) {
+      return true;
+    }
+    const result = await PermissionsAndroid.request(permission);
+    return result === PermissionsAndroid.RESULTS.GRANTED;
+  } catch (error) {
+    if (__DEV__) {
+      console.warn('[outputs] record audio permission error', error);
+    }
+    return false;
+  }
+}
+
+/**
+ * Start decoding CW from the microphone. Detection runs in the native input
+ * callback; call poll() on a timer (every 50-100 ms is plenty) to collect
+ * decoded letters and word breaks.
+ */
+export async function startNativeCwReceiver(toneHz: number, unitMs: number): Promise<NativeCwReceiver | null> {
+  const outputsAudio = shouldPreferNitroOutputs() ? loadOutputsAudio() : null;
+  if (
+    !outputsAudio ||
+    typeof outputsAudio.startCwReceiver !== 'function' ||
+    typeof outputsAudio.pollCwReceiver !== 'function'
+  ) {
+    return null;
+  }
+  if (!(await ensureRecordAudioPermission())) {
+    return null;
+  }
+  try {
+    if (!outputsAudio.startCwReceiver(toneHz, unitMs)) {
+      return null;
+    }
+  } catch (error) {
+    if (__DEV__) {
+      console.warn('[outputs] nitro startCwReceiver error', error);
+    }
+    return null;
+  }
+  return {
+    poll() {
+      return parseDecodedEvents(outputsAudio.pollCwReceiver?.());
+    },
+    getState() {
+      const payload = outputsAudio.getCwReceiverState?.();
+      if (!payload) {
+        return null;
+      }
+      try {
+        return JSON.parse(payload) as NativeCwReceiverState;
+      } catch {
+        return null;
+      }
+    },
+    stop() {
+      try {
+        outputsAudio.stopCwReceiver?.();
+      } catch (error) {
+        if (__DEV__) {
+          console.warn('[outputs] nitro stopCwReceiver error', error);
+        }
+      }
+    },
+  };
+}
+
+/** Decode a WAV recording on the native side; returns null when unsupported. */
+export function decodeNativeWavFile(path: string, toneHz: number, unitMs: number): DecodedMorseEvent[] | null {
+  const outputsAudio = shouldPreferNitroOutputs() ? loadOutputsAudio() : null;
+  if (!outputsAudio || typeof outputsAudio.decodeWavFile !== 'function') {
+    return null;
+  }
+  try {
+    const payload = outputsAudio.decodeWavFile(path.replace(/^file:\/\//, ''), toneHz, unitMs);
+    return payload == null ? null : parseDecodedEvents(payload);
+  } catch (error) {
+    if (__DEV__) {
+      console.warn('[outputs] nitro decodeWavFile error', error);
+    }
+    return null;
+  }
+}
+
+/**
+ * Decode every CW signal in a WAV recording (e.g. a pileup) on the native
+ * side. Carriers are found automatically; `unitMs` only seeds each channel's
+ * speed estimate.
+ */
+export function decodeNativePileupWavFile(path: string, unitMs: number): ChannelDecodedMorseEvent[] | null {
+  const outputsAudio = shouldPreferNitroOutputs() ? loadOutputsAudio() : null;
+  if (!outputsAudio || typeof outputsAudio.decodePileupWavFile !== 'function') {
+    return null;
+  }
+  try {
+    const payload = outputsAudio.decodePileupWavFile(path.replace(/^file:\/\//, ''), unitMs);
+    return payload == null ? null : (parseDecodedEvents(payload) as ChannelDecodedMorseEvent[]);
+  } catch (error) {
+    if (__DEV__) {
+      console.warn('[outputs] nitro decodePileupWavFile error', error);
+    }
+    return null;
+  }
+}
+
+/** Native per-channel latency histograms; covers the whole session since the last reset. */
+export function getNativeLatencyHistograms(): LatencyHistogramReport | null {
+  const outputsAudio = shouldPreferNitroOutputs() ? loadOutputsAudio() : null;
+  if (!outputsAudio || typeof outputsAudio.getLatencyHistograms !== 'function') {
+    return null;
+  }
+  try {
+    const payload = outputsAudio.getLatencyHistograms();
+    return payload ? (JSON.parse(payload) as LatencyHistogramReport) : null;
+  } catch (error) {
+    if (__DEV__) {
+      console.warn('[outputs] nitro getLatencyHistograms error', error);
+    }
+    return null;
+  }
+}
+
+export function resetNativeLatencyHistograms(): void {
+  const outputsAudio = shouldPreferNitroOutputs() ? loadOutputsAudio() : null;
+  if (!outputsAudio || typeof outputsAudio.resetLatencyHistograms !== 'function') {
+    return;
+  }
+  try {
+    outputsAudio.resetLatencyHistograms();
+  } catch (error) {
+    if (__DEV__) {
+      console.warn('[outputs] nitro resetLatencyHistograms error', error);
+    }
+  }
+}
+
+let correlatedCommitCursor = 0;
+
+/**
+ * Tone and actuator commits tagged with a press correlation id since the
+ * previous call (native steady-clock times; convert with nativeToJsTime).
+ */
+export function drainNativeCorrelatedCommits(): CorrelatedCommit[] {
+  const outputsAudio = shouldPreferNitroOutputs() ? loadOutputsAudio() : null;
+  if (!outputsAudio || typeof outputsAudio.getCorrelatedCommits !== 'function') {
+    return [];
+  }
+  try {
+    const payload = outputsAudio.getCorrelatedCommits(correlatedCommitCursor);
+    if (!payload) {
+      return [];
+    }
+    const parsed = JSON.parse(payload) as CorrelatedCommits;
+    correlatedCommitCursor = parsed.cursor;
+    if (__DEV__ && parsed.dropped > 0) {
+      console.warn('[outputs] nitro correlated commits dropped', parsed.dropped);
+    }
+    return parsed.records;
+  } catch (error) {
+    if (__DEV__) {
+      console.warn('[outputs] nitro getCorrelatedCommits error', error);
+    }
+    return [];
+  }
+}
+
+/**
+ * Call count, failures and latency of every JNI call into NativeOutputsDispatcher
+ * since the last reset; compare with the startSkew histograms to tell a slow
+ * Java callee from an audio-path stall.
+ */
+export function getNativeBridgeStats(): NativeBridgeStats | null {
+  const outputsAudio = shouldPreferNitroOutputs() ? loadOutputsAudio() : null;
+  if (!outputsAudio || typeof outputsAudio.getBridgeStats !== 'function') {
+    return null;
+  }
+  try {
+    const payload = outputsAudio.getBridgeStats();
+    return payload ? (JSON.parse(payload) as NativeBridgeStats) : null;
+  } catch (error) {
+    if (__DEV__) {
+      console.warn('[outputs] nitro getBridgeStats error', error);
+    }
+    return null;
+  }
+}
+
+export function resetNativeBridgeStats(): void {
+  const outputsAudio = shouldPreferNitroOutputs() ? loadOutputsAudio() : null;
+  if (!outputsAudio || typeof outputsAudio.resetBridgeStats !== 'function') {
+    return;
+  }
+  try {
+    outputsAudio.resetBridgeStats();
+  } catch (error) {
+    if (__DEV__) {
+      console.warn('[outputs] nitro resetBridgeStats error', error);
+    }
+  }
+}
+
+export function getNativeWarmupStatus(): WarmupStatus | null {
+  const outputsAudio = shouldPreferNitroOutputs() ? loadOutputsAudio() : null;
+  if (!outputsAudio || typeof outputsAudio.getWarmupStatus !== 'function') {
+    return null;
+  }
+  try {
+    const payload = outputsAudio.getWarmupStatus();
+    return payload ? (JSON.parse(payload) as WarmupStatus) : null;
+  } catch (error) {
+    if (__DEV__) {
+      console.warn('[outputs] nitro getWarmupStatus error', error);
+    }
+    return null;
+  }
+}
+
+/**
+ * Latency profile of every output device the engine has played on, plus the
+ * active one. Persist the presentation offsets and hand them back through
+ * restoreNativeAudioRouteProfile on the next launch.
+ */
+export function getNativeAudioRouteProfiles(): AudioRouteProfiles | null {
+  const outputsAudio = shouldPreferNitroOutputs() ? loadOutputsAudio() : null;
+  if (!outputsAudio || typeof outputsAudio.getAudioRouteProfiles !== 'function') {
+    return null;
+  }
+  try {
+    const payload = outputsAudio.getAudioRouteProfiles();
+    return payload ? (JSON.parse(payload) as AudioRouteProfiles) : null;
+  } catch (error) {
+    if (__DEV__) {
+      console.warn('[outputs] nitro getAudioRouteProfiles error', error);
+    }
+    return null;
+  }
+}
+
+export function restoreNativeAudioRouteProfile(
+  route: AudioRouteName,
+  deviceName: string,
+  presentationOffsetMs: number,
+): boolean {
+  const outputsAudio = shouldPreferNitroOutputs() ? loadOutputsAudio() : null;
+  if (!outputsAudio || typeof outputsAudio.setAudioRouteProfile !== 'function') {
+    return false;
+  }
+  try {
+    return outputsAudio.setAudioRouteProfile(route, deviceName, presentationOffsetMs);
+  } catch (error) {
+    if (__DEV__) {
+      console.warn('[outputs] nitro setAudioRouteProfile error', error);
+    }
+    return false;
+  }
+}
+
+/**
+ * Measures the active route's output latency with a loopback: chirps are
+ * played and recorded back through the phone's microphone, so with
+ * headphones an earpiece has to be held against it. Poll
+ * getNativeLatencyCalibration for progress; a consistent result becomes the
+ * route's presentation offset.
+ */
+export async function startNativeLatencyCalibration(): Promise<boolean> {
+  const outputsAudio = shouldPreferNitroOutputs() ? loadOutputsAudio() : null;
+  if (!outputsAudio || typeof outputsAudio.startLatencyCalibration !== 'function') {
+    return false;
+  }
+  if (!(await ensureRecordAudioPermission())) {
+    return false;
+  }
+  try {
+    return outputsAudio.startLatencyCalibration();
+  } catch (error) {
+    if (__DEV__) {
+      console.warn('[outputs] nitro startLatencyCalibration error', error);
+    }
+    return false;
+  }
+}
+
+export function getNativeLatencyCalibration(): LatencyCalibrationStatus | null {
+  const outputsAudio = shouldPreferNitroOutputs() ? loadOutputsAudio() : null;
+  if (!outputsAudio || typeof outputsAudio.getLatencyCalibration !== 'function') {
+    return null;
+  }
+  try {
+    const payload = outputsAudio.getLatencyCalibration();
+    return payload ? (JSON.parse(payload) as LatencyCalibrationStatus) : null;
+  } catch (error) {
+    if (__DEV__) {
+      console.warn('[outputs] nitro getLatencyCalibration error', error);
+    }
+    return null;
+  }
+}
+
+export function cancelNativeLatencyCalibration(): void {
+  const outputsAudio = shouldPreferNitroOutputs() ? loadOutputsAudio() : null;
+  if (!outputsAudio || typeof outputsAudio.cancelLatencyCalibration !== 'function') {
+    return;
+  }
+  try {
+    outputsAudio.cancelLatencyCalibration();
+  } catch (error) {
+    if (__DEV__) {
+      console.warn('[outputs] nitro cancelLatencyCalibration error', error);
+    }
+  }
+}
+
+const DEFAULT_TRACE_CAPACITY_EVENTS = 1 << 18;
+
+function nativeTracePath(name: string): string | null {
+  const dir = FileSystem.documentDirectory;
+  return dir ? `${dir}${name}`.replace(/^file:\/\//, '') : null;
+}
+
+/**
+ * Start recording a binary output-timing trace (callbacks, tone edges,
+ * dispatches, actuator JNI calls, xruns) into a memory-mapped ring file.
+ * Returns the ring file path, or null when unsupported.
+ */
+export function startNativeOutputTrace(capacityEvents: number = DEFAULT_TRACE_CAPACITY_EVENTS): string | null {
+  const outputsAudio = shouldPreferNitroOutputs() ? loadOutputsAudio() : null;
+  const path = nativeTracePath('morse-trace.bin');
+  if (!outputsAudio || typeof outputsAudio.startTrace !== 'function' || !path) {
+    return null;
+  }
+  try {
+    return outputsAudio.startTrace(path, capacityEvents) ? path : null;
+  } catch (error) {
+    if (__DEV__) {
+      console.warn('[outputs] nitro startTrace error', error);
+    }
+    return null;
+  }
+}
+
+export function stopNativeOutputTrace(): void {
+  const outputsAudio = shouldPreferNitroOutputs() ? loadOutputsAudio() : null;
+  if (!outputsAudio || typeof outputsAudio.stopTrace !== 'function') {
+    return;
+  }
+  try {
+    outputsAudio.stopTrace();
+  } catch (error) {
+    if (__DEV__) {
+      console.warn('[outputs] nitro stopTrace error', error);
+    }
+  }
+}
+
+/**
+ * Export the current (or last) trace as Chrome trace JSON, loadable in
+ * ui.perfetto.dev. Returns the file URI, or null on failure.
+ */
+export function exportNativeOutputTrace(): string | null {
+  const outputsAudio = shouldPreferNitroOutputs() ? loadOutputsAudio() : null;
+  const path = nativeTracePath('morse-trace.json');
+  if (!outputsAudio || typeof outputsAudio.exportTrace !== 'function' || !path) {
+    return null;
+  }
+  try {
+    return outputsAudio.exportTrace(path) ? `file://${path}` : null;
+  } catch (error) {
+    if (__DEV__) {
+      console.warn('[outputs] nitro exportTrace error', error);
+    }
+    return null;
+  }
+}
+
+// Plays a whole lesson as one native timeline so it can be paused and seeked
+// by symbol or character. Completion is reported through the dispatch callback.
+export function playNativeMorseTimeline(code: string, request: Omit<PlaybackRequest, 'pattern'>): boolean {
+  const outputsAudio = shouldPreferNitroOutputs() ? loadOutputsAudio() : null;
+  if (!outputsAudio || typeof outputsAudio.playMorseCode !== 'function') {
+    return false;
+  }
+  try {
+    outputsAudio.playMorseCode({ ...request, pattern: [] }, code);
+    return true;
+  } catch (error) {
+    if (__DEV__) {
+      console.warn('[outputs] nitro playMorseCode error', error);
+    }
+    return false;
+  }
+}
+
+/**
+ * Character and word boundaries of native timelines, pushed as they play
+ * (see PlaybackProgressEvent); timestamps arrive already converted to JS
+ * time. Pass null to stop. Returns false when the native side cannot push.
+ */
+export function setNativePlaybackProgressListener(listener: ((event: PlaybackProgressEvent) => void) | null): boolean {
+  const outputsAudio = shouldPreferNitroOutputs() ? loadOutputsAudio() : null;
+  if (!outputsAudio || typeof outputsAudio.setPlaybackProgressCallback !== 'function') {
+    return false;
+  }
+  try {
+    outputsAudio.setPlaybackProgressCallback(
+      listener
+        ? (event: PlaybackProgressEvent) => {
+            listener({ ...event, timestampMs: normalizeNativeTimestamp(event.timestampMs) });
+          }
+        : null,
+    );
+    return true;
+  } catch (error) {
+    if (__DEV__) {
+      console.warn('[outputs] nitro setPlaybackProgressCallback error', error);
+    }
+    return false;
+  }
+}
+
+function callPlaybackControl(
+  name: 'pausePlayback' | 'resumePlayback' | 'seekPlaybackToSymbol' | 'seekPlaybackToCharacter' | 'setPlaybackUnitMs',
+  arg?: number,
+): boolean {
+  const outputsAudio = shouldPreferNitroOutputs() ? loadOutputsAudio() : null;
+  const method = outputsAudio?.[name];
+  if (!outputsAudio || typeof method !== 'function') {
+    return false;
+  }
+  try {
+    return (method as (value?: number) => boolean).call(outputsAudio, arg);
+  } catch (error) {
+    if (__DEV__) {
+      console.warn(`[outputs] nitro ${name} error`, error);
+    }
+    return false;
+  }
+}
+
+export function pauseNativePlayback(): boolean {
+  return callPlaybackControl('pausePlayback');
+}
+
+export function resumeNativePlayback(): boolean {
+  return callPlaybackControl('resumePlayback');
+}
+
+// sequence is 1-based, matching PlaybackDispatchEvent.sequence.
+export function seekNativePlaybackToSymbol(sequence: number): boolean {
+  return callPlaybackControl('seekPlaybackToSymbol', sequence);
+}
+
+export function seekNativePlaybackToCharacter(character: number): boolean {
+  return callPlaybackControl('seekPlaybackToCharacter', character);
+}
+
+// Retimes the rest of the running pattern without restarting it.
+export function setNativePlaybackUnitMs(unitMs: number): boolean {
+  return callPlaybackControl('setPlaybackUnitMs', unitMs);
+}
+
+export function setNativePlaybackToneHz(toneHz: number, glideMs?: number): boolean {
+  const outputsAudio = shouldPreferNitroOutputs() ? loadOutputsAudio() : null;
+  if (!outputsAudio || typeof outputsAudio.setPlaybackToneHz !== 'function') {
+    return false;
+  }
+  try {
+    return outputsAudio.setPlaybackToneHz(toneHz, glideMs);
+  } catch (error) {
+    if (__DEV__) {
+      console.warn('[outputs] nitro setPlaybackToneHz error', error);
+    }
+    return false;
+  }
+}
+
+export function getNativePlaybackPosition(): PlaybackPosition | null {
+  const outputsAudio = shouldPreferNitroOutputs() ? loadOutputsAudio() : null;
+  if (!outputsAudio || typeof outputsAudio.getPlaybackPosition !== 'function') {
+    return null;
+  }
+  try {
+    const payload = outputsAudio.getPlaybackPosition();
+    return payload ? (JSON.parse(payload) as PlaybackPosition) : null;
+  } catch (error) {
+    if (__DEV__) {
+      console.warn('[outputs] nitro getPlaybackPosition error', error);
+    }
+    return null;
+  }
+}
+
 export async function playTextAsMorse(text: string, opts: PlayOpts = {}) {
   const unitMs = opts.unitMsOverride ?? getMorseUnitMs();
   const chars = text.split('');